@@ -2,19 +2,18 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
-#include "nlohmann/json.hpp"
+// This executable is kept for compatibility,
+// linglong runtime program runs linglong::generator::IDMapping in process.
 
-#include <iostream>
+#include "linglong/oci_cfg_generators/id_mapping.h"
 
-#include <unistd.h>
+#include <iostream>
 
 int main()
 {
     nlohmann::json content;
-    std::string ociVersion;
     try {
         content = nlohmann::json::parse(std::cin);
-        ociVersion = content.at("ociVersion");
     } catch (std::exception &exp) {
         std::cerr << exp.what() << std::endl;
         return -1;
@@ -23,23 +22,10 @@ int main()
         return -1;
     }
 
-    if (ociVersion != "1.0.1") {
-        std::cerr << "OCI version mismatched." << std::endl;
+    if (!linglong::generator::IDMapping{}.generate(content)) {
         return -1;
     }
 
-    content["linux"]["uidMappings"] = nlohmann::json::array({ nlohmann::json::object({
-      { "containerID", ::getuid() },
-      { "hostID", ::getuid() },
-      { "size", 1 },
-    }) });
-
-    content["linux"]["gidMappings"] = nlohmann::json::array({ nlohmann::json::object({
-      { "containerID", ::getgid() },
-      { "hostID", ::getgid() },
-      { "size", 1 },
-    }) });
-
     std::cout << content.dump() << std::endl;
     return 0;
 }
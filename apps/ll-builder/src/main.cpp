@@ -9,12 +9,13 @@
 #include "linglong/builder/linglong_builder.h"
 #include "linglong/package/architecture.h"
 #include "linglong/repo/config.h"
+#include "linglong/runtime/oci_runtime.h"
 #include "linglong/utils/command/env.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/error/error.h"
+#include "linglong/utils/finally/finally.h"
 #include "linglong/utils/global/initialize.h"
 #include "linglong/utils/serialize/yaml.h"
-#include "ocppi/cli/crun/Crun.hpp"
 
 #include <QCommandLineOption>
 #include <QCommandLineParser>
@@ -22,8 +23,12 @@
 #include <QMap>
 #include <QRegExp>
 
+#include <atomic>
+#include <csignal>
 #include <fstream>
+#include <thread>
 
+#include <glib-unix.h>
 #include <wordexp.h>
 
 namespace {
@@ -116,15 +121,11 @@ int main(int argc, char **argv)
 
     applicationInitializte();
 
-    auto path = QStandardPaths::findExecutable("crun");
-    if (path.isEmpty()) {
-        qCritical() << "crun not found";
+    auto ociRuntime = linglong::runtime::newOCIRuntime();
+    if (!ociRuntime) {
+        qCritical() << ociRuntime.error();
         return -1;
     }
-    auto crun = ocppi::cli::crun::Crun::New(path.toStdString());
-    if (!crun.has_value()) {
-        std::rethrow_exception(crun.error());
-    }
 
     QCommandLineParser parser;
 
@@ -359,7 +360,7 @@ int main(int argc, char **argv)
         return -1;
     }
 
-    auto containerBuidler = new linglong::runtime::ContainerBuilder(**crun);
+    auto containerBuidler = new linglong::runtime::ContainerBuilder(**ociRuntime);
     containerBuidler->setParent(QCoreApplication::instance());
 
     linglong::builder::Builder builder(*project,
@@ -422,6 +423,14 @@ int main(int argc, char **argv)
               auto buildSkipCommitOutput =
                 QCommandLineOption("skip-commit-output", "skip commit build output", "");
               auto buildArch = QCommandLineOption("arch", "set the build arch", "arch");
+              auto buildSkipBuildCache =
+                QCommandLineOption("skip-build-cache",
+                                   "build even if nothing changed since the last build",
+                                   "");
+
+              auto buildFetchJobs = QCommandLineOption("fetch-jobs",
+                                                       "number of sources fetched at the same time",
+                                                       "jobs");
 
               parser.addOptions({ execVerbose,
                                   pkgVersion,
@@ -430,7 +439,9 @@ int main(int argc, char **argv)
                                   buildOffline,
                                   buildSkipFetchSource,
                                   buildSkipCommitOutput,
-                                  buildArch });
+                                  buildArch,
+                                  buildSkipBuildCache,
+                                  buildFetchJobs });
 
               parser.addPositionalArgument("build", "build project", "build");
 
@@ -447,6 +458,25 @@ int main(int argc, char **argv)
                   builder.setConfig(cfg);
               }
 
+              if (parser.isSet(buildFetchJobs)) {
+                  bool ok = false;
+                  auto jobs = parser.value(buildFetchJobs).toInt(&ok);
+                  if (!ok || jobs < 1) {
+                      qCritical() << "invalid number of jobs" << parser.value(buildFetchJobs);
+                      return -1;
+                  }
+                  auto cfg = builder.getConfig();
+                  cfg.fetchJobs = jobs;
+                  builder.setConfig(cfg);
+              }
+
+              // Commands given by --exec are usually interactive, always run them.
+              if (parser.isSet(buildSkipBuildCache) || parser.isSet(execVerbose)) {
+                  auto cfg = builder.getConfig();
+                  cfg.skipBuildCache = true;
+                  builder.setConfig(cfg);
+              }
+
               auto exec = QStringList{ "/source/entry.sh" };
               if (parser.isSet(execVerbose)) {
                   exec = splitExec(parser.value(execVerbose));
@@ -489,9 +519,24 @@ int main(int argc, char **argv)
           [&](QCommandLineParser &parser) -> int {
               LINGLONG_TRACE("command export");
               parser.clearPositionalArguments();
+
+              auto optCompressor =
+                QCommandLineOption("compressor",
+                                   "compression of the layer: lz4, lz4hc[,level], lzma[,level], "
+                                   "deflate[,level] or zstd[,level], as supported by mkfs.erofs",
+                                   "compressor");
+              auto optDeltaFrom =
+                QCommandLineOption("delta-from",
+                                   "also export a delta from an older layer file of the runtime "
+                                   "module, which can be installed by ll-cli install",
+                                   "layer");
+              parser.addOptions({ optCompressor, optDeltaFrom });
+
               parser.process(app);
 
-              auto result = builder.exportLayer(QDir().absolutePath());
+              auto result = builder.exportLayer(QDir().absolutePath(),
+                                                parser.value(optCompressor),
+                                                parser.value(optDeltaFrom));
               if (!result) {
                   qCritical() << result.error();
                   return -1;
@@ -566,7 +611,12 @@ int main(int argc, char **argv)
               auto optRepoChannel =
                 QCommandLineOption("channel", "remote repo channel", "--channel", "main");
               auto optNoDevel = QCommandLineOption("no-devel", "push without devel", "");
-              parser.addOptions({ optRepoUrl, optRepoName, optRepoChannel, optNoDevel });
+              auto optTimeout = QCommandLineOption("timeout",
+                                                   "give up after seconds, 0 means no limit",
+                                                   "seconds",
+                                                   "0");
+              parser.addOptions(
+                { optRepoUrl, optRepoName, optRepoChannel, optNoDevel, optTimeout });
 
               parser.process(app);
 
@@ -576,7 +626,49 @@ int main(int argc, char **argv)
 
               bool pushWithDevel = parser.isSet(optNoDevel) ? false : true;
 
-              auto result = builder.push(pushWithDevel, repoUrl, repoName);
+              bool ok = false;
+              const auto timeout = parser.value(optTimeout).toLongLong(&ok);
+              if (!ok || timeout < 0) {
+                  qCritical() << "invalid timeout" << parser.value(optTimeout);
+                  return -1;
+              }
+
+              linglong::repo::pushOption opts;
+              // One deadline for the pushes of the layers with and without devel.
+              if (timeout > 0) {
+                  opts.deadline = QDeadlineTimer(std::chrono::seconds(timeout));
+              }
+
+              // The push blocks the main thread, SIGINT and SIGTERM cancel it from a thread of
+              // their own.
+              g_autoptr(GCancellable) cancellable = g_cancellable_new();
+              opts.cancellable = cancellable;
+              g_autoptr(GMainContext) signalContext = g_main_context_new();
+              for (const auto sig : { SIGINT, SIGTERM }) {
+                  g_autoptr(GSource) source = g_unix_signal_source_new(sig);
+                  g_source_set_callback(
+                    source,
+                    [](gpointer data) -> gboolean {
+                        g_cancellable_cancel(static_cast<GCancellable *>(data));
+                        return G_SOURCE_CONTINUE;
+                    },
+                    cancellable,
+                    nullptr);
+                  g_source_attach(source, signalContext);
+              }
+              std::atomic_bool pushed{ false };
+              std::thread signalThread([&pushed, context = signalContext]() {
+                  while (!pushed) {
+                      g_main_context_iteration(context, TRUE);
+                  }
+              });
+              auto stopSignalThread = linglong::utils::finally::finally([&]() {
+                  pushed = true;
+                  g_main_context_wakeup(signalContext);
+                  signalThread.join();
+              });
+
+              auto result = builder.push(pushWithDevel, repoUrl, repoName, opts);
               if (!result) {
                   qCritical() << result.error();
                   return -1;
@@ -9,9 +9,10 @@
 #include "linglong/repo/config.h"
 #include "linglong/repo/ostree_repo.h"
 #include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/oci_runtime.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/finally/finally.h"
-#include "ocppi/cli/crun/Crun.hpp"
+#include "linglong/utils/trace/trace.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -112,6 +113,7 @@ int main(int argc, char **argv)
     auto ret = QMetaObject::invokeMethod(
       QCoreApplication::instance(),
       [&argc, &argv]() {
+          const auto started = linglong::utils::trace::Clock::now();
           auto raw_args = transformOldExec(argc, argv);
 
           std::map<std::string, docopt::value> args =
@@ -120,6 +122,13 @@ int main(int argc, char **argv)
                            true,                              // show help if requested
                            "linglong CLI " LINGLONG_VERSION); // version string
 
+          if (args["--trace"].isString()) {
+              linglong::utils::trace::enable(QString::fromStdString(args["--trace"].asString()));
+              linglong::utils::trace::complete("parse arguments",
+                                               started,
+                                               linglong::utils::trace::Clock::now());
+          }
+
           auto pkgManConn = QDBusConnection::systemBus();
           auto pkgMan =
             new linglong::api::dbus::v1::PackageManager("org.deepin.linglong.PackageManager",
@@ -165,6 +174,7 @@ int main(int argc, char **argv)
           } else {
               // NOTE: We need to ping package manager to make it initialize system linglong
               // repository.
+              LINGLONG_SPAN("ping package manager");
               auto peer = linglong::api::dbus::v1::DBusPeer("org.deepin.linglong.PackageManager",
                                                             "/org/deepin/linglong/PackageManager",
                                                             pkgManConn);
@@ -185,6 +195,7 @@ int main(int argc, char **argv)
               printer = std::make_unique<Printer>();
           }
 
+          linglong::utils::trace::Span initSpan("initialize");
           linglong::api::client::ClientApi api;
           auto config = linglong::repo::loadConfig(
             { LINGLONG_ROOT "/config.yaml", LINGLONG_DATA_DIR "/config.yaml" });
@@ -196,20 +207,17 @@ int main(int argc, char **argv)
           auto *repo = new linglong::repo::OSTreeRepo(QDir(LINGLONG_ROOT), *config, api);
           repo->setParent(QCoreApplication::instance());
 
-          auto path = QStandardPaths::findExecutable("crun");
-          if (path.isEmpty()) {
-              qCritical() << "crun not found";
+          auto ociRuntime = linglong::runtime::newOCIRuntime();
+          if (!ociRuntime) {
+              qCritical() << ociRuntime.error();
               QCoreApplication::exit(-1);
               return;
           }
-          auto crun = ocppi::cli::crun::Crun::New(path.toStdString());
-          if (!crun) {
-              std::rethrow_exception(crun.error());
-          }
-          auto containerBuidler = new linglong::runtime::ContainerBuilder(**crun);
+          auto containerBuidler = new linglong::runtime::ContainerBuilder(**ociRuntime);
           containerBuidler->setParent(QCoreApplication::instance());
+          initSpan.end();
           auto cli = new linglong::cli::Cli(*printer,
-                                            **crun,
+                                            **ociRuntime,
                                             *containerBuidler,
                                             *pkgMan,
                                             *repo,
@@ -227,7 +235,9 @@ int main(int argc, char **argv)
                               { "uninstall", &Cli::uninstall },
                               { "list", &Cli::list },
                               { "repo", &Cli::repo },
-                              { "info", &Cli::info } };
+                              { "info", &Cli::info },
+                              { "export-bundle", &Cli::exportBundle },
+                              { "zygote", &Cli::zygote } };
 
           if (!QObject::connect(QCoreApplication::instance(),
                                 &QCoreApplication::aboutToQuit,
@@ -240,7 +250,13 @@ int main(int argc, char **argv)
 
           for (const auto &subcommand : subcommandMap.keys()) {
               if (args[subcommand.toStdString()].asBool() == true) {
-                  QCoreApplication::exit(subcommandMap[subcommand](cli, args));
+                  auto code = subcommandMap[subcommand](cli, args);
+                  if (linglong::utils::trace::enabled()) {
+                      if (auto ret = linglong::utils::trace::flush(); !ret) {
+                          qWarning() << ret.error();
+                      }
+                  }
+                  QCoreApplication::exit(code);
                   return;
               }
           }
@@ -0,0 +1,813 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// ll-zygote runs as the init process of a zygote container,
+// which has mounted the base, the runtime and the common mounts in advance.
+// It forks a child for each launch request received from the unix socket,
+// the child finishes the mounts of the application in a new mount namespace,
+// then executes the application.
+//
+// The request is written by ll-cli to zygote-request.json in the bundle of the application,
+// which is in BUNDLES_DIR, the directory of bundles on the host seen through its rootfs:
+//
+//   {"token": "...", "args": [...], "env": [...], "cwd": "...", "mounts": [OCI mounts...],
+//    "rlimits": [OCI rlimits...], "noNewPrivileges": false,
+//    "maskedPaths": [...], "readonlyPaths": [...]}
+//
+// Containers can neither write nor see the bundles, so a request is only accepted from ll-cli,
+// which sends the bundle and the token of the request over the unix socket.
+// Messages and replies are json objects sent as SOCK_SEQPACKET messages:
+//
+//   -> {"bundle": "path relative to BUNDLES_DIR", "token": "..."}
+//      with stdin, stdout and stderr attached as SCM_RIGHTS.
+//   <- {"started": true} with SCM_CREDENTIALS of the application process,
+//      sent right before executing the application.
+//   <- {"error": "..."} if the application cannot be started.
+//   <- {"exit": code} after the application exits.
+//
+// The application receives SIGHUP if the client disconnects before it exits.
+//
+// The socket and the bundles are masked in the mount namespace of the application,
+// and connections from processes in the zygote are refused.
+// Like a container without capabilities, the application executes
+// with empty bounding and inheritable capability sets.
+//
+// NOTE: This program runs inside the container on the libraries of the base,
+// so it must not depend on any library of the host.
+
+#include <nlohmann/json.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/capability.h>
+#include <poll.h>
+#include <sys/mount.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ; // NOLINT
+
+namespace {
+
+constexpr std::size_t maxMessageSize = 64 * 1024;
+constexpr auto requestFile = "zygote-request.json";
+constexpr int stdioCount = 3;
+
+// Zygotes without running applications exit after being idle for a while,
+// or when the system is short of memory.
+constexpr auto defaultIdleTimeout = std::chrono::minutes(10);
+constexpr auto checkInterval = std::chrono::seconds(10);
+// Percentage of time in the last 10 seconds some tasks stalled on memory.
+constexpr double memoryPressureThreshold = 10.0;
+// Percentage of available memory used if pressure stall information is unavailable.
+constexpr long long lowMemoryThreshold = 10;
+
+auto errorMessage(const std::string &what, int err = errno) -> std::string
+{
+    return what + ": " + std::strerror(err);
+}
+
+auto sendMessage(int fd, const nlohmann::json &message, bool withCredentials = false) noexcept
+  -> bool
+{
+    auto content = message.dump();
+    iovec iov{ content.data(), content.size() };
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(ucred))]{};
+    if (withCredentials) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        auto *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_CREDENTIALS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(ucred));
+
+        // NOTE: The kernel translates the PID to the PID namespace of the client.
+        ucred cred{ ::getpid(), ::getuid(), ::getgid() };
+        std::memcpy(CMSG_DATA(cmsg), &cred, sizeof(cred));
+    }
+
+    while (::sendmsg(fd, &msg, MSG_NOSIGNAL) == -1) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Only ll-cli outside of the zygote is allowed to launch applications.
+void checkPeer(int fd)
+{
+    ucred cred{};
+    socklen_t size = sizeof(cred);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &size) == -1) {
+        throw std::runtime_error(errorMessage("get credentials of peer"));
+    }
+
+    if (cred.uid != ::getuid()) {
+        throw std::runtime_error("peer is run by another user");
+    }
+
+    // NOTE: The PID is translated to the PID namespace of the zygote,
+    // processes outside of the zygote are not visible and have PID 0.
+    if (cred.pid != 0) {
+        throw std::runtime_error("processes in the zygote can not launch applications");
+    }
+}
+
+// Receive a message with the attached file descriptors.
+auto receiveMessage(int fd, std::vector<int> &fds) -> nlohmann::json
+{
+    std::string buffer(maxMessageSize, '\0');
+    iovec iov{ buffer.data(), buffer.size() };
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * stdioCount)]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t size = -1;
+    while ((size = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC)) == -1) {
+        if (errno != EINTR) {
+            throw std::runtime_error(errorMessage("recvmsg"));
+        }
+    }
+
+    for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (std::size_t i = 0; i < count; ++i) {
+            int received = -1;
+            std::memcpy(&received, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            fds.push_back(received);
+        }
+    }
+
+    if ((msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0) {
+        throw std::runtime_error("request is truncated");
+    }
+
+    if (fds.size() != stdioCount) {
+        throw std::runtime_error("stdin, stdout and stderr are required");
+    }
+
+    return nlohmann::json::parse(buffer.substr(0, size));
+}
+
+// Load the request written by ll-cli in the bundle of the application.
+auto loadRequest(const std::string &bundlesDir, const nlohmann::json &message) -> nlohmann::json
+{
+    const std::string bundle = message.at("bundle");
+    const std::string token = message.at("token");
+    if (bundle.empty() || bundle.front() == '/' || token.empty()) {
+        throw std::runtime_error("invalid bundle " + bundle);
+    }
+    for (std::size_t begin = 0, end = 0; begin <= bundle.size(); begin = end + 1) {
+        end = bundle.find('/', begin);
+        if (end == std::string::npos) {
+            end = bundle.size();
+        }
+        if (bundle.compare(begin, end - begin, "..") == 0) {
+            throw std::runtime_error("invalid bundle " + bundle);
+        }
+    }
+
+    const auto path = bundlesDir + "/" + bundle + "/" + requestFile;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error(errorMessage("open " + path));
+    }
+
+    auto request = nlohmann::json::parse(file);
+    if (request.value("token", "") != token) {
+        throw std::runtime_error("token of the request does not match");
+    }
+
+    return request;
+}
+
+void makeParents(const std::string &path)
+{
+    for (auto pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1)) {
+        auto parent = path.substr(0, pos);
+        if (::mkdir(parent.c_str(), 0755) == -1 && errno != EEXIST) {
+            throw std::runtime_error(errorMessage("mkdir " + parent));
+        }
+    }
+}
+
+// Create the mount point like OCI runtimes do.
+void makeMountPoint(const std::string &destination, bool isDirectory)
+{
+    struct stat st{};
+    if (::stat(destination.c_str(), &st) == 0) {
+        return;
+    }
+
+    makeParents(destination);
+
+    if (isDirectory) {
+        if (::mkdir(destination.c_str(), 0755) == -1 && errno != EEXIST) {
+            throw std::runtime_error(errorMessage("mkdir " + destination));
+        }
+        return;
+    }
+
+    int fd = ::open(destination.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error(errorMessage("create " + destination));
+    }
+    ::close(fd);
+}
+
+struct MountFlags
+{
+    unsigned long flags{ 0 };
+    bool recursive{ false };
+    bool readonly{ false };
+    std::string data;
+};
+
+auto parseOptions(const nlohmann::json &options) -> MountFlags
+{
+    static const std::map<std::string, unsigned long> knownFlags{
+        { "nosuid", MS_NOSUID },   { "nodev", MS_NODEV },           { "noexec", MS_NOEXEC },
+        { "noatime", MS_NOATIME }, { "nodiratime", MS_NODIRATIME }, { "relatime", MS_RELATIME },
+        { "strictatime", MS_STRICTATIME },
+    };
+
+    MountFlags result;
+    for (const std::string option : options) {
+        if (option == "bind") {
+            result.flags |= MS_BIND;
+        } else if (option == "rbind") {
+            result.flags |= MS_BIND;
+            result.recursive = true;
+        } else if (option == "ro") {
+            result.readonly = true;
+        } else if (option == "rw") {
+            result.readonly = false;
+        } else if (auto flag = knownFlags.find(option); flag != knownFlags.end()) {
+            result.flags |= flag->second;
+        } else {
+            result.data += (result.data.empty() ? "" : ",") + option;
+        }
+    }
+
+    return result;
+}
+
+#ifdef SYS_mount_setattr
+// Same as struct mount_attr of <linux/mount.h>, which conflicts with <sys/mount.h> of old glibc.
+struct MountAttr
+{
+    uint64_t attrSet;
+    uint64_t attrClr;
+    uint64_t propagation;
+    uint64_t usernsFd;
+};
+
+constexpr uint64_t mountAttrReadonly = 0x00000001;
+constexpr uint64_t mountAttrNosuid = 0x00000002;
+constexpr uint64_t mountAttrNodev = 0x00000004;
+constexpr uint64_t mountAttrNoexec = 0x00000008;
+
+#ifndef AT_RECURSIVE
+#define AT_RECURSIVE 0x8000
+#endif
+#endif
+
+// A bind mount keeps the flags of its source, for example, all mounts from
+// /run/host/rootfs are read only. So the flags are applied by remounting,
+// the flags locked by the kernel are kept.
+void remountBind(const std::string &destination, const MountFlags &options)
+{
+#ifdef SYS_mount_setattr
+    MountAttr attr{};
+    attr.attrSet = (options.readonly ? mountAttrReadonly : 0)
+      | ((options.flags & MS_NOSUID) != 0 ? mountAttrNosuid : 0)
+      | ((options.flags & MS_NODEV) != 0 ? mountAttrNodev : 0)
+      | ((options.flags & MS_NOEXEC) != 0 ? mountAttrNoexec : 0);
+    attr.attrClr = options.readonly ? 0 : mountAttrReadonly;
+    if (::syscall(SYS_mount_setattr,
+                  AT_FDCWD,
+                  destination.c_str(),
+                  options.recursive ? AT_RECURSIVE : 0,
+                  &attr,
+                  sizeof(attr))
+        == 0) {
+        return;
+    }
+    if (errno != ENOSYS) {
+        throw std::runtime_error(errorMessage("mount_setattr " + destination));
+    }
+#endif
+
+    struct statvfs st{};
+    if (::statvfs(destination.c_str(), &st) == -1) {
+        throw std::runtime_error(errorMessage("statvfs " + destination));
+    }
+
+    unsigned long locked = 0;
+    for (auto [stFlag, msFlag] : std::initializer_list<std::pair<unsigned long, unsigned long>>{
+           { ST_NOSUID, MS_NOSUID },
+           { ST_NODEV, MS_NODEV },
+           { ST_NOEXEC, MS_NOEXEC },
+           { ST_NOATIME, MS_NOATIME },
+           { ST_NODIRATIME, MS_NODIRATIME },
+           { ST_RELATIME, MS_RELATIME },
+         }) {
+        if ((st.f_flag & stFlag) != 0) {
+            locked |= msFlag;
+        }
+    }
+
+    auto flags = MS_BIND | MS_REMOUNT | locked | options.flags | (options.readonly ? MS_RDONLY : 0);
+    if (::mount(nullptr, destination.c_str(), nullptr, flags, nullptr) == -1) {
+        throw std::runtime_error(errorMessage("remount " + destination));
+    }
+}
+
+void doMount(const nlohmann::json &mount)
+{
+    const std::string destination = mount.at("destination");
+    const std::string source = mount.value("source", "none");
+    const std::string type = mount.value("type", "");
+    auto options = parseOptions(mount.value("options", nlohmann::json::array()));
+
+    const bool isBind = type == "bind" || (options.flags & MS_BIND) != 0;
+    if (!isBind) {
+        makeMountPoint(destination, true);
+
+        auto flags = options.flags | (options.readonly ? MS_RDONLY : 0);
+        if (::mount(source.c_str(),
+                    destination.c_str(),
+                    type.c_str(),
+                    flags,
+                    options.data.empty() ? nullptr : options.data.c_str())
+            == -1) {
+            throw std::runtime_error(errorMessage("mount " + type + " on " + destination));
+        }
+        return;
+    }
+
+    struct stat st{};
+    if (::stat(source.c_str(), &st) == -1) {
+        throw std::runtime_error(errorMessage("stat " + source));
+    }
+    makeMountPoint(destination, S_ISDIR(st.st_mode));
+
+    auto flags = MS_BIND | (options.recursive ? MS_REC : 0);
+    if (::mount(source.c_str(), destination.c_str(), nullptr, flags, nullptr) == -1) {
+        throw std::runtime_error(errorMessage("bind " + source + " to " + destination));
+    }
+
+    remountBind(destination, options);
+}
+
+// Mask a path like maskedPaths of OCI runtimes do,
+// directories are covered by an empty read only tmpfs and files by /dev/null.
+void maskPath(const std::string &path)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) == -1) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw std::runtime_error(errorMessage("stat " + path));
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        if (::mount("tmpfs",
+                    path.c_str(),
+                    "tmpfs",
+                    MS_RDONLY | MS_NOSUID | MS_NODEV | MS_NOEXEC,
+                    "mode=755")
+            == -1) {
+            throw std::runtime_error(errorMessage("mask " + path));
+        }
+        return;
+    }
+
+    if (::mount("/dev/null", path.c_str(), nullptr, MS_BIND, nullptr) == -1) {
+        throw std::runtime_error(errorMessage("mask " + path));
+    }
+}
+
+// Make a path read only like readonlyPaths of OCI runtimes do.
+void readonlyPath(const std::string &path)
+{
+    if (::mount(path.c_str(), path.c_str(), nullptr, MS_BIND | MS_REC, nullptr) == -1) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw std::runtime_error(errorMessage("bind " + path));
+    }
+
+    MountFlags options;
+    options.recursive = true;
+    options.readonly = true;
+    remountBind(path, options);
+}
+
+// Drop the capabilities of the zygote, which are kept across execve
+// by the bounding set for files with capabilities, or by the inheritable set.
+void dropCapabilities()
+{
+    for (int cap = 0; ::prctl(PR_CAPBSET_READ, cap, 0, 0, 0) >= 0; ++cap) {
+        if (::prctl(PR_CAPBSET_DROP, cap, 0, 0, 0) == -1) {
+            throw std::runtime_error(errorMessage("drop capability " + std::to_string(cap)));
+        }
+    }
+
+    __user_cap_header_struct header{ _LINUX_CAPABILITY_VERSION_3, 0 };
+    __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3]{};
+    if (::syscall(SYS_capget, &header, data) == -1) {
+        throw std::runtime_error(errorMessage("capget"));
+    }
+    for (auto &set : data) {
+        set.inheritable = 0;
+    }
+    if (::syscall(SYS_capset, &header, data) == -1) {
+        throw std::runtime_error(errorMessage("capset"));
+    }
+}
+
+void setRlimits(const nlohmann::json &rlimits)
+{
+    static const std::map<std::string, int> knownResources{
+        { "RLIMIT_AS", RLIMIT_AS },
+        { "RLIMIT_CORE", RLIMIT_CORE },
+        { "RLIMIT_CPU", RLIMIT_CPU },
+        { "RLIMIT_DATA", RLIMIT_DATA },
+        { "RLIMIT_FSIZE", RLIMIT_FSIZE },
+        { "RLIMIT_LOCKS", RLIMIT_LOCKS },
+        { "RLIMIT_MEMLOCK", RLIMIT_MEMLOCK },
+        { "RLIMIT_MSGQUEUE", RLIMIT_MSGQUEUE },
+        { "RLIMIT_NICE", RLIMIT_NICE },
+        { "RLIMIT_NOFILE", RLIMIT_NOFILE },
+        { "RLIMIT_NPROC", RLIMIT_NPROC },
+        { "RLIMIT_RSS", RLIMIT_RSS },
+        { "RLIMIT_RTPRIO", RLIMIT_RTPRIO },
+        { "RLIMIT_RTTIME", RLIMIT_RTTIME },
+        { "RLIMIT_SIGPENDING", RLIMIT_SIGPENDING },
+        { "RLIMIT_STACK", RLIMIT_STACK },
+    };
+
+    for (const auto &entry : rlimits) {
+        const std::string type = entry.at("type");
+        auto resource = knownResources.find(type);
+        if (resource == knownResources.end()) {
+            throw std::runtime_error("unknown rlimit " + type);
+        }
+
+        // NOTE: The limits are unsigned, RLIM_INFINITY is -1 in the configuration.
+        rlimit limit{ static_cast<rlim_t>(entry.at("soft").get<std::int64_t>()),
+                      static_cast<rlim_t>(entry.at("hard").get<std::int64_t>()) };
+        if (::setrlimit(resource->second, &limit) == -1) {
+            throw std::runtime_error(errorMessage("setrlimit " + type));
+        }
+    }
+}
+
+auto toCStrings(std::vector<std::string> &strings) -> std::vector<char *>
+{
+    std::vector<char *> result;
+    result.reserve(strings.size() + 1);
+    for (auto &str : strings) {
+        result.push_back(str.data());
+    }
+    result.push_back(nullptr);
+    return result;
+}
+
+[[noreturn]] void runChild(int connection,
+                           const nlohmann::json &request,
+                           std::vector<int> &fds,
+                           const std::vector<std::string> &hiddenPaths)
+{
+    auto fail = [connection](const std::string &message) {
+        sendMessage(connection, { { "error", message } });
+        ::_exit(127);
+    };
+
+    try {
+        sigset_t mask;
+        sigemptyset(&mask);
+        ::sigprocmask(SIG_SETMASK, &mask, nullptr);
+
+        // Mounts of the application are only visible to itself.
+        if (::unshare(CLONE_NEWNS) == -1) {
+            fail(errorMessage("unshare"));
+        }
+        if (::mount(nullptr, "/", nullptr, MS_REC | MS_SLAVE, nullptr) == -1) {
+            fail(errorMessage("make / slave"));
+        }
+
+        for (const auto &mount : request.at("mounts")) {
+            doMount(mount);
+        }
+
+        for (const std::string path : request.value("readonlyPaths", nlohmann::json::array())) {
+            readonlyPath(path);
+        }
+        for (const std::string path : request.value("maskedPaths", nlohmann::json::array())) {
+            maskPath(path);
+        }
+
+        // The application must not reach the socket or the requests of the zygote.
+        for (const auto &path : hiddenPaths) {
+            maskPath(path);
+        }
+
+        for (int i = 0; i < stdioCount; ++i) {
+            if (::dup2(fds[i], i) == -1) {
+                fail(errorMessage("dup2"));
+            }
+        }
+
+        const std::string cwd = request.value("cwd", "/");
+        if (::chdir(cwd.c_str()) == -1) {
+            fail(errorMessage("chdir " + cwd));
+        }
+
+        auto args = request.at("args").get<std::vector<std::string>>();
+        if (args.empty()) {
+            fail("no command to run");
+        }
+        auto env = request.value("env", std::vector<std::string>{});
+
+        // The application should not inherit the capabilities of the zygote,
+        // the permitted and effective ones are dropped by execve as its user is not root.
+        if (::prctl(PR_CAP_AMBIENT, PR_CAP_AMBIENT_CLEAR_ALL, 0, 0, 0) == -1) {
+            fail(errorMessage("clear ambient capabilities"));
+        }
+        dropCapabilities();
+
+        setRlimits(request.value("rlimits", nlohmann::json::array()));
+
+        if (request.value("noNewPrivileges", false)
+            && ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1) {
+            fail(errorMessage("set no new privileges"));
+        }
+
+        if (!sendMessage(connection, { { "started", true } }, true)) {
+            ::_exit(127);
+        }
+
+        auto argv = toCStrings(args);
+        auto envp = toCStrings(env);
+        // NOTE: execvp looks up the command in PATH of environ.
+        environ = envp.data();
+        ::execvp(argv[0], argv.data());
+        fail(errorMessage("exec " + args[0]));
+    } catch (const std::exception &e) {
+        fail(e.what());
+    }
+
+    ::_exit(127);
+}
+
+auto memoryPressureHigh() noexcept -> bool
+{
+    std::ifstream pressure("/proc/pressure/memory");
+    std::string line;
+    if (pressure.is_open() && std::getline(pressure, line)) {
+        // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+        auto pos = line.find("avg10=");
+        if (pos != std::string::npos) {
+            return std::strtod(line.c_str() + pos + std::strlen("avg10="), nullptr)
+              >= memoryPressureThreshold;
+        }
+    }
+
+    std::ifstream meminfo("/proc/meminfo");
+    long long total = 0;
+    long long available = -1;
+    std::string key;
+    long long value = 0;
+    std::string unit;
+    while (meminfo >> key >> value >> unit) {
+        if (key == "MemTotal:") {
+            total = value;
+        } else if (key == "MemAvailable:") {
+            available = value;
+        }
+    }
+
+    return total > 0 && available >= 0 && available * 100 / total < lowMemoryThreshold;
+}
+
+struct Launch
+{
+    int connection;
+    bool hangup{ false };
+};
+
+auto exitCode(int status) noexcept -> int
+{
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    return 128 + WTERMSIG(status);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " SOCKET BUNDLES_DIR [IDLE_TIMEOUT_SECONDS]"
+                  << std::endl;
+        return -1;
+    }
+
+    const std::string socketPath = argv[1];
+    const std::string bundlesDir = argv[2];
+    std::chrono::steady_clock::duration idleTimeout = defaultIdleTimeout;
+    if (argc == 4) {
+        idleTimeout = std::chrono::seconds(std::strtol(argv[3], nullptr, 10));
+    }
+
+    const std::vector<std::string> hiddenPaths{
+        socketPath.substr(0, socketPath.rfind('/')),
+        bundlesDir,
+    };
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "socket path is too long: " << socketPath << std::endl;
+        return -1;
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    ::sigprocmask(SIG_BLOCK, &mask, nullptr);
+    int signalFD = ::signalfd(-1, &mask, SFD_CLOEXEC);
+    if (signalFD == -1) {
+        std::cerr << errorMessage("signalfd") << std::endl;
+        return -1;
+    }
+
+    int listenFD = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listenFD == -1) {
+        std::cerr << errorMessage("socket") << std::endl;
+        return -1;
+    }
+
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFD, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 // NOLINT
+        || ::listen(listenFD, SOMAXCONN) == -1) {
+        std::cerr << errorMessage("listen on " + socketPath) << std::endl;
+        return -1;
+    }
+
+    std::map<pid_t, Launch> launches;
+    auto lastActive = std::chrono::steady_clock::now();
+    while (true) {
+        std::vector<pollfd> pfds{ { listenFD, POLLIN, 0 }, { signalFD, POLLIN, 0 } };
+        std::vector<pid_t> pids;
+        for (const auto &[pid, launch] : launches) {
+            if (!launch.hangup) {
+                pfds.push_back({ launch.connection, POLLIN, 0 });
+                pids.push_back(pid);
+            }
+        }
+
+        auto ret = ::poll(pfds.data(),
+                          pfds.size(),
+                          std::chrono::duration_cast<std::chrono::milliseconds>(checkInterval)
+                            .count());
+        if (ret == -1 && errno != EINTR) {
+            std::cerr << errorMessage("poll") << std::endl;
+            break;
+        }
+
+        if (ret > 0 && (pfds[0].revents & POLLIN) != 0) {
+            int connection = ::accept4(listenFD, nullptr, nullptr, SOCK_CLOEXEC);
+            if (connection != -1) {
+                lastActive = std::chrono::steady_clock::now();
+
+                std::vector<int> fds;
+                try {
+                    checkPeer(connection);
+                    auto request = loadRequest(bundlesDir, receiveMessage(connection, fds));
+                    auto pid = ::fork();
+                    if (pid == 0) {
+                        runChild(connection, request, fds, hiddenPaths);
+                    }
+                    if (pid == -1) {
+                        throw std::runtime_error(errorMessage("fork"));
+                    }
+                    launches.emplace(pid, Launch{ connection });
+                } catch (const std::exception &e) {
+                    sendMessage(connection, { { "error", e.what() } });
+                    ::close(connection);
+                }
+
+                for (auto fd : fds) {
+                    ::close(fd);
+                }
+            }
+        }
+
+        if (ret > 0 && (pfds[1].revents & POLLIN) != 0) {
+            signalfd_siginfo info{};
+            if (::read(signalFD, &info, sizeof(info)) == sizeof(info)
+                && info.ssi_signo != SIGCHLD) {
+                break;
+            }
+
+            // As the init process, orphans in the container are reaped too.
+            int status = 0;
+            pid_t pid = 0;
+            while ((pid = ::waitpid(-1, &status, WNOHANG)) > 0) {
+                auto launch = launches.find(pid);
+                if (launch == launches.end()) {
+                    continue;
+                }
+
+                sendMessage(launch->second.connection, { { "exit", exitCode(status) } });
+                ::close(launch->second.connection);
+                launches.erase(launch);
+                lastActive = std::chrono::steady_clock::now();
+            }
+        }
+
+        for (std::size_t i = 2; ret > 0 && i < pfds.size(); ++i) {
+            if (pfds[i].revents == 0) {
+                continue;
+            }
+
+            auto launch = launches.find(pids[i - 2]);
+            if (launch == launches.end()) {
+                continue;
+            }
+
+            char buffer[1];
+            auto size = ::recv(pfds[i].fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (size > 0 || (size == -1 && (errno == EAGAIN || errno == EINTR))) {
+                continue;
+            }
+
+            // The client is gone, like the terminal of the application is closed.
+            launch->second.hangup = true;
+            ::kill(launch->first, SIGHUP);
+        }
+
+        if (!launches.empty()) {
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() - lastActive >= idleTimeout) {
+            std::cerr << "exit after being idle" << std::endl;
+            break;
+        }
+
+        if (memoryPressureHigh()) {
+            std::cerr << "exit under memory pressure" << std::endl;
+            break;
+        }
+    }
+
+    ::unlink(socketPath.c_str());
+    return 0;
+}
@@ -52,6 +52,10 @@ void ClientApi::initializeServerConfigs() {
     _serverIndices.insert("uploadTaskInfo", 0);
     _serverConfigs.insert("uploadTaskLayerFile", defaultConf);
     _serverIndices.insert("uploadTaskLayerFile", 0);
+    _serverConfigs.insert("uploadTaskMissingObjects", defaultConf);
+    _serverIndices.insert("uploadTaskMissingObjects", 0);
+    _serverConfigs.insert("uploadTaskObjects", defaultConf);
+    _serverIndices.insert("uploadTaskObjects", 0);
 }
 
 /**
@@ -673,6 +677,153 @@ void ClientApi::uploadTaskLayerFileCallback(HttpRequestWorker *worker) {
     }
 }
 
+void ClientApi::uploadTaskMissingObjects(const QString &x_token, const QString &task_id, const Request_UploadTaskObjectsReq &req) {
+    QString fullPath = QString(_serverConfigs["uploadTaskMissingObjects"][_serverIndices.value("uploadTaskMissingObjects")].URL()+"/api/v1/upload-tasks/{task_id}/objects/missing");
+    
+    
+    {
+        QString task_idPathParam("{");
+        task_idPathParam.append("task_id").append("}");
+        QString pathPrefix, pathSuffix, pathDelimiter;
+        QString pathStyle = "";
+        if (pathStyle == "")
+            pathStyle = "simple";
+        pathPrefix = getParamStylePrefix(pathStyle);
+        pathSuffix = getParamStyleSuffix(pathStyle);
+        pathDelimiter = getParamStyleDelimiter(pathStyle, "task_id", false);
+        QString paramString = (pathStyle == "matrix") ? pathPrefix+"task_id"+pathSuffix : pathPrefix;
+        fullPath.replace(task_idPathParam, paramString+QUrl::toPercentEncoding(::linglong::api::client::toStringValue(task_id)));
+    }
+    HttpRequestWorker *worker = new HttpRequestWorker(this, _manager);
+    worker->setTimeOut(_timeOut);
+    worker->setWorkingDirectory(_workingDirectory);
+    HttpRequestInput input(fullPath, "POST");
+
+    {
+
+        
+        QByteArray output = req.asJson().toUtf8();
+        input.request_body.append(output);
+    }
+    
+    {
+        if (!::linglong::api::client::toStringValue(x_token).isEmpty()) {
+            input.headers.insert("X-Token", ::linglong::api::client::toStringValue(x_token));
+        }
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    for (auto keyValueIt = _defaultHeaders.keyValueBegin(); keyValueIt != _defaultHeaders.keyValueEnd(); keyValueIt++) {
+        input.headers.insert(keyValueIt->first, keyValueIt->second);
+    }
+#else
+    for (auto key : _defaultHeaders.keys()) {
+        input.headers.insert(key, _defaultHeaders[key]);
+    }
+#endif
+
+    connect(worker, &HttpRequestWorker::on_execution_finished, this, &ClientApi::uploadTaskMissingObjectsCallback);
+    connect(this, &ClientApi::abortRequestsSignal, worker, &QObject::deleteLater);
+    connect(worker, &QObject::destroyed, this, [this]() {
+        if (findChildren<HttpRequestWorker*>().count() == 0) {
+            Q_EMIT allPendingRequestsCompleted();
+        }
+    });
+
+    worker->execute(&input);
+}
+
+void ClientApi::uploadTaskMissingObjectsCallback(HttpRequestWorker *worker) {
+    QString error_str = worker->error_str;
+    QNetworkReply::NetworkError error_type = worker->error_type;
+
+    if (worker->error_type != QNetworkReply::NoError) {
+        error_str = QString("%1, %2").arg(worker->error_str, QString(worker->response));
+    }
+    UploadTaskMissingObjects_200_response output(QString(worker->response));
+    worker->deleteLater();
+
+    if (worker->error_type == QNetworkReply::NoError) {
+        Q_EMIT uploadTaskMissingObjectsSignal(output);
+        Q_EMIT uploadTaskMissingObjectsSignalFull(worker, output);
+    } else {
+        Q_EMIT uploadTaskMissingObjectsSignalE(output, error_type, error_str);
+        Q_EMIT uploadTaskMissingObjectsSignalEFull(worker, error_type, error_str);
+    }
+}
+
+void ClientApi::uploadTaskObjects(const QString &x_token, const QString &task_id, const HttpFileElement &file) {
+    QString fullPath = QString(_serverConfigs["uploadTaskObjects"][_serverIndices.value("uploadTaskObjects")].URL()+"/api/v1/upload-tasks/{task_id}/objects");
+    
+    
+    {
+        QString task_idPathParam("{");
+        task_idPathParam.append("task_id").append("}");
+        QString pathPrefix, pathSuffix, pathDelimiter;
+        QString pathStyle = "";
+        if (pathStyle == "")
+            pathStyle = "simple";
+        pathPrefix = getParamStylePrefix(pathStyle);
+        pathSuffix = getParamStyleSuffix(pathStyle);
+        pathDelimiter = getParamStyleDelimiter(pathStyle, "task_id", false);
+        QString paramString = (pathStyle == "matrix") ? pathPrefix+"task_id"+pathSuffix : pathPrefix;
+        fullPath.replace(task_idPathParam, paramString+QUrl::toPercentEncoding(::linglong::api::client::toStringValue(task_id)));
+    }
+    HttpRequestWorker *worker = new HttpRequestWorker(this, _manager);
+    worker->setTimeOut(_timeOut);
+    worker->setWorkingDirectory(_workingDirectory);
+    HttpRequestInput input(fullPath, "PUT");
+
+    
+    {
+        input.add_file("file", file.local_filename, file.request_filename, file.mime_type);
+    }
+
+    
+    {
+        if (!::linglong::api::client::toStringValue(x_token).isEmpty()) {
+            input.headers.insert("X-Token", ::linglong::api::client::toStringValue(x_token));
+        }
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    for (auto keyValueIt = _defaultHeaders.keyValueBegin(); keyValueIt != _defaultHeaders.keyValueEnd(); keyValueIt++) {
+        input.headers.insert(keyValueIt->first, keyValueIt->second);
+    }
+#else
+    for (auto key : _defaultHeaders.keys()) {
+        input.headers.insert(key, _defaultHeaders[key]);
+    }
+#endif
+
+    connect(worker, &HttpRequestWorker::on_execution_finished, this, &ClientApi::uploadTaskObjectsCallback);
+    connect(this, &ClientApi::abortRequestsSignal, worker, &QObject::deleteLater);
+    connect(worker, &QObject::destroyed, this, [this]() {
+        if (findChildren<HttpRequestWorker*>().count() == 0) {
+            Q_EMIT allPendingRequestsCompleted();
+        }
+    });
+
+    worker->execute(&input);
+}
+
+void ClientApi::uploadTaskObjectsCallback(HttpRequestWorker *worker) {
+    QString error_str = worker->error_str;
+    QNetworkReply::NetworkError error_type = worker->error_type;
+
+    if (worker->error_type != QNetworkReply::NoError) {
+        error_str = QString("%1, %2").arg(worker->error_str, QString(worker->response));
+    }
+    Api_UploadTaskFileResp output(QString(worker->response));
+    worker->deleteLater();
+
+    if (worker->error_type == QNetworkReply::NoError) {
+        Q_EMIT uploadTaskObjectsSignal(output);
+        Q_EMIT uploadTaskObjectsSignalFull(worker, output);
+    } else {
+        Q_EMIT uploadTaskObjectsSignalE(output, error_type, error_str);
+        Q_EMIT uploadTaskObjectsSignalEFull(worker, error_type, error_str);
+    }
+}
+
 void ClientApi::tokenAvailable(){
 
     oauthToken token;
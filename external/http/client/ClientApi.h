@@ -26,9 +26,11 @@
 #include "NewUploadTaskID_200_response.h"
 #include "Request_Auth.h"
 #include "Request_FuzzySearchReq.h"
+#include "Request_UploadTaskObjectsReq.h"
 #include "Schema_NewUploadTaskReq.h"
 #include "SignIn_200_response.h"
 #include "UploadTaskInfo_200_response.h"
+#include "UploadTaskMissingObjects_200_response.h"
 #include <QString>
 
 #include <QObject>
@@ -110,6 +112,20 @@ public:
     */
     void uploadTaskLayerFile(const QString &x_token, const QString &task_id, const HttpFileElement &file);
 
+    /**
+    * @param[in]  x_token QString [required]
+    * @param[in]  task_id QString [required]
+    * @param[in]  req Request_UploadTaskObjectsReq [required]
+    */
+    void uploadTaskMissingObjects(const QString &x_token, const QString &task_id, const Request_UploadTaskObjectsReq &req);
+
+    /**
+    * @param[in]  x_token QString [required]
+    * @param[in]  task_id QString [required]
+    * @param[in]  file HttpFileElement [required]
+    */
+    void uploadTaskObjects(const QString &x_token, const QString &task_id, const HttpFileElement &file);
+
 
 private:
     QMap<QString,int> _serverIndices;
@@ -140,6 +156,8 @@ private:
     void uploadTaskFileCallback(HttpRequestWorker *worker);
     void uploadTaskInfoCallback(HttpRequestWorker *worker);
     void uploadTaskLayerFileCallback(HttpRequestWorker *worker);
+    void uploadTaskMissingObjectsCallback(HttpRequestWorker *worker);
+    void uploadTaskObjectsCallback(HttpRequestWorker *worker);
 
 Q_SIGNALS:
 
@@ -150,6 +168,8 @@ Q_SIGNALS:
     void uploadTaskFileSignal(Api_UploadTaskFileResp summary);
     void uploadTaskInfoSignal(UploadTaskInfo_200_response summary);
     void uploadTaskLayerFileSignal(Api_UploadTaskLayerFileResp summary);
+    void uploadTaskMissingObjectsSignal(UploadTaskMissingObjects_200_response summary);
+    void uploadTaskObjectsSignal(Api_UploadTaskFileResp summary);
 
     void fuzzySearchAppSignalFull(HttpRequestWorker *worker, FuzzySearchApp_200_response summary);
     void getRepoSignalFull(HttpRequestWorker *worker, GetRepo_200_response summary);
@@ -158,6 +178,8 @@ Q_SIGNALS:
     void uploadTaskFileSignalFull(HttpRequestWorker *worker, Api_UploadTaskFileResp summary);
     void uploadTaskInfoSignalFull(HttpRequestWorker *worker, UploadTaskInfo_200_response summary);
     void uploadTaskLayerFileSignalFull(HttpRequestWorker *worker, Api_UploadTaskLayerFileResp summary);
+    void uploadTaskMissingObjectsSignalFull(HttpRequestWorker *worker, UploadTaskMissingObjects_200_response summary);
+    void uploadTaskObjectsSignalFull(HttpRequestWorker *worker, Api_UploadTaskFileResp summary);
 
     void fuzzySearchAppSignalE(FuzzySearchApp_200_response summary, QNetworkReply::NetworkError error_type, QString error_str);
     void getRepoSignalE(GetRepo_200_response summary, QNetworkReply::NetworkError error_type, QString error_str);
@@ -166,6 +188,8 @@ Q_SIGNALS:
     void uploadTaskFileSignalE(Api_UploadTaskFileResp summary, QNetworkReply::NetworkError error_type, QString error_str);
     void uploadTaskInfoSignalE(UploadTaskInfo_200_response summary, QNetworkReply::NetworkError error_type, QString error_str);
     void uploadTaskLayerFileSignalE(Api_UploadTaskLayerFileResp summary, QNetworkReply::NetworkError error_type, QString error_str);
+    void uploadTaskMissingObjectsSignalE(UploadTaskMissingObjects_200_response summary, QNetworkReply::NetworkError error_type, QString error_str);
+    void uploadTaskObjectsSignalE(Api_UploadTaskFileResp summary, QNetworkReply::NetworkError error_type, QString error_str);
 
     void fuzzySearchAppSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
     void getRepoSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
@@ -174,6 +198,8 @@ Q_SIGNALS:
     void uploadTaskFileSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
     void uploadTaskInfoSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
     void uploadTaskLayerFileSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
+    void uploadTaskMissingObjectsSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
+    void uploadTaskObjectsSignalEFull(HttpRequestWorker *worker, QNetworkReply::NetworkError error_type, QString error_str);
 
     void abortRequestsSignal();
     void allPendingRequestsCompleted();
@@ -14,6 +14,7 @@
 #include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
+#include <QHttpMultiPart>
 #include <QTimer>
 #include <QUrl>
 #include <QUuid>
@@ -182,6 +183,7 @@ void HttpRequestWorker::execute(HttpRequestInput *input) {
     // reset variables
     QNetworkReply *reply = nullptr;
     QByteArray request_content = "";
+    QHttpMultiPart *multi_part = nullptr;
     response = "";
     error_type = QNetworkReply::NoError;
     error_str = "";
@@ -233,29 +235,17 @@ void HttpRequestWorker::execute(HttpRequestInput *input) {
                             .arg(QDateTime::currentDateTime().toTime_t())
                             .arg(qrand());
                     #endif
-        QString boundary_delimiter = "--";
-        QString new_line = "\r\n";
+        multi_part = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+        multi_part->setBoundary(boundary.toUtf8());
 
         // add variables
         for (QString key : input->vars.keys()) {
-            // add boundary
-            request_content.append(boundary_delimiter.toUtf8());
-            request_content.append(boundary.toUtf8());
-            request_content.append(new_line.toUtf8());
-
-            // add header
-            request_content.append("Content-Disposition: form-data; ");
-            request_content.append(http_attribute_encode("name", key).toUtf8());
-            request_content.append(new_line.toUtf8());
-            request_content.append("Content-Type: text/plain");
-            request_content.append(new_line.toUtf8());
-
-            // add header to body splitter
-            request_content.append(new_line.toUtf8());
-
-            // add variable content
-            request_content.append(input->vars.value(key).toUtf8());
-            request_content.append(new_line.toUtf8());
+            QHttpPart part;
+            part.setRawHeader("Content-Disposition",
+                              QString("form-data; %1").arg(http_attribute_encode("name", key)).toUtf8());
+            part.setRawHeader("Content-Type", "text/plain");
+            part.setBody(input->vars.value(key).toUtf8());
+            multi_part->append(part);
         }
 
         // add files
@@ -274,9 +264,10 @@ void HttpRequestWorker::execute(HttpRequestInput *input) {
                 continue;
             }
 
-            QFile file(file_info->local_filename);
-            if (!file.open(QIODevice::ReadOnly)) {
+            QFile *file = new QFile(file_info->local_filename, multi_part);
+            if (!file->open(QIODevice::ReadOnly)) {
                 // silent abort for the current file
+                delete file;
                 continue;
             }
 
@@ -288,44 +279,26 @@ void HttpRequestWorker::execute(HttpRequestInput *input) {
                 }
             }
 
-            // add boundary
-            request_content.append(boundary_delimiter.toUtf8());
-            request_content.append(boundary.toUtf8());
-            request_content.append(new_line.toUtf8());
-
-            // add header
-            request_content.append(
-                QString("Content-Disposition: form-data; %1; %2").arg(http_attribute_encode("name", file_info->variable_name), http_attribute_encode("filename", file_info->request_filename)).toUtf8());
-            request_content.append(new_line.toUtf8());
-
+            QHttpPart part;
+            part.setRawHeader(
+                "Content-Disposition",
+                QString("form-data; %1; %2").arg(http_attribute_encode("name", file_info->variable_name), http_attribute_encode("filename", file_info->request_filename)).toUtf8());
             if (file_info->mime_type != nullptr && !file_info->mime_type.isEmpty()) {
-                request_content.append("Content-Type: ");
-                request_content.append(file_info->mime_type.toUtf8());
-                request_content.append(new_line.toUtf8());
+                part.setRawHeader("Content-Type", file_info->mime_type.toUtf8());
             }
+            part.setRawHeader("Content-Transfer-Encoding", "binary");
 
-            request_content.append("Content-Transfer-Encoding: binary");
-            request_content.append(new_line.toUtf8());
-
-            // add header to body splitter
-            request_content.append(new_line.toUtf8());
-
-            // add file content
-            request_content.append(file.readAll());
-            request_content.append(new_line.toUtf8());
-
-            file.close();
+            // add file content, it is read from disk while the request is sent
+            part.setBodyDevice(file);
+            multi_part->append(part);
         }
-
-        // add end of body
-        request_content.append(boundary_delimiter.toUtf8());
-        request_content.append(boundary.toUtf8());
-        request_content.append(boundary_delimiter.toUtf8());
     }
 
     if (input->request_body.size() > 0) {
         qDebug() << "got a request body";
         request_content.clear();
+        delete multi_part;
+        multi_part = nullptr;
         if(!isFormData && (input->var_layout != MULTIPART) && isRequestCompressionEnabled){
             request_content.append(compress(input->request_body, 7, CompressionType::Gzip));
         } else {
@@ -362,7 +335,16 @@ void HttpRequestWorker::execute(HttpRequestInput *input) {
         request.setRawHeader("Accept-Encoding", "identity");
     }
 
-    if (input->http_method == "GET") {
+    if (multi_part != nullptr) {
+        if (input->http_method == "POST") {
+            reply = manager->post(request, multi_part);
+        } else if (input->http_method == "PUT") {
+            reply = manager->put(request, multi_part);
+        } else {
+            reply = manager->sendCustomRequest(request, input->http_method.toLatin1(), multi_part);
+        }
+        multi_part->setParent(reply);
+    } else if (input->http_method == "GET") {
         reply = manager->get(request);
     } else if (input->http_method == "POST") {
         reply = manager->post(request, request_content);
@@ -394,6 +376,12 @@ void HttpRequestWorker::execute(HttpRequestInput *input) {
         QObject::connect(&timeOutTimer, &QTimer::timeout, [this, reply] {
             on_reply_timeout(reply);
         });
+        // large uploads only time out when they stop making progress
+        connect(reply, &QNetworkReply::uploadProgress, this, [this](qint64 bytesSent, qint64) {
+            if (bytesSent > 0 && timeOutTimer.isActive()) {
+                timeOutTimer.start();
+            }
+        });
         timeOutTimer.start();
     }
 }
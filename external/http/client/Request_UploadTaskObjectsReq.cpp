@@ -0,0 +1,135 @@
+/**
+ * linglong仓库
+ * 玲珑仓库接口
+ *
+ * The version of the OpenAPI document: 1.0.0
+ * Contact: wurongjie@deepin.org
+ *
+ * NOTE: This class is auto generated by OpenAPI Generator (https://openapi-generator.tech).
+ * https://openapi-generator.tech
+ * Do not edit the class manually.
+ */
+
+#include "Request_UploadTaskObjectsReq.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QObject>
+
+#include "Helpers.h"
+
+namespace linglong {
+namespace api {
+namespace client {
+
+Request_UploadTaskObjectsReq::Request_UploadTaskObjectsReq(QString json) {
+    this->initializeModel();
+    this->fromJson(json);
+}
+
+Request_UploadTaskObjectsReq::Request_UploadTaskObjectsReq() {
+    this->initializeModel();
+}
+
+Request_UploadTaskObjectsReq::~Request_UploadTaskObjectsReq() {}
+
+void Request_UploadTaskObjectsReq::initializeModel() {
+
+    m_commit_isSet = false;
+    m_commit_isValid = false;
+
+    m_objects_isSet = false;
+    m_objects_isValid = false;
+}
+
+void Request_UploadTaskObjectsReq::fromJson(QString jsonString) {
+    QByteArray array(jsonString.toStdString().c_str());
+    QJsonDocument doc = QJsonDocument::fromJson(array);
+    QJsonObject jsonObject = doc.object();
+    this->fromJsonObject(jsonObject);
+}
+
+void Request_UploadTaskObjectsReq::fromJsonObject(QJsonObject json) {
+
+    m_commit_isValid = ::linglong::api::client::fromJsonValue(m_commit, json[QString("commit")]);
+    m_commit_isSet = !json[QString("commit")].isNull() && m_commit_isValid;
+
+    m_objects_isValid = ::linglong::api::client::fromJsonValue(m_objects, json[QString("objects")]);
+    m_objects_isSet = !json[QString("objects")].isNull() && m_objects_isValid;
+}
+
+QString Request_UploadTaskObjectsReq::asJson() const {
+    QJsonObject obj = this->asJsonObject();
+    QJsonDocument doc(obj);
+    QByteArray bytes = doc.toJson();
+    return QString(bytes);
+}
+
+QJsonObject Request_UploadTaskObjectsReq::asJsonObject() const {
+    QJsonObject obj;
+    if (m_commit_isSet) {
+        obj.insert(QString("commit"), ::linglong::api::client::toJsonValue(m_commit));
+    }
+    if (m_objects.size() > 0) {
+        obj.insert(QString("objects"), ::linglong::api::client::toJsonValue(m_objects));
+    }
+    return obj;
+}
+
+QString Request_UploadTaskObjectsReq::getCommit() const {
+    return m_commit;
+}
+void Request_UploadTaskObjectsReq::setCommit(const QString &commit) {
+    m_commit = commit;
+    m_commit_isSet = true;
+}
+
+bool Request_UploadTaskObjectsReq::is_commit_Set() const{
+    return m_commit_isSet;
+}
+
+bool Request_UploadTaskObjectsReq::is_commit_Valid() const{
+    return m_commit_isValid;
+}
+
+QList<QString> Request_UploadTaskObjectsReq::getObjects() const {
+    return m_objects;
+}
+void Request_UploadTaskObjectsReq::setObjects(const QList<QString> &objects) {
+    m_objects = objects;
+    m_objects_isSet = true;
+}
+
+bool Request_UploadTaskObjectsReq::is_objects_Set() const{
+    return m_objects_isSet;
+}
+
+bool Request_UploadTaskObjectsReq::is_objects_Valid() const{
+    return m_objects_isValid;
+}
+
+bool Request_UploadTaskObjectsReq::isSet() const {
+    bool isObjectUpdated = false;
+    do {
+        if (m_commit_isSet) {
+            isObjectUpdated = true;
+            break;
+        }
+
+        if (m_objects.size() > 0) {
+            isObjectUpdated = true;
+            break;
+        }
+    } while (false);
+    return isObjectUpdated;
+}
+
+bool Request_UploadTaskObjectsReq::isValid() const {
+    // only required properties are required for the object to be considered valid
+    return true;
+}
+
+} // namespace linglong
+} // namespace api
+} // namespace client
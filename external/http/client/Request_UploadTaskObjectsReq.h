@@ -0,0 +1,76 @@
+/**
+ * linglong仓库
+ * 玲珑仓库接口
+ *
+ * The version of the OpenAPI document: 1.0.0
+ * Contact: wurongjie@deepin.org
+ *
+ * NOTE: This class is auto generated by OpenAPI Generator (https://openapi-generator.tech).
+ * https://openapi-generator.tech
+ * Do not edit the class manually.
+ */
+
+/*
+ * Request_UploadTaskObjectsReq.h
+ *
+ * 
+ */
+
+#ifndef Request_UploadTaskObjectsReq_H
+#define Request_UploadTaskObjectsReq_H
+
+#include <QJsonObject>
+
+#include <QList>
+#include <QString>
+
+#include "Enum.h"
+#include "Object.h"
+
+namespace linglong {
+namespace api {
+namespace client {
+
+class Request_UploadTaskObjectsReq : public Object {
+public:
+    Request_UploadTaskObjectsReq();
+    Request_UploadTaskObjectsReq(QString json);
+    ~Request_UploadTaskObjectsReq() override;
+
+    QString asJson() const override;
+    QJsonObject asJsonObject() const override;
+    void fromJsonObject(QJsonObject json) override;
+    void fromJson(QString jsonString) override;
+
+    QString getCommit() const;
+    void setCommit(const QString &commit);
+    bool is_commit_Set() const;
+    bool is_commit_Valid() const;
+
+    QList<QString> getObjects() const;
+    void setObjects(const QList<QString> &objects);
+    bool is_objects_Set() const;
+    bool is_objects_Valid() const;
+
+    virtual bool isSet() const override;
+    virtual bool isValid() const override;
+
+private:
+    void initializeModel();
+
+    QString m_commit;
+    bool m_commit_isSet;
+    bool m_commit_isValid;
+
+    QList<QString> m_objects;
+    bool m_objects_isSet;
+    bool m_objects_isValid;
+};
+
+} // namespace linglong
+} // namespace api
+} // namespace client
+
+Q_DECLARE_METATYPE(linglong::api::client::Request_UploadTaskObjectsReq)
+
+#endif // Request_UploadTaskObjectsReq_H
@@ -0,0 +1,105 @@
+/**
+ * linglong仓库
+ * 玲珑仓库接口
+ *
+ * The version of the OpenAPI document: 1.0.0
+ * Contact: wurongjie@deepin.org
+ *
+ * NOTE: This class is auto generated by OpenAPI Generator (https://openapi-generator.tech).
+ * https://openapi-generator.tech
+ * Do not edit the class manually.
+ */
+
+#include "Response_UploadTaskMissingObjects.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QObject>
+
+#include "Helpers.h"
+
+namespace linglong {
+namespace api {
+namespace client {
+
+Response_UploadTaskMissingObjects::Response_UploadTaskMissingObjects(QString json) {
+    this->initializeModel();
+    this->fromJson(json);
+}
+
+Response_UploadTaskMissingObjects::Response_UploadTaskMissingObjects() {
+    this->initializeModel();
+}
+
+Response_UploadTaskMissingObjects::~Response_UploadTaskMissingObjects() {}
+
+void Response_UploadTaskMissingObjects::initializeModel() {
+
+    m_objects_isSet = false;
+    m_objects_isValid = false;
+}
+
+void Response_UploadTaskMissingObjects::fromJson(QString jsonString) {
+    QByteArray array(jsonString.toStdString().c_str());
+    QJsonDocument doc = QJsonDocument::fromJson(array);
+    QJsonObject jsonObject = doc.object();
+    this->fromJsonObject(jsonObject);
+}
+
+void Response_UploadTaskMissingObjects::fromJsonObject(QJsonObject json) {
+
+    m_objects_isValid = ::linglong::api::client::fromJsonValue(m_objects, json[QString("objects")]);
+    m_objects_isSet = !json[QString("objects")].isNull() && m_objects_isValid;
+}
+
+QString Response_UploadTaskMissingObjects::asJson() const {
+    QJsonObject obj = this->asJsonObject();
+    QJsonDocument doc(obj);
+    QByteArray bytes = doc.toJson();
+    return QString(bytes);
+}
+
+QJsonObject Response_UploadTaskMissingObjects::asJsonObject() const {
+    QJsonObject obj;
+    if (m_objects.size() > 0) {
+        obj.insert(QString("objects"), ::linglong::api::client::toJsonValue(m_objects));
+    }
+    return obj;
+}
+
+QList<QString> Response_UploadTaskMissingObjects::getObjects() const {
+    return m_objects;
+}
+void Response_UploadTaskMissingObjects::setObjects(const QList<QString> &objects) {
+    m_objects = objects;
+    m_objects_isSet = true;
+}
+
+bool Response_UploadTaskMissingObjects::is_objects_Set() const{
+    return m_objects_isSet;
+}
+
+bool Response_UploadTaskMissingObjects::is_objects_Valid() const{
+    return m_objects_isValid;
+}
+
+bool Response_UploadTaskMissingObjects::isSet() const {
+    bool isObjectUpdated = false;
+    do {
+        if (m_objects.size() > 0) {
+            isObjectUpdated = true;
+            break;
+        }
+    } while (false);
+    return isObjectUpdated;
+}
+
+bool Response_UploadTaskMissingObjects::isValid() const {
+    // only required properties are required for the object to be considered valid
+    return true;
+}
+
+} // namespace linglong
+} // namespace api
+} // namespace client
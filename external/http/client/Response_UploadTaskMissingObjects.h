@@ -0,0 +1,67 @@
+/**
+ * linglong仓库
+ * 玲珑仓库接口
+ *
+ * The version of the OpenAPI document: 1.0.0
+ * Contact: wurongjie@deepin.org
+ *
+ * NOTE: This class is auto generated by OpenAPI Generator (https://openapi-generator.tech).
+ * https://openapi-generator.tech
+ * Do not edit the class manually.
+ */
+
+/*
+ * Response_UploadTaskMissingObjects.h
+ *
+ * 
+ */
+
+#ifndef Response_UploadTaskMissingObjects_H
+#define Response_UploadTaskMissingObjects_H
+
+#include <QJsonObject>
+
+#include <QList>
+#include <QString>
+
+#include "Enum.h"
+#include "Object.h"
+
+namespace linglong {
+namespace api {
+namespace client {
+
+class Response_UploadTaskMissingObjects : public Object {
+public:
+    Response_UploadTaskMissingObjects();
+    Response_UploadTaskMissingObjects(QString json);
+    ~Response_UploadTaskMissingObjects() override;
+
+    QString asJson() const override;
+    QJsonObject asJsonObject() const override;
+    void fromJsonObject(QJsonObject json) override;
+    void fromJson(QString jsonString) override;
+
+    QList<QString> getObjects() const;
+    void setObjects(const QList<QString> &objects);
+    bool is_objects_Set() const;
+    bool is_objects_Valid() const;
+
+    virtual bool isSet() const override;
+    virtual bool isValid() const override;
+
+private:
+    void initializeModel();
+
+    QList<QString> m_objects;
+    bool m_objects_isSet;
+    bool m_objects_isValid;
+};
+
+} // namespace linglong
+} // namespace api
+} // namespace client
+
+Q_DECLARE_METATYPE(linglong::api::client::Response_UploadTaskMissingObjects)
+
+#endif // Response_UploadTaskMissingObjects_H
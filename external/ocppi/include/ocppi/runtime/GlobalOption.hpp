@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -10,5 +11,9 @@ namespace ocppi::runtime
 struct GlobalOption {
         std::optional<std::filesystem::path> root;
         std::vector<std::string> extra;
+        // Manage cgroups of containers by systemd, e.g. in transient scopes.
+        bool systemdCgroup{ false };
+        // Kill the runtime program if it does not exit in time.
+        std::optional<std::chrono::milliseconds> timeout;
 };
 }
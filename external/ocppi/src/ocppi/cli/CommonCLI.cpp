@@ -65,6 +65,7 @@ auto doCommand(const std::string &bin,
 #ifdef OCPPI_WITH_SPDLOG
                [[maybe_unused]] const std::shared_ptr<spdlog::logger> &logger,
 #endif
+               std::optional<std::chrono::milliseconds> timeout,
                std::vector<std::string> &&globalOption,
                const std::string &command, std::vector<std::string> &&options,
                std::vector<std::string> &&arguments) -> Result
@@ -82,14 +83,14 @@ auto doCommand(const std::string &bin,
 #endif
 
         if constexpr (std::is_void_v<Result>) {
-                auto ret = runProcess(bin, args);
+                auto ret = runProcess(bin, args, timeout);
                 if (ret != 0) {
                         throw CommandFailedError(ret, bin);
                 }
                 return;
         } else {
                 std::string output;
-                auto ret = runProcess(bin, args, output);
+                auto ret = runProcess(bin, args, output, timeout);
                 if (ret != 0) {
                         throw CommandFailedError(ret, bin);
                 }
@@ -152,6 +153,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                 this->logger(),
 #endif
+                option.timeout,
                 this->generateGlobalOptions(option), "state",
                 this->generateSubcommandOptions(option), { id });
 } catch (...) {
@@ -178,6 +180,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                         this->logger(),
 #endif
+                        opt.timeout,
                         this->generateGlobalOptions(opt), "create",
                         this->generateSubcommandOptions(opt), { id });
         return {};
@@ -199,6 +202,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                         this->logger(),
 #endif
+                        option.timeout,
                         this->generateGlobalOptions(option), "start",
                         this->generateSubcommandOptions(option), { id });
         return {};
@@ -222,6 +226,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                         this->logger(),
 #endif
+                        option.timeout,
                         this->generateGlobalOptions(option), "kill",
                         this->generateSubcommandOptions(option),
                         { id, signal });
@@ -245,6 +250,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                         this->logger(),
 #endif
+                        option.timeout,
                         this->generateGlobalOptions(option), "delete",
                         this->generateSubcommandOptions(option), { id });
         return {};
@@ -275,6 +281,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                         this->logger(),
 #endif
+                        option.timeout,
                         this->generateGlobalOptions(option), "exec",
                         this->generateSubcommandOptions(option),
                         std::move(arguments));
@@ -302,6 +309,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                 this->logger(),
 #endif
+                option.timeout,
                 this->generateGlobalOptions(option), "list",
                 this->generateSubcommandOptions(option), {});
 } catch (...) {
@@ -328,6 +336,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                         this->logger(),
 #endif
+                        opt.timeout,
                         this->generateGlobalOptions(opt), "run",
                         this->generateSubcommandOptions(opt), { id });
         return {};
@@ -349,6 +358,7 @@ try {
 #ifdef OCPPI_WITH_SPDLOG
                 this->logger(),
 #endif
+                option.timeout,
                 this->generateGlobalOptions(option), "features",
                 this->generateSubcommandOptions(option), {});
 } catch (...) {
@@ -363,6 +373,9 @@ auto CommonCLI::generateGlobalOptions(const runtime::GlobalOption &option)
                 ret.emplace_back("--root");
                 ret.push_back(option.root->string());
         }
+        if (option.systemdCgroup) {
+                ret.emplace_back("--systemd-cgroup");
+        }
         return ret;
 }
 
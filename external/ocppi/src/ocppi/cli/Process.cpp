@@ -1,106 +1,322 @@
 #include "ocppi/cli/Process.hpp"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
-#include <array>
 #include <cstddef>
 #include <memory>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
-int runProcess(const std::string &binaryPath,
-               const std::vector<std::string> &args, std::string &output)
+extern char **environ; // NOLINT
+
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
+namespace
+{
+
+// NOTE: Output of `list` and `state` is usually much larger than 1KiB
+// when there are many containers, read it in large chunks.
+constexpr std::size_t bufferSize = 64 * 1024;
+
+[[noreturn]] void throwSystemError(int err, const char *what)
+{
+        throw std::system_error(err, std::generic_category(), what);
+}
+
+class FileDescriptor {
+    public:
+        explicit FileDescriptor(int fd = -1) noexcept
+                : fd_(fd)
+        {
+        }
+        FileDescriptor(const FileDescriptor &) = delete;
+        FileDescriptor(FileDescriptor &&other) noexcept
+                : fd_(std::exchange(other.fd_, -1))
+        {
+        }
+        auto operator=(const FileDescriptor &) -> FileDescriptor & = delete;
+        auto operator=(FileDescriptor &&) -> FileDescriptor & = delete;
+        ~FileDescriptor() { this->reset(); }
+
+        void reset(int fd = -1) noexcept
+        {
+                if (this->fd_ >= 0) {
+                        ::close(this->fd_);
+                }
+                this->fd_ = fd;
+        }
+
+        [[nodiscard]]
+        auto get() const noexcept -> int
+        {
+                return this->fd_;
+        }
+
+    private:
+        int fd_;
+};
+
+class Deadline {
+    public:
+        explicit Deadline(std::optional<std::chrono::milliseconds> timeout)
+        {
+                if (timeout) {
+                        this->deadline_ =
+                                std::chrono::steady_clock::now() + *timeout;
+                }
+        }
+
+        [[nodiscard]]
+        auto isSet() const noexcept -> bool
+        {
+                return this->deadline_.has_value();
+        }
+
+        [[nodiscard]]
+        auto expired() const noexcept -> bool
+        {
+                return this->deadline_ &&
+                       std::chrono::steady_clock::now() >= *this->deadline_;
+        }
+
+        // Timeout argument of poll(2), -1 means no timeout.
+        [[nodiscard]]
+        auto pollTimeout() const noexcept -> int
+        {
+                if (!this->deadline_) {
+                        return -1;
+                }
+
+                auto remaining =
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                                *this->deadline_ -
+                                std::chrono::steady_clock::now());
+                return remaining.count() > 0 ?
+                               static_cast<int>(remaining.count()) :
+                               0;
+        }
+
+    private:
+        std::optional<std::chrono::steady_clock::time_point> deadline_;
+};
+
+struct Child {
+        pid_t pid{ -1 };
+        // Invalid if the kernel does not support pidfd_open(2).
+        FileDescriptor pidfd;
+};
+
+auto spawn(const std::string &binaryPath, const std::vector<std::string> &args,
+           int stdoutFD) -> Child
 {
-        constexpr auto bufferSize = 1024;
-        auto cArgs = std::make_unique<const char *[]>(args.size() + 2);
+        auto cArgs = std::make_unique<char *[]>(args.size() + 2);
 
-        cArgs[0] = binaryPath.data();
+        cArgs[0] = const_cast<char *>(binaryPath.c_str());
         for (std::size_t i = 1; i <= args.size(); ++i) {
-                cArgs[i] = args[i - 1].data();
+                cArgs[i] = const_cast<char *>(args[i - 1].c_str());
         }
         cArgs[args.size() + 1] = nullptr;
 
-        int pipes[2];
-        if (::pipe(pipes) == -1) {
-                throw std::system_error(errno, std::generic_category(), "pipe");
+        posix_spawn_file_actions_t actions;
+        auto err = posix_spawn_file_actions_init(&actions);
+        if (err != 0) {
+                throwSystemError(err, "posix_spawn_file_actions_init");
+        }
+        if (stdoutFD >= 0) {
+                err = posix_spawn_file_actions_adddup2(&actions, stdoutFD,
+                                                       STDOUT_FILENO);
         }
 
-        pid_t childId{ -1 };
-        childId = fork();
-        if (childId == -1) {
-                throw std::system_error(errno, std::generic_category(), "fork");
+        Child child;
+        if (err == 0) {
+                // NOTE: posix_spawn reports errors of exec in the parent,
+                // instead of leaving a forked child running the caller's code.
+                err = posix_spawnp(&child.pid, binaryPath.c_str(), &actions,
+                                   nullptr, cArgs.get(), environ);
+        }
+        posix_spawn_file_actions_destroy(&actions);
+        if (err != 0) {
+                throwSystemError(err, "posix_spawnp");
         }
 
-        int ret{ 0 };
-        if (childId == 0) {
-                ::close(pipes[0]);
-                ::dup2(pipes[1], 1);
+#ifdef SYS_pidfd_open
+        child.pidfd.reset(
+                static_cast<int>(::syscall(SYS_pidfd_open, child.pid, 0)));
+#endif
 
-                ret = execvp(binaryPath.data(), (char **)(cArgs.get()));
-                throw std::system_error(errno, std::generic_category(),
-                                        "execvp");
+        return child;
+}
+
+auto exitCode(const siginfo_t &info) noexcept -> int
+{
+        if (info.si_code == CLD_EXITED) {
+                return info.si_status;
         }
+        return 128 + info.si_status;
+}
 
-        ::close(pipes[1]);
-        std::array<char, bufferSize> buffer{};
+void killAndReap(const Child &child) noexcept
+{
+#ifdef SYS_pidfd_send_signal
+        if (child.pidfd.get() < 0 ||
+            ::syscall(SYS_pidfd_send_signal, child.pidfd.get(), SIGKILL,
+                      nullptr, 0) != 0) {
+                ::kill(child.pid, SIGKILL);
+        }
+#else
+        ::kill(child.pid, SIGKILL);
+#endif
 
-        ssize_t readCount{ 0 };
-        while (true) {
-                readCount = read(pipes[0], buffer.data(), bufferSize);
-                if (readCount == -1) {
-                        if (errno == EINTR) {
-                                continue;
-                        }
+        siginfo_t info{};
+        while (::waitid(P_PID, child.pid, &info, WEXITED) == -1 &&
+               errno == EINTR) {
+        }
+}
 
-                        throw std::system_error(errno, std::generic_category(),
-                                                "read");
-                }
+// Wait for the child only, other children of this process are not touched.
+auto wait(const Child &child, const Deadline &deadline) -> int
+{
+        siginfo_t info{};
 
-                if (readCount == 0) {
+        if (child.pidfd.get() >= 0) {
+                // A pidfd becomes readable when the process exits.
+                pollfd pfd{ child.pidfd.get(), POLLIN, 0 };
+                while (true) {
+                        auto ret = ::poll(&pfd, 1, deadline.pollTimeout());
+                        if (ret == -1) {
+                                if (errno == EINTR) {
+                                        continue;
+                                }
+                                auto err = errno;
+                                killAndReap(child);
+                                throwSystemError(err, "poll");
+                        }
+                        if (ret == 0) {
+                                killAndReap(child);
+                                throwSystemError(ETIMEDOUT, "wait");
+                        }
                         break;
                 }
 
-                output.append(buffer.data(), readCount);
+                while (::waitid(static_cast<idtype_t>(P_PIDFD),
+                                child.pidfd.get(), &info, WEXITED) == -1) {
+                        if (errno != EINTR) {
+                                throwSystemError(errno, "waitid");
+                        }
+                }
+                return exitCode(info);
         }
 
-        if (::wait(&ret) == -1) {
-                throw std::system_error(errno, std::generic_category(), "wait");
+        // Kernels before 5.3 have no pidfd, poll the PID if there is a timeout.
+        using namespace std::chrono_literals;
+        const int flags = WEXITED | (deadline.isSet() ? WNOHANG : 0);
+        while (true) {
+                info.si_pid = 0;
+                if (::waitid(P_PID, child.pid, &info, flags) == -1) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        throwSystemError(errno, "waitid");
+                }
+                if (info.si_pid != 0) {
+                        return exitCode(info);
+                }
+                if (deadline.expired()) {
+                        killAndReap(child);
+                        throwSystemError(ETIMEDOUT, "wait");
+                }
+                std::this_thread::sleep_for(10ms);
         }
+}
 
-        ::close(pipes[0]);
-        return ret;
 }
 
 int runProcess(const std::string &binaryPath,
-               const std::vector<std::string> &args)
+               const std::vector<std::string> &args, std::string &output,
+               std::optional<std::chrono::milliseconds> timeout)
 {
-        auto cArgs = std::make_unique<const char *[]>(args.size() + 2);
-
-        cArgs[0] = binaryPath.data();
-        for (std::size_t i = 1; i <= args.size(); ++i) {
-                cArgs[i] = args[i - 1].data();
+        int pipes[2];
+        if (::pipe2(pipes, O_CLOEXEC) == -1) {
+                throwSystemError(errno, "pipe2");
         }
-        cArgs[args.size() + 1] = nullptr;
+        FileDescriptor readEnd(pipes[0]);
+        FileDescriptor writeEnd(pipes[1]);
 
-        pid_t childId{ -1 };
-        childId = fork();
-        if (childId == -1) {
-                throw std::system_error(errno, std::generic_category(), "fork");
-        }
+        const Deadline deadline(timeout);
+        auto child = spawn(binaryPath, args, writeEnd.get());
+        writeEnd.reset();
 
-        int ret{ 0 };
-        if (childId == 0) {
-                ret = execvp(binaryPath.data(), (char **)(cArgs.get()));
-                throw std::system_error(errno, std::generic_category(),
-                                        "execvp");
-        }
+        auto buffer = std::make_unique<char[]>(bufferSize);
+        pollfd pfd{ readEnd.get(), POLLIN, 0 };
+        while (true) {
+                if (deadline.isSet()) {
+                        auto ret = ::poll(&pfd, 1, deadline.pollTimeout());
+                        if (ret == -1 && errno == EINTR) {
+                                continue;
+                        }
+                        if (ret == -1) {
+                                auto err = errno;
+                                killAndReap(child);
+                                throwSystemError(err, "poll");
+                        }
+                        if (ret == 0) {
+                                killAndReap(child);
+                                throwSystemError(ETIMEDOUT, "read");
+                        }
+                }
+
+                auto readCount = ::read(readEnd.get(), buffer.get(), bufferSize);
+                if (readCount == -1) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        auto err = errno;
+                        killAndReap(child);
+                        throwSystemError(err, "read");
+                }
 
-        if (::wait(&ret) == -1) {
-                throw std::system_error(errno, std::generic_category(), "wait");
+                if (readCount == 0) {
+                        break;
+                }
+
+                output.append(buffer.get(), readCount);
         }
 
-        return ret;
+        return wait(child, deadline);
+}
+
+int runProcess(const std::string &binaryPath,
+               const std::vector<std::string> &args,
+               std::optional<std::chrono::milliseconds> timeout)
+{
+        const Deadline deadline(timeout);
+        auto child = spawn(binaryPath, args, -1);
+        return wait(child, deadline);
+}
+
+auto runProcessAsync(std::string binaryPath, std::vector<std::string> args,
+                     std::optional<std::chrono::milliseconds> timeout)
+        -> std::future<std::pair<int, std::string>>
+{
+        return std::async(std::launch::async,
+                          [binaryPath = std::move(binaryPath),
+                           args = std::move(args), timeout]() {
+                                  std::string output;
+                                  auto ret = runProcess(binaryPath, args,
+                                                        output, timeout);
+                                  return std::make_pair(ret,
+                                                        std::move(output));
+                          });
 }
@@ -1,10 +1,34 @@
 #pragma once
 
+#include <chrono>
+#include <future>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+// Run a program and wait for it to exit.
+//
+// The program is started by posix_spawn and waited by its pidfd if the kernel
+// supports it, so only the spawned child is reaped even if other threads of
+// the calling process are running their own children.
+//
+// The return value is the exit code of the program, or 128 plus the signal
+// number if it is killed by a signal, like shells do.
+// If timeout is set and the program does not exit in time,
+// it is killed and std::system_error with ETIMEDOUT is thrown.
+
 int runProcess(const std::string &binaryPath,
-               const std::vector<std::string> &args, std::string &output);
+               const std::vector<std::string> &args, std::string &output,
+               std::optional<std::chrono::milliseconds> timeout = std::nullopt);
 
 int runProcess(const std::string &binaryPath,
-               const std::vector<std::string> &args);
+               const std::vector<std::string> &args,
+               std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+// Run a program in another thread, the future holds the return value
+// and the output of the program.
+auto runProcessAsync(std::string binaryPath, std::vector<std::string> args,
+                     std::optional<std::chrono::milliseconds> timeout =
+                             std::nullopt)
+        -> std::future<std::pair<int, std::string>>;
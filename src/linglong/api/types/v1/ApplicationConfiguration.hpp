@@ -27,6 +27,11 @@ using nlohmann::json;
 
 struct ApplicationConfiguration {
 std::optional<ApplicationConfigurationPermissions> permissions;
+/**
+* Run commands in the running container of the application instead of a new one, defaults
+* to true
+*/
+std::optional<bool> reuseContainer;
 std::string version;
 };
 }
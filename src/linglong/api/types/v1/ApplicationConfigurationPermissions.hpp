@@ -18,6 +18,7 @@
 #include "linglong/api/types/v1/helper.hpp"
 
 #include "linglong/api/types/v1/ApplicationConfigurationPermissionsBind.hpp"
+#include "linglong/api/types/v1/ApplicationConfigurationPermissionsResources.hpp"
 
 namespace linglong {
 namespace api {
@@ -27,6 +28,10 @@ using nlohmann::json;
 
 struct ApplicationConfigurationPermissions {
 std::optional<std::vector<ApplicationConfigurationPermissionsBind>> binds;
+/**
+* Resource control of the cgroup of the application container
+*/
+std::optional<ApplicationConfigurationPermissionsResources> resources;
 };
 }
 }
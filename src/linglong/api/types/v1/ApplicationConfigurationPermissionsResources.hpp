@@ -0,0 +1,53 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+//  To parse this JSON data, first install
+//
+//      json.hpp  https://github.com/nlohmann/json
+//
+//  Then include this file, and then do
+//
+//     ApplicationConfigurationPermissionsResources.hpp data = nlohmann::json::parse(jsonString);
+
+#pragma once
+
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "linglong/api/types/v1/helper.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+using nlohmann::json;
+
+/**
+* Resource control of the cgroup of the application container
+*/
+struct ApplicationConfigurationPermissionsResources {
+/**
+* cpu.weight of the cgroup, from 1 to 10000, defaults to 100
+*/
+std::optional<int64_t> cpuWeight;
+/**
+* io.weight of the cgroup, from 1 to 10000, defaults to 100
+*/
+std::optional<int64_t> ioWeight;
+/**
+* memory.high of the cgroup in bytes, the application is throttled and its memory is
+* reclaimed above it
+*/
+std::optional<int64_t> memoryHigh;
+/**
+* memory.max of the cgroup in bytes, the application is killed by the OOM killer above it
+*/
+std::optional<int64_t> memoryMax;
+};
+}
+}
+}
+}
+
+// clang-format on
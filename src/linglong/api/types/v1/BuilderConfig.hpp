@@ -33,8 +33,20 @@ using nlohmann::json;
 struct BuilderConfig {
 std::optional<std::string> arch;
 std::optional<std::string> cache;
+/**
+* size budget in bytes of the download cache, 10 GiB by default
+*/
+std::optional<int64_t> cacheSize;
+/**
+* number of sources fetched at the same time, 4 by default
+*/
+std::optional<int64_t> fetchJobs;
 std::optional<bool> offline;
 std::string repo;
+/**
+* build even if nothing changed since the last build
+*/
+std::optional<bool> skipBuildCache;
 std::optional<bool> skipCommit;
 std::optional<bool> skipFetch;
 int64_t version;
@@ -17,6 +17,8 @@
 #include <nlohmann/json.hpp>
 #include "linglong/api/types/v1/helper.hpp"
 
+#include "linglong/api/types/v1/CliContainerStats.hpp"
+
 namespace linglong {
 namespace api {
 namespace types {
@@ -27,6 +29,10 @@ struct CliContainer {
 std::string id;
 std::string package;
 int64_t pid;
+/**
+* Resource usage read from the cgroup of the container
+*/
+std::optional<CliContainerStats> stats;
 };
 }
 }
@@ -0,0 +1,50 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+//  To parse this JSON data, first install
+//
+//      json.hpp  https://github.com/nlohmann/json
+//
+//  Then include this file, and then do
+//
+//     CliContainerStats.hpp data = nlohmann::json::parse(jsonString);
+
+#pragma once
+
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "linglong/api/types/v1/helper.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+using nlohmann::json;
+
+/**
+* Resource usage read from the cgroup of the container
+*/
+struct CliContainerStats {
+/**
+* CPU time used in microseconds
+*/
+std::optional<int64_t> cpuUsageUsec;
+std::optional<int64_t> ioReadBytes;
+std::optional<int64_t> ioWriteBytes;
+/**
+* Number of processes and threads
+*/
+std::optional<int64_t> pids;
+/**
+* Anonymous and mapped file memory in bytes
+*/
+std::optional<int64_t> rss;
+};
+}
+}
+}
+}
+
+// clang-format on
@@ -0,0 +1,55 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+//  To parse this JSON data, first install
+//
+//      json.hpp  https://github.com/nlohmann/json
+//
+//  Then include this file, and then do
+//
+//     ContainerRegistryEntry.hpp data = nlohmann::json::parse(jsonString);
+
+#pragma once
+
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "linglong/api/types/v1/helper.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+using nlohmann::json;
+
+/**
+* A running linglong container recorded in $XDG_RUNTIME_DIR/linglong.
+*/
+struct ContainerRegistryEntry {
+std::string appId;
+/**
+* Path to the OCI bundle directory of the container
+*/
+std::string bundle;
+std::string containerId;
+/**
+* PID of the container init process in the root PID namespace
+*/
+std::optional<int64_t> pid;
+std::string ref;
+/**
+* Start time of the init process in clock ticks after boot, used to detect PID reuse
+*/
+std::optional<int64_t> startTime;
+/**
+* Container ID of the zygote which the process is launched in
+*/
+std::optional<std::string> zygoteId;
+};
+}
+}
+}
+}
+
+// clang-format on
@@ -32,14 +32,18 @@
 #include "linglong/api/types/v1/PackageInfo.hpp"
 #include "linglong/api/types/v1/OciConfigurationPatch.hpp"
 #include "linglong/api/types/v1/LayerInfo.hpp"
+#include "linglong/api/types/v1/LayerInfoFile.hpp"
+#include "linglong/api/types/v1/ContainerRegistryEntry.hpp"
 #include "linglong/api/types/v1/CommonResult.hpp"
 #include "linglong/api/types/v1/CliContainer.hpp"
+#include "linglong/api/types/v1/CliContainerStats.hpp"
 #include "linglong/api/types/v1/BuilderProject.hpp"
 #include "linglong/api/types/v1/BuilderProjectSource.hpp"
 #include "linglong/api/types/v1/BuilderProjectPackage.hpp"
 #include "linglong/api/types/v1/BuilderConfig.hpp"
 #include "linglong/api/types/v1/ApplicationConfiguration.hpp"
 #include "linglong/api/types/v1/ApplicationConfigurationPermissions.hpp"
+#include "linglong/api/types/v1/ApplicationConfigurationPermissionsResources.hpp"
 #include "linglong/api/types/v1/ApplicationConfigurationPermissionsBind.hpp"
 
 namespace linglong {
@@ -49,6 +53,9 @@ namespace v1 {
 void from_json(const json & j, ApplicationConfigurationPermissionsBind & x);
 void to_json(json & j, const ApplicationConfigurationPermissionsBind & x);
 
+void from_json(const json & j, ApplicationConfigurationPermissionsResources & x);
+void to_json(json & j, const ApplicationConfigurationPermissionsResources & x);
+
 void from_json(const json & j, ApplicationConfigurationPermissions & x);
 void to_json(json & j, const ApplicationConfigurationPermissions & x);
 
@@ -67,12 +74,21 @@ void to_json(json & j, const BuilderProjectSource & x);
 void from_json(const json & j, BuilderProject & x);
 void to_json(json & j, const BuilderProject & x);
 
+void from_json(const json & j, CliContainerStats & x);
+void to_json(json & j, const CliContainerStats & x);
+
 void from_json(const json & j, CliContainer & x);
 void to_json(json & j, const CliContainer & x);
 
 void from_json(const json & j, CommonResult & x);
 void to_json(json & j, const CommonResult & x);
 
+void from_json(const json & j, ContainerRegistryEntry & x);
+void to_json(json & j, const ContainerRegistryEntry & x);
+
+void from_json(const json & j, LayerInfoFile & x);
+void to_json(json & j, const LayerInfoFile & x);
+
 void from_json(const json & j, LayerInfo & x);
 void to_json(json & j, const LayerInfo & x);
 
@@ -129,8 +145,32 @@ j["destination"] = x.destination;
 j["source"] = x.source;
 }
 
+inline void from_json(const json & j, ApplicationConfigurationPermissionsResources& x) {
+x.cpuWeight = get_stack_optional<int64_t>(j, "cpu_weight");
+x.ioWeight = get_stack_optional<int64_t>(j, "io_weight");
+x.memoryHigh = get_stack_optional<int64_t>(j, "memory_high");
+x.memoryMax = get_stack_optional<int64_t>(j, "memory_max");
+}
+
+inline void to_json(json & j, const ApplicationConfigurationPermissionsResources & x) {
+j = json::object();
+if (x.cpuWeight) {
+j["cpu_weight"] = x.cpuWeight;
+}
+if (x.ioWeight) {
+j["io_weight"] = x.ioWeight;
+}
+if (x.memoryHigh) {
+j["memory_high"] = x.memoryHigh;
+}
+if (x.memoryMax) {
+j["memory_max"] = x.memoryMax;
+}
+}
+
 inline void from_json(const json & j, ApplicationConfigurationPermissions& x) {
 x.binds = get_stack_optional<std::vector<ApplicationConfigurationPermissionsBind>>(j, "binds");
+x.resources = get_stack_optional<ApplicationConfigurationPermissionsResources>(j, "resources");
 }
 
 inline void to_json(json & j, const ApplicationConfigurationPermissions & x) {
@@ -138,10 +178,14 @@ j = json::object();
 if (x.binds) {
 j["binds"] = x.binds;
 }
+if (x.resources) {
+j["resources"] = x.resources;
+}
 }
 
 inline void from_json(const json & j, ApplicationConfiguration& x) {
 x.permissions = get_stack_optional<ApplicationConfigurationPermissions>(j, "permissions");
+x.reuseContainer = get_stack_optional<bool>(j, "reuse_container");
 x.version = j.at("version").get<std::string>();
 }
 
@@ -150,14 +194,20 @@ j = json::object();
 if (x.permissions) {
 j["permissions"] = x.permissions;
 }
+if (x.reuseContainer) {
+j["reuse_container"] = x.reuseContainer;
+}
 j["version"] = x.version;
 }
 
 inline void from_json(const json & j, BuilderConfig& x) {
 x.arch = get_stack_optional<std::string>(j, "arch");
 x.cache = get_stack_optional<std::string>(j, "cache");
+x.cacheSize = get_stack_optional<int64_t>(j, "cache_size");
+x.fetchJobs = get_stack_optional<int64_t>(j, "fetch_jobs");
 x.offline = get_stack_optional<bool>(j, "offline");
 x.repo = j.at("repo").get<std::string>();
+x.skipBuildCache = get_stack_optional<bool>(j, "skip_build_cache");
 x.skipCommit = get_stack_optional<bool>(j, "skip_commit");
 x.skipFetch = get_stack_optional<bool>(j, "skip_fetch");
 x.version = j.at("version").get<int64_t>();
@@ -171,10 +221,19 @@ j["arch"] = x.arch;
 if (x.cache) {
 j["cache"] = x.cache;
 }
+if (x.cacheSize) {
+j["cache_size"] = x.cacheSize;
+}
+if (x.fetchJobs) {
+j["fetch_jobs"] = x.fetchJobs;
+}
 if (x.offline) {
 j["offline"] = x.offline;
 }
 j["repo"] = x.repo;
+if (x.skipBuildCache) {
+j["skip_build_cache"] = x.skipBuildCache;
+}
 if (x.skipCommit) {
 j["skip_commit"] = x.skipCommit;
 }
@@ -261,10 +320,38 @@ j["strip"] = x.strip;
 j["version"] = x.version;
 }
 
+inline void from_json(const json & j, CliContainerStats& x) {
+x.cpuUsageUsec = get_stack_optional<int64_t>(j, "cpu_usage_usec");
+x.ioReadBytes = get_stack_optional<int64_t>(j, "io_read_bytes");
+x.ioWriteBytes = get_stack_optional<int64_t>(j, "io_write_bytes");
+x.pids = get_stack_optional<int64_t>(j, "pids");
+x.rss = get_stack_optional<int64_t>(j, "rss");
+}
+
+inline void to_json(json & j, const CliContainerStats & x) {
+j = json::object();
+if (x.cpuUsageUsec) {
+j["cpu_usage_usec"] = x.cpuUsageUsec;
+}
+if (x.ioReadBytes) {
+j["io_read_bytes"] = x.ioReadBytes;
+}
+if (x.ioWriteBytes) {
+j["io_write_bytes"] = x.ioWriteBytes;
+}
+if (x.pids) {
+j["pids"] = x.pids;
+}
+if (x.rss) {
+j["rss"] = x.rss;
+}
+}
+
 inline void from_json(const json & j, CliContainer& x) {
 x.id = j.at("id").get<std::string>();
 x.package = j.at("package").get<std::string>();
 x.pid = j.at("pid").get<int64_t>();
+x.stats = get_stack_optional<CliContainerStats>(j, "stats");
 }
 
 inline void to_json(json & j, const CliContainer & x) {
@@ -272,6 +359,9 @@ j = json::object();
 j["id"] = x.id;
 j["package"] = x.package;
 j["pid"] = x.pid;
+if (x.stats) {
+j["stats"] = x.stats;
+}
 }
 
 inline void from_json(const json & j, CommonResult& x) {
@@ -285,13 +375,71 @@ j["code"] = x.code;
 j["message"] = x.message;
 }
 
+inline void from_json(const json & j, ContainerRegistryEntry& x) {
+x.appId = j.at("appID").get<std::string>();
+x.bundle = j.at("bundle").get<std::string>();
+x.containerId = j.at("containerID").get<std::string>();
+x.pid = get_stack_optional<int64_t>(j, "pid");
+x.ref = j.at("ref").get<std::string>();
+x.startTime = get_stack_optional<int64_t>(j, "startTime");
+x.zygoteId = get_stack_optional<std::string>(j, "zygoteID");
+}
+
+inline void to_json(json & j, const ContainerRegistryEntry & x) {
+j = json::object();
+j["appID"] = x.appId;
+j["bundle"] = x.bundle;
+j["containerID"] = x.containerId;
+if (x.pid) {
+j["pid"] = x.pid;
+}
+j["ref"] = x.ref;
+if (x.startTime) {
+j["startTime"] = x.startTime;
+}
+if (x.zygoteId) {
+j["zygoteID"] = x.zygoteId;
+}
+}
+
+inline void from_json(const json & j, LayerInfoFile& x) {
+x.mode = j.at("mode").get<int64_t>();
+x.path = j.at("path").get<std::string>();
+x.size = j.at("size").get<int64_t>();
+x.target = get_stack_optional<std::string>(j, "target");
+x.type = j.at("type").get<std::string>();
+}
+
+inline void to_json(json & j, const LayerInfoFile & x) {
+j = json::object();
+j["mode"] = x.mode;
+j["path"] = x.path;
+j["size"] = x.size;
+if (x.target) {
+j["target"] = x.target;
+}
+j["type"] = x.type;
+}
+
 inline void from_json(const json & j, LayerInfo& x) {
+x.chunkSize = get_stack_optional<int64_t>(j, "chunk_size");
+x.chunks = get_stack_optional<std::vector<std::string>>(j, "chunks");
+x.files = get_stack_optional<std::vector<LayerInfoFile>>(j, "files");
 x.info = get_untyped(j, "info");
 x.version = j.at("version").get<std::string>();
 }
 
 inline void to_json(json & j, const LayerInfo & x) {
 j = json::object();
+if (x.chunkSize) {
+j["chunk_size"] = x.chunkSize;
+}
+if (x.chunks) {
+j["chunks"] = x.chunks;
+}
+if (x.files) {
+j["files"] = x.files;
+}
 j["info"] = x.info;
 j["version"] = x.version;
 }
@@ -486,6 +634,7 @@ x.builderConfig = get_stack_optional<BuilderConfig>(j, "BuilderConfig");
 x.builderProject = get_stack_optional<BuilderProject>(j, "BuilderProject");
 x.cliContainer = get_stack_optional<CliContainer>(j, "CLIContainer");
 x.commonResult = get_stack_optional<CommonResult>(j, "CommonResult");
+x.containerRegistryEntry = get_stack_optional<ContainerRegistryEntry>(j, "ContainerRegistryEntry");
 x.layerInfo = get_stack_optional<LayerInfo>(j, "LayerInfo");
 x.ociConfigurationPatch = get_stack_optional<OciConfigurationPatch>(j, "OCIConfigurationPatch");
 x.packageInfo = get_stack_optional<PackageInfo>(j, "PackageInfo");
@@ -525,6 +674,9 @@ j["CLIContainer"] = x.cliContainer;
 if (x.commonResult) {
 j["CommonResult"] = x.commonResult;
 }
+if (x.containerRegistryEntry) {
+j["ContainerRegistryEntry"] = x.containerRegistryEntry;
+}
 if (x.layerInfo) {
 j["LayerInfo"] = x.layerInfo;
 }
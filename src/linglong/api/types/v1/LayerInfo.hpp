@@ -17,6 +17,8 @@
 #include <nlohmann/json.hpp>
 #include "linglong/api/types/v1/helper.hpp"
 
+#include "linglong/api/types/v1/LayerInfoFile.hpp"
+
 namespace linglong {
 namespace api {
 namespace types {
@@ -31,7 +33,22 @@ using nlohmann::json;
 * Meta infomation on the head of layer file.
 */
 struct LayerInfo {
+/**
+* Size in bytes of the chunks of the binary data, since version 2.
+*/
+std::optional<int64_t> chunkSize;
+/**
+* SHA-256 digests in hex of the chunks of the binary data, since version 2.
+*/
+std::optional<std::vector<std::string>> chunks;
+/**
+* Table of contents of the binary data, since version 2.
+*/
+std::optional<std::vector<LayerInfoFile>> files;
 nlohmann::json info;
+/**
+* Version of the layer file format, "1" or "2".
+*/
 std::string version;
 };
 }
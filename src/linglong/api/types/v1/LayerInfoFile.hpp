@@ -0,0 +1,53 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+//  To parse this JSON data, first install
+//
+//      json.hpp  https://github.com/nlohmann/json
+//
+//  Then include this file, and then do
+//
+//     LayerInfoFile.hpp data = nlohmann::json::parse(jsonString);
+
+#pragma once
+
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "linglong/api/types/v1/helper.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+using nlohmann::json;
+
+struct LayerInfoFile {
+/**
+* Permission bits of the file.
+*/
+int64_t mode;
+/**
+* Path relative to the root of the layer.
+*/
+std::string path;
+/**
+* Size of the file in bytes.
+*/
+int64_t size;
+/**
+* Target of a symbolic link.
+*/
+std::optional<std::string> target;
+/**
+* One of "directory", "file", "symlink" and "other".
+*/
+std::string type;
+};
+}
+}
+}
+}
+
+// clang-format on
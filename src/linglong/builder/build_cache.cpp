@@ -0,0 +1,256 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "build_cache.h"
+
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/builder/file.h"
+#include "linglong/utils/command/env.h"
+
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QUrl>
+
+#include <functional>
+
+namespace linglong::builder {
+
+namespace {
+
+// Records written by other versions are ignored.
+constexpr auto recordVersion = 2;
+
+// Digest of the files in the project directory which might be used by the build script, the
+// content of the files is hashed so a fresh checkout of the same tree gets the same digest.
+QString projectFilesDigest(const QDir &project) noexcept
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    std::function<void(const QDir &)> addDir = [&](const QDir &dir) {
+        const auto entries =
+          dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                            QDir::Name);
+        for (const auto &info : entries) {
+            const auto path = project.relativeFilePath(info.absoluteFilePath());
+            if (path == "linglong" || path == ".git") {
+                continue;
+            }
+
+            hash.addData(path.toUtf8());
+            hash.addData("\0", 1);
+            if (info.isSymLink()) {
+                hash.addData(info.symLinkTarget().toUtf8());
+            } else if (info.isDir()) {
+                addDir(info.absoluteFilePath());
+            } else {
+                QFile file(info.absoluteFilePath());
+                if (file.open(QIODevice::ReadOnly)) {
+                    hash.addData(&file);
+                }
+            }
+            hash.addData("\0", 1);
+        }
+    };
+    addDir(project);
+
+    return hash.result().toHex();
+}
+
+} // namespace
+
+utils::error::Result<nlohmann::json>
+buildInputs(const api::types::v1::BuilderProject &project,
+            const QDir &workingDir,
+            const api::types::v1::BuilderConfig &cfg,
+            const QStringList &args,
+            const repo::OSTreeRepo &repo,
+            const package::Reference &base,
+            const std::optional<package::Reference> &runtime) noexcept
+{
+    LINGLONG_TRACE("collect inputs of the build");
+
+    auto inputs = nlohmann::json::object();
+
+    inputs["linglong.yaml"] =
+      util::fileHash(workingDir.absoluteFilePath("linglong.yaml"), QCryptographicHash::Sha256)
+        .toStdString();
+    inputs["project files"] = projectFilesDigest(workingDir).toStdString();
+    inputs["build command"] = args.join(' ').toStdString();
+
+    // Options which do not change the output of the build are not part of the key.
+    auto config = nlohmann::json(cfg);
+    for (const auto *option : { "cache", "cache_size", "fetch_jobs", "skip_build_cache" }) {
+        config.erase(option);
+    }
+    config["linglong"] = LINGLONG_VERSION;
+    inputs["builder config"] = config.dump();
+
+    auto layerCommit = [&repo](const package::Reference &ref) -> utils::error::Result<QString> {
+        auto commit = repo.getLayerCommit(ref, true);
+        if (!commit) {
+            return repo.getLayerCommit(ref);
+        }
+        return commit;
+    };
+
+    auto commit = layerCommit(base);
+    if (!commit) {
+        return LINGLONG_ERR(commit);
+    }
+    inputs["base " + base.toString().toStdString()] = commit->toStdString();
+
+    if (runtime) {
+        commit = layerCommit(*runtime);
+        if (!commit) {
+            return LINGLONG_ERR(commit);
+        }
+        inputs["runtime " + runtime->toString().toStdString()] = commit->toStdString();
+    }
+
+    if (!project.sources) {
+        return inputs;
+    }
+
+    // Sources are keyed by their position, as a project may fetch the same url more than once.
+    const QDir sources = workingDir.absoluteFilePath("linglong/sources");
+    for (std::size_t i = 0; i < project.sources->size(); ++i) {
+        const auto &source = project.sources->at(i);
+        auto name = "source " + std::to_string(i) + " " + source.url.value_or(source.kind);
+
+        if (source.kind == "archive" || source.kind == "file") {
+            inputs[name] = source.digest.value_or("");
+            continue;
+        }
+
+        if (source.kind == "git" && source.url) {
+            auto head = utils::command::Exec(
+              "git",
+              { "-C",
+                sources.absoluteFilePath(QUrl(QString::fromStdString(*source.url)).fileName()),
+                "rev-parse",
+                "HEAD" });
+            if (!head) {
+                return LINGLONG_ERR(head);
+            }
+            inputs[name] = head->trimmed().toStdString();
+            continue;
+        }
+
+        // The content of other sources can not be pinned, an empty digest never matches.
+        inputs[name] = "";
+    }
+
+    return inputs;
+}
+
+QString buildCachePath(const api::types::v1::BuilderConfig &cfg,
+                       const package::Reference &ref) noexcept
+{
+    return QDir(QString::fromStdString(cfg.repo))
+      .absoluteFilePath(QString("build-cache/%1_%2_%3_%4.json")
+                          .arg(ref.channel, ref.id, ref.version.toString(), ref.arch.toString()));
+}
+
+QString buildCacheMissReason(const QString &path,
+                             const nlohmann::json &inputs,
+                             const repo::OSTreeRepo &repo,
+                             const package::Reference &ref) noexcept
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return "no previous build is recorded";
+    }
+
+    nlohmann::json record;
+    try {
+        record = nlohmann::json::parse(file.readAll().toStdString());
+        if (record.at("version").get<int>() != recordVersion) {
+            return "the record of the previous build is outdated";
+        }
+    } catch (const std::exception &e) {
+        return QString("the record of the previous build is broken: %1").arg(e.what());
+    }
+
+    QStringList changed;
+    const auto last = record.value("inputs", nlohmann::json::object());
+    for (const auto &input : inputs.items()) {
+        const auto name = QString::fromStdString(input.key());
+        if (!last.contains(input.key())) {
+            changed.append(name + " is added");
+        } else if (last[input.key()] != input.value()) {
+            changed.append(name + " is changed");
+        } else if (input.value() == "") {
+            changed.append(name + " can not be pinned");
+        }
+    }
+    for (const auto &input : last.items()) {
+        if (!inputs.contains(input.key())) {
+            changed.append(QString::fromStdString(input.key()) + " is removed");
+        }
+    }
+    if (!changed.isEmpty()) {
+        return changed.join(", ");
+    }
+
+    const auto commits = record.value("commits", nlohmann::json::object());
+    for (const auto devel : { false, true }) {
+        auto commit = repo.getLayerCommit(ref, devel);
+        if (!commit
+            || commits.value(devel ? "develop" : "runtime", "") != commit->toStdString()) {
+            return QString("the %1 layer of the previous build is replaced or removed")
+              .arg(devel ? "develop" : "runtime");
+        }
+    }
+
+    return {};
+}
+
+utils::error::Result<void> saveBuildCache(const QString &path,
+                                          const nlohmann::json &inputs,
+                                          const repo::OSTreeRepo &repo,
+                                          const package::Reference &ref) noexcept
+{
+    LINGLONG_TRACE("record the build of " + ref.toString());
+
+    auto runtimeCommit = repo.getLayerCommit(ref);
+    if (!runtimeCommit) {
+        return LINGLONG_ERR(runtimeCommit);
+    }
+    auto developCommit = repo.getLayerCommit(ref, true);
+    if (!developCommit) {
+        return LINGLONG_ERR(developCommit);
+    }
+
+    const auto record = nlohmann::json{
+        { "version", recordVersion },
+        { "inputs", inputs },
+        { "commits",
+          { { "runtime", runtimeCommit->toStdString() },
+            { "develop", developCommit->toStdString() } } },
+    };
+
+    if (!QFileInfo(path).dir().mkpath(".")) {
+        return LINGLONG_ERR("failed to create " + QFileInfo(path).absolutePath());
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(file);
+    }
+
+    auto content = QByteArray::fromStdString(record.dump());
+    if (file.write(content) != content.size()) {
+        return LINGLONG_ERR(file);
+    }
+
+    if (!file.commit()) {
+        return LINGLONG_ERR(file);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace linglong::builder
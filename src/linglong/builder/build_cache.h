@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_SRC_BUILDER_BUILD_CACHE_H_
+#define LINGLONG_SRC_BUILDER_BUILD_CACHE_H_
+
+#include "linglong/api/types/v1/BuilderConfig.hpp"
+#include "linglong/api/types/v1/BuilderProject.hpp"
+#include "linglong/package/reference.h"
+#include "linglong/repo/ostree_repo.h"
+#include "linglong/utils/error/error.h"
+
+#include <nlohmann/json.hpp>
+
+#include <QDir>
+#include <QStringList>
+
+#include <optional>
+
+namespace linglong::builder {
+
+// Everything the output of a build depends on, with a digest for each of them, so the reason
+// of a rebuild can be told by comparing with the inputs of the last build.
+utils::error::Result<nlohmann::json>
+buildInputs(const api::types::v1::BuilderProject &project,
+            const QDir &workingDir,
+            const api::types::v1::BuilderConfig &cfg,
+            const QStringList &args,
+            const repo::OSTreeRepo &repo,
+            const package::Reference &base,
+            const std::optional<package::Reference> &runtime) noexcept;
+
+// Path of the record of the last build of ref.
+QString buildCachePath(const api::types::v1::BuilderConfig &cfg,
+                       const package::Reference &ref) noexcept;
+
+// Returns an empty string if the layers of the last build are still in the repository and made
+// from the same inputs, otherwise the reason why the project has to be built again.
+QString buildCacheMissReason(const QString &path,
+                             const nlohmann::json &inputs,
+                             const repo::OSTreeRepo &repo,
+                             const package::Reference &ref) noexcept;
+
+// Record the inputs of a successful build with the commits of the layers it made.
+utils::error::Result<void> saveBuildCache(const QString &path,
+                                          const nlohmann::json &inputs,
+                                          const repo::OSTreeRepo &repo,
+                                          const package::Reference &ref) noexcept;
+
+} // namespace linglong::builder
+
+#endif // LINGLONG_SRC_BUILDER_BUILD_CACHE_H_
@@ -20,12 +20,11 @@ auto loadConfig(const QString &file) noexcept -> utils::error::Result<api::types
     LINGLONG_TRACE(QString("load config from %1").arg(file));
 
     try {
-        auto ifs = std::ifstream(file.toLocal8Bit());
-        if (!ifs.is_open()) {
-            return LINGLONG_ERR("open failed");
+        auto config = utils::serialize::LoadYAMLFile<api::types::v1::BuilderConfig>(file);
+        if (!config) {
+            return LINGLONG_ERR(config);
         }
 
-        auto config = utils::serialize::LoadYAML<api::types::v1::BuilderConfig>(ifs);
         if (config->version != 1) {
             return LINGLONG_ERR(
               QString("wrong configuration file version %1").arg(config->version));
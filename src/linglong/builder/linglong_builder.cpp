@@ -7,6 +7,7 @@
 #include "linglong_builder.h"
 
 #include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/builder/build_cache.h"
 #include "linglong/builder/file.h"
 #include "linglong/package/layer_packager.h"
 #include "linglong/repo/ostree_repo.h"
@@ -14,6 +15,7 @@
 #include "linglong/utils/command/env.h"
 #include "linglong/utils/command/ocppi-helper.h"
 #include "linglong/utils/error/error.h"
+#include "linglong/utils/serialize/json.h"
 #include "linglong/utils/xdg/desktop_entry.h"
 #include "nlohmann/json_fwd.hpp"
 #include "ocppi/cli/CLI.hpp"
@@ -33,7 +35,9 @@
 #include <QThread>
 #include <QUrl>
 
+#include <atomic>
 #include <fstream>
+#include <memory>
 #include <optional>
 
 #include <sys/socket.h>
@@ -80,6 +84,51 @@ fetchSources(const std::vector<api::types::v1::BuilderProjectSource> &sources,
 {
     LINGLONG_TRACE("fetch sources to " + destination.absolutePath());
 
+    if (!destination.mkpath(".")) {
+        return LINGLONG_ERR("make path " + destination.absolutePath() + ": failed");
+    }
+
+    // Files used last are kept in the download cache, even if fetching failed.
+    auto prune = utils::finally::finally([&cfg]() {
+        SourceFetcher::pruneCache(cfg);
+    });
+
+    // Downloads are independent of each other, they run concurrently. Threads are QThreads as
+    // downloading files runs event loops.
+    std::vector<std::optional<utils::error::Result<void>>> results(sources.size());
+    std::atomic<std::size_t> next = 0;
+    std::atomic<bool> failed = false;
+    auto worker = [&]() {
+        for (auto i = next++; i < sources.size() && !failed; i = next++) {
+            SourceFetcher sf(sources[i], cfg);
+            results[i] = sf.prefetch();
+            if (!*results[i]) {
+                failed = true;
+            }
+        }
+    };
+
+    const auto jobs = cfg.fetchJobs.value_or(SourceFetcher::defaultFetchJobs);
+    const auto threadCount =
+      std::min<std::size_t>(sources.size(), static_cast<std::size_t>(std::max<int64_t>(jobs, 1)));
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (std::size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(QThread::create(worker));
+        threads.back()->start();
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread->wait();
+    }
+
+    for (auto &result : results) {
+        if (result && !*result) {
+            return LINGLONG_ERR(*result);
+        }
+    }
+
+    // Sources may write the same paths, they are put into the destination one by one in the order
+    // of the project, so later sources always win.
     for (const auto &source : sources) {
         SourceFetcher sf(source, cfg);
         auto result = sf.fetch(destination);
@@ -183,6 +232,28 @@ utils::error::Result<void> Builder::build(const QStringList &args) noexcept
         return LINGLONG_ERR(base);
     }
 
+    auto ref = currentReference(this->project);
+    if (!ref) {
+        return LINGLONG_ERR(ref);
+    }
+
+    auto inputs =
+      buildInputs(this->project, this->workingDir, this->cfg, args, this->repo, *base, runtime);
+    if (!inputs) {
+        return LINGLONG_ERR(inputs);
+    }
+
+    const auto cachePath = buildCachePath(this->cfg, *ref);
+    if (!this->cfg.skipBuildCache.value_or(false)) {
+        auto reason = buildCacheMissReason(cachePath, *inputs, this->repo, *ref);
+        if (reason.isEmpty()) {
+            qInfo().noquote() << "nothing changed since the last build of" << ref->toString()
+                              << "skip building";
+            return LINGLONG_OK;
+        }
+        qInfo().noquote() << "build" << ref->toString() << "because" << reason;
+    }
+
     QFile entry = this->workingDir.absoluteFilePath("linglong/entry.sh");
     if (!entry.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
         return LINGLONG_ERR(entry);
@@ -201,14 +272,10 @@ utils::error::Result<void> Builder::build(const QStringList &args) noexcept
         return LINGLONG_ERR("make path " + developOutput.absolutePath() + ": failed.");
     }
 
-    auto ref = currentReference(this->project);
-    if (!ref) {
-        return LINGLONG_ERR(ref);
-    }
-
     auto opts = runtime::ContainerOptions{
         .appID = QString::fromStdString(this->project.package.id),
         .containerID = "linglong-builder-" + ref->toString(), // FIXME
+        .ref = ref->toString(),
         .runtimeDir = {},
         .baseDir = *this->repo.getLayerDir(*base),
         .appDir = {},
@@ -395,10 +462,17 @@ utils::error::Result<void> Builder::build(const QStringList &args) noexcept
         return LINGLONG_ERR(result);
     }
 
+    result = saveBuildCache(cachePath, *inputs, this->repo, *ref);
+    if (!result) {
+        qWarning() << result.error();
+    }
+
     return LINGLONG_OK;
 }
 
-utils::error::Result<void> Builder::exportLayer(const QString &destination)
+utils::error::Result<void> Builder::exportLayer(const QString &destination,
+                                                const QString &compressor,
+                                                const QString &deltaFrom)
 {
     LINGLONG_TRACE("export layer file");
 
@@ -437,6 +511,9 @@ utils::error::Result<void> Builder::exportLayer(const QString &destination)
     }
 
     package::LayerPackager pkger;
+    if (!compressor.isEmpty()) {
+        pkger.setCompressor(compressor);
+    }
 
     auto runtimeLayer = pkger.pack(*runtimeLayerDir, runtimeLayerPath);
     if (!runtimeLayer) {
@@ -448,6 +525,52 @@ utils::error::Result<void> Builder::exportLayer(const QString &destination)
         return LINGLONG_ERR(develLayer);
     }
 
+    if (deltaFrom.isEmpty()) {
+        return LINGLONG_OK;
+    }
+
+    auto oldLayer = package::LayerFile::New(deltaFrom);
+    if (!oldLayer) {
+        return LINGLONG_ERR(oldLayer);
+    }
+    auto oldLayerInfo = (*oldLayer)->metaInfo();
+    if (!oldLayerInfo) {
+        return LINGLONG_ERR(oldLayerInfo);
+    }
+    auto oldInfo = utils::serialize::LoadJSON<api::types::v1::PackageInfo>(oldLayerInfo->info);
+    if (!oldInfo) {
+        return LINGLONG_ERR(oldInfo);
+    }
+    if (oldInfo->packageInfoModule == "develop") {
+        return LINGLONG_ERR(deltaFrom + " is a develop module, deltas are made between runtimes");
+    }
+    auto oldRef = package::Reference::fromPackageInfo(*oldInfo);
+    if (!oldRef) {
+        return LINGLONG_ERR(oldRef);
+    }
+    if (oldRef->id != ref->id || oldRef->arch != ref->arch) {
+        return LINGLONG_ERR(deltaFrom + " is not an older version of " + ref->toString());
+    }
+
+    if (!this->repo.getLayerDir(*oldRef)) {
+        auto result = this->importLayer(deltaFrom);
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+    }
+
+    const auto deltaPath = QString("%1/%2_%3_%4_%5_%6.delta")
+                             .arg(destDir.absolutePath(),
+                                  ref->id,
+                                  oldRef->version.toString(),
+                                  ref->version.toString(),
+                                  ref->arch.toString(),
+                                  "runtime");
+    auto result = this->repo.exportDelta(*oldRef, *ref, deltaPath);
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
     return LINGLONG_OK;
 }
 
@@ -482,8 +605,9 @@ utils::error::Result<void> Builder::extractLayer(const QString &layerPath,
 }
 
 linglong::utils::error::Result<void> Builder::push(bool pushWithDevel,
+                                                   const QString &repoUrl,
                                                    const QString &repoName,
-                                                   const QString &repoUrl)
+                                                   const repo::pushOption &opts)
 {
     LINGLONG_TRACE("push reference to remote repository");
 
@@ -512,7 +636,7 @@ linglong::utils::error::Result<void> Builder::push(bool pushWithDevel,
         return LINGLONG_ERR(result);
     }
 
-    result = repo.push(*ref);
+    result = repo.push(*ref, false, opts);
     if (!result) {
         return LINGLONG_ERR(result);
     }
@@ -521,7 +645,7 @@ linglong::utils::error::Result<void> Builder::push(bool pushWithDevel,
         return LINGLONG_OK;
     }
 
-    result = repo.push(*ref, true);
+    result = repo.push(*ref, true, opts);
 
     if (!result) {
         return LINGLONG_ERR(result);
@@ -566,6 +690,7 @@ utils::error::Result<void> Builder::run(const QStringList &args)
     auto options = runtime::ContainerOptions{
         .appID = ref->id,
         .containerID = (ref->toString() + "-" + QUuid::createUuid().toString()).toUtf8().toBase64(),
+        .ref = ref->toString(),
         .runtimeDir = {},
         .baseDir = {},
         .appDir = {},
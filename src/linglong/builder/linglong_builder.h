@@ -31,13 +31,19 @@ public:
     auto build(const QStringList &args = { "/project/linglong/entry.sh" }) noexcept
       -> utils::error::Result<void>;
 
-    auto exportLayer(const QString &destination) -> utils::error::Result<void>;
+    // compressor is passed to mkfs.erofs, the default of LayerPackager is used if it is empty.
+    // A delta from the layer file deltaFrom is exported as well if it is not empty.
+    auto exportLayer(const QString &destination,
+                     const QString &compressor = {},
+                     const QString &deltaFrom = {}) -> utils::error::Result<void>;
 
     auto extractLayer(const QString &layerPath, const QString &destination)
       -> utils::error::Result<void>;
 
-    auto push(bool pushWithDevel = true, const QString &repoUrl = "", const QString &repoName = "")
-      -> utils::error::Result<void>;
+    auto push(bool pushWithDevel = true,
+              const QString &repoUrl = "",
+              const QString &repoName = "",
+              const repo::pushOption &opts = {}) -> utils::error::Result<void>;
 
     auto import() -> utils::error::Result<void>;
 
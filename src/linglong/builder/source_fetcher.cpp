@@ -16,12 +16,18 @@
 #include <qnetworkreply.h>
 
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QNetworkRequest>
+#include <QRegularExpression>
 #include <QStandardPaths>
 #include <QTemporaryDir>
 
+#include <cerrno>
+#include <cstdio>
 #include <utility>
 
+#include <utime.h>
+
 namespace linglong::builder {
 namespace {
 static constexpr auto CompressedFileTarXz = "tar.xz";
@@ -45,7 +51,9 @@ auto fixSuffix(const QFileInfo &fi) -> QString
     return fi.suffix();
 }
 
-auto extractFile(const QString &path, const QDir &dir) -> utils::error::Result<void>
+// The compression is told by the name of the file, which might be different from the path.
+auto extractFile(const QString &path, const QString &name, const QDir &dir)
+  -> utils::error::Result<void>
 {
     LINGLONG_TRACE("extract file");
 
@@ -62,7 +70,7 @@ auto extractFile(const QString &path, const QDir &dir) -> utils::error::Result<v
         return utils::command::Exec("unzip", { "-d", dir.absolutePath(), path });
     };
 
-    QFileInfo fi(path);
+    QFileInfo fi(name);
 
     QMap<QString,
          std::function<utils::error::Result<QString>(const QString &path, const QDir &dir)>>
@@ -75,7 +83,7 @@ auto extractFile(const QString &path, const QDir &dir) -> utils::error::Result<v
     auto suffix = fixSuffix(fi);
 
     if (!subcommandMap.contains(suffix)) {
-        return LINGLONG_ERR("unsupported suffix " + path + " " + fi.completeSuffix() + " "
+        return LINGLONG_ERR("unsupported suffix " + name + " " + fi.completeSuffix() + " "
                             + fi.suffix() + " " + fi.bundleName());
     }
 
@@ -88,22 +96,59 @@ auto extractFile(const QString &path, const QDir &dir) -> utils::error::Result<v
     return LINGLONG_OK;
 }
 
-auto needDownload(const api::types::v1::BuilderProjectSource &source, QFile &file) noexcept -> bool
+auto download(const QUrl &url, QFile &file) noexcept -> utils::error::Result<void>
 {
-    if (!file.exists()) {
-        return true;
+    LINGLONG_TRACE("download " + url.toString());
+
+    QNetworkRequest request;
+    request.setUrl(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Wget/1.21.4");
+
+    QNetworkAccessManager mgr;
+    auto reply = mgr.get(request);
+
+    QObject::connect(reply, &QNetworkReply::metaDataChanged, [reply]() {
+        qDebug() << reply->header(QNetworkRequest::ContentLengthHeader);
+    });
+
+    QObject::connect(reply, &QNetworkReply::readyRead, [reply, &file]() {
+        file.write(reply->readAll());
+    });
+
+    QEventLoop loop;
+    QEventLoop::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        return LINGLONG_ERR(reply->errorString(), reply->error());
     }
 
-    if (!source.digest) {
-        return true;
+    file.write(reply->readAll());
+    if (!file.flush()) {
+        return LINGLONG_ERR(file);
+    }
+
+    return LINGLONG_OK;
+}
+
+auto cacheDir(const api::types::v1::BuilderConfig &cfg) noexcept -> QDir
+{
+    auto dir = QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                    + "/linglong/builder/archives");
+    if (cfg.cache) {
+        dir.setPath(QString::fromStdString(*cfg.cache));
     }
 
-    auto digest = util::fileHash(file, QCryptographicHash::Sha256).toStdString();
-    return digest != *source.digest;
+    return dir.absoluteFilePath("sha256");
 }
 
-auto fetchFile(const api::types::v1::BuilderProjectSource &source, QDir destination) noexcept
-  -> utils::error::Result<QString>
+// Files are cached by their SHA-256 digest, so the same file is only downloaded once no matter
+// which project or URL it comes from. The modification time of a cached file is the time it was
+// used last, which is used to evict the least recently used files.
+auto fetchFile(const api::types::v1::BuilderProjectSource &source,
+               const api::types::v1::BuilderConfig &cfg) noexcept -> utils::error::Result<QString>
 {
     LINGLONG_TRACE("fetch file");
 
@@ -115,50 +160,53 @@ auto fetchFile(const api::types::v1::BuilderProjectSource &source, QDir destinat
         return LINGLONG_ERR("digest missing");
     }
 
-    QUrl url(source.url->c_str());
+    const auto digest = QString::fromStdString(*source.digest);
+    if (!QRegularExpression("^[0-9a-f]{64}$").match(digest).hasMatch()) {
+        return LINGLONG_ERR("invalid sha256 digest " + digest);
+    }
 
-    auto path = destination.absoluteFilePath(url.fileName());
+    const auto cache = cacheDir(cfg);
+    if (!cache.mkpath(".")) {
+        return LINGLONG_ERR("create " + cache.absolutePath() + ": failed");
+    }
 
-    QFile file = path;
+    auto path = cache.absoluteFilePath(digest);
+    if (QFileInfo::exists(path)) {
+        // The cache might be shared with other users, check the content before using it.
+        if (util::fileHash(path, QCryptographicHash::Sha256) == digest) {
+            ::utime(path.toLocal8Bit().constData(), nullptr);
+            return path;
+        }
 
-    if (needDownload(source, file)) {
-        file.remove();
+        qWarning() << "remove corrupted cache" << path;
+        QFile::remove(path);
     }
 
-    if (!file.open(QIODevice::WriteOnly)) {
+    QTemporaryFile file(cache.absoluteFilePath(digest + ".XXXXXX"));
+    if (!file.open()) {
         return LINGLONG_ERR(file);
     }
 
-    QNetworkRequest request;
-    request.setUrl(url);
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
-                         QNetworkRequest::NoLessSafeRedirectPolicy);
-    request.setHeader(QNetworkRequest::UserAgentHeader, "Wget/1.21.4");
-
-    QNetworkAccessManager mgr;
-    auto reply = mgr.get(request);
-
-    QObject::connect(reply, &QNetworkReply::metaDataChanged, [reply]() {
-        qDebug() << reply->header(QNetworkRequest::ContentLengthHeader);
-    });
-
-    QObject::connect(reply, &QNetworkReply::readyRead, [reply, &file]() {
-        file.write(reply->readAll());
-    });
+    auto result = download(QUrl(QString::fromStdString(*source.url)), file);
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
 
-    QEventLoop loop;
-    QEventLoop::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    loop.exec();
-    // 将缓存写入文件
-    file.close();
+    auto actual = util::fileHash(file.fileName(), QCryptographicHash::Sha256);
+    if (actual != digest) {
+        return LINGLONG_ERR("digest mismatched: " + actual + " vs " + digest);
+    }
 
-    auto digest = util::fileHash(file, QCryptographicHash::Sha256).toStdString();
-    if (digest != *source.digest) {
-        return LINGLONG_ERR(
-          QString::fromStdString("digest mismatched: " + digest + " vs " + *source.digest));
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ReadGroup
+                        | QFileDevice::ReadOther);
+    // Replace the file which might be downloaded by others at the same time.
+    if (::rename(file.fileName().toLocal8Bit().constData(), path.toLocal8Bit().constData())
+        == -1) {
+        return LINGLONG_ERR("rename " + file.fileName() + " to " + path, errno);
     }
+    file.setAutoRemove(false);
 
-    return QFileInfo(file).absolutePath();
+    return path;
 }
 
 auto fetchGitRepo(const api::types::v1::BuilderProjectSource &source, QDir destination)
@@ -237,6 +285,22 @@ auto fetchDscRepo(const api::types::v1::BuilderProjectSource &source, QDir desti
 
 } // namespace
 
+auto SourceFetcher::prefetch() noexcept -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("prefetch source");
+
+    if (this->source.kind != "archive" && this->source.kind != "file") {
+        return LINGLONG_OK;
+    }
+
+    auto path = fetchFile(this->source, this->cfg);
+    if (!path) {
+        return LINGLONG_ERR(path);
+    }
+
+    return LINGLONG_OK;
+}
+
 auto SourceFetcher::fetch(QDir destination) noexcept -> utils::error::Result<void>
 {
     LINGLONG_TRACE("fetch source");
@@ -258,22 +322,14 @@ auto SourceFetcher::fetch(QDir destination) noexcept -> utils::error::Result<voi
     }
 
     if (this->source.kind == "archive") {
-        auto cacheDir = QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
-                             + "/linglong/builder/archives");
-        if (this->cfg.cache) {
-            cacheDir.setPath(QString::fromStdString(*this->cfg.cache));
-        }
-
-        if (!cacheDir.mkpath(".")) {
-            return LINGLONG_ERR("create " + cacheDir.absolutePath() + ": failed");
-        }
-
-        auto archivePath = fetchFile(this->source, cacheDir);
+        auto archivePath = fetchFile(this->source, this->cfg);
         if (!archivePath) {
             return LINGLONG_ERR(archivePath);
         }
 
-        auto ret = extractFile(*archivePath, destination);
+        auto ret = extractFile(*archivePath,
+                               QUrl(QString::fromStdString(*this->source.url)).fileName(),
+                               destination);
         if (!ret) {
             return LINGLONG_ERR(ret);
         }
@@ -281,16 +337,48 @@ auto SourceFetcher::fetch(QDir destination) noexcept -> utils::error::Result<voi
     }
 
     if (source.kind == "file") {
-        auto path = fetchFile(this->source, destination);
+        auto path = fetchFile(this->source, this->cfg);
         if (!path) {
             return LINGLONG_ERR(path);
         }
+
+        auto target =
+          destination.absoluteFilePath(QUrl(QString::fromStdString(*this->source.url)).fileName());
+        QFile::remove(target);
+        if (!QFile::copy(*path, target)) {
+            return LINGLONG_ERR("copy " + *path + " to " + target + ": failed");
+        }
         return LINGLONG_OK;
     }
 
     return LINGLONG_ERR("unknown source kind");
 }
 
+void SourceFetcher::pruneCache(const api::types::v1::BuilderConfig &cfg) noexcept
+{
+    const auto budget = cfg.cacheSize.value_or(defaultCacheSize);
+
+    // Newest first, files being downloaded have a suffix. They are written all the time, those
+    // not modified for long are left by builds which were killed.
+    auto entries = cacheDir(cfg).entryInfoList(QDir::Files, QDir::Time);
+    const auto staleTime = QDateTime::currentDateTime().addSecs(
+      -std::chrono::duration_cast<std::chrono::seconds>(staleDownloadAge).count());
+    qint64 size = 0;
+    for (const auto &entry : entries) {
+        if (entry.fileName().contains('.')) {
+            if (entry.lastModified() < staleTime && !QFile::remove(entry.absoluteFilePath())) {
+                qWarning() << "failed to remove" << entry.absoluteFilePath() << "from cache";
+            }
+            continue;
+        }
+
+        size += entry.size();
+        if (size > budget && !QFile::remove(entry.absoluteFilePath())) {
+            qWarning() << "failed to remove" << entry.absoluteFilePath() << "from cache";
+        }
+    }
+}
+
 SourceFetcher::SourceFetcher(api::types::v1::BuilderProjectSource s,
                              api::types::v1::BuilderConfig cfg)
     : source(std::move(s))
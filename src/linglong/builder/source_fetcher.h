@@ -15,6 +15,8 @@
 #include <QObject>
 #include <QUrl>
 
+#include <chrono>
+
 namespace linglong::builder {
 
 class SourceFetcher
@@ -23,8 +25,20 @@ public:
     explicit SourceFetcher(api::types::v1::BuilderProjectSource s,
                            api::types::v1::BuilderConfig cfg);
 
+    // Download the source into the download cache, so fetching it later needs no network.
+    // Sources which can not be cached are left to fetch.
+    auto prefetch() noexcept -> utils::error::Result<void>;
+
     auto fetch(QDir destination) noexcept -> utils::error::Result<void>;
 
+    // Remove the least recently used files from the download cache until it fits in the budget,
+    // and the files left by downloads which stopped long ago.
+    static void pruneCache(const api::types::v1::BuilderConfig &cfg) noexcept;
+
+    static constexpr qint64 defaultCacheSize = 10LL * 1024 * 1024 * 1024;
+    static constexpr int defaultFetchJobs = 4;
+    static constexpr std::chrono::hours staleDownloadAge{ 24 };
+
 private:
     api::types::v1::BuilderProjectSource source;
     api::types::v1::BuilderConfig cfg;
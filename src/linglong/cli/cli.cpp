@@ -10,17 +10,27 @@
 #include "linglong/api/types/v1/PackageManager1Package.hpp"
 #include "linglong/api/types/v1/PackageManager1ResultWithTaskID.hpp"
 #include "linglong/package/layer_file.h"
+#include "linglong/package/layer_packager.h"
+#include "linglong/runtime/cgroup.h"
 #include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/zygote.h"
 #include "linglong/utils/command/env.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/error/error.h"
 #include "linglong/utils/serialize/json.h"
+#include "linglong/utils/trace/trace.h"
+#include "ocppi/runtime/ExecOption.hpp"
 #include "ocppi/runtime/Signal.hpp"
-#include "ocppi/types/ContainerListItem.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <QLockFile>
+#include <QStandardPaths>
+
 #include <iostream>
+#include <limits>
+
+#include <unistd.h>
 
 using namespace linglong::utils::error;
 
@@ -32,8 +42,8 @@ A CLI program to run application and manage linglong pagoda and tiers.
 
 Usage:
     ll-cli [--json] --version
-    ll-cli [--json] run APP [--no-dbus-proxy] [--dbus-proxy-cfg=PATH] ( [--file=FILE] | [--url=URL] ) [--] [COMMAND...]
-    ll-cli [--json] ps
+    ll-cli [--json] run ( APP | --layer=FILE ) [--no-dbus-proxy] [--dbus-proxy-cfg=PATH] [--trace=FILE] ( [--file=FILE] | [--url=URL] ) [--] [COMMAND...]
+    ll-cli [--json] ps [--stats]
     ll-cli [--json] exec PAGODA [--working-directory=PATH] [--] COMMAND...
     ll-cli [--json] enter PAGODA [--working-directory=PATH] [--] [COMMAND...]
     ll-cli [--json] kill PAGODA
@@ -44,7 +54,9 @@ Usage:
     ll-cli [--json] [--no-dbus] list [--type=TYPE]
     ll-cli [--json] repo modify [--name=REPO] URL
     ll-cli [--json] repo list
-    ll-cli [--json] info LAYER
+    ll-cli [--json] info [--files] [--verify] LAYER
+    ll-cli [--json] export-bundle APP --output=FILE
+    ll-cli [--json] zygote BASE [RUNTIME]
 
 Arguments:
     APP     Specify the application.
@@ -53,6 +65,8 @@ Arguments:
     URL     Specify the new repo URL.
     TEXT    The text used to search tiers.
     LAYER   Specify the layer path
+    BASE    Specify the base.
+    RUNTIME Specify the runtime.
 
 Options:
     -h --help                 Show this screen.
@@ -61,11 +75,17 @@ Options:
     --no-dbus                 Use peer to peer DBus, this is used only in case that DBus daemon is not available.
     --no-dbus-proxy           Do not enable linglong-dbus-proxy.
     --dbus-proxy-cfg=PATH     Path of config of linglong-dbus-proxy.
+    --layer=FILE              Run the application in a layer file without installing it.
+    --trace=FILE              Write where the time of launching goes to FILE in Chrome trace event format.
     --file=FILE               you can refer to https://linglong.dev/guide/ll-cli/run.html to use this parameter.
     --url=URL                 you can refer to https://linglong.dev/guide/ll-cli/run.html to use this parameter.
     --working-directory=PATH  Specify working directory.
     --type=TYPE               Filter result with tiers type. One of "lib", "app" or "dev". [default: app]
     --state=STATE             Filter result with the tiers install state. Should be "local" or "remote". [default: local]
+    --stats                   Show resource usage of pagodas read from their cgroups.
+    --files                   List the files in the layer without mounting it.
+    --output=FILE             Write the bundle to FILE.
+    --verify                  Check the checksums of the layer.
     --prune                   Remove application data if the tier is an application and all version of that application has been removed.
 
 Subcommands:
@@ -81,8 +101,26 @@ Subcommands:
     list       List known tiers.
     repo       Display or modify information of the repository currently using.
     info       Display the information of layer
+    export-bundle  Export an application with its runtime and base to a file, which can be installed by ll-cli install without network.
+    zygote     Start a zygote to launch applications on the base and runtime quickly.
 )";
 
+namespace {
+
+// Bundles written by "ll-cli export-bundle" are tar archives starting with bundle.json.
+bool isBundle(const QString &path) noexcept
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const auto header = file.read(512);
+    return header.size() == 512 && header.mid(257, 5) == "ustar"
+      && header.left(static_cast<int>(qstrnlen(header.constData(), 100))) == "bundle.json";
+}
+
+} // namespace
+
 void Cli::processDownloadStatus(const QString &recTaskID,
                                 const QString &percentage,
                                 const QString &message,
@@ -130,38 +168,104 @@ Cli::Cli(Printer &printer,
     , containerBuidler(containerBuilder)
     , repository(repo)
     , pkgMan(pkgMan)
+    , registry(runtime::ContainerRegistry::defaultDir())
 {
 }
 
 int Cli::run(std::map<std::string, docopt::value> &args)
 {
     LINGLONG_TRACE("command run");
+    LINGLONG_SPAN("command run");
 
-    const auto userInputAPP = QString::fromStdString(args["APP"].asString());
-    Q_ASSERT(!userInputAPP.isEmpty());
+    utils::trace::Span resolveSpan("resolve application");
 
-    auto fuzzyRef = package::FuzzyReference::parse(userInputAPP);
-    if (!fuzzyRef) {
-        this->printer.printErr(fuzzyRef.error());
-        return -1;
+    // A layer file is mounted read only until the application exits,
+    // its base and runtime are installed ones.
+    std::unique_ptr<package::LayerPackager> layerPackager;
+    std::optional<package::LayerDir> layerFileDir;
+    if (args["--layer"].isString()) {
+        auto layerFile =
+          package::LayerFile::New(QString::fromStdString(args["--layer"].asString()));
+        if (!layerFile) {
+            this->printer.printErr(layerFile.error());
+            return -1;
+        }
+
+        layerPackager = std::make_unique<package::LayerPackager>();
+        auto mounted = layerPackager->unpack(**layerFile);
+        if (!mounted) {
+            this->printer.printErr(mounted.error());
+            return -1;
+        }
+        layerFileDir = *mounted;
     }
 
-    auto ref = this->repository.clearReference(*fuzzyRef,
+    auto ref = [&]() -> utils::error::Result<package::Reference> {
+        if (layerFileDir) {
+            auto info = layerFileDir->info();
+            if (!info) {
+                return LINGLONG_ERR(info);
+            }
+            return package::Reference::fromPackageInfo(*info);
+        }
+
+        const auto userInputAPP = QString::fromStdString(args["APP"].asString());
+        Q_ASSERT(!userInputAPP.isEmpty());
+
+        auto fuzzyRef = package::FuzzyReference::parse(userInputAPP);
+        if (!fuzzyRef) {
+            return LINGLONG_ERR(fuzzyRef);
+        }
+
+        return this->repository.clearReference(*fuzzyRef,
                                                {
                                                  .forceRemote = false,
                                                  .fallbackToRemote = false,
                                                });
+    }();
     if (!ref) {
         this->printer.printErr(ref.error());
         return -1;
     }
 
-    auto layerDir = this->repository.getLayerDir(*ref, false);
+    resolveSpan.end();
+
+    if (!layerFileDir) {
+        if (auto code = this->runInRunningContainer(*ref, args); code) {
+            return *code;
+        }
+    }
+
+    utils::trace::Span layersSpan("resolve layers");
+    auto layerDir = layerFileDir ? utils::error::Result<package::LayerDir>(*layerFileDir)
+                                 : this->repository.getLayerDir(*ref, false);
     if (!layerDir) {
         this->printer.printErr(layerDir.error());
         return -1;
     }
 
+    // The generated OCI configuration is cached by the commits of all layers,
+    // nothing is cached for a layer file which is not committed.
+    std::optional<QStringList> layerCommits;
+    if (!layerFileDir) {
+        layerCommits = QStringList{};
+    }
+    auto recordLayerCommit = [this, &layerCommits](const package::Reference &ref) {
+        if (!layerCommits) {
+            return;
+        }
+
+        auto commit = this->repository.getLayerCommit(ref);
+        if (!commit) {
+            qWarning() << commit.error();
+            layerCommits.reset();
+            return;
+        }
+
+        layerCommits->push_back(*commit);
+    };
+    recordLayerCommit(*ref);
+
     auto info = layerDir->info();
     if (!info) {
         this->printer.printErr(info.error());
@@ -169,6 +273,7 @@ int Cli::run(std::map<std::string, docopt::value> &args)
     }
 
     std::optional<package::LayerDir> runtimeLayerDir;
+    std::optional<QString> runtimeRefString;
 
     if (info->runtime) {
         auto runtimeFuzzyRef =
@@ -195,6 +300,8 @@ int Cli::run(std::map<std::string, docopt::value> &args)
         }
 
         runtimeLayerDir = *layerDir;
+        runtimeRefString = runtimeRef->toString();
+        recordLayerCommit(*runtimeRef);
     }
 
     auto baseFuzzyRef = package::FuzzyReference::parse(QString::fromStdString(info->base));
@@ -218,20 +325,50 @@ int Cli::run(std::map<std::string, docopt::value> &args)
         this->printer.printErr(LINGLONG_ERRV(baseLayerDir));
         return -1;
     }
+    recordLayerCommit(*baseRef);
+    layersSpan.end();
+
+    // Applications on the same base and runtime share a zygote if it is enabled,
+    // which is started in background for the later launches if it is not running.
+    std::optional<QString> zygoteID;
+    if (runtime::Zygote::enabled() && layerCommits) {
+        zygoteID = runtime::Zygote::containerID(layerCommits->mid(1));
+        if (!this->registry.get(*zygoteID)) {
+            QStringList zygoteArgs{ "zygote", baseRef->toString() };
+            if (runtimeRefString) {
+                zygoteArgs.push_back(*runtimeRefString);
+            }
+
+            QProcess zygote;
+            zygote.setProgram(QCoreApplication::applicationFilePath());
+            zygote.setArguments(zygoteArgs);
+            zygote.setStandardInputFile(QProcess::nullDevice());
+            zygote.setStandardOutputFile(QProcess::nullDevice());
+            zygote.setStandardErrorFile(QProcess::nullDevice());
+            if (!zygote.startDetached()) {
+                qWarning() << "failed to start zygote:" << zygote.errorString();
+            }
+        }
+    }
 
+    utils::trace::Span createSpan("create container");
     auto container = this->containerBuidler.create({
       .appID = ref->id,
       .containerID = (ref->toString() + "-" + QUuid::createUuid().toString()).toUtf8().toBase64(),
+      .ref = ref->toString(),
       .runtimeDir = runtimeLayerDir,
       .baseDir = *baseLayerDir,
       .appDir = *layerDir,
       .patches = {},
       .mounts = {},
+      .layerCommits = layerCommits.value_or(QStringList{}),
+      .zygoteID = zygoteID,
     });
     if (!container) {
         this->printer.printErr(container.error());
         return -1;
     }
+    createSpan.end();
 
     ocppi::runtime::config::types::Process p;
 
@@ -258,26 +395,74 @@ int Cli::run(std::map<std::string, docopt::value> &args)
     return 0;
 }
 
-int Cli::exec(std::map<std::string, docopt::value> &args)
+// A second launch of an application executes the command in its running container,
+// unless reuse_container is false in the configuration of the application.
+std::optional<int> Cli::runInRunningContainer(const package::Reference &ref,
+                                              std::map<std::string, docopt::value> &args)
 {
-    LINGLONG_TRACE("ll-cli exec");
+    LINGLONG_TRACE("run in running container of " + ref.toString());
 
-    auto containers = this->ociCLI.list();
-    if (!containers) {
-        auto err = LINGLONG_ERRV(containers);
-        this->printer.printErr(err);
-        return -1;
+    auto command = args["COMMAND"].asStringList();
+    if (command.empty()) {
+        return std::nullopt;
+    }
+
+    auto config = runtime::getApplicationConfiguration(ref.id);
+    if (config && config->reuseContainer && !*config->reuseContainer) {
+        return std::nullopt;
     }
 
-    auto pagoda = args["PAGODA"].asString();
-    for (const auto &container : *containers) {
-        auto decodedID = QString(QByteArray::fromBase64(container.id.c_str()));
-        if (!decodedID.startsWith(QString::fromStdString(pagoda))) {
+    const auto refString = ref.toString().toStdString();
+    for (const auto &container : this->registry.list(ref.id)) {
+        // Containers still starting can not execute commands,
+        // and processes launched in a zygote do not have their own containers.
+        if (container.ref != refString || !container.pid || container.zygoteId) {
             continue;
         }
-        pagoda = container.id;
-        break;
+
+        std::vector<std::string> execArgs;
+        this->filePathMapping(args, command, execArgs);
+        if (execArgs.empty()) {
+            return std::nullopt;
+        }
+
+        ocppi::runtime::ExecOption opt{};
+        opt.tty = isatty(fileno(stdin)) != 0;
+        opt.cwd = ("/run/host/rootfs" + QDir::currentPath()).toStdString();
+        for (const auto &env : utils::command::getUserEnv(utils::command::envList)) {
+            auto pos = env.indexOf('=');
+            opt.env[env.left(pos).toStdString()] = env.mid(pos + 1).toStdString();
+        }
+
+        qInfo() << "run in pagoda" << QString::fromStdString(container.containerId);
+
+        LINGLONG_SPAN("exec in running container");
+        auto result = this->ociCLI.exec(container.containerId,
+                                        execArgs[0],
+                                        std::vector<std::string>(execArgs.begin() + 1,
+                                                                 execArgs.end()),
+                                        opt);
+        if (!result) {
+            this->printer.printErr(LINGLONG_ERRV(result));
+            return -1;
+        }
+
+        return 0;
+    }
+
+    return std::nullopt;
+}
+
+int Cli::exec(std::map<std::string, docopt::value> &args)
+{
+    LINGLONG_TRACE("ll-cli exec");
+
+    auto container = this->registry.find(QString::fromStdString(args["PAGODA"].asString()));
+    if (!container) {
+        this->printer.printErr(LINGLONG_ERRV(container));
+        return -1;
     }
+    const auto &pagoda = container->containerId;
 
     qInfo() << "select pagoda" << QString::fromStdString(pagoda);
 
@@ -299,26 +484,32 @@ int Cli::exec(std::map<std::string, docopt::value> &args)
     return 0;
 }
 
-int Cli::ps(std::map<std::string, docopt::value> & /*args*/)
+int Cli::ps(std::map<std::string, docopt::value> &args)
 {
     LINGLONG_TRACE("command ps");
 
-    auto containers = this->ociCLI.list();
-    if (!containers) {
-        auto err = LINGLONG_ERRV(containers);
-        this->printer.printErr(err);
-        return -1;
-    }
+    const auto showStats = args["--stats"].asBool();
 
     std::vector<api::types::v1::CliContainer> myContainers;
-    for (const auto &container : *containers) {
-        auto decodedID = QString(QByteArray::fromBase64(container.id.c_str()));
-        auto pkgName = decodedID.left(decodedID.indexOf('-'));
-        myContainers.push_back({
-          .id = container.id,
-          .package = pkgName.toStdString(),
-          .pid = container.pid,
-        });
+    for (const auto &container : this->registry.list()) {
+        api::types::v1::CliContainer item{
+            .id = container.containerId,
+            .package = container.ref,
+            .pid = container.pid.value_or(0),
+        };
+
+        // NOTE: Applications launched in a zygote share the cgroup of the zygote.
+        if (showStats && container.pid) {
+            auto stats = runtime::cgroup::stats(*container.pid);
+            if (stats) {
+                item.stats = *stats;
+            } else {
+                qWarning() << stats.error();
+                item.stats = api::types::v1::CliContainerStats{};
+            }
+        }
+
+        myContainers.push_back(std::move(item));
     }
 
     this->printer.printContainers(myContainers);
@@ -330,27 +521,28 @@ int Cli::kill(std::map<std::string, docopt::value> &args)
 {
     LINGLONG_TRACE("command kill");
 
-    auto containers = this->ociCLI.list();
-    if (!containers) {
-        auto err = LINGLONG_ERRV(containers);
-        this->printer.printErr(err);
+    auto container = this->registry.find(QString::fromStdString(args["PAGODA"].asString()));
+    if (!container) {
+        this->printer.printErr(LINGLONG_ERRV(container));
         return -1;
     }
 
-    auto pagoda = args["PAGODA"].asString();
-    for (const auto &container : *containers) {
-        auto decodedID = QString(QByteArray::fromBase64(container.id.c_str()));
-        if (!decodedID.startsWith(QString::fromStdString(pagoda))) {
-            continue;
+    qInfo() << "select pagoda" << QString::fromStdString(container->containerId);
+
+    // The PID is unknown while the container is starting.
+    if (!container->pid) {
+        auto result = this->ociCLI.kill(ocppi::runtime::ContainerID(container->containerId),
+                                        ocppi::runtime::Signal("SIGTERM"));
+        if (!result) {
+            auto err = LINGLONG_ERRV(result);
+            this->printer.printErr(err);
+            return -1;
         }
-        pagoda = container.id;
-        break;
-    }
 
-    qInfo() << "select pagoda" << QString::fromStdString(pagoda);
+        return 0;
+    }
 
-    auto result =
-      this->ociCLI.kill(ocppi::runtime::ContainerID(pagoda), ocppi::runtime::Signal("SIGTERM"));
+    auto result = runtime::ContainerRegistry::kill(*container, SIGTERM);
     if (!result) {
         auto err = LINGLONG_ERRV(result);
         this->printer.printErr(err);
@@ -375,6 +567,58 @@ int Cli::install(std::map<std::string, docopt::value> &args)
     auto tier = args["TIER"].asString();
     auto fuzzyRef = package::FuzzyReference::parse(QString::fromStdString(tier));
 
+    if (isBundle(QString::fromStdString(tier))) {
+        QFile bundleFile(QString::fromStdString(tier));
+        if (!bundleFile.open(QIODevice::ReadOnly)) {
+            qCritical() << QFileInfo(bundleFile).absoluteFilePath() << "is not readable.";
+            return -1;
+        }
+        qInfo() << "install bundle file" << QString::fromStdString(tier);
+        // Importing a large bundle takes longer than the default timeout of DBus calls.
+        this->pkgMan.setTimeout(std::numeric_limits<int>::max());
+        auto pendingReply =
+          this->pkgMan.InstallBundle(QDBusUnixFileDescriptor(bundleFile.handle()));
+        auto reply = pendingReply.value();
+        auto result =
+          utils::serialize::fromQVariantMap<api::types::v1::PackageManager1ResultWithTaskID>(reply);
+        if (!result) {
+            qCritical() << result.error();
+            qCritical() << "linglong bug detected.";
+            std::abort();
+        }
+        if (result->code != 0) {
+            auto err = LINGLONG_ERRV(QString::fromStdString(result->message), result->code);
+            this->printer.printErr(err);
+            return -1;
+        }
+        return 0;
+    }
+
+    if (QString::fromStdString(tier).endsWith(".delta")
+        && QFileInfo::exists(QString::fromStdString(tier))) {
+        QFile deltaFile(QString::fromStdString(tier));
+        if (!deltaFile.open(QIODevice::ReadOnly)) {
+            qCritical() << QFileInfo(deltaFile).absoluteFilePath() << "is not readable.";
+            return -1;
+        }
+        qInfo() << "install delta file" << QString::fromStdString(tier);
+        auto pendingReply = this->pkgMan.InstallDelta(QDBusUnixFileDescriptor(deltaFile.handle()));
+        auto reply = pendingReply.value();
+        auto result =
+          utils::serialize::fromQVariantMap<api::types::v1::PackageManager1ResultWithTaskID>(reply);
+        if (!result) {
+            qCritical() << result.error();
+            qCritical() << "linglong bug detected.";
+            std::abort();
+        }
+        if (result->code != 0) {
+            auto err = LINGLONG_ERRV(QString::fromStdString(result->message), result->code);
+            this->printer.printErr(err);
+            return -1;
+        }
+        return 0;
+    }
+
     if (!fuzzyRef) {
         const auto layerFile = package::LayerFile::New(QString::fromStdString(tier));
         if (!layerFile) {
@@ -708,6 +952,25 @@ int Cli::info(std::map<std::string, docopt::value> &args)
         return -1;
     }
 
+    if (args["--verify"].asBool()) {
+        auto result = (*layerFile)->verify();
+        if (!result) {
+            this->printer.printErr(result.error());
+            return -1;
+        }
+    }
+
+    if (args["--files"].asBool()) {
+        const auto files = (*layerFile)->files();
+        if (!files) {
+            this->printer.printErr(files.error());
+            return -1;
+        }
+
+        this->printer.printLayerFiles(*files);
+        return 0;
+    }
+
     const auto layerInfo = (*layerFile)->metaInfo();
     if (!layerInfo) {
         this->printer.printErr(layerInfo.error());
@@ -718,6 +981,183 @@ int Cli::info(std::map<std::string, docopt::value> &args)
     return 0;
 }
 
+int Cli::exportBundle(std::map<std::string, docopt::value> &args)
+{
+    LINGLONG_TRACE("command export-bundle");
+
+    auto resolve = [this](const std::string &input) -> utils::error::Result<package::Reference> {
+        LINGLONG_TRACE("resolve " + QString::fromStdString(input));
+
+        auto fuzzyRef = package::FuzzyReference::parse(QString::fromStdString(input));
+        if (!fuzzyRef) {
+            return LINGLONG_ERR(fuzzyRef);
+        }
+
+        auto ref = this->repository.clearReference(*fuzzyRef,
+                                                   {
+                                                     .forceRemote = false,
+                                                     .fallbackToRemote = false,
+                                                   });
+        if (!ref) {
+            return LINGLONG_ERR(ref);
+        }
+
+        return ref;
+    };
+
+    auto ref = resolve(args["APP"].asString());
+    if (!ref) {
+        this->printer.printErr(ref.error());
+        return -1;
+    }
+
+    auto layerDir = this->repository.getLayerDir(*ref);
+    if (!layerDir) {
+        this->printer.printErr(layerDir.error());
+        return -1;
+    }
+
+    auto info = layerDir->info();
+    if (!info) {
+        this->printer.printErr(info.error());
+        return -1;
+    }
+
+    std::vector<package::Reference> refs{ *ref };
+    for (const auto &dependency : { info->runtime.value_or(""), info->base }) {
+        if (dependency.empty()) {
+            continue;
+        }
+
+        auto dependencyRef = resolve(dependency);
+        if (!dependencyRef) {
+            this->printer.printErr(dependencyRef.error());
+            return -1;
+        }
+        refs.push_back(*dependencyRef);
+    }
+
+    auto result =
+      this->repository.exportBundle(refs, QString::fromStdString(args["--output"].asString()));
+    if (!result) {
+        this->printer.printErr(result.error());
+        return -1;
+    }
+
+    return 0;
+}
+
+int Cli::zygote(std::map<std::string, docopt::value> &args)
+{
+    LINGLONG_TRACE("command zygote");
+
+    // The zygote keeps running after the application started it exits.
+    ::setsid();
+
+    auto resolve = [this](const std::string &input) -> utils::error::Result<package::Reference> {
+        LINGLONG_TRACE("resolve " + QString::fromStdString(input));
+
+        auto fuzzyRef = package::FuzzyReference::parse(QString::fromStdString(input));
+        if (!fuzzyRef) {
+            return LINGLONG_ERR(fuzzyRef);
+        }
+
+        auto ref = this->repository.clearReference(*fuzzyRef,
+                                                   {
+                                                     .forceRemote = false,
+                                                     .fallbackToRemote = false,
+                                                   });
+        if (!ref) {
+            return LINGLONG_ERR(ref);
+        }
+
+        return ref;
+    };
+
+    // Commits are in the same order as the layers of the applications, see Cli::run.
+    QStringList layerCommits;
+    std::optional<package::LayerDir> runtimeLayerDir;
+    if (args["RUNTIME"].isString()) {
+        auto runtimeRef = resolve(args["RUNTIME"].asString());
+        if (!runtimeRef) {
+            this->printer.printErr(runtimeRef.error());
+            return -1;
+        }
+
+        auto layerDir = this->repository.getLayerDir(*runtimeRef);
+        if (!layerDir) {
+            this->printer.printErr(layerDir.error());
+            return -1;
+        }
+        runtimeLayerDir = *layerDir;
+
+        auto commit = this->repository.getLayerCommit(*runtimeRef);
+        if (!commit) {
+            this->printer.printErr(commit.error());
+            return -1;
+        }
+        layerCommits.push_back(*commit);
+    }
+
+    auto baseRef = resolve(args["BASE"].asString());
+    if (!baseRef) {
+        this->printer.printErr(baseRef.error());
+        return -1;
+    }
+
+    auto baseLayerDir = this->repository.getLayerDir(*baseRef);
+    if (!baseLayerDir) {
+        this->printer.printErr(baseLayerDir.error());
+        return -1;
+    }
+
+    auto baseCommit = this->repository.getLayerCommit(*baseRef);
+    if (!baseCommit) {
+        this->printer.printErr(baseCommit.error());
+        return -1;
+    }
+    layerCommits.push_back(*baseCommit);
+
+    const auto zygoteID = runtime::Zygote::containerID(layerCommits);
+
+    // Only one zygote runs for the same layers.
+    QDir runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (!runtimeDir.mkpath("linglong")) {
+        this->printer.printErr(LINGLONG_ERRV("make directory linglong in runtime directory"));
+        return -1;
+    }
+    QLockFile lock(runtimeDir.absoluteFilePath("linglong/" + zygoteID + ".lock"));
+    lock.setStaleLockTime(0);
+    if (!lock.tryLock()) {
+        qInfo() << "zygote" << zygoteID << "is running";
+        return 0;
+    }
+
+    auto container = this->containerBuidler.create({
+      .appID = runtime::Zygote::appID,
+      .containerID = zygoteID,
+      .ref = baseRef->toString(),
+      .runtimeDir = runtimeLayerDir,
+      .baseDir = *baseLayerDir,
+      .appDir = std::nullopt,
+      .patches = {},
+      .mounts = {},
+      .layerCommits = layerCommits,
+    });
+    if (!container) {
+        this->printer.printErr(container.error());
+        return -1;
+    }
+
+    auto result = (*container)->run(runtime::Zygote::serverProcess());
+    if (!result) {
+        this->printer.printErr(result.error());
+        return -1;
+    }
+
+    return 0;
+}
+
 void Cli::filePathMapping(std::map<std::string, docopt::value> &args,
                           const std::vector<std::string> &command,
                           std::vector<std::string> &execArgs) const noexcept
@@ -9,6 +9,7 @@
 
 #include "linglong/api/dbus/v1/package_manager.h"
 #include "linglong/cli/printer.h"
+#include "linglong/package/reference.h"
 #include "linglong/package_manager/package_manager.h"
 #include "linglong/runtime/container_builder.h"
 #include "linglong/utils/error/error.h"
@@ -25,6 +26,7 @@
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <optional>
 
 namespace linglong::cli {
 
@@ -52,12 +54,15 @@ private:
     runtime::ContainerBuilder &containerBuidler;
     repo::OSTreeRepo &repository;
     api::dbus::v1::PackageManager &pkgMan;
+    runtime::ContainerRegistry registry;
     QString taskID;
     bool taskDone{ true };
     service::InstallTask::Status lastStatus;
     void filePathMapping(std::map<std::string, docopt::value> &args,
                          const std::vector<std::string> &command,
                          std::vector<std::string> &execArgs) const noexcept;
+    std::optional<int> runInRunningContainer(const package::Reference &ref,
+                                             std::map<std::string, docopt::value> &args);
 
 public:
     int run(std::map<std::string, docopt::value> &args);
@@ -72,6 +77,8 @@ public:
     int list(std::map<std::string, docopt::value> &args);
     int repo(std::map<std::string, docopt::value> &args);
     int info(std::map<std::string, docopt::value> &args);
+    int exportBundle(std::map<std::string, docopt::value> &args);
+    int zygote(std::map<std::string, docopt::value> &args);
 
     void cancelCurrentTask();
 
@@ -50,6 +50,11 @@ void JSONPrinter::printLayerInfo(const api::types::v1::LayerInfo &info)
     std::cout << nlohmann::json(info).dump() << std::endl;
 }
 
+void JSONPrinter::printLayerFiles(const std::vector<api::types::v1::LayerInfoFile> &files)
+{
+    std::cout << nlohmann::json(files).dump() << std::endl;
+}
+
 void JSONPrinter::printTaskStatus(const QString &percentage, const QString &message, int status)
 {
     QJsonArray jsonArray;
@@ -20,6 +20,7 @@ public:
     void printReply(const api::types::v1::CommonResult &) override;
     void printRepoConfig(const api::types::v1::RepoConfig &) override;
     void printLayerInfo(const api::types::v1::LayerInfo &) override;
+    void printLayerFiles(const std::vector<api::types::v1::LayerInfoFile> &) override;
     void printTaskStatus(const QString &percentage, const QString &message, int status) override;
 };
 
@@ -10,11 +10,48 @@
 
 #include <QJsonArray>
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 
 namespace linglong::cli {
 
+namespace {
+
+void printContainerStats(const std::vector<api::types::v1::CliContainer> &list)
+{
+    // Values missing in the cgroup are printed as "-".
+    auto format = [](const std::optional<int64_t> &value, double unit) -> std::string {
+        if (!value) {
+            return "-";
+        }
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1) << static_cast<double>(*value) / unit;
+        return ss.str();
+    };
+    constexpr auto second = 1000.0 * 1000;
+    constexpr auto mebibyte = 1024.0 * 1024;
+
+    std::cout << "\033[38;5;214m" << std::left << std::setw(48) << qUtf8Printable("App")
+              << std::setw(8) << qUtf8Printable("Pid") << std::setw(10)
+              << qUtf8Printable("CPU(s)") << std::setw(10) << qUtf8Printable("RSS(MiB)")
+              << std::setw(12) << qUtf8Printable("Read(MiB)") << std::setw(12)
+              << qUtf8Printable("Write(MiB)") << qUtf8Printable("PIDs") << "\033[0m" << std::endl;
+
+    for (auto const &container : list) {
+        auto stats = container.stats.value_or(api::types::v1::CliContainerStats{});
+        std::cout << std::setw(48) << container.package << std::setw(8) << container.pid
+                  << std::setw(10) << format(stats.cpuUsageUsec, second) << std::setw(10)
+                  << format(stats.rss, mebibyte) << std::setw(12)
+                  << format(stats.ioReadBytes, mebibyte) << std::setw(12)
+                  << format(stats.ioWriteBytes, mebibyte)
+                  << (stats.pids ? std::to_string(*stats.pids) : "-") << std::endl;
+    }
+}
+
+} // namespace
+
 void Printer::printErr(const utils::error::Error &err)
 {
     std::cout << "Error: CODE=" << err.code() << std::endl
@@ -55,6 +92,13 @@ void Printer::printPackages(const std::vector<api::types::v1::PackageInfo> &list
 
 void Printer::printContainers(const std::vector<api::types::v1::CliContainer> &list)
 {
+    if (std::any_of(list.begin(), list.end(), [](const auto &container) {
+            return container.stats.has_value();
+        })) {
+        printContainerStats(list);
+        return;
+    }
+
     std::cout << "\033[38;5;214m" << std::left << std::setw(48) << qUtf8Printable("App")
               << std::setw(36) << qUtf8Printable("ContainerID") << std::setw(8)
               << qUtf8Printable("Pid") << qUtf8Printable("Path") << "\033[0m" << std::endl;
@@ -86,6 +130,19 @@ void Printer::printLayerInfo(const api::types::v1::LayerInfo &info)
     std::cout << info.info.dump(4) << std::endl;
 }
 
+void Printer::printLayerFiles(const std::vector<api::types::v1::LayerInfoFile> &files)
+{
+    for (const auto &file : files) {
+        std::cout << std::oct << std::setw(4) << std::setfill('0') << file.mode << std::dec
+                  << std::setfill(' ') << " " << std::right << std::setw(12) << file.size << " "
+                  << std::left << file.path;
+        if (file.target) {
+            std::cout << " -> " << *file.target;
+        }
+        std::cout << std::endl;
+    }
+}
+
 void Printer::printTaskStatus(const QString &percentage, const QString &message, int /*status*/)
 {
     std::cout << "\r\33[K"
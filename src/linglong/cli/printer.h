@@ -40,6 +40,7 @@ public:
     virtual void printReply(const api::types::v1::CommonResult &);
     virtual void printRepoConfig(const api::types::v1::RepoConfig &);
     virtual void printLayerInfo(const api::types::v1::LayerInfo &);
+    virtual void printLayerFiles(const std::vector<api::types::v1::LayerInfoFile> &);
     virtual void printTaskStatus(const QString &percentage, const QString &message, int status);
 };
 
@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/oci_cfg_generators/builtins.h"
+
+#include "linglong/oci_cfg_generators/devices.h"
+#include "linglong/oci_cfg_generators/host_ipc.h"
+#include "linglong/oci_cfg_generators/id_mapping.h"
+#include "linglong/oci_cfg_generators/initialize.h"
+#include "linglong/oci_cfg_generators/legacy.h"
+#include "linglong/oci_cfg_generators/user_home.h"
+
+namespace linglong::generator {
+
+namespace {
+
+template<typename... Generators>
+auto makeGenerators() -> std::map<std::string_view, std::unique_ptr<Generator>>
+{
+    std::map<std::string_view, std::unique_ptr<Generator>> generators;
+    (
+      [&generators]() {
+          auto generator = std::make_unique<Generators>();
+          auto name = generator->name();
+          generators.emplace(name, std::move(generator));
+      }(),
+      ...);
+    return generators;
+}
+
+} // namespace
+
+auto builtinGenerators() noexcept
+  -> const std::map<std::string_view, std::unique_ptr<Generator>> &
+{
+    static const auto generators =
+      makeGenerators<IDMapping, Initialize, Devices, UserHome, HostIPC, Legacy>();
+    return generators;
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_BUILTINS_H_
+#define LINGLONG_OCI_CFG_GENERATORS_BUILTINS_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+
+#include <map>
+#include <memory>
+
+namespace linglong::generator {
+
+// Generators shipped with linglong, indexed by their names.
+// They run in process instead of the executables with the same name in config.d.
+auto builtinGenerators() noexcept
+  -> const std::map<std::string_view, std::unique_ptr<Generator>> &;
+
+} // namespace linglong::generator
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/oci_cfg_generators/devices.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace linglong::generator {
+
+bool Devices::generate(nlohmann::json &config) const noexcept
+{
+    using namespace nlohmann::literals;
+
+    try {
+        if (config.at("ociVersion") != "1.0.1") {
+            std::cerr << "OCI version mismatched." << std::endl;
+            return false;
+        }
+
+        auto mounts = u8R"( [
+            {
+                "destination": "/run/udev",
+                "type": "bind",
+                "source": "/run/udev",
+                "options": [
+                        "rbind"
+                ]
+            },{
+                "destination": "/dev/dri",
+                "type": "bind",
+                "source": "/dev/dri",
+                "options": [
+                        "rbind"
+                ]
+            },{
+                "destination": "/dev/snd",
+                "type": "bind",
+                "source": "/dev/snd",
+                "options": [
+                        "rbind"
+                ]
+            }
+        ])"_json;
+
+        for (const auto &entry : std::filesystem::directory_iterator{ "/dev" }) {
+            const auto &devPath = entry.path();
+            auto devName = devPath.filename().string();
+            if ((devName.rfind("video", 0) == 0) || (devName.rfind("nvidia", 0) == 0)) {
+                auto dev = u8R"(
+                {
+                    "type": "bind",
+                    "options": [ "rbind" ]
+                })"_json;
+                dev["destination"] = devPath.string();
+                dev["source"] = devPath.string();
+
+                mounts.emplace_back(std::move(dev));
+            }
+        }
+
+        auto &configMounts = config["mounts"];
+        configMounts.insert(configMounts.end(), mounts.begin(), mounts.end());
+    } catch (const std::exception &exp) {
+        std::cerr << exp.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_DEVICES_H_
+#define LINGLONG_OCI_CFG_GENERATORS_DEVICES_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+
+namespace linglong::generator {
+
+// Pass through device nodes used by desktop applications.
+class Devices : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "20-devices"; }
+
+    [[nodiscard]] bool generate(nlohmann::json &config) const noexcept override;
+};
+
+} // namespace linglong::generator
+
+#endif
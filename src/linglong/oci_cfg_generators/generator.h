@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_GENERATOR_H_
+#define LINGLONG_OCI_CFG_GENERATORS_GENERATOR_H_
+
+#include "nlohmann/json.hpp"
+
+#include <string_view>
+
+namespace linglong::generator {
+
+// Generator modifies the constructing OCI configuration of a linglong
+// container in place.
+//
+// A generator should check everything it needs before touching the
+// configuration, so that a failed generator leaves it unchanged.
+// Error messages and warnings are printed to stderr.
+class Generator
+{
+public:
+    Generator() = default;
+    Generator(const Generator &) = delete;
+    Generator(Generator &&) = delete;
+    Generator &operator=(const Generator &) = delete;
+    Generator &operator=(Generator &&) = delete;
+    virtual ~Generator() = default;
+
+    // The file name of this generator in config.d
+    [[nodiscard]] virtual std::string_view name() const noexcept = 0;
+
+    [[nodiscard]] virtual bool generate(nlohmann::json &config) const noexcept = 0;
+};
+
+} // namespace linglong::generator
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_HOST_IPC_H_
+#define LINGLONG_OCI_CFG_GENERATORS_HOST_IPC_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+
+namespace linglong::generator {
+
+// Pass through D-Bus, X11, wayland and other IPC sockets of the host.
+class HostIPC : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "40-host-ipc"; }
+
+    [[nodiscard]] bool generate(nlohmann::json &config) const noexcept override;
+};
+
+} // namespace linglong::generator
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/oci_cfg_generators/id_mapping.h"
+
+#include <iostream>
+
+#include <unistd.h>
+
+namespace linglong::generator {
+
+bool IDMapping::generate(nlohmann::json &config) const noexcept
+{
+    try {
+        if (config.at("ociVersion") != "1.0.1") {
+            std::cerr << "OCI version mismatched." << std::endl;
+            return false;
+        }
+
+        config["linux"]["uidMappings"] = nlohmann::json::array({ nlohmann::json::object({
+          { "containerID", ::getuid() },
+          { "hostID", ::getuid() },
+          { "size", 1 },
+        }) });
+
+        config["linux"]["gidMappings"] = nlohmann::json::array({ nlohmann::json::object({
+          { "containerID", ::getgid() },
+          { "hostID", ::getgid() },
+          { "size", 1 },
+        }) });
+    } catch (const std::exception &exp) {
+        std::cerr << exp.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_ID_MAPPING_H_
+#define LINGLONG_OCI_CFG_GENERATORS_ID_MAPPING_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+
+namespace linglong::generator {
+
+// Map the current user into the user namespace of container.
+class IDMapping : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "00-id-mapping"; }
+
+    [[nodiscard]] bool generate(nlohmann::json &config) const noexcept override;
+};
+
+} // namespace linglong::generator
+
+#endif
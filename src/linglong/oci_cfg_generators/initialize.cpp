@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/oci_cfg_generators/initialize.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace linglong::generator {
+
+bool Initialize::generate(nlohmann::json &config) const noexcept
+{
+    try {
+        if (config.at("ociVersion") != "1.0.1") {
+            std::cerr << "OCI version mismatched." << std::endl;
+            return false;
+        }
+
+        const auto &annotations = config.at("annotations");
+        const std::string appID = annotations.at("org.deepin.linglong.appID");
+
+        auto mounts = nlohmann::json::array();
+
+        if (annotations.contains("org.deepin.linglong.runtimeDir")) {
+            mounts.push_back(
+              { { "destination", "/runtime" },
+                { "options", nlohmann::json::array({ "rbind", "ro" }) },
+                { "source",
+                  std::filesystem::path(
+                    annotations.at("org.deepin.linglong.runtimeDir").get<std::string>())
+                    / "files" },
+                { "type", "bind" } });
+        }
+
+        if (annotations.contains("org.deepin.linglong.appDir")) {
+            mounts.push_back({
+              { "destination", "/opt/apps/" },
+              { "options", nlohmann::json::array({ "nodev", "nosuid", "mode=700" }) },
+              { "source", "tmpfs" },
+              { "type", "tmpfs" },
+            });
+
+            mounts.push_back(
+              { { "destination", std::filesystem::path("/opt/apps") / appID / "files" },
+                { "options", nlohmann::json::array({ "rbind", "rw" }) },
+                { "source",
+                  std::filesystem::path(
+                    annotations.at("org.deepin.linglong.appDir").get<std::string>())
+                    / "files" },
+                { "type", "bind" } });
+        }
+
+        auto &configMounts = config["mounts"];
+        configMounts.insert(configMounts.end(), mounts.begin(), mounts.end());
+    } catch (const std::exception &exp) {
+        std::cerr << exp.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_INITIALIZE_H_
+#define LINGLONG_OCI_CFG_GENERATORS_INITIALIZE_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+
+namespace linglong::generator {
+
+// Mount runtime and application layers.
+class Initialize : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "05-initialize"; }
+
+    [[nodiscard]] bool generate(nlohmann::json &config) const noexcept override;
+};
+
+} // namespace linglong::generator
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/oci_cfg_generators/legacy.h"
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+
+namespace linglong::generator {
+
+bool Legacy::generate(nlohmann::json &config) const noexcept
+{
+    try {
+        if (config.at("ociVersion") != "1.0.1") {
+            std::cerr << "OCI version mismatched." << std::endl;
+            return false;
+        }
+
+        std::map<std::string, std::string> roMountMap{
+            { "/etc/resolv.conf", "/run/host/etc/resolv.conf" },
+            { "/etc/resolvconf", "/run/host/etc/resolvconf" },
+            { "/etc/localtime", "/run/host/etc/localtime" },
+            { "/etc/machine-id", "/run/host/etc/machine-id" },
+            { "/etc/machine-id", "/etc/machine-id" },
+            { "/etc/ssl/certs", "/run/host/etc/ssl/certs" },
+            { "/etc/ssl/certs", "/etc/ssl/certs" },
+            { "/var/cache/fontconfig", "/run/host/appearance/fonts-cache" },
+            { "/usr/share/fonts", "/usr/share/fonts" },
+            { "/usr/lib/locale/", "/usr/lib/locale/" },
+            { "/usr/share/themes", "/usr/share/themes" },
+            { "/usr/share/icons", "/usr/share/icons" },
+            { "/usr/share/zoneinfo", "/usr/share/zoneinfo" },
+        };
+
+        auto &mounts = config["mounts"];
+        for (const auto &[source, destination] : roMountMap) {
+            if (!std::filesystem::exists(source)) {
+                std::cerr << source << " not exists on host." << std::endl;
+                continue;
+            }
+
+            mounts.push_back({
+              { "type", "bind" },
+              { "options", nlohmann::json::array({ "ro", "rbind" }) },
+              { "destination", destination },
+              { "source", source },
+            });
+        }
+
+        // The fontconfig caches generated by the fc-cache of the base,
+        // applications would rescan the fonts if the caches of the host are incompatible.
+        // linglong runtime program annotates the directory of the caches if they exist.
+        const auto annotations = config.value("annotations", nlohmann::json::object());
+        if (annotations.contains("org.deepin.linglong.baseDir")
+            && annotations.contains("org.deepin.linglong.fontCacheDir")) {
+            const std::filesystem::path baseDir =
+              annotations.at("org.deepin.linglong.baseDir").get<std::string>();
+            const auto fontCacheDir =
+              annotations.at("org.deepin.linglong.fontCacheDir").get<std::string>();
+            if (std::filesystem::exists(baseDir / "files/var/cache/fontconfig")) {
+                mounts.push_back({
+                  { "type", "bind" },
+                  { "options", nlohmann::json::array({ "ro", "rbind" }) },
+                  { "destination", "/var/cache/fontconfig" },
+                  { "source", fontCacheDir },
+                });
+            }
+        }
+    } catch (const std::exception &exp) {
+        std::cerr << exp.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace linglong::generator
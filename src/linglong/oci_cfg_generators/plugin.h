@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_PLUGIN_H_
+#define LINGLONG_OCI_CFG_GENERATORS_PLUGIN_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+
+// ABI of OCI configuration generators built as shared objects.
+//
+// Files in config.d ending with ".so" are loaded by linglong runtime program,
+// which looks up the LinglongOCICfgGeneratorV1 exported as
+// LINGLONG_OCI_CFG_GENERATOR_SYMBOL and calls its generate function
+// with the constructing configuration.
+//
+// The configuration is passed as a nlohmann::json object, so a plugin must
+// be built with the same nlohmann_json version as linglong,
+// which is checked by jsonVersion.
+
+#define LINGLONG_OCI_CFG_GENERATOR_ABI_VERSION 1
+#define LINGLONG_OCI_CFG_GENERATOR_SYMBOL "linglong_oci_cfg_generator_v1"
+#define LINGLONG_OCI_CFG_GENERATOR_JSON_VERSION                                           \
+    (NLOHMANN_JSON_VERSION_MAJOR * 10000 + NLOHMANN_JSON_VERSION_MINOR * 100 /*NOLINT*/ \
+     + NLOHMANN_JSON_VERSION_PATCH)
+
+extern "C" {
+
+struct LinglongOCICfgGeneratorV1
+{
+    std::uint32_t abiVersion;
+    std::uint32_t jsonVersion;
+    // Return false if the generator failed.
+    bool (*generate)(nlohmann::json *config) noexcept;
+};
+}
+
+// Export a linglong::generator::Generator implementation from a shared object.
+#define LINGLONG_OCI_CFG_GENERATOR_EXPORT(GeneratorClass) /*NOLINT*/                \
+    extern "C" __attribute__((visibility("default")))                               \
+    const LinglongOCICfgGeneratorV1 linglong_oci_cfg_generator_v1 /*NOLINT*/ = {    \
+        LINGLONG_OCI_CFG_GENERATOR_ABI_VERSION,                                     \
+        LINGLONG_OCI_CFG_GENERATOR_JSON_VERSION,                                    \
+        [](nlohmann::json *config) noexcept -> bool {                               \
+            static const GeneratorClass generator;                                  \
+            return generator.generate(*config);                                     \
+        },                                                                          \
+    }
+
+#endif
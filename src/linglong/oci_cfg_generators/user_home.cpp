@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/oci_cfg_generators/user_home.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace linglong::generator {
+
+bool UserHome::generate(nlohmann::json &config) const noexcept
+{
+    try {
+        if (config.at("ociVersion") != "1.0.1") {
+            std::cerr << "OCI version mismatched." << std::endl;
+            return false;
+        }
+
+        const auto &annotations = config.at("annotations");
+        const std::string appID = annotations.at("org.deepin.linglong.appID");
+
+        auto *home = ::getenv("HOME"); // NOLINT
+        if (home == nullptr) {
+            std::cerr << "Couldn't get HOME." << std::endl;
+            return false;
+        }
+
+        auto homeDir = std::filesystem::path(home);
+        if (!std::filesystem::exists(homeDir)) {
+            std::cerr << "Home " << homeDir << "doesn't exists." << std::endl;
+            return false;
+        }
+
+        auto mounts = nlohmann::json::array();
+
+        mounts.push_back({
+          { "destination", "/home" },
+          { "options", nlohmann::json::array({ "nodev", "nosuid", "mode=700" }) },
+          { "source", "tmpfs" },
+          { "type", "tmpfs" },
+        });
+
+        auto PassthroughDir = [&mounts](const std::string &absolutePath, std::error_code &ec) {
+            std::filesystem::create_directories(absolutePath, ec);
+            if (ec) {
+                return;
+            }
+
+            mounts.push_back({
+              { "destination", absolutePath },
+              { "options", nlohmann::json::array({ "rbind" }) },
+              { "source", absolutePath },
+              { "type", "bind" },
+            });
+
+            ec.clear();
+        };
+
+        std::error_code ec;
+        PassthroughDir(homeDir.c_str(), ec);
+        if (ec) {
+            std::cerr << "Mount home failed:" << ec.message() << std::endl;
+            return false;
+        }
+
+        PassthroughDir(homeDir / ".deepinwine", ec);
+        if (ec) {
+            std::cerr << "Mount .deepinwine failed:" << ec.message() << std::endl;
+            return false;
+        }
+
+        auto appDataDir = std::filesystem::path(homeDir / ".linglong" / appID);
+        std::filesystem::create_directories(appDataDir, ec);
+        if (ec) {
+            std::cerr << "Check appDataDir failed:" << ec.message() << std::endl;
+            return false;
+        }
+
+        auto shadowDir =
+          [&mounts](const std::string &hostDir, const std::string &destDir, std::error_code &ec) {
+              std::filesystem::create_directories(hostDir, ec);
+              if (ec) {
+                  return;
+              }
+
+              std::filesystem::create_directories(destDir, ec);
+              if (ec) {
+                  return;
+              }
+
+              mounts.push_back({
+                { "destination", hostDir },
+                { "options", nlohmann::json::array({ "rbind" }) },
+                { "source", destDir },
+                { "type", "bind" },
+              });
+
+              ec.clear();
+          };
+
+        // process XDG_* environment variables.
+
+        // Data files should access by other application.
+        auto *ptr = ::getenv("XDG_DATA_HOME"); // NOLINT
+        auto XDGDataHome = ptr == nullptr ? "" : std::string{ ptr };
+        if (XDGDataHome.empty()) {
+            XDGDataHome = homeDir / ".local/share";
+        }
+        PassthroughDir(XDGDataHome, ec);
+        if (ec) {
+            std::cerr << "Failed to passthrough " << XDGDataHome << ec.message() << std::endl;
+            return false;
+        }
+
+        ptr = ::getenv("XDG_CONFIG_HOME"); // NOLINT
+        auto XDGConfigHome = ptr == nullptr ? "" : std::string{ ptr };
+        if (XDGConfigHome.empty()) {
+            XDGConfigHome = homeDir / ".config";
+        }
+
+        auto appConfigDir = appDataDir / "config";
+        shadowDir(XDGConfigHome, appConfigDir, ec);
+        if (ec) {
+            std::cerr << "Failed to shadow " << XDGConfigHome << ec.message() << std::endl;
+            return false;
+        }
+
+        ptr = ::getenv("XDG_CACHE_HOME"); // NOLINT
+        auto XDGCacheHome = ptr == nullptr ? "" : std::string{ ptr };
+        if (XDGCacheHome.empty()) {
+            XDGCacheHome = homeDir / ".cache";
+        }
+        shadowDir(XDGCacheHome, appDataDir / "cache", ec);
+        if (ec) {
+            std::cerr << "Failed to shadow " << XDGCacheHome << ec.message() << std::endl;
+            return false;
+        }
+
+        ptr = ::getenv("XDG_STATE_HOME"); // NOLINT
+        auto XDGStateHome = ptr == nullptr ? "" : std::string{ ptr };
+        if (XDGStateHome.empty()) {
+            XDGStateHome = homeDir / ".local/state";
+        }
+        shadowDir(XDGStateHome, appDataDir / "state", ec);
+        if (ec) {
+            std::cerr << "Failed to shadow " << XDGStateHome << ec.message() << std::endl;
+            return false;
+        }
+
+        // systemd user path
+        auto systemdUserDir = XDGConfigHome + "/systemd/user";
+        shadowDir(systemdUserDir, appDataDir / "config/systemd/user", ec);
+        if (ec) {
+            std::cerr << "Failed to shadow " << systemdUserDir << ec.message() << std::endl;
+            return false;
+        }
+
+        auto dconfPath = XDGConfigHome + "/dconf";
+        shadowDir(dconfPath, appDataDir / "config/dconf", ec);
+        if (ec) {
+            std::cerr << "Failed to shadow " << dconfPath << ec.message() << std::endl;
+            return false;
+        }
+
+        // for dde application theme
+        auto ddeApiPath = XDGCacheHome + "/deepin/dde-api";
+        PassthroughDir(ddeApiPath, ec);
+        if (ec) {
+            std::cerr << "Failed to passthrough " << ddeApiPath << ec.message() << std::endl;
+            return false;
+        }
+        shadowDir(ddeApiPath, appConfigDir / "deepin/dde-api", ec);
+        if (ec) {
+            std::cerr << "Failed to shadow " << ddeApiPath << ec.message() << std::endl;
+            return false;
+        }
+
+        // for xdg-user-dirs
+        if (auto userDirs = homeDir / ".config/user-dirs.dirs"; std::filesystem::exists(userDirs)) {
+            mounts.push_back({
+              { "destination", userDirs },
+              { "options", nlohmann::json::array({ "rbind" }) },
+              { "source", userDirs },
+              { "type", "bind" },
+            });
+        }
+
+        if (auto userLocale = homeDir / ".config/user-dirs.locale";
+            std::filesystem::exists(userLocale)) {
+            mounts.push_back({
+              { "destination", userLocale },
+              { "options", nlohmann::json::array({ "rbind" }) },
+              { "source", userLocale },
+              { "type", "bind" },
+            });
+        }
+
+        auto &configMounts = config["mounts"];
+        configMounts.insert(configMounts.end(), mounts.begin(), mounts.end());
+    } catch (const std::exception &exp) {
+        std::cerr << exp.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace linglong::generator
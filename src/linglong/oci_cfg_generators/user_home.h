@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_OCI_CFG_GENERATORS_USER_HOME_H_
+#define LINGLONG_OCI_CFG_GENERATORS_USER_HOME_H_
+
+#include "linglong/oci_cfg_generators/generator.h"
+
+namespace linglong::generator {
+
+// Mount home directory of the current user with per application XDG directories.
+class UserHome : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "30-user-home"; }
+
+    [[nodiscard]] bool generate(nlohmann::json &config) const noexcept override;
+};
+
+} // namespace linglong::generator
+
+#endif
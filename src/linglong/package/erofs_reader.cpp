@@ -0,0 +1,608 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/package/erofs_reader.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace linglong::package {
+
+namespace {
+
+// See include/erofs_fs.h of erofs-utils for the on-disk format.
+constexpr quint64 superBlockOffset = 1024;
+constexpr std::size_t superBlockSize = 128;
+constexpr quint32 superBlockMagic = 0xE0F5E1E2;
+constexpr auto slotSizeBits = 5;
+constexpr std::size_t compactInodeSize = 32;
+constexpr std::size_t extendedInodeSize = 64;
+constexpr std::size_t xattrHeaderSize = 12;
+constexpr std::size_t direntSize = 12;
+constexpr std::size_t mapHeaderSize = 8;
+constexpr std::size_t fullIndexSize = 8;
+// Data is read from uncompressed files in chunks of this size.
+constexpr quint64 chunkSize = 1024 * 1024;
+// LZ4 expands data at most 255 times, a block never decompresses to more than this.
+constexpr quint64 lz4MaxRatio = 255;
+
+constexpr quint8 layoutFlatPlain = 0;
+constexpr quint8 layoutCompressedFull = 1;
+constexpr quint8 layoutFlatInline = 2;
+constexpr quint8 layoutCompressedCompact = 3;
+
+constexpr quint32 featureZeroPadding = 0x1;
+// Either configurations of compression algorithms or big physical clusters,
+// the latter are rejected by the advice of each inode.
+constexpr quint32 featureComprCfgs = 0x2;
+constexpr quint32 featureComprHead2 = 0x8;
+constexpr quint32 supportedFeatures = featureZeroPadding | featureComprCfgs | featureComprHead2;
+
+constexpr quint16 adviseCompacted2B = 0x1;
+
+constexpr quint8 clusterPlain = 0;
+constexpr quint8 clusterHead1 = 1;
+constexpr quint8 clusterNonHead = 2;
+
+constexpr quint8 algorithmLz4 = 0;
+
+template<typename T>
+auto le(const char *data) noexcept -> T
+{
+    return qFromLittleEndian<T>(data);
+}
+
+// Decompress an LZ4 block until out is full, the input might have trailing garbage.
+auto lz4Decompress(const quint8 *in, std::size_t inSize, char *out, std::size_t outSize) noexcept
+  -> bool
+{
+    const auto *ip = in;
+    const auto *const end = in + inSize;
+    auto readLength = [&ip, end](std::size_t length) -> std::optional<std::size_t> {
+        if (length != 15) {
+            return length;
+        }
+        while (ip < end) {
+            const auto byte = *ip++;
+            length += byte;
+            if (byte != 255) {
+                return length;
+            }
+        }
+        return std::nullopt;
+    };
+
+    std::size_t op = 0;
+    while (op < outSize) {
+        if (ip >= end) {
+            return false;
+        }
+        const auto token = *ip++;
+
+        auto literals = readLength(token >> 4);
+        if (!literals || *literals > static_cast<std::size_t>(end - ip)) {
+            return false;
+        }
+        const auto copied = std::min(*literals, outSize - op);
+        std::memcpy(out + op, ip, copied);
+        op += copied;
+        ip += *literals;
+        if (op == outSize) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        const std::size_t distance = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (distance == 0 || distance > op) {
+            return false;
+        }
+
+        auto match = readLength(token & 15);
+        if (!match) {
+            return false;
+        }
+        const auto length = std::min(*match + 4, outSize - op);
+        // NOTE: The match might overlap the output, copy it byte by byte.
+        for (std::size_t i = 0; i < length; ++i, ++op) {
+            out[op] = out[op - distance];
+        }
+    }
+
+    return true;
+}
+
+// Value and type of an entry in a pack of compact indexes.
+auto decodeCompactBits(const char *pack, unsigned int bitPosition, unsigned int clusterBits,
+                       quint8 &type) noexcept -> quint32
+{
+    const auto value = le<quint32>(pack + bitPosition / 8) >> (bitPosition & 7);
+    type = (value >> clusterBits) & 3;
+    return value & ((1U << clusterBits) - 1);
+}
+
+struct ClusterIndex
+{
+    quint8 type = clusterNonHead;
+    quint32 clusterOffset = 0;
+    quint32 block = 0;
+};
+
+} // namespace
+
+auto ErofsReader::open(int fd, qint64 offset) noexcept -> utils::error::Result<ErofsReader>
+{
+    LINGLONG_TRACE("open EROFS image");
+
+    ErofsReader reader;
+    reader.fd = fd;
+    reader.offset = offset;
+
+    // NOTE: lseek works for block devices, whose st_size is 0.
+    const auto end = ::lseek(fd, 0, SEEK_END);
+    if (end == -1) {
+        return LINGLONG_ERR("lseek", errno);
+    }
+    if (offset < 0 || end < offset) {
+        return LINGLONG_ERR("offset is out of the file");
+    }
+    reader.imageSize = static_cast<quint64>(end - offset);
+
+    auto superBlock = reader.readAt(superBlockOffset, superBlockSize);
+    if (!superBlock) {
+        return LINGLONG_ERR(superBlock);
+    }
+    const auto *data = superBlock->constData();
+    if (le<quint32>(data) != superBlockMagic) {
+        return LINGLONG_ERR("invalid magic number");
+    }
+
+    reader.blockSizeBits = static_cast<quint8>(data[12]);
+    if (reader.blockSizeBits < 9 || reader.blockSizeBits > 16) {
+        return LINGLONG_ERR(QString("invalid block size bits %1").arg(reader.blockSizeBits));
+    }
+    reader.rootNid = le<quint16>(data + 14);
+    reader.metaBlockAddress = le<quint32>(data + 40);
+    reader.featureIncompat = le<quint32>(data + 80);
+    if ((reader.featureIncompat & ~supportedFeatures) != 0) {
+        const auto unsupported = reader.featureIncompat & ~supportedFeatures;
+        return LINGLONG_ERR(QString("unsupported features 0x%1").arg(unsupported, 0, 16), ENOTSUP);
+    }
+
+    return reader;
+}
+
+auto ErofsReader::root() const noexcept -> utils::error::Result<Inode>
+{
+    return this->inode(this->rootNid);
+}
+
+auto ErofsReader::inode(quint64 nid) const noexcept -> utils::error::Result<Inode>
+{
+    LINGLONG_TRACE(QString("read inode %1").arg(nid));
+
+    const auto position =
+      (static_cast<quint64>(this->metaBlockAddress) << this->blockSizeBits) + (nid << slotSizeBits);
+    auto raw = this->readAt(position, compactInodeSize);
+    if (!raw) {
+        return LINGLONG_ERR(raw);
+    }
+
+    const auto format = le<quint16>(raw->constData());
+    const bool extended = (format & 1) != 0;
+    auto inodeSize = compactInodeSize;
+    if (extended) {
+        inodeSize = extendedInodeSize;
+        raw = this->readAt(position, extendedInodeSize);
+        if (!raw) {
+            return LINGLONG_ERR(raw);
+        }
+    }
+    const auto *data = raw->constData();
+
+    Inode inode;
+    inode.nid = nid;
+    inode.layout = (format >> 1) & 0x7;
+    inode.mode = le<quint16>(data + 4);
+    inode.size = extended ? le<quint64>(data + 8) : le<quint32>(data + 8);
+    inode.rawBlockAddress = le<quint32>(data + 16);
+
+    const auto xattrCount = le<quint16>(data + 2);
+    const auto xattrSize = xattrCount == 0 ? 0 : xattrHeaderSize + (xattrCount - 1) * 4;
+    inode.tailPosition = position + inodeSize + xattrSize;
+
+    return inode;
+}
+
+auto ErofsReader::readDir(const Inode &dir) const noexcept
+  -> utils::error::Result<std::vector<DirEntry>>
+{
+    LINGLONG_TRACE(QString("read directory %1").arg(dir.nid));
+
+    if (!S_ISDIR(dir.mode)) {
+        return LINGLONG_ERR("not a directory");
+    }
+
+    auto content = this->readAll(dir);
+    if (!content) {
+        return LINGLONG_ERR(content);
+    }
+    if (static_cast<quint64>(content->size()) != dir.size) {
+        return LINGLONG_ERR("truncated directory");
+    }
+
+    std::vector<DirEntry> entries;
+    const quint64 blockSize = 1ULL << this->blockSizeBits;
+    for (quint64 start = 0; start < dir.size; start += blockSize) {
+        const auto *block = content->constData() + start;
+        const auto blockLength = static_cast<std::size_t>(std::min(blockSize, dir.size - start));
+        if (blockLength < direntSize) {
+            return LINGLONG_ERR("truncated directory block");
+        }
+
+        // Names follow the entries, the offset of the first name tells the number of entries.
+        const std::size_t count = le<quint16>(block + 8) / direntSize;
+        if (count == 0 || count * direntSize > blockLength) {
+            return LINGLONG_ERR("invalid directory block");
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto *dirent = block + i * direntSize;
+            const std::size_t nameOffset = le<quint16>(dirent + 8);
+            const std::size_t nameEnd =
+              i + 1 < count ? le<quint16>(dirent + direntSize + 8) : blockLength;
+            if (nameOffset >= nameEnd || nameEnd > blockLength) {
+                return LINGLONG_ERR("invalid name in directory block");
+            }
+
+            QByteArray name(block + nameOffset, static_cast<int>(nameEnd - nameOffset));
+            if (auto nul = name.indexOf('\0'); nul != -1) {
+                name.truncate(nul);
+            }
+            if (name == "." || name == "..") {
+                continue;
+            }
+
+            entries.push_back({ std::move(name), le<quint64>(dirent) });
+        }
+    }
+
+    return entries;
+}
+
+auto ErofsReader::read(const Inode &file, const Sink &sink) const noexcept
+  -> utils::error::Result<void>
+{
+    LINGLONG_TRACE(QString("read inode %1").arg(file.nid));
+
+    if (file.layout == layoutCompressedFull || file.layout == layoutCompressedCompact) {
+        auto result = this->readCompressed(file, sink);
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+        return LINGLONG_OK;
+    }
+
+    if (file.layout != layoutFlatPlain && file.layout != layoutFlatInline) {
+        return LINGLONG_ERR(QString("unsupported data layout %1").arg(file.layout), ENOTSUP);
+    }
+
+    // The last block of an inline file is stored right after the inode.
+    const quint64 blockSize = 1ULL << this->blockSizeBits;
+    const auto blocks = (file.size + blockSize - 1) >> this->blockSizeBits;
+    const auto plainSize = file.layout == layoutFlatInline && blocks > 0
+      ? (blocks - 1) << this->blockSizeBits
+      : file.size;
+
+    const auto start = static_cast<quint64>(file.rawBlockAddress) << this->blockSizeBits;
+    for (quint64 done = 0; done < plainSize;) {
+        auto data = this->readAt(start + done, std::min(chunkSize, plainSize - done));
+        if (!data) {
+            return LINGLONG_ERR(data);
+        }
+        auto result = sink(data->constData(), data->size());
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+        done += data->size();
+    }
+
+    if (plainSize < file.size) {
+        auto tail = this->readAt(file.tailPosition, file.size - plainSize);
+        if (!tail) {
+            return LINGLONG_ERR(tail);
+        }
+        auto result = sink(tail->constData(), tail->size());
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+    }
+
+    return LINGLONG_OK;
+}
+
+auto ErofsReader::readAll(const Inode &file) const noexcept -> utils::error::Result<QByteArray>
+{
+    LINGLONG_TRACE(QString("read all of inode %1").arg(file.nid));
+
+    if (file.size > static_cast<quint64>(std::numeric_limits<int>::max())) {
+        return LINGLONG_ERR(QString("inode is too large: %1 bytes").arg(file.size));
+    }
+
+    // NOTE: Compressed files might be larger than the image, do not trust the size.
+    QByteArray content;
+    content.reserve(static_cast<int>(std::min(file.size, this->imageSize)));
+    auto result = this->read(file,
+                             [&content](const char *data,
+                                        std::size_t size) -> utils::error::Result<void> {
+                                 content.append(data, static_cast<int>(size));
+                                 return LINGLONG_OK;
+                             });
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
+    return content;
+}
+
+auto ErofsReader::readCompressed(const Inode &file, const Sink &sink) const noexcept
+  -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("read compressed data");
+
+    const auto headerPosition = (file.tailPosition + 7) & ~7ULL;
+    auto header = this->readAt(headerPosition, mapHeaderSize);
+    if (!header) {
+        return LINGLONG_ERR(header);
+    }
+
+    const auto advise = le<quint16>(header->constData() + 4);
+    const auto algorithms = static_cast<quint8>(header->at(6));
+    const unsigned int clusterBits = this->blockSizeBits + (header->at(7) & 7);
+    if ((advise & ~adviseCompacted2B) != 0) {
+        return LINGLONG_ERR(QString("unsupported compression advise 0x%1").arg(advise, 0, 16),
+                            ENOTSUP);
+    }
+    // Logical clusters larger than a block come with big physical clusters.
+    if (clusterBits != this->blockSizeBits) {
+        return LINGLONG_ERR("unsupported logical cluster size", ENOTSUP);
+    }
+
+    const quint64 blockSize = 1ULL << this->blockSizeBits;
+    const auto clusters =
+      (file.size >> clusterBits) + ((file.size & (blockSize - 1)) != 0 ? 1 : 0);
+    if (clusters == 0) {
+        return LINGLONG_OK;
+    }
+    // Each logical cluster has an index of 2 bytes at least in the image.
+    if (clusters > this->imageSize / 2) {
+        return LINGLONG_ERR(QString("inode is too large: %1 bytes").arg(file.size));
+    }
+
+    // Indexes of all logical clusters are read at once.
+    QByteArray indexes;
+    quint64 indexesPosition = 0;
+    std::function<utils::error::Result<ClusterIndex>(quint64)> clusterIndex;
+
+    if (file.layout == layoutCompressedFull) {
+        indexesPosition = headerPosition + mapHeaderSize + 8;
+        auto data = this->readAt(indexesPosition, clusters * fullIndexSize);
+        if (!data) {
+            return LINGLONG_ERR(data);
+        }
+        indexes = std::move(*data);
+
+        clusterIndex = [&indexes](quint64 cluster) -> utils::error::Result<ClusterIndex> {
+            const auto *index = indexes.constData() + cluster * fullIndexSize;
+            return ClusterIndex{
+                .type = static_cast<quint8>(le<quint16>(index) & 3),
+                .clusterOffset = le<quint16>(index + 2),
+                .block = le<quint32>(index + 4),
+            };
+        };
+    } else {
+        // Compact indexes are 4 bytes each until aligned to 32 bytes, then 2 bytes each
+        // in packs of 16 if enabled, and 4 bytes each in packs of 2 for the rest.
+        const auto base = headerPosition + mapHeaderSize;
+        const quint64 initial4B = ((32 - base % 32) / 4) & 7;
+        quint64 compacted2B = 0;
+        if ((advise & adviseCompacted2B) != 0 && initial4B < clusters) {
+            if (clusterBits != 12) {
+                return LINGLONG_ERR("unsupported compact indexes", ENOTSUP);
+            }
+            compacted2B = (clusters - initial4B) / 16 * 16;
+        }
+
+        auto position = [base, initial4B, compacted2B](quint64 cluster) {
+            if (cluster < initial4B) {
+                return std::make_pair(base + cluster * 4, 2U);
+            }
+            cluster -= initial4B;
+            if (cluster < compacted2B) {
+                return std::make_pair(base + initial4B * 4 + cluster * 2, 1U);
+            }
+            cluster -= compacted2B;
+            return std::make_pair(base + initial4B * 4 + compacted2B * 2 + cluster * 4, 2U);
+        };
+
+        const auto [lastPosition, lastShift] = position(clusters - 1);
+        const auto lastPackSize = (lastShift == 2 ? 2U : 16U) << lastShift;
+        indexesPosition = base;
+        const auto indexesEnd = lastPosition - lastPosition % lastPackSize + lastPackSize;
+        auto data = this->readAt(base, indexesEnd - base);
+        if (!data) {
+            return LINGLONG_ERR(data);
+        }
+        indexes = std::move(*data);
+
+        clusterIndex = [&indexes, indexesPosition, position, clusterBits](
+                         quint64 cluster) -> utils::error::Result<ClusterIndex> {
+            LINGLONG_TRACE(QString("decode compact index of cluster %1").arg(cluster));
+
+            const auto [entryPosition, shift] = position(cluster);
+            const unsigned int count = shift == 2 ? 2 : 16;
+            const auto packSize = count << shift;
+            const auto packPosition = entryPosition - entryPosition % packSize;
+            if (packPosition < indexesPosition) {
+                return LINGLONG_ERR("misaligned compact indexes");
+            }
+            const auto *pack = indexes.constData() + (packPosition - indexesPosition);
+            const auto bits = (packSize - 4) * 8 / count;
+
+            // The physical block of a head is counted from the address at the end of the pack.
+            int i = static_cast<int>((entryPosition - packPosition) >> shift);
+            ClusterIndex index;
+            const auto value = decodeCompactBits(pack, bits * i, clusterBits, index.type);
+            if (index.type == clusterNonHead) {
+                return index;
+            }
+            index.clusterOffset = value;
+
+            quint32 blocks = 1;
+            while (i > 0) {
+                --i;
+                quint8 type = 0;
+                const auto delta = decodeCompactBits(pack, bits * i, clusterBits, type);
+                if (type == clusterNonHead) {
+                    i -= static_cast<int>(delta);
+                }
+                if (i >= 0) {
+                    ++blocks;
+                }
+            }
+            index.block = le<quint32>(pack + packSize - 4) + blocks;
+            return index;
+        };
+    }
+
+    // Every head of a logical cluster starts an extent, which ends at the next head.
+    std::vector<std::pair<quint64, ClusterIndex>> extents;
+    for (quint64 cluster = 0; cluster < clusters; ++cluster) {
+        auto index = clusterIndex(cluster);
+        if (!index) {
+            return LINGLONG_ERR(index);
+        }
+        if (index->type == clusterNonHead) {
+            continue;
+        }
+        if (index->clusterOffset >= blockSize) {
+            return LINGLONG_ERR(QString("invalid offset in logical cluster %1").arg(cluster));
+        }
+
+        const auto start = (cluster << clusterBits) + index->clusterOffset;
+        if (!extents.empty() && start <= extents.back().first) {
+            return LINGLONG_ERR(QString("extents are not increasing at %1").arg(start));
+        }
+        extents.emplace_back(start, *index);
+    }
+    if (extents.empty() || extents.front().first != 0) {
+        return LINGLONG_ERR("no head of the first logical cluster");
+    }
+
+    QByteArray decompressed;
+    for (std::size_t i = 0; i < extents.size(); ++i) {
+        const auto &[start, index] = extents[i];
+        if (start >= file.size) {
+            break;
+        }
+        const auto end = i + 1 < extents.size() ? std::min(extents[i + 1].first, file.size)
+                                                : file.size;
+        const auto length = end - start;
+
+        auto block = this->readAt(static_cast<quint64>(index.block) << this->blockSizeBits,
+                                  blockSize);
+        if (!block) {
+            return LINGLONG_ERR(block);
+        }
+
+        if (index.type == clusterPlain) {
+            if (length > blockSize) {
+                return LINGLONG_ERR("uncompressed extent is larger than a block");
+            }
+            auto result = sink(block->constData(), length);
+            if (!result) {
+                return LINGLONG_ERR(result);
+            }
+            continue;
+        }
+
+        // A physical cluster of one block might be decompressed to several logical clusters.
+        if (length > blockSize * lz4MaxRatio) {
+            return LINGLONG_ERR(QString("compressed extent at %1 is too large").arg(start));
+        }
+
+        const auto algorithm = index.type == clusterHead1 ? algorithms & 0xf : algorithms >> 4;
+        if (algorithm != algorithmLz4) {
+            return LINGLONG_ERR(QString("unsupported compression algorithm %1").arg(algorithm),
+                                ENOTSUP);
+        }
+
+        // Compressed data is aligned to the end of the block with zero padding.
+        const auto *in = reinterpret_cast<const quint8 *>(block->constData());
+        std::size_t inSize = blockSize;
+        if ((this->featureIncompat & featureZeroPadding) != 0) {
+            while (inSize > 0 && *in == 0) {
+                ++in;
+                --inSize;
+            }
+        }
+
+        decompressed.resize(static_cast<int>(length));
+        if (!lz4Decompress(in, inSize, decompressed.data(), length)) {
+            return LINGLONG_ERR(QString("corrupted LZ4 data at %1").arg(start));
+        }
+        auto result = sink(decompressed.constData(), length);
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+    }
+
+    return LINGLONG_OK;
+}
+
+auto ErofsReader::readAt(quint64 position, std::size_t size) const noexcept
+  -> utils::error::Result<QByteArray>
+{
+    LINGLONG_TRACE(QString("read %1 bytes at %2 of EROFS image").arg(size).arg(position));
+
+    if (size > static_cast<std::size_t>(std::numeric_limits<int>::max())
+        || position > this->imageSize || size > this->imageSize - position) {
+        return LINGLONG_ERR("out of the image");
+    }
+
+    QByteArray data(static_cast<int>(size), Qt::Uninitialized);
+    std::size_t done = 0;
+    while (done < size) {
+        auto ret = ::pread(this->fd,
+                           data.data() + done,
+                           size - done,
+                           static_cast<off_t>(this->offset + position + done));
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret == -1) {
+            return LINGLONG_ERR("pread", errno);
+        }
+        if (ret == 0) {
+            return LINGLONG_ERR("unexpected end of image");
+        }
+        done += ret;
+    }
+
+    return data;
+}
+
+} // namespace linglong::package
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_PACKAGE_EROFS_READER_H_
+#define LINGLONG_PACKAGE_EROFS_READER_H_
+
+#include "linglong/utils/error/error.h"
+
+#include <QByteArray>
+
+#include <functional>
+#include <vector>
+
+namespace linglong::package {
+
+// ErofsReader reads an EROFS image at an offset of a file without mounting it.
+//
+// It supports the layouts written by mkfs.erofs without extended options:
+// uncompressed files, and files compressed by LZ4 in clusters of one block
+// with full or compact indexes. Images using other features are reported
+// as errors with code ENOTSUP, the caller should fall back to mounting them.
+//
+// Images are not trusted, sizes and offsets are checked against the image
+// before reading, callers walking the tree should check the nesting with
+// maxDepth and reject directories visited twice.
+class ErofsReader
+{
+public:
+    // Directories nested deeper than this are rejected.
+    static constexpr int maxDepth = 512;
+
+    struct Inode
+    {
+        quint64 nid = 0;
+        quint32 mode = 0;
+        quint64 size = 0;
+        quint8 layout = 0;
+        quint32 rawBlockAddress = 0;
+        // Position after the inode and its extended attributes in the image.
+        quint64 tailPosition = 0;
+    };
+
+    struct DirEntry
+    {
+        QByteArray name;
+        quint64 nid = 0;
+    };
+
+    // Called with the data of a file in order, an error stops reading.
+    using Sink = std::function<utils::error::Result<void>(const char *data, std::size_t size)>;
+
+    static auto open(int fd, qint64 offset) noexcept -> utils::error::Result<ErofsReader>;
+
+    [[nodiscard]] auto root() const noexcept -> utils::error::Result<Inode>;
+    [[nodiscard]] auto inode(quint64 nid) const noexcept -> utils::error::Result<Inode>;
+
+    // Entries of a directory except "." and "..".
+    [[nodiscard]] auto readDir(const Inode &dir) const noexcept
+      -> utils::error::Result<std::vector<DirEntry>>;
+
+    [[nodiscard]] auto read(const Inode &file, const Sink &sink) const noexcept
+      -> utils::error::Result<void>;
+    [[nodiscard]] auto readAll(const Inode &file) const noexcept
+      -> utils::error::Result<QByteArray>;
+
+private:
+    ErofsReader() = default;
+
+    [[nodiscard]] auto readAt(quint64 position, std::size_t size) const noexcept
+      -> utils::error::Result<QByteArray>;
+    [[nodiscard]] auto readCompressed(const Inode &file, const Sink &sink) const noexcept
+      -> utils::error::Result<void>;
+
+    int fd = -1;
+    qint64 offset = 0;
+    // Size of the image after the offset.
+    quint64 imageSize = 0;
+    quint8 blockSizeBits = 0;
+    quint64 rootNid = 0;
+    quint32 metaBlockAddress = 0;
+    quint32 featureIncompat = 0;
+};
+
+} // namespace linglong::package
+
+#endif
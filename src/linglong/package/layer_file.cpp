@@ -7,10 +7,22 @@
 #include "linglong/package/layer_file.h"
 
 #include "linglong/api/types/v1/LayerInfo.hpp"
+#include "linglong/package/erofs_reader.h"
 #include "linglong/utils/serialize/json.h"
 
+#include <QCryptographicHash>
 #include <QDataStream>
 #include <QFileInfo>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_set>
+
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace linglong::package {
 
@@ -60,8 +72,24 @@ utils::error::Result<api::types::v1::LayerInfo> LayerFile::metaInfo() noexcept
     }
 
     auto rawData = this->read(qint64(*ret));
+    if (rawData.size() != qint64(*ret)) {
+        return LINGLONG_ERR("meta info is truncated");
+    }
+
+    auto content = utils::serialize::LoadJSON<json>(rawData);
+    if (!content) {
+        return LINGLONG_ERR(content);
+    }
 
-    auto layerInfo = utils::serialize::LoadJSON<api::types::v1::LayerInfo>(rawData);
+    // Layer files of version 1 written by older versions have only the package info.
+    if (!content->contains("info")) {
+        return api::types::v1::LayerInfo{
+            .info = std::move(*content),
+            .version = "1",
+        };
+    }
+
+    auto layerInfo = utils::serialize::LoadJSON<api::types::v1::LayerInfo>(*content);
     if (!layerInfo) {
         return LINGLONG_ERR(layerInfo);
     }
@@ -73,11 +101,14 @@ utils::error::Result<quint32> LayerFile::metaInfoLength()
 {
     LINGLONG_TRACE("read meta info length");
 
+    if (!this->seek(magicNumber.size())) {
+        return LINGLONG_ERR(*this);
+    }
+
     QDataStream layerDataStream(this);
 
     layerDataStream.startTransaction();
 
-    layerDataStream.skipRawData(magicNumber.size());
     quint32 metaInfoLength = 0;
     layerDataStream >> metaInfoLength;
 
@@ -100,6 +131,236 @@ utils::error::Result<quint32> LayerFile::binaryDataOffset() noexcept
     return magicNumber.size() + *size + sizeof(quint32);
 }
 
+utils::error::Result<void> LayerFile::verify() noexcept
+{
+    LINGLONG_TRACE("verify layer file " + this->fileName());
+
+    auto info = this->metaInfo();
+    if (!info) {
+        return LINGLONG_ERR(info);
+    }
+
+    if (!info->chunks) {
+        return LINGLONG_OK;
+    }
+    // The chunk size comes from the layer file, which might be crafted.
+    if (!info->chunkSize || *info->chunkSize < minChunkSize || *info->chunkSize > maxChunkSize) {
+        return LINGLONG_ERR("invalid chunk size");
+    }
+
+    auto offset = this->binaryDataOffset();
+    if (!offset) {
+        return LINGLONG_ERR(offset);
+    }
+
+    const auto size = this->size() - *offset;
+    if (size < 0) {
+        return LINGLONG_ERR("binary data is truncated");
+    }
+    const auto count =
+      static_cast<std::size_t>((size + *info->chunkSize - 1) / *info->chunkSize);
+    if (count != info->chunks->size()) {
+        return LINGLONG_ERR(
+          QString("layer file has %1 chunks, %2 expected").arg(count).arg(info->chunks->size()));
+    }
+
+    auto digests = digestChunks(this->handle(), *offset, *info->chunkSize);
+    if (!digests) {
+        return LINGLONG_ERR(digests);
+    }
+
+    if (digests->size() != info->chunks->size()) {
+        return LINGLONG_ERR(QString("layer file has %1 chunks, %2 expected")
+                              .arg(digests->size())
+                              .arg(info->chunks->size()));
+    }
+
+    QStringList corrupted;
+    for (std::size_t i = 0; i < digests->size(); ++i) {
+        if (digests->at(i) != info->chunks->at(i)) {
+            corrupted << QString::number(i);
+        }
+    }
+    if (!corrupted.isEmpty()) {
+        return LINGLONG_ERR("corrupted chunks: " + corrupted.join(", "));
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<std::vector<api::types::v1::LayerInfoFile>> LayerFile::files() noexcept
+{
+    LINGLONG_TRACE("list files of layer file " + this->fileName());
+
+    auto info = this->metaInfo();
+    if (!info) {
+        return LINGLONG_ERR(info);
+    }
+
+    if (info->files) {
+        return *info->files;
+    }
+
+    auto offset = this->binaryDataOffset();
+    if (!offset) {
+        return LINGLONG_ERR(offset);
+    }
+
+    auto files = listFiles(this->handle(), *offset);
+    if (!files) {
+        return LINGLONG_ERR(files);
+    }
+
+    return files;
+}
+
+utils::error::Result<std::vector<std::string>>
+LayerFile::digestChunks(int fd, qint64 offset, qint64 chunkSize) noexcept
+{
+    LINGLONG_TRACE("digest chunks");
+
+    if (chunkSize < minChunkSize || chunkSize > maxChunkSize) {
+        return LINGLONG_ERR(QString("invalid chunk size %1").arg(chunkSize));
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) == -1) {
+        return LINGLONG_ERR("stat", errno);
+    }
+    if (info.st_size < offset) {
+        return LINGLONG_ERR("binary data is truncated");
+    }
+
+    const auto size = info.st_size - offset;
+    const auto count = static_cast<std::size_t>((size + chunkSize - 1) / chunkSize);
+    std::vector<std::string> digests(count);
+
+    std::atomic<std::size_t> next = 0;
+    std::atomic<int> error = 0;
+    auto worker = [&]() {
+        std::vector<char> buffer(static_cast<std::size_t>(chunkSize));
+        for (auto i = next++; i < count && error == 0; i = next++) {
+            const auto start = static_cast<qint64>(i) * chunkSize;
+            const auto length = std::min(chunkSize, size - start);
+            for (qint64 done = 0; done < length;) {
+                const auto ret =
+                  ::pread(fd, buffer.data() + done, length - done, offset + start + done);
+                if (ret == -1 && errno == EINTR) {
+                    continue;
+                }
+                if (ret <= 0) {
+                    error = ret == 0 ? EIO : errno;
+                    return;
+                }
+                done += ret;
+            }
+
+            QCryptographicHash hash(QCryptographicHash::Sha256);
+            hash.addData(buffer.data(), static_cast<int>(length));
+            digests[i] = hash.result().toHex().toStdString();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const auto threadCount =
+      std::min<std::size_t>(count, std::max(QThread::idealThreadCount(), 1));
+    for (std::size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (error != 0) {
+        return LINGLONG_ERR("read binary data", error.load());
+    }
+
+    return digests;
+}
+
+utils::error::Result<std::vector<api::types::v1::LayerInfoFile>>
+LayerFile::listFiles(int fd, qint64 offset) noexcept
+{
+    LINGLONG_TRACE("list files in EROFS image");
+
+    auto reader = ErofsReader::open(fd, offset);
+    if (!reader) {
+        return LINGLONG_ERR(reader);
+    }
+
+    auto root = reader->root();
+    if (!root) {
+        return LINGLONG_ERR(root);
+    }
+
+    std::vector<api::types::v1::LayerInfoFile> files;
+    std::unordered_set<quint64> visitedDirs;
+    std::function<utils::error::Result<void>(const ErofsReader::Inode &, const std::string &, int)>
+      walk;
+    walk = [&](const ErofsReader::Inode &dir,
+               const std::string &prefix,
+               int depth) -> utils::error::Result<void> {
+        // A crafted image might link a directory into itself.
+        if (depth > ErofsReader::maxDepth) {
+            return LINGLONG_ERR("directories are nested too deep");
+        }
+        if (!visitedDirs.insert(dir.nid).second) {
+            return LINGLONG_ERR("directory is linked more than once");
+        }
+
+        auto entries = reader->readDir(dir);
+        if (!entries) {
+            return LINGLONG_ERR(entries);
+        }
+
+        for (const auto &entry : *entries) {
+            auto inode = reader->inode(entry.nid);
+            if (!inode) {
+                return LINGLONG_ERR(inode);
+            }
+
+            api::types::v1::LayerInfoFile file{
+                .mode = inode->mode & 07777,
+                .path = prefix + entry.name.toStdString(),
+                .size = 0,
+                .type = "other",
+            };
+            if (S_ISREG(inode->mode)) {
+                file.type = "file";
+                file.size = static_cast<int64_t>(inode->size);
+            } else if (S_ISLNK(inode->mode)) {
+                auto target = reader->readAll(*inode);
+                if (!target) {
+                    return LINGLONG_ERR(target);
+                }
+                file.type = "symlink";
+                file.size = static_cast<int64_t>(inode->size);
+                file.target = target->toStdString();
+            } else if (S_ISDIR(inode->mode)) {
+                file.type = "directory";
+            }
+            files.push_back(file);
+
+            if (S_ISDIR(inode->mode)) {
+                auto result = walk(*inode, file.path + "/", depth + 1);
+                if (!result) {
+                    return LINGLONG_ERR(result);
+                }
+            }
+        }
+
+        return LINGLONG_OK;
+    };
+
+    auto result = walk(*root, "", 0);
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
+    return files;
+}
+
 utils::error::Result<void> LayerFile::saveTo(const QString &destination) noexcept
 {
     LINGLONG_TRACE(QString("save layer file to %1").arg(destination));
@@ -12,6 +12,9 @@
 
 #include <QFile>
 
+#include <string>
+#include <vector>
+
 namespace linglong::package {
 
 const QByteArray magicNumber =
@@ -24,6 +27,11 @@ const QByteArray magicNumber =
 // meta info length  4                 40
 // meta info         meta info length  44
 // binary data                         44 + meta info length
+//
+// The meta info is a LayerInfo in JSON. Since version 2 it has the SHA-256 digests
+// of the chunks of the binary data and a table of contents, and it is padded by
+// spaces to align the binary data to 4096 bytes. Layer files of version 1 written
+// by older versions have a PackageInfo as meta info.
 class LayerFile : public QFile
 {
 public:
@@ -37,6 +45,12 @@ public:
 
     utils::error::Result<quint32> binaryDataOffset() noexcept;
 
+    // Check the digests of all chunks, layer files of version 1 have nothing to check.
+    utils::error::Result<void> verify() noexcept;
+
+    // Files in the binary data, read from the image if the meta info has no table of contents.
+    utils::error::Result<std::vector<api::types::v1::LayerInfoFile>> files() noexcept;
+
     utils::error::Result<void> saveTo(const QString &destination) noexcept;
 
     // NOTE: Maybe should be removed. and use QTemporaryFile
@@ -44,6 +58,21 @@ public:
 
     static utils::error::Result<QSharedPointer<LayerFile>> New(const QString &path) noexcept;
 
+    // Size of the chunks of the binary data written by LayerPackager.
+    static constexpr qint64 chunkSize = 4 * 1024 * 1024;
+    // Range of chunk sizes accepted from the meta info of layer files.
+    static constexpr qint64 minChunkSize = 4 * 1024;
+    static constexpr qint64 maxChunkSize = 64 * 1024 * 1024;
+
+    // SHA-256 digests of the chunks of the data from offset to the end of fd,
+    // the chunks are hashed in parallel.
+    static utils::error::Result<std::vector<std::string>>
+    digestChunks(int fd, qint64 offset, qint64 chunkSize) noexcept;
+
+    // Files in the EROFS image at offset of fd.
+    static utils::error::Result<std::vector<api::types::v1::LayerInfoFile>>
+    listFiles(int fd, qint64 offset) noexcept;
+
 private:
     explicit LayerFile(const QString &path);
     utils::error::Result<quint32> metaInfoLength();
@@ -8,11 +8,138 @@
 
 #include "linglong/api/types/v1/Generators.hpp"
 #include "linglong/utils/command/env.h"
+#include "linglong/utils/finally/finally.h"
 
 #include <QDataStream>
+#include <QProcess>
+#include <QThread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace linglong::package {
 
+namespace {
+
+constexpr int headerAlignment = 4096;
+
+auto alignUp(int size, int alignment) noexcept -> int
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Multithreaded compression is supported since erofs-utils 1.8.
+auto mkfsSupportsWorkers() noexcept -> bool
+{
+    static const bool supported = []() {
+        QProcess process;
+        process.setProcessChannelMode(QProcess::MergedChannels);
+        process.start("mkfs.erofs", { "--help" });
+        if (!process.waitForFinished()) {
+            return false;
+        }
+        return process.readAll().contains("--workers");
+    }();
+    return supported;
+}
+
+auto writeAll(int fd, const QByteArray &data) noexcept -> bool
+{
+    for (qint64 done = 0; done < data.size();) {
+        const auto written = ::pwrite(fd, data.constData() + done, data.size() - done, done);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += written;
+    }
+    return true;
+}
+
+// Put the header before the image in the layer file, and sync the file.
+auto insertHeader(const QString &layerFilePath, const QByteArray &header) noexcept
+  -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("insert header into " + layerFilePath);
+
+    const auto path = layerFilePath.toLocal8Bit();
+    const int fd = ::open(path.constData(), O_RDWR | O_CLOEXEC);
+    if (fd == -1) {
+        return LINGLONG_ERR("open", errno);
+    }
+    auto closeFd = utils::finally::finally([fd]() {
+        ::close(fd);
+    });
+
+    // Shift the extents of the image, no data is copied on ext4 and xfs.
+    if (::fallocate(fd, FALLOC_FL_INSERT_RANGE, 0, header.size()) == 0) {
+        if (!writeAll(fd, header)) {
+            return LINGLONG_ERR("write header", errno);
+        }
+        if (::fsync(fd) == -1) {
+            return LINGLONG_ERR("fsync", errno);
+        }
+        return LINGLONG_OK;
+    }
+    if (errno != EOPNOTSUPP && errno != EINVAL) {
+        return LINGLONG_ERR("insert range", errno);
+    }
+
+    // Otherwise copy the image after the header in the kernel,
+    // it shares the extents on file systems supporting reflinks.
+    const auto imagePath = path + ".erofs";
+    if (::rename(path.constData(), imagePath.constData()) == -1) {
+        return LINGLONG_ERR("rename image", errno);
+    }
+    auto removeImage = utils::finally::finally([&imagePath]() {
+        ::unlink(imagePath.constData());
+    });
+
+    const int out = ::open(path.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (out == -1) {
+        return LINGLONG_ERR("create", errno);
+    }
+    auto closeOut = utils::finally::finally([out]() {
+        ::close(out);
+    });
+
+    if (!writeAll(out, header)) {
+        return LINGLONG_ERR("write header", errno);
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) == -1) {
+        return LINGLONG_ERR("stat image", errno);
+    }
+
+    loff_t inOffset = 0;
+    loff_t outOffset = header.size();
+    while (inOffset < info.st_size) {
+        const auto copied =
+          ::copy_file_range(fd, &inOffset, out, &outOffset, info.st_size - inOffset, 0);
+        if (copied == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return LINGLONG_ERR("copy image", errno);
+        }
+        if (copied == 0) {
+            return LINGLONG_ERR("image is truncated");
+        }
+    }
+
+    if (::fsync(out) == -1) {
+        return LINGLONG_ERR("fsync", errno);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace
+
 LayerPackager::LayerPackager(const QDir &workDir)
     : workDir(workDir.absoluteFilePath(QUuid::createUuid().toString(QUuid::Id128)))
 {
@@ -26,12 +153,12 @@ LayerPackager::LayerPackager(const QDir &workDir)
 
 LayerPackager::~LayerPackager()
 {
-    for (const auto &info : this->workDir.entryInfoList()) {
-        if (!info.isDir()) {
-            continue;
+    for (const auto &info : this->workDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        auto ret = utils::command::Exec("umount", { info.absoluteFilePath() });
+        if (!ret) {
+            // Users are not permitted to umount their FUSE mounts by umount(8).
+            ret = utils::command::Exec("fusermount", { "-u", info.absoluteFilePath() });
         }
-
-        auto ret = utils::command::Exec("umount", { info.absolutePath() });
         if (!ret) {
             qCritical() << ret.error();
             Q_ASSERT(false);
@@ -46,66 +173,88 @@ LayerPackager::~LayerPackager()
     Q_ASSERT(false);
 }
 
+void LayerPackager::setCompressor(const QString &compressor) noexcept
+{
+    this->compressor = compressor;
+}
+
 utils::error::Result<QSharedPointer<LayerFile>>
 LayerPackager::pack(const LayerDir &dir, const QString &layerFilePath) const
 {
     LINGLONG_TRACE("pack layer");
 
-    QFile layer(layerFilePath);
-    if (!layer.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        return LINGLONG_ERR(layer);
-    }
-
-    if (layer.write(magicNumber) < 0) {
-        return LINGLONG_ERR(layer);
-    }
-
     auto info = dir.info();
     if (!info) {
         return LINGLONG_ERR(info);
     }
 
-    auto json = nlohmann::json(*info);
-    auto data = QByteArray::fromStdString(json.dump());
-
-    QByteArray dataSizeBytes;
-
-    QDataStream dataSizeStream(&dataSizeBytes, QIODevice::WriteOnly);
-    dataSizeStream.setVersion(QDataStream::Qt_5_10);
-    dataSizeStream << quint32(data.size());
-
-    Q_ASSERT(dataSizeStream.status() == QDataStream::Status::Ok);
-
-    if (layer.write(dataSizeBytes) < 0) {
-        return LINGLONG_ERR(layer);
+    if (QFile::exists(layerFilePath) && !QFile::remove(layerFilePath)) {
+        return LINGLONG_ERR("remove " + layerFilePath);
     }
 
-    if (layer.write(data) < 0) {
-        return LINGLONG_ERR(layer);
+    // mkfs.erofs writes the image to the layer file itself, the header is inserted later.
+    QStringList args{ "-z" + this->compressor };
+    if (mkfsSupportsWorkers()) {
+        args << QString("--workers=%1").arg(QThread::idealThreadCount());
     }
-
-    layer.close();
-
-    // compress data with erofs
-    const auto compressedFilePath = this->workDir.absoluteFilePath("tmp.erofs");
-
-    auto ret =
-      utils::command::Exec("mkfs.erofs", { "-zlz4hc,9", compressedFilePath, dir.absolutePath() });
+    args << layerFilePath << dir.absolutePath();
+    auto ret = utils::command::Exec("mkfs.erofs", args);
     if (!ret) {
         return LINGLONG_ERR(ret);
     }
 
-    ret = utils::command::Exec(
-      "sh",
-      { "-c", QString("cat %1 >> %2").arg(compressedFilePath, layerFilePath) });
-    if (!ret) {
-        LINGLONG_ERR(ret);
+    QFile image(layerFilePath);
+    if (!image.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(image);
+    }
+
+    auto chunks = LayerFile::digestChunks(image.handle(), 0, LayerFile::chunkSize);
+    if (!chunks) {
+        return LINGLONG_ERR(chunks);
+    }
+
+    // The list of files is optional, ErofsReader does not read all images mkfs.erofs writes.
+    std::optional<std::vector<api::types::v1::LayerInfoFile>> files;
+    if (auto listed = LayerFile::listFiles(image.handle(), 0); listed) {
+        files = std::move(*listed);
+    } else {
+        qWarning() << "write layer without the list of files:" << listed.error();
+    }
+    image.close();
+
+    const api::types::v1::LayerInfo layerInfo{
+        .chunkSize = LayerFile::chunkSize,
+        .chunks = std::move(*chunks),
+        .files = std::move(files),
+        .info = *info,
+        .version = "2",
+    };
+
+    auto data = QByteArray::fromStdString(nlohmann::json(layerInfo).dump());
+    // NOTE: The meta info is padded by spaces to align the image to a block,
+    // so the header can be inserted before the image without moving its data.
+    const auto headerSize = magicNumber.size() + int(sizeof(quint32)) + data.size();
+    data.append(QByteArray(alignUp(headerSize, headerAlignment) - headerSize, ' '));
+
+    QByteArray header = magicNumber;
+    QDataStream headerStream(&header, QIODevice::WriteOnly | QIODevice::Append);
+    headerStream.setVersion(QDataStream::Qt_5_10);
+    headerStream << quint32(data.size());
+    Q_ASSERT(headerStream.status() == QDataStream::Status::Ok);
+    header.append(data);
+
+    auto result = insertHeader(layerFilePath, header);
+    if (!result) {
+        QFile::remove(layerFilePath);
+        return LINGLONG_ERR(result);
     }
 
-    auto result = LayerFile::New(layerFilePath);
-    Q_ASSERT(result.has_value());
+    auto layerFile = LayerFile::New(layerFilePath);
+    if (!layerFile) {
+        return LINGLONG_ERR(layerFile);
+    }
 
-    return result;
+    return layerFile;
 }
 
 utils::error::Result<LayerDir> LayerPackager::unpack(LayerFile &file)
@@ -122,6 +271,22 @@ utils::error::Result<LayerDir> LayerPackager::unpack(LayerFile &file)
         return LINGLONG_ERR(offset);
     }
 
+    // Mounting the image by the kernel is much faster than erofsfuse,
+    // but only root is permitted to set up the loop device.
+    if (::geteuid() == 0) {
+        auto ret = utils::command::Exec("mount",
+                                        { "-t",
+                                          "erofs",
+                                          "-o",
+                                          QString("ro,loop,offset=%1").arg(*offset),
+                                          fileInfo.absoluteFilePath(),
+                                          unpackDir.absolutePath() });
+        if (ret) {
+            return unpackDir.absolutePath();
+        }
+        qDebug() << "fallback to erofsfuse:" << ret.error();
+    }
+
     auto ret = utils::command::Exec("erofsfuse",
                                     { QString("--offset=%1").arg(*offset),
                                       fileInfo.absoluteFilePath(),
@@ -24,12 +24,15 @@ public:
     LayerPackager &operator=(const LayerPackager &) = delete;
     LayerPackager &operator=(LayerPackager &&) = delete;
     ~LayerPackager() override;
+    // Compression of mkfs.erofs, e.g. "lz4hc,9", "lzma" or "zstd".
+    void setCompressor(const QString &compressor) noexcept;
     utils::error::Result<QSharedPointer<LayerFile>> pack(const LayerDir &dir,
                                                          const QString &layerFilePath) const;
     utils::error::Result<LayerDir> unpack(LayerFile &file);
 
 private:
     QDir workDir;
+    QString compressor = "lz4hc,9";
 };
 
 } // namespace linglong::package
@@ -10,6 +10,7 @@
 #include "linglong/api/types/v1/PackageManager1ModifyRepoParameters.hpp"
 #include "linglong/package/layer_file.h"
 #include "linglong/package/layer_packager.h"
+#include "linglong/runtime/font_cache.h"
 #include "linglong/utils/finally/finally.h"
 #include "linglong/utils/serialize/json.h"
 #include "linglong/utils/transaction.h"
@@ -18,11 +19,15 @@
 #include <QDBusReply>
 #include <QDBusUnixFileDescriptor>
 #include <QDebug>
+#include <QDirIterator>
 #include <QEventLoop>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QMetaObject>
 #include <QSettings>
 
+#include <cerrno>
+
 namespace linglong::service {
 
 namespace {
@@ -75,6 +80,108 @@ PackageManager::PackageManager(linglong::repo::OSTreeRepo &repo, QObject *parent
     : QObject(parent)
     , repo(repo)
 {
+    // Fonts are usually installed by a package manager of the host in batches,
+    // wait for it to finish before regenerating the font caches.
+    constexpr auto fontCacheDelay = 10 * 1000;
+    this->fontCacheTimer.setSingleShot(true);
+    this->fontCacheTimer.setInterval(fontCacheDelay);
+    connect(&this->fontCacheTimer, &QTimer::timeout, this, [this] {
+        this->updateFontCaches();
+    });
+
+    this->fontCacheWorker.moveToThread(&this->fontCacheThread);
+    this->fontCacheThread.start();
+
+    // NOTE: Fonts are usually installed in subdirectories, inotify does not watch them
+    // with their parent.
+    this->watchFontDirs();
+    connect(&this->fontDirsWatcher, &QFileSystemWatcher::directoryChanged, this, [this] {
+        this->watchFontDirs();
+        this->fontCacheTimer.start();
+    });
+
+    // Fonts might be changed while the package manager is not running.
+    this->fontCacheTimer.start();
+}
+
+PackageManager::~PackageManager()
+{
+    this->fontCacheThread.quit();
+    this->fontCacheThread.wait();
+}
+
+void PackageManager::watchFontDirs() noexcept
+{
+    const auto watched = this->fontDirsWatcher.directories();
+    QStringList dirs;
+    for (const auto &fontDir : runtime::FontCache::fontDirs()) {
+        if (!QFileInfo(fontDir).isDir()) {
+            continue;
+        }
+
+        dirs << fontDir;
+        QDirIterator it(fontDir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            dirs << it.next();
+        }
+    }
+
+    for (const auto &dir : dirs) {
+        if (!watched.contains(dir)) {
+            this->fontDirsWatcher.addPath(dir);
+        }
+    }
+}
+
+void PackageManager::generateFontCache(const QDir &baseDir) noexcept
+{
+    QMetaObject::invokeMethod(
+      &this->fontCacheWorker,
+      [baseDir] {
+          auto result = runtime::FontCache::generate(baseDir);
+          if (!result) {
+              qWarning() << result.error();
+          }
+      },
+      Qt::QueuedConnection);
+}
+
+void PackageManager::removeFontCache(const QDir &baseDir) noexcept
+{
+    QMetaObject::invokeMethod(
+      &this->fontCacheWorker,
+      [baseDir] {
+          runtime::FontCache::remove(baseDir);
+      },
+      Qt::QueuedConnection);
+}
+
+void PackageManager::updateFontCaches() noexcept
+{
+    auto pkgInfos = this->repo.listLocal();
+    if (!pkgInfos) {
+        qWarning() << pkgInfos.error();
+        return;
+    }
+
+    for (const auto &info : *pkgInfos) {
+        if (info.kind != "base") {
+            continue;
+        }
+
+        auto ref = package::Reference::fromPackageInfo(info);
+        if (!ref) {
+            qWarning() << ref.error();
+            continue;
+        }
+
+        auto layerDir = this->repo.getLayerDir(*ref);
+        if (!layerDir) {
+            continue;
+        }
+
+        this->generateFontCache(*layerDir);
+    }
 }
 
 auto PackageManager::getConfiguration() const noexcept -> QVariantMap
@@ -106,13 +213,30 @@ auto PackageManager::InstallLayer(const QDBusUnixFileDescriptor &fd) noexcept ->
     }
     Q_ASSERT(*layerFile != nullptr);
 
+    auto result = (*layerFile)->verify();
+    if (!result) {
+        return toDBusReply(result);
+    }
+
+    result = this->repo.importLayerFile(**layerFile);
+    if (result) {
+        return toDBusReply(0, "Install layer file success.");
+    }
+    // NOTE: The image may use EROFS features which are not supported by the reader,
+    // mount it and import the files instead. Other errors, such as a layer which is
+    // installed already or a corrupted image, are returned as they are.
+    if (result.error().code() != ENOTSUP) {
+        return toDBusReply(result);
+    }
+    qWarning() << "import layer file without mounting:" << result.error();
+
     package::LayerPackager layerPackager;
     auto layerDir = layerPackager.unpack(**layerFile);
     if (!layerDir) {
         return toDBusReply(layerDir);
     }
 
-    auto result = this->repo.importLayerDir(*layerDir);
+    result = this->repo.importLayerDir(*layerDir);
     if (!result) {
         return toDBusReply(result);
     }
@@ -120,6 +244,53 @@ auto PackageManager::InstallLayer(const QDBusUnixFileDescriptor &fd) noexcept ->
     return toDBusReply(0, "Install layer file success.");
 }
 
+auto PackageManager::InstallDelta(const QDBusUnixFileDescriptor &fd) noexcept -> QVariantMap
+{
+    auto result =
+      this->repo.importDelta(QString("/proc/self/fd/%1").arg(fd.fileDescriptor()));
+    if (!result) {
+        return toDBusReply(result);
+    }
+
+    return toDBusReply(0, "Install delta file success.");
+}
+
+auto PackageManager::InstallBundle(const QDBusUnixFileDescriptor &fd) noexcept -> QVariantMap
+{
+    auto refs = this->repo.importBundle(QString("/proc/self/fd/%1").arg(fd.fileDescriptor()));
+    if (!refs) {
+        return toDBusReply(refs);
+    }
+
+    QStringList installed;
+    for (const auto &ref : *refs) {
+        installed << ref.toString();
+
+        auto layerDir = this->repo.getLayerDir(ref);
+        if (!layerDir) {
+            qWarning() << layerDir.error();
+            continue;
+        }
+        auto info = layerDir->info();
+        if (!info) {
+            qWarning() << info.error();
+            continue;
+        }
+
+        if (info->kind == "app") {
+            this->repo.exportReference(ref);
+        } else if (info->kind == "base") {
+            this->generateFontCache(*layerDir);
+        }
+    }
+
+    if (installed.isEmpty()) {
+        return toDBusReply(0, "All layers in the bundle are installed already.");
+    }
+
+    return toDBusReply(0, "Install " + installed.join(", ") + " success.");
+}
+
 auto PackageManager::Install(const QVariantMap &parameters) noexcept -> QVariantMap
 {
     auto paras =
@@ -287,6 +458,10 @@ void PackageManager::Install(const std::shared_ptr<InstallTask> &taskContext,
         return;
     }
 
+    if (auto baseDir = this->repo.getLayerDir(*base); baseDir) {
+        this->generateFontCache(*baseDir);
+    }
+
     bool shouldExport = true;
 
     [&ref, this, &shouldExport]() {
@@ -358,12 +533,17 @@ auto PackageManager::Uninstall(const QVariantMap &parameters) noexcept -> QVaria
     }
 
     auto devel = paras->package.packageManager1PackageModule.value_or("runtime") == "devel";
+    auto layerDir = this->repo.getLayerDir(*ref, devel);
 
     auto result = this->repo.remove(*ref, devel);
     if (!result) {
         return toDBusReply(result);
     }
 
+    if (layerDir) {
+        this->removeFontCache(*layerDir);
+    }
+
     this->repo.unexportReference(*ref);
 
     return toDBusReply(0, "Uninstall " + ref->toString() + " success.");
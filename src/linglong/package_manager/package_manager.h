@@ -12,8 +12,11 @@
 
 #include <QDBusArgument>
 #include <QDBusContext>
+#include <QFileSystemWatcher>
 #include <QList>
 #include <QObject>
+#include <QThread>
+#include <QTimer>
 
 namespace linglong::service {
 
@@ -26,7 +29,7 @@ class PackageManager : public QObject, protected QDBusContext
 public:
     PackageManager(linglong::repo::OSTreeRepo &repo, QObject *parent);
 
-    ~PackageManager() override = default;
+    ~PackageManager() override;
     PackageManager(const PackageManager &) = delete;
     PackageManager(PackageManager &&) = delete;
     auto operator=(const PackageManager &) -> PackageManager & = delete;
@@ -44,6 +47,8 @@ public Q_SLOTS: // NOLINT
     virtual auto setConfiguration(const QVariantMap &parameters) noexcept -> QVariantMap;
     virtual auto Install(const QVariantMap &parameters) noexcept -> QVariantMap;
     virtual auto InstallLayer(const QDBusUnixFileDescriptor &fd) noexcept -> QVariantMap;
+    virtual auto InstallDelta(const QDBusUnixFileDescriptor &fd) noexcept -> QVariantMap;
+    virtual auto InstallBundle(const QDBusUnixFileDescriptor &fd) noexcept -> QVariantMap;
     virtual auto Uninstall(const QVariantMap &parameters) noexcept -> QVariantMap;
     virtual auto Update(const QVariantMap &parameters) noexcept -> QVariantMap;
     virtual auto Search(const QVariantMap &parameters) noexcept -> QVariantMap;
@@ -53,8 +58,21 @@ Q_SIGNALS:
     void TaskChanged(QString taskID, QString percentage, QString message, int status);
 
 private:
+    // Regenerate the font caches of the installed bases which are out of date.
+    void updateFontCaches() noexcept;
+    // Watch the directories of the host fonts, including the new subdirectories.
+    void watchFontDirs() noexcept;
+    // Font caches are generated and removed in order by a worker thread,
+    // scanning fonts takes a while and would block the D-Bus calls.
+    void generateFontCache(const QDir &baseDir) noexcept;
+    void removeFontCache(const QDir &baseDir) noexcept;
+
     linglong::repo::OSTreeRepo &repo; // NOLINT
     std::map<QString, std::shared_ptr<InstallTask>> taskMap;
+    QFileSystemWatcher fontDirsWatcher;
+    QTimer fontCacheTimer;
+    QThread fontCacheThread;
+    QObject fontCacheWorker;
 };
 
 } // namespace linglong::service
@@ -8,6 +8,7 @@
 
 #include "linglong/api/types/helper.h"
 #include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/package/erofs_reader.h"
 #include "linglong/package/fuzzy_reference.h"
 #include "linglong/package/layer_dir.h"
 #include "linglong/package/reference.h"
@@ -22,15 +23,31 @@
 #include <glib.h>
 #include <ostree-repo.h>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDeadlineTimer>
 #include <QDir>
 #include <QProcess>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <QUrl>
 #include <QtWebSockets/QWebSocket>
 
+#include <algorithm>
+#include <chrono>
 #include <complex>
 #include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include <fcntl.h>
+#include <unistd.h>
 
 namespace linglong::repo {
 
@@ -241,6 +258,9 @@ void progress_changed(OstreeAsyncProgress *progress, gpointer user_data)
     }
 }
 
+const QByteArray deltaMagicNumber =
+  QByteArray("<<< deepin linglong layer delta >>>").leftJustified(40, 0);
+
 QString ostreeSpecFromReference(const package::Reference &ref, bool devel = false) noexcept
 {
     if (devel) {
@@ -282,11 +302,13 @@ utils::error::Result<void> removeOstreeRef(OstreeRepo *repo, const char *ref) no
     return LINGLONG_OK;
 }
 
-utils::error::Result<void> commitDirToRepo(GFile *dir,
-                                           OstreeRepo *repo,
-                                           const char *refspec) noexcept
+using TreeWriter = std::function<utils::error::Result<void>(OstreeMutableTree *)>;
+
+// Commit the tree written by writeTree to the repository and point refspec to the commit.
+utils::error::Result<void> commitToRepo(OstreeRepo *repo,
+                                        const char *refspec,
+                                        const TreeWriter &writeTree) noexcept
 {
-    Q_ASSERT(dir != nullptr);
     Q_ASSERT(repo != nullptr);
 
     LINGLONG_TRACE("commit to ostree linglong repo");
@@ -295,18 +317,14 @@ utils::error::Result<void> commitDirToRepo(GFile *dir,
     if (ostree_repo_prepare_transaction(repo, NULL, NULL, &gErr) == FALSE) {
         return LINGLONG_ERR("ostree_repo_prepare_transaction", gErr);
     }
+    auto abort = utils::finally::finally([repo]() {
+        ostree_repo_abort_transaction(repo, nullptr, nullptr);
+    });
 
     g_autoptr(OstreeMutableTree) mtree = ostree_mutable_tree_new();
-    g_autoptr(OstreeRepoCommitModifier) modifier = nullptr;
-    modifier =
-      ostree_repo_commit_modifier_new(OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS,
-                                      nullptr,
-                                      nullptr,
-                                      nullptr);
-    Q_ASSERT(modifier != nullptr);
-
-    if (ostree_repo_write_directory_to_mtree(repo, dir, mtree, modifier, nullptr, &gErr) == FALSE) {
-        return LINGLONG_ERR("ostree_repo_write_directory_to_mtree", gErr);
+    auto result = writeTree(mtree);
+    if (!result) {
+        return LINGLONG_ERR(result);
     }
 
     g_autoptr(GFile) file = nullptr;
@@ -337,247 +355,905 @@ utils::error::Result<void> commitDirToRepo(GFile *dir,
     return LINGLONG_OK;
 }
 
-utils::error::Result<void> handleRepositoryUpdate(OstreeRepo *repo,
-                                                  QDir layerDir,
-                                                  const char *refspec) noexcept
+// Checksum of the root tree of rev committed again without parent, metadata and time,
+// which depends only on the files. Deltas between layers use these commits,
+// as the commits made by importing the same layer on two machines differ.
+// Nothing is written to the repository, see writeCanonicalCommit.
+utils::error::Result<QString> canonicalCommit(OstreeRepo *repo, const char *rev) noexcept
 {
-    LINGLONG_TRACE(QString("checkout %1 from ostree repository to layers dir").arg(refspec));
-
-    int root = open("/", O_DIRECTORY);
-    auto _ = utils::finally::finally([root]() {
-        close(root);
-    });
+    Q_ASSERT(repo != nullptr);
 
-    auto path = layerDir.absolutePath();
-    path = path.right(path.length() - 1);
+    LINGLONG_TRACE(QString("compute canonical commit of %1").arg(rev));
 
-    Q_ASSERT(layerDir.exists() == false);
-    if (!layerDir.mkpath(".")) {
-        Q_ASSERT(false);
+    g_autoptr(GError) gErr = nullptr;
+    g_autofree char *checksum = nullptr;
+    if (ostree_repo_resolve_rev(repo, rev, FALSE, &checksum, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_resolve_rev", gErr);
     }
-    if (!layerDir.removeRecursively()) {
-        Q_ASSERT(false);
+
+    g_autoptr(GVariant) commit = nullptr;
+    if (ostree_repo_load_commit(repo, checksum, &commit, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_load_commit", gErr);
+    }
+
+    // NOTE: Same as the commit ostree_repo_write_commit_with_time writes
+    // without parent, subject, body and metadata at time 0.
+    g_autoptr(GVariant) contents = g_variant_get_child_value(commit, 6);
+    g_autoptr(GVariant) metadata = g_variant_get_child_value(commit, 7);
+    g_autoptr(GVariant) canonical = g_variant_ref_sink(
+      g_variant_new("(@a{sv}@ay@a(say)sst@ay@ay)",
+                    g_variant_new_array(G_VARIANT_TYPE("{sv}"), nullptr, 0),
+                    g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, nullptr, 0, 1),
+                    g_variant_new_array(G_VARIANT_TYPE("(say)"), nullptr, 0),
+                    "",
+                    "",
+                    GUINT64_TO_BE(0),
+                    contents,
+                    metadata));
+    g_autoptr(GVariant) normal = g_variant_get_normal_form(canonical);
+    g_autofree char *canonicalChecksum =
+      g_compute_checksum_for_data(G_CHECKSUM_SHA256,
+                                  static_cast<const guchar *>(g_variant_get_data(normal)),
+                                  g_variant_get_size(normal));
+    return QString::fromUtf8(canonicalChecksum);
+}
+
+// Write the canonical commit of rev, which static deltas are generated from and applied to.
+// written is appended with the commit if it was not in the repository,
+// callers delete it by deleteCommits once the delta is done.
+utils::error::Result<QString> writeCanonicalCommit(OstreeRepo *repo,
+                                                   const char *rev,
+                                                   QStringList &written) noexcept
+{
+    Q_ASSERT(repo != nullptr);
+
+    LINGLONG_TRACE(QString("write canonical commit of %1").arg(rev));
+
+    auto expected = canonicalCommit(repo, rev);
+    if (!expected) {
+        return LINGLONG_ERR(expected);
     }
 
     g_autoptr(GError) gErr = nullptr;
+    gboolean exists = FALSE;
+    if (ostree_repo_has_object(repo,
+                               OSTREE_OBJECT_TYPE_COMMIT,
+                               expected->toUtf8().constData(),
+                               &exists,
+                               nullptr,
+                               &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_has_object", gErr);
+    }
+    if (exists == TRUE) {
+        return expected;
+    }
 
-    g_autofree char *commit;
+    g_autoptr(GFile) root = nullptr;
+    if (ostree_repo_read_commit(repo, rev, &root, nullptr, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_read_commit", gErr);
+    }
 
-    if (ostree_repo_resolve_rev(repo, refspec, FALSE, &commit, &gErr) == FALSE) {
-        return LINGLONG_ERR("ostree_repo_resolve_rev", gErr);
+    if (ostree_repo_prepare_transaction(repo, NULL, NULL, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_prepare_transaction", gErr);
     }
+    auto abort = utils::finally::finally([repo]() {
+        ostree_repo_abort_transaction(repo, nullptr, nullptr);
+    });
 
-    if (ostree_repo_checkout_at(repo, nullptr, root, path.toUtf8().constData(), commit, NULL, &gErr)
+    g_autofree char *commit = nullptr;
+    if (ostree_repo_write_commit_with_time(repo,
+                                           nullptr,
+                                           nullptr,
+                                           nullptr,
+                                           nullptr,
+                                           OSTREE_REPO_FILE(root),
+                                           0,
+                                           &commit,
+                                           nullptr,
+                                           &gErr)
         == FALSE) {
-        return LINGLONG_ERR("ostree_repo_checkout_at", gErr);
+        return LINGLONG_ERR("ostree_repo_write_commit_with_time", gErr);
     }
 
-    return LINGLONG_OK;
+    if (ostree_repo_commit_transaction(repo, NULL, NULL, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_commit_transaction", gErr);
+    }
+
+    written << QString::fromUtf8(commit);
+    if (written.last() != *expected) {
+        return LINGLONG_ERR("canonical commit " + written.last() + " differs from " + *expected);
+    }
+
+    return expected;
 }
 
-utils::error::Result<void> updateOstreeRepoConfig(OstreeRepo *repo,
-                                                  const QString &remoteName,
-                                                  const QString &url,
-                                                  QString parent = "") noexcept
+// Package info of the layer in the commit, read from its info.json.
+utils::error::Result<api::types::v1::PackageInfo> layerInfoOfCommit(OstreeRepo *repo,
+                                                                    const char *commit) noexcept
 {
-    LINGLONG_TRACE("update configuration");
+    Q_ASSERT(repo != nullptr);
 
-    g_autoptr(GVariant) options = NULL;
-    GVariantBuilder builder;
-    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
-    g_variant_builder_add(&builder, "{sv}", "gpg-verify", g_variant_new_boolean(FALSE));
-    // NOTE:
-    // libcurl 8.2.1 has a http2 bug https://github.com/curl/curl/issues/11859
-    // We disable http2 for now.
-    g_variant_builder_add(&builder, "{sv}", "http2", g_variant_new_boolean(FALSE));
-    options = g_variant_ref_sink(g_variant_builder_end(&builder));
+    LINGLONG_TRACE(QString("read package info of commit %1").arg(commit));
 
     g_autoptr(GError) gErr = nullptr;
-    if (ostree_repo_remote_change(repo,
-                                  nullptr,
-                                  OSTREE_REPO_REMOTE_CHANGE_REPLACE,
-                                  remoteName.toUtf8(),
-                                  (url + "/repos/" + remoteName).toUtf8(),
-                                  options,
-                                  nullptr,
-                                  &gErr)
-        == FALSE) {
-        return LINGLONG_ERR("ostree_repo_remote_change", gErr);
+    g_autoptr(GFile) root = nullptr;
+    if (ostree_repo_read_commit(repo, commit, &root, nullptr, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_read_commit", gErr);
     }
 
-    GKeyFile *configKeyFile = ostree_repo_get_config(repo);
-    Q_ASSERT(configKeyFile != nullptr);
-    QDir a;
-
-    g_key_file_set_string(configKeyFile, "core", "min-free-space-size", "600MB");
-    if (!parent.isEmpty()) {
-        QDir parentDir = parent;
-        Q_ASSERT(parentDir.exists());
-        g_key_file_set_string(configKeyFile, "core", "parent", parentDir.absolutePath().toUtf8());
+    g_autoptr(GFile) infoFile = g_file_resolve_relative_path(root, "info.json");
+    g_autofree char *content = nullptr;
+    gsize length = 0;
+    if (g_file_load_contents(infoFile, nullptr, &content, &length, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("g_file_load_contents", gErr);
     }
 
-    if (ostree_repo_write_config(repo, configKeyFile, &gErr) == FALSE) {
-        return LINGLONG_ERR("ostree_repo_write_config", gErr);
+    auto info = utils::serialize::LoadJSON<api::types::v1::PackageInfo>(
+      QByteArray(content, static_cast<int>(length)));
+    if (!info) {
+        return LINGLONG_ERR(info);
     }
 
-    return LINGLONG_OK;
+    return info;
 }
 
-utils::error::Result<OstreeRepo *> createOstreeRepo(const QDir &location,
-                                                    const QString &remoteName,
-                                                    const QString &url,
-                                                    const QString &parent = "") noexcept
+// Delete the commit objects, the objects of their trees are kept.
+void deleteCommits(OstreeRepo *repo, const QStringList &commits) noexcept
 {
-    LINGLONG_TRACE("create linglong repository at " + location.absolutePath());
-
-    if (!QFileInfo(location.absolutePath()).isWritable()) {
-        return LINGLONG_ERR("permission denied");
+    for (const auto &commit : commits) {
+        g_autoptr(GError) gErr = nullptr;
+        if (ostree_repo_delete_object(repo,
+                                      OSTREE_OBJECT_TYPE_COMMIT,
+                                      commit.toUtf8().constData(),
+                                      nullptr,
+                                      &gErr)
+            == FALSE) {
+            qWarning() << "delete commit" << commit << gErr->message;
+        }
     }
+}
 
-    g_autoptr(GError) gErr = nullptr;
-    g_autoptr(GFile) repoPath = nullptr;
-    g_autoptr(OstreeRepo) ostreeRepo = nullptr;
+// List all objects reachable from commit, in the "checksum.objtype" form of ostree.
+utils::error::Result<QStringList> listCommitObjects(OstreeRepo *repo,
+                                                    const QString &commit) noexcept
+{
+    Q_ASSERT(repo != nullptr);
 
-    repoPath = g_file_new_for_path(location.absolutePath().toUtf8());
-    ostreeRepo = ostree_repo_new(repoPath);
-    Q_ASSERT(ostreeRepo != nullptr);
-    if (ostree_repo_create(ostreeRepo, OSTREE_REPO_MODE_BARE_USER_ONLY, nullptr, &gErr) == FALSE) {
-        return LINGLONG_ERR("ostree_repo_create", gErr);
-    }
+    LINGLONG_TRACE("list objects of " + commit);
 
-    auto result = updateOstreeRepoConfig(ostreeRepo, remoteName, url, parent);
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(GHashTable) reachable = nullptr;
+    if (ostree_repo_traverse_commit(repo,
+                                    commit.toUtf8().constData(),
+                                    -1,
+                                    &reachable,
+                                    nullptr,
+                                    &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_traverse_commit", gErr);
+    }
 
-    if (!result) {
-        return LINGLONG_ERR(result);
+    QStringList objects;
+    GHashTableIter iter;
+    gpointer key = nullptr;
+    g_hash_table_iter_init(&iter, reachable);
+    while (g_hash_table_iter_next(&iter, &key, nullptr) != FALSE) {
+        const char *checksum = nullptr;
+        OstreeObjectType type{};
+        ostree_object_name_deserialize(static_cast<GVariant *>(key), &checksum, &type);
+        g_autofree char *name = ostree_object_to_string(checksum, type);
+        objects.push_back(QString::fromUtf8(name));
     }
+    objects.sort();
 
-    return g_steal_pointer(&ostreeRepo);
+    return objects;
 }
 
-utils::error::Result<package::Reference> clearReferenceLocal(const package::FuzzyReference &fuzzy,
-                                                             QDir layersDir) noexcept
+// Copy objects into a new archive repository in workDir and pack its objects directory to path.
+utils::error::Result<void> exportObjects(OstreeRepo *repo,
+                                         const QStringList &objects,
+                                         const QDir &workDir,
+                                         const QString &path) noexcept
 {
-    LINGLONG_TRACE("clear fuzzy reference locally");
+    Q_ASSERT(repo != nullptr);
 
-    auto arch = package::Architecture::parse(QSysInfo::currentCpuArchitecture());
-    if (fuzzy.arch) {
-        arch = *fuzzy.arch;
-    }
+    LINGLONG_TRACE(QString("export %1 objects to %2").arg(objects.size()).arg(path));
 
-    QString channel = "main";
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(GFile) repoPath = g_file_new_for_path(workDir.absoluteFilePath("repo").toLocal8Bit());
+    g_autoptr(OstreeRepo) objectsRepo = ostree_repo_new(repoPath);
+    if (ostree_repo_create(objectsRepo, OSTREE_REPO_MODE_ARCHIVE, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_create", gErr);
+    }
 
-    if (fuzzy.channel) {
-        channel = *fuzzy.channel;
+    if (ostree_repo_prepare_transaction(objectsRepo, nullptr, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_prepare_transaction", gErr);
     }
+    auto abort = utils::finally::finally([&objectsRepo]() {
+        ostree_repo_abort_transaction(objectsRepo, nullptr, nullptr);
+    });
 
-    QDir versionDir = layersDir.absoluteFilePath(channel + "/" + fuzzy.id);
-    if (!versionDir.exists() && channel == "main") {
-        // NOTE: fallback from main to linglong
-        channel = "linglong";
-        versionDir.setPath(layersDir.absoluteFilePath(channel + "/" + fuzzy.id));
+    for (const auto &object : objects) {
+        g_autofree char *checksum = nullptr;
+        OstreeObjectType type{};
+        ostree_object_from_string(object.toUtf8().constData(), &checksum, &type);
+        if (ostree_repo_import_object_from(objectsRepo, repo, type, checksum, nullptr, &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_import_object_from " + object, gErr);
+        }
     }
-    if (!versionDir.exists()) {
-        return LINGLONG_ERR("channel not found");
+
+    if (ostree_repo_commit_transaction(objectsRepo, nullptr, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_commit_transaction", gErr);
     }
 
-    utils::error::Result<package::Version> foundVersion =
-      LINGLONG_ERR("compatible version not found");
+    // Objects of archive repositories are compressed already.
+    auto ret = utils::command::Exec(
+      "tar",
+      { "-cf", path, "-C", workDir.absoluteFilePath("repo"), "objects" });
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
 
-    auto list = versionDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    return LINGLONG_OK;
+}
 
-    for (const auto &info : list) {
-        if (!info.isDir()) {
-            continue;
+// Extract the bundle at path to dir. Bundles come from users, so the members are checked
+// while they are passed to tar: only bundle.json and regular files and directories in repo/
+// are accepted, and the owners and permissions in the bundle are ignored.
+utils::error::Result<void> extractBundle(const QString &path, const QDir &dir) noexcept
+{
+    LINGLONG_TRACE("extract bundle " + path);
+
+    QFile bundle(path);
+    if (!bundle.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(bundle);
+    }
+
+    QProcess tar;
+    tar.start("tar",
+              { "--no-same-owner",
+                "--no-same-permissions",
+                "-xf",
+                "-",
+                "-C",
+                dir.absolutePath() });
+    if (!tar.waitForStarted()) {
+        return LINGLONG_ERR("start tar: " + tar.errorString());
+    }
+    auto killTar = utils::finally::finally([&tar]() {
+        if (tar.state() != QProcess::NotRunning) {
+            tar.kill();
+            tar.waitForFinished();
         }
+    });
 
-        auto availableVersion = package::Version::parse(info.fileName());
-        if (!availableVersion) {
-            qCritical() << "broken ostree based linglong repository detected"
-                        << info.absoluteFilePath() << availableVersion.error();
-            Q_ASSERT(false);
-            continue;
+    // NOTE: Wait for the data to be written, the bundle might be larger than the memory.
+    auto write = [&tar](const QByteArray &data) -> bool {
+        if (tar.write(data) != data.size()) {
+            return false;
         }
-
-        if (!availableVersion->tweak) {
-            qCritical() << "broken ostree based linglong repository detected"
-                        << info.absoluteFilePath() << "tweak missing.";
-            Q_ASSERT(false);
-            continue;
+        while (tar.bytesToWrite() > 0) {
+            if (!tar.waitForBytesWritten(-1)) {
+                return false;
+            }
         }
+        return true;
+    };
 
-        qDebug() << "available version found:" << availableVersion->toString();
-
-        if (!fuzzy.version) {
-            foundVersion = *availableVersion;
-            continue;
+    constexpr qint64 blockSize = 512;
+    constexpr qint64 maxLongNameSize = 4096;
+    QByteArray longName;
+    while (true) {
+        const auto header = bundle.read(blockSize);
+        if (header.size() != blockSize) {
+            return LINGLONG_ERR("bundle is truncated");
         }
 
-        if (fuzzy.version->tweak) {
-            if (*availableVersion != fuzzy.version) {
-                continue;
+        // The archive ends with blocks of zeros.
+        if (header.count('\0') == blockSize) {
+            if (!write(header) || !write(header)) {
+                return LINGLONG_ERR("write to tar: " + tar.errorString());
             }
+            break;
+        }
 
-            foundVersion = *availableVersion;
-            continue;
+        const auto type = header.at(156);
+        bool ok = false;
+        const auto size =
+          QByteArray(header.constData() + 124, 12).replace('\0', ' ').trimmed().toLongLong(&ok, 8);
+        if (!ok || size < 0) {
+            return LINGLONG_ERR("invalid size of member in bundle");
         }
+        const auto paddedSize = (size + blockSize - 1) / blockSize * blockSize;
 
-        auto versionWithoutTweak = *availableVersion;
-        versionWithoutTweak.tweak = std::nullopt;
-        if (versionWithoutTweak != *fuzzy.version) {
+        // Names longer than 100 bytes are stored in the data of a GNU long name member.
+        if (type == 'L') {
+            if (size > maxLongNameSize) {
+                return LINGLONG_ERR("name of member in bundle is too long");
+            }
+            const auto data = bundle.read(paddedSize);
+            if (data.size() != paddedSize) {
+                return LINGLONG_ERR("bundle is truncated");
+            }
+            longName = data.left(static_cast<int>(qstrnlen(data.constData(), size)));
+            if (!write(header) || !write(data)) {
+                return LINGLONG_ERR("write to tar: " + tar.errorString());
+            }
             continue;
         }
 
-        foundVersion = *availableVersion;
-    }
+        auto name = QString::fromUtf8(
+          longName.isEmpty() ? header.left(static_cast<int>(qstrnlen(header.constData(), 100)))
+                             : longName);
+        longName.clear();
+        if (name.endsWith('/')) {
+            name.chop(1);
+        }
 
-    if (!foundVersion) {
-        return LINGLONG_ERR(foundVersion);
-    }
+        const bool isFile = type == '0' || type == '\0';
+        const bool isDir = type == '5' && size == 0;
+        const auto components = name.split('/');
+        const bool inRepo = components.first() == "repo"
+          && !components.contains("..") && !components.contains(".") && !components.contains("");
+        if (!(name == "bundle.json" && isFile) && !(inRepo && (isFile || isDir))) {
+            return LINGLONG_ERR("unexpected member " + name + " in bundle");
+        }
 
-    auto ref = package::Reference::create(channel, fuzzy.id, *foundVersion, *arch);
-    if (!ref) {
-        Q_ASSERT(false);
-        return LINGLONG_ERR(ref);
+        if (!write(header)) {
+            return LINGLONG_ERR("write to tar: " + tar.errorString());
+        }
+        for (auto remaining = paddedSize; remaining > 0;) {
+            const auto chunk = bundle.read(std::min<qint64>(remaining, 1024 * 1024));
+            if (chunk.isEmpty()) {
+                return LINGLONG_ERR("bundle is truncated");
+            }
+            if (!write(chunk)) {
+                return LINGLONG_ERR("write to tar: " + tar.errorString());
+            }
+            remaining -= chunk.size();
+        }
     }
 
-    QDir layer = versionDir.absoluteFilePath(foundVersion->toString() + "/" + arch->toString());
-    if (!layer.exists()) {
-        return LINGLONG_ERR("cannot found layer " + ref->toString());
+    tar.closeWriteChannel();
+    if (!tar.waitForFinished(-1) || tar.exitStatus() != QProcess::NormalExit
+        || tar.exitCode() != 0) {
+        return LINGLONG_ERR("tar: " + QString::fromLocal8Bit(tar.readAllStandardError()));
     }
 
-    return ref;
+    return LINGLONG_OK;
 }
 
-utils::error::Result<package::Reference> clearReferenceRemote(const package::FuzzyReference &fuzzy,
-                                                              api::client::ClientApi &api,
-                                                              const QString &repoName) noexcept
+// Pull refs from the repository at path on the same machine, only missing objects are copied.
+utils::error::Result<void> pullLocal(OstreeRepo *repo,
+                                     const QString &path,
+                                     const std::vector<QByteArray> &refs,
+                                     OstreeRepoPullFlags flags) noexcept
 {
-    LINGLONG_TRACE("clear reference remotely");
+    Q_ASSERT(repo != nullptr);
 
-    api::client::Request_FuzzySearchReq req;
-    if (fuzzy.channel) {
-        req.setChannel(*fuzzy.channel);
-    }
+    LINGLONG_TRACE("pull from " + path);
 
-    req.setAppId(fuzzy.id);
-    if (fuzzy.version) {
-        req.setVersion(fuzzy.version->toString());
+    std::vector<const char *> refv;
+    for (const auto &ref : refs) {
+        refv.push_back(ref.constData());
     }
 
-    if (fuzzy.arch) {
-        req.setArch(fuzzy.arch->toString());
-    } else {
-        // NOTE: Server requires that arch is set, but why?
-        req.setArch(QSysInfo::currentCpuArchitecture());
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "refs",
+                          g_variant_new_strv(refv.data(), static_cast<gssize>(refv.size())));
+    g_variant_builder_add(&builder, "{sv}", "flags", g_variant_new_int32(flags));
+    g_autoptr(GVariant) options = g_variant_ref_sink(g_variant_builder_end(&builder));
+
+    const auto url = QUrl::fromLocalFile(path).toString().toUtf8();
+    g_autoptr(GError) gErr = nullptr;
+    if (ostree_repo_pull_with_options(repo, url.constData(), options, nullptr, nullptr, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_pull_with_options", gErr);
     }
 
-    req.setRepoName(repoName);
+    return LINGLONG_OK;
+}
 
-    utils::error::Result<package::Reference> ref = LINGLONG_ERR("unknown error");
+utils::error::Result<void> writeDirToMtree(GFile *dir,
+                                           OstreeRepo *repo,
+                                           OstreeMutableTree *mtree) noexcept
+{
+    Q_ASSERT(dir != nullptr);
 
-    QEventLoop loop;
-    const qint32 HTTP_OK = 200;
-    QEventLoop::connect(
+    LINGLONG_TRACE("write directory to ostree mutable tree");
+
+    g_autoptr(OstreeRepoCommitModifier) modifier = nullptr;
+    modifier =
+      ostree_repo_commit_modifier_new(OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS,
+                                      nullptr,
+                                      nullptr,
+                                      nullptr);
+    Q_ASSERT(modifier != nullptr);
+
+    g_autoptr(GError) gErr = nullptr;
+    if (ostree_repo_write_directory_to_mtree(repo, dir, mtree, modifier, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_write_directory_to_mtree", gErr);
+    }
+
+    return LINGLONG_OK;
+}
+
+// File information with the permissions canonicalized as
+// OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS does.
+GFileInfo *canonicalFileInfo(quint32 mode) noexcept
+{
+    auto *info = g_file_info_new();
+    g_file_info_set_attribute_uint32(info, "unix::uid", 0);
+    g_file_info_set_attribute_uint32(info, "unix::gid", 0);
+
+    if (S_ISDIR(mode)) {
+        g_file_info_set_file_type(info, G_FILE_TYPE_DIRECTORY);
+        mode = S_IFDIR | 0755;
+    } else if (S_ISREG(mode)) {
+        g_file_info_set_file_type(info, G_FILE_TYPE_REGULAR);
+        mode = S_IFREG | ((mode & S_IXUSR) != 0 ? 0755 : 0644);
+    } else if (S_ISLNK(mode)) {
+        g_file_info_set_file_type(info, G_FILE_TYPE_SYMBOLIC_LINK);
+    }
+    g_file_info_set_attribute_uint32(info, "unix::mode", mode);
+
+    return info;
+}
+
+// Writes the files of an EROFS image to an ostree mutable tree without mounting the image.
+class ErofsTreeWriter
+{
+public:
+    ErofsTreeWriter(OstreeRepo *repo, const package::ErofsReader &reader, QString tmpDir)
+        : repo(repo)
+        , reader(reader)
+        , tmpDir(std::move(tmpDir))
+    {
+    }
+
+    utils::error::Result<void> write(OstreeMutableTree *mtree) noexcept
+    {
+        LINGLONG_TRACE("write EROFS image to ostree mutable tree");
+
+        // All directories share the same metadata with canonical permissions.
+        g_autoptr(GFileInfo) info = canonicalFileInfo(S_IFDIR);
+        g_autoptr(GVariant) dirmeta = ostree_create_directory_metadata(info, nullptr);
+        g_autofree guchar *csum = nullptr;
+        g_autoptr(GError) gErr = nullptr;
+        if (ostree_repo_write_metadata(this->repo,
+                                       OSTREE_OBJECT_TYPE_DIR_META,
+                                       nullptr,
+                                       dirmeta,
+                                       &csum,
+                                       nullptr,
+                                       &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_write_metadata", gErr);
+        }
+        g_autofree char *checksum = ostree_checksum_from_bytes(csum);
+        this->dirMetaChecksum = checksum;
+
+        auto root = this->reader.root();
+        if (!root) {
+            return LINGLONG_ERR(root);
+        }
+
+        auto result = this->writeDir(*root, mtree, 0);
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+
+        return LINGLONG_OK;
+    }
+
+private:
+    // Files larger than this are written to a temporary file instead of memory.
+    static constexpr quint64 inMemoryLimit = 16 * 1024 * 1024;
+
+    utils::error::Result<void> writeDir(const package::ErofsReader::Inode &dir,
+                                        OstreeMutableTree *mtree,
+                                        int depth) noexcept
+    {
+        LINGLONG_TRACE(QString("write directory %1").arg(dir.nid));
+
+        // A crafted image might link a directory into itself.
+        if (depth > package::ErofsReader::maxDepth) {
+            return LINGLONG_ERR("directories are nested too deep");
+        }
+        if (!this->visitedDirs.insert(dir.nid).second) {
+            return LINGLONG_ERR("directory is linked more than once");
+        }
+
+        ostree_mutable_tree_set_metadata_checksum(mtree, this->dirMetaChecksum.c_str());
+
+        auto entries = this->reader.readDir(dir);
+        if (!entries) {
+            return LINGLONG_ERR(entries);
+        }
+
+        g_autoptr(GError) gErr = nullptr;
+        for (const auto &entry : *entries) {
+            auto inode = this->reader.inode(entry.nid);
+            if (!inode) {
+                return LINGLONG_ERR(inode);
+            }
+
+            if (S_ISDIR(inode->mode)) {
+                g_autoptr(OstreeMutableTree) subdir = nullptr;
+                if (ostree_mutable_tree_ensure_dir(mtree, entry.name.constData(), &subdir, &gErr)
+                    == FALSE) {
+                    return LINGLONG_ERR("ostree_mutable_tree_ensure_dir", gErr);
+                }
+
+                auto result = this->writeDir(*inode, subdir, depth + 1);
+                if (!result) {
+                    return LINGLONG_ERR(result);
+                }
+                continue;
+            }
+
+            auto checksum = this->writeFile(*inode);
+            if (!checksum) {
+                return LINGLONG_ERR(checksum);
+            }
+
+            if (ostree_mutable_tree_replace_file(mtree,
+                                                 entry.name.constData(),
+                                                 checksum->c_str(),
+                                                 &gErr)
+                == FALSE) {
+                return LINGLONG_ERR("ostree_mutable_tree_replace_file", gErr);
+            }
+        }
+
+        return LINGLONG_OK;
+    }
+
+    utils::error::Result<std::string> writeFile(const package::ErofsReader::Inode &file) noexcept
+    {
+        LINGLONG_TRACE(QString("write file %1").arg(file.nid));
+
+        // Hard links are decompressed only once.
+        if (auto it = this->written.find(file.nid); it != this->written.end()) {
+            return it->second;
+        }
+
+        g_autoptr(GFileInfo) info = canonicalFileInfo(file.mode);
+        g_autoptr(GInputStream) input = nullptr;
+        QByteArray content;
+        QTemporaryFile spill(this->tmpDir + "/linglong-layer-XXXXXX");
+
+        if (S_ISLNK(file.mode)) {
+            auto target = this->reader.readAll(file);
+            if (!target) {
+                return LINGLONG_ERR(target);
+            }
+            g_file_info_set_symlink_target(info, target->constData());
+        } else if (S_ISREG(file.mode) && file.size <= inMemoryLimit) {
+            auto data = this->reader.readAll(file);
+            if (!data) {
+                return LINGLONG_ERR(data);
+            }
+            content = std::move(*data);
+            g_file_info_set_size(info, content.size());
+            input =
+              g_memory_input_stream_new_from_data(content.constData(), content.size(), nullptr);
+        } else if (S_ISREG(file.mode)) {
+            if (!spill.open()) {
+                return LINGLONG_ERR(spill);
+            }
+            auto result = this->reader.read(
+              file,
+              [&spill](const char *data, std::size_t size) -> utils::error::Result<void> {
+                  LINGLONG_TRACE("write temporary file");
+                  if (spill.write(data, static_cast<qint64>(size)) != static_cast<qint64>(size)) {
+                      return LINGLONG_ERR(spill);
+                  }
+                  return LINGLONG_OK;
+              });
+            if (!result) {
+                return LINGLONG_ERR(result);
+            }
+            if (!spill.flush()) {
+                return LINGLONG_ERR(spill);
+            }
+            g_file_info_set_size(info, spill.size());
+
+            g_autoptr(GFile) spillFile = g_file_new_for_path(spill.fileName().toUtf8().constData());
+            g_autoptr(GError) gErr = nullptr;
+            input = G_INPUT_STREAM(g_file_read(spillFile, nullptr, &gErr));
+            if (input == nullptr) {
+                return LINGLONG_ERR("g_file_read", gErr);
+            }
+        } else {
+            // NOTE: ostree does not store device nodes, FIFOs and sockets.
+            return LINGLONG_ERR(QString("unsupported file type %1").arg(file.mode & S_IFMT, 0, 8));
+        }
+
+        g_autoptr(GError) gErr = nullptr;
+        g_autoptr(GInputStream) objectInput = nullptr;
+        guint64 length = 0;
+        if (ostree_raw_file_to_content_stream(input,
+                                              info,
+                                              nullptr,
+                                              &objectInput,
+                                              &length,
+                                              nullptr,
+                                              &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_raw_file_to_content_stream", gErr);
+        }
+
+        g_autofree guchar *csum = nullptr;
+        if (ostree_repo_write_content(this->repo,
+                                      nullptr,
+                                      objectInput,
+                                      length,
+                                      &csum,
+                                      nullptr,
+                                      &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_write_content", gErr);
+        }
+
+        g_autofree char *checksum = ostree_checksum_from_bytes(csum);
+        return this->written.emplace(file.nid, checksum).first->second;
+    }
+
+    OstreeRepo *repo;
+    const package::ErofsReader &reader;
+    QString tmpDir;
+    std::string dirMetaChecksum;
+    std::unordered_map<quint64, std::string> written;
+    std::unordered_set<quint64> visitedDirs;
+};
+
+utils::error::Result<void> handleRepositoryUpdate(OstreeRepo *repo,
+                                                  QDir layerDir,
+                                                  const char *refspec) noexcept
+{
+    LINGLONG_TRACE(QString("checkout %1 from ostree repository to layers dir").arg(refspec));
+
+    int root = open("/", O_DIRECTORY);
+    auto _ = utils::finally::finally([root]() {
+        close(root);
+    });
+
+    auto path = layerDir.absolutePath();
+    path = path.right(path.length() - 1);
+
+    Q_ASSERT(layerDir.exists() == false);
+    if (!layerDir.mkpath(".")) {
+        Q_ASSERT(false);
+    }
+    if (!layerDir.removeRecursively()) {
+        Q_ASSERT(false);
+    }
+
+    g_autoptr(GError) gErr = nullptr;
+
+    g_autofree char *commit;
+
+    if (ostree_repo_resolve_rev(repo, refspec, FALSE, &commit, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_resolve_rev", gErr);
+    }
+
+    if (ostree_repo_checkout_at(repo, nullptr, root, path.toUtf8().constData(), commit, NULL, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_checkout_at", gErr);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> updateOstreeRepoConfig(OstreeRepo *repo,
+                                                  const QString &remoteName,
+                                                  const QString &url,
+                                                  QString parent = "") noexcept
+{
+    LINGLONG_TRACE("update configuration");
+
+    g_autoptr(GVariant) options = NULL;
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&builder, "{sv}", "gpg-verify", g_variant_new_boolean(FALSE));
+    // NOTE:
+    // libcurl 8.2.1 has a http2 bug https://github.com/curl/curl/issues/11859
+    // We disable http2 for now.
+    g_variant_builder_add(&builder, "{sv}", "http2", g_variant_new_boolean(FALSE));
+    options = g_variant_ref_sink(g_variant_builder_end(&builder));
+
+    g_autoptr(GError) gErr = nullptr;
+    if (ostree_repo_remote_change(repo,
+                                  nullptr,
+                                  OSTREE_REPO_REMOTE_CHANGE_REPLACE,
+                                  remoteName.toUtf8(),
+                                  (url + "/repos/" + remoteName).toUtf8(),
+                                  options,
+                                  nullptr,
+                                  &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_remote_change", gErr);
+    }
+
+    GKeyFile *configKeyFile = ostree_repo_get_config(repo);
+    Q_ASSERT(configKeyFile != nullptr);
+    QDir a;
+
+    g_key_file_set_string(configKeyFile, "core", "min-free-space-size", "600MB");
+    if (!parent.isEmpty()) {
+        QDir parentDir = parent;
+        Q_ASSERT(parentDir.exists());
+        g_key_file_set_string(configKeyFile, "core", "parent", parentDir.absolutePath().toUtf8());
+    }
+
+    if (ostree_repo_write_config(repo, configKeyFile, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_write_config", gErr);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<OstreeRepo *> createOstreeRepo(const QDir &location,
+                                                    const QString &remoteName,
+                                                    const QString &url,
+                                                    const QString &parent = "") noexcept
+{
+    LINGLONG_TRACE("create linglong repository at " + location.absolutePath());
+
+    if (!QFileInfo(location.absolutePath()).isWritable()) {
+        return LINGLONG_ERR("permission denied");
+    }
+
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(GFile) repoPath = nullptr;
+    g_autoptr(OstreeRepo) ostreeRepo = nullptr;
+
+    repoPath = g_file_new_for_path(location.absolutePath().toUtf8());
+    ostreeRepo = ostree_repo_new(repoPath);
+    Q_ASSERT(ostreeRepo != nullptr);
+    if (ostree_repo_create(ostreeRepo, OSTREE_REPO_MODE_BARE_USER_ONLY, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_create", gErr);
+    }
+
+    auto result = updateOstreeRepoConfig(ostreeRepo, remoteName, url, parent);
+
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
+    return g_steal_pointer(&ostreeRepo);
+}
+
+utils::error::Result<package::Reference> clearReferenceLocal(const package::FuzzyReference &fuzzy,
+                                                             QDir layersDir) noexcept
+{
+    LINGLONG_TRACE("clear fuzzy reference locally");
+
+    auto arch = package::Architecture::parse(QSysInfo::currentCpuArchitecture());
+    if (fuzzy.arch) {
+        arch = *fuzzy.arch;
+    }
+
+    QString channel = "main";
+
+    if (fuzzy.channel) {
+        channel = *fuzzy.channel;
+    }
+
+    QDir versionDir = layersDir.absoluteFilePath(channel + "/" + fuzzy.id);
+    if (!versionDir.exists() && channel == "main") {
+        // NOTE: fallback from main to linglong
+        channel = "linglong";
+        versionDir.setPath(layersDir.absoluteFilePath(channel + "/" + fuzzy.id));
+    }
+    if (!versionDir.exists()) {
+        return LINGLONG_ERR("channel not found");
+    }
+
+    utils::error::Result<package::Version> foundVersion =
+      LINGLONG_ERR("compatible version not found");
+
+    auto list = versionDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+    for (const auto &info : list) {
+        if (!info.isDir()) {
+            continue;
+        }
+
+        auto availableVersion = package::Version::parse(info.fileName());
+        if (!availableVersion) {
+            qCritical() << "broken ostree based linglong repository detected"
+                        << info.absoluteFilePath() << availableVersion.error();
+            Q_ASSERT(false);
+            continue;
+        }
+
+        if (!availableVersion->tweak) {
+            qCritical() << "broken ostree based linglong repository detected"
+                        << info.absoluteFilePath() << "tweak missing.";
+            Q_ASSERT(false);
+            continue;
+        }
+
+        qDebug() << "available version found:" << availableVersion->toString();
+
+        if (!fuzzy.version) {
+            foundVersion = *availableVersion;
+            continue;
+        }
+
+        if (fuzzy.version->tweak) {
+            if (*availableVersion != fuzzy.version) {
+                continue;
+            }
+
+            foundVersion = *availableVersion;
+            continue;
+        }
+
+        auto versionWithoutTweak = *availableVersion;
+        versionWithoutTweak.tweak = std::nullopt;
+        if (versionWithoutTweak != *fuzzy.version) {
+            continue;
+        }
+
+        foundVersion = *availableVersion;
+    }
+
+    if (!foundVersion) {
+        return LINGLONG_ERR(foundVersion);
+    }
+
+    auto ref = package::Reference::create(channel, fuzzy.id, *foundVersion, *arch);
+    if (!ref) {
+        Q_ASSERT(false);
+        return LINGLONG_ERR(ref);
+    }
+
+    QDir layer = versionDir.absoluteFilePath(foundVersion->toString() + "/" + arch->toString());
+    if (!layer.exists()) {
+        return LINGLONG_ERR("cannot found layer " + ref->toString());
+    }
+
+    return ref;
+}
+
+utils::error::Result<package::Reference> clearReferenceRemote(const package::FuzzyReference &fuzzy,
+                                                              api::client::ClientApi &api,
+                                                              const QString &repoName) noexcept
+{
+    LINGLONG_TRACE("clear reference remotely");
+
+    api::client::Request_FuzzySearchReq req;
+    if (fuzzy.channel) {
+        req.setChannel(*fuzzy.channel);
+    }
+
+    req.setAppId(fuzzy.id);
+    if (fuzzy.version) {
+        req.setVersion(fuzzy.version->toString());
+    }
+
+    if (fuzzy.arch) {
+        req.setArch(fuzzy.arch->toString());
+    } else {
+        // NOTE: Server requires that arch is set, but why?
+        req.setArch(QSysInfo::currentCpuArchitecture());
+    }
+
+    req.setRepoName(repoName);
+
+    utils::error::Result<package::Reference> ref = LINGLONG_ERR("unknown error");
+
+    QEventLoop loop;
+    const qint32 HTTP_OK = 200;
+    QEventLoop::connect(
       &api,
       &api::client::ClientApi::fuzzySearchAppSignal,
       &loop,
@@ -637,14 +1313,147 @@ utils::error::Result<package::Reference> clearReferenceRemote(const package::Fuz
       },
       loop.thread() == api.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
 
-    api.fuzzySearchApp(req);
-    loop.exec();
+    api.fuzzySearchApp(req);
+    loop.exec();
+
+    if (!ref) {
+        return LINGLONG_ERR("not found");
+    }
+
+    return *ref;
+}
+
+// Check whether a push should stop, because it is cancelled or has timed out.
+utils::error::Result<void> checkPushAborted(const QDeadlineTimer &deadline,
+                                            GCancellable *cancellable) noexcept
+{
+    LINGLONG_TRACE("check push");
+
+    if (cancellable != nullptr && g_cancellable_is_cancelled(cancellable) != FALSE) {
+        return LINGLONG_ERR("push is cancelled");
+    }
+    if (deadline.hasExpired()) {
+        return LINGLONG_ERR("push timed out");
+    }
+
+    return LINGLONG_OK;
+}
+
+// Run loop until a handler sets answered and exits it. The loop is also left when the push is
+// cancelled, times out or the application quits, an error is returned then.
+utils::error::Result<void> execPushLoop(QEventLoop &loop,
+                                        const bool &answered,
+                                        const QDeadlineTimer &deadline,
+                                        GCancellable *cancellable) noexcept
+{
+    LINGLONG_TRACE("wait for server");
+
+    QTimer ticker;
+    QObject::connect(&ticker, &QTimer::timeout, &loop, [&loop, &deadline, cancellable]() {
+        if (!checkPushAborted(deadline, cancellable)) {
+            loop.exit();
+        }
+    });
+    ticker.start(100);
+    loop.exec();
+
+    if (answered) {
+        return LINGLONG_OK;
+    }
+    auto ret = checkPushAborted(deadline, cancellable);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+    return LINGLONG_ERR("push is interrupted");
+}
+
+// Sleep for interval, but wake up early when the push is cancelled or times out.
+utils::error::Result<void> waitPush(std::chrono::milliseconds interval,
+                                    const QDeadlineTimer &deadline,
+                                    GCancellable *cancellable) noexcept
+{
+    LINGLONG_TRACE("wait");
+
+    const QDeadlineTimer wakeUp(interval);
+    while (!wakeUp.hasExpired()) {
+        auto ret = checkPushAborted(deadline, cancellable);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+        QThread::msleep(static_cast<unsigned long>(std::min<qint64>(100, wakeUp.remainingTime())));
+    }
+
+    return LINGLONG_OK;
+}
+
+// Uploads which failed in the network or on the server are retried, the requests rejected by the
+// server would fail again.
+bool isTransientUploadError(QNetworkReply::NetworkError error) noexcept
+{
+    if (error == QNetworkReply::OperationCanceledError) {
+        return false;
+    }
+    const bool networkError =
+      error > QNetworkReply::NoError && error < QNetworkReply::ContentAccessDenied;
+    const bool serverError =
+      error >= QNetworkReply::InternalServerError && error <= QNetworkReply::UnknownServerError;
+    return networkError || serverError;
+}
+
+// Wait for an upload task to finish with the status pushed over a websocket. Returns false if
+// the server could not be watched until the end, the status has to be polled then.
+utils::error::Result<bool> watchUploadTask(const QUrl &url,
+                                           const QString &token,
+                                           const QDeadlineTimer &deadline,
+                                           GCancellable *cancellable) noexcept
+{
+    LINGLONG_TRACE("watch upload task by " + url.toString());
 
-    if (!ref) {
-        return LINGLONG_ERR("not found");
-    }
+    utils::error::Result<bool> result = false;
+    bool answered = false;
 
-    return *ref;
+    QEventLoop loop;
+    QWebSocket socket;
+    QObject::connect(&socket,
+                     &QWebSocket::textMessageReceived,
+                     &loop,
+                     [&](const QString &message) {
+                         const api::client::Response_UploadTaskStatusInfo info(message);
+                         if (info.getStatus() == "complete") {
+                             result = true;
+                         } else if (info.getStatus() == "failed") {
+                             result = LINGLONG_ERR(info.asJson());
+                         } else {
+                             return;
+                         }
+                         answered = true;
+                         loop.exit();
+                     });
+    QObject::connect(&socket, &QWebSocket::disconnected, &loop, [&]() {
+        answered = true;
+        loop.exit();
+    });
+    QObject::connect(&socket,
+                     QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
+                     &loop,
+                     [&](QAbstractSocket::SocketError) {
+                         qWarning() << "watch upload task:" << socket.errorString();
+                         answered = true;
+                         loop.exit();
+                     });
+
+    QNetworkRequest request(url);
+    request.setRawHeader("X-Token", token.toUtf8());
+    socket.open(request);
+
+    auto ret = execPushLoop(loop, answered, deadline, cancellable);
+    QObject::disconnect(&socket, nullptr, &loop, nullptr);
+    socket.abort();
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return result;
 }
 
 } // namespace
@@ -691,150 +1500,742 @@ OSTreeRepo::OSTreeRepo(const QDir &path,
             return;
         }
 
-        qDebug() << LINGLONG_ERRV("ostree_repo_open", gErr);
+        qDebug() << LINGLONG_ERRV("ostree_repo_open", gErr);
+
+        g_clear_error(&gErr);
+        g_clear_object(&ostreeRepo);
+    }
+
+    LINGLONG_TRACE("init ostree-based linglong repository");
+
+    auto result = createOstreeRepo(this->ostreeRepoDir().absolutePath(),
+                                   QString::fromStdString(this->cfg.defaultRepo),
+                                   QString::fromStdString(this->cfg.repos[this->cfg.defaultRepo]
+                                                          + "/repos/" + this->cfg.defaultRepo));
+    if (!result) {
+        qCritical() << LINGLONG_ERRV(result);
+        qFatal("abort");
+    }
+
+    this->ostreeRepo.reset(*result);
+}
+
+api::types::v1::RepoConfig OSTreeRepo::getConfig() const noexcept
+{
+    return cfg;
+}
+
+utils::error::Result<void> OSTreeRepo::setConfig(const api::types::v1::RepoConfig &cfg) noexcept
+{
+    LINGLONG_TRACE("set config");
+
+    if (cfg == this->cfg) {
+        return LINGLONG_OK;
+    }
+
+    utils::Transaction transaction;
+
+    auto result = saveConfig(cfg, this->repoDir.absoluteFilePath("config.yaml"));
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+    transaction.addRollBack([this]() noexcept {
+        auto result = saveConfig(this->cfg, this->repoDir.absoluteFilePath("config.yaml"));
+        if (!result) {
+            qCritical() << result.error();
+            Q_ASSERT(false);
+        }
+    });
+
+    result = updateOstreeRepoConfig(this->ostreeRepo.get(),
+                                    QString::fromStdString(cfg.defaultRepo),
+                                    QString::fromStdString(cfg.repos.at(cfg.defaultRepo)));
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+    transaction.addRollBack([this]() noexcept {
+        auto result =
+          updateOstreeRepoConfig(this->ostreeRepo.get(),
+                                 QString::fromStdString(this->cfg.defaultRepo),
+                                 QString::fromStdString(this->cfg.repos.at(this->cfg.defaultRepo)));
+        if (!result) {
+            qCritical() << result.error();
+            Q_ASSERT(false);
+        }
+    });
+
+    this->apiClient.setNewServerForAllOperations(
+      QString::fromStdString(cfg.repos.at(cfg.defaultRepo)));
+
+    this->cfg = cfg;
+
+    transaction.commit();
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> OSTreeRepo::importLayerDir(const package::LayerDir &dir) noexcept
+{
+    LINGLONG_TRACE("import layer dir");
+
+    if (!dir.exists()) {
+        return LINGLONG_ERR(QString("layer directory %1 not exists").arg(dir.absolutePath()));
+    }
+
+    g_autoptr(GFile) gFile = g_file_new_for_path(dir.absolutePath().toUtf8());
+    if (gFile == nullptr) {
+        qFatal("g_file_new_for_path");
+    }
+
+    auto info = dir.info();
+    if (!info) {
+        return LINGLONG_ERR(info);
+    }
+
+    auto result = this->importLayer(*info, [this, &gFile](OstreeMutableTree *mtree) {
+        return writeDirToMtree(gFile, this->ostreeRepo.get(), mtree);
+    });
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> OSTreeRepo::importLayerFile(package::LayerFile &file) noexcept
+{
+    LINGLONG_TRACE("import layer file " + file.fileName());
+
+    auto offset = file.binaryDataOffset();
+    if (!offset) {
+        return LINGLONG_ERR(offset);
+    }
+
+    auto reader = package::ErofsReader::open(file.handle(), *offset);
+    if (!reader) {
+        return LINGLONG_ERR(reader);
+    }
+
+    auto root = reader->root();
+    if (!root) {
+        return LINGLONG_ERR(root);
+    }
+
+    auto entries = reader->readDir(*root);
+    if (!entries) {
+        return LINGLONG_ERR(entries);
+    }
+
+    auto infoEntry = std::find_if(entries->begin(), entries->end(), [](const auto &entry) {
+        return entry.name == "info.json";
+    });
+    if (infoEntry == entries->end()) {
+        return LINGLONG_ERR("info.json not found in layer");
+    }
+
+    auto infoInode = reader->inode(infoEntry->nid);
+    if (!infoInode) {
+        return LINGLONG_ERR(infoInode);
+    }
+
+    auto content = reader->readAll(*infoInode);
+    if (!content) {
+        return LINGLONG_ERR(content);
+    }
+
+    auto info = utils::serialize::LoadJSON<api::types::v1::PackageInfo>(*content);
+    if (!info) {
+        return LINGLONG_ERR(info);
+    }
+
+    ErofsTreeWriter writer(this->ostreeRepo.get(),
+                           *reader,
+                           this->ostreeRepoDir().absoluteFilePath("tmp"));
+    auto result = this->importLayer(*info, [&writer](OstreeMutableTree *mtree) {
+        return writer.write(mtree);
+    });
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void>
+OSTreeRepo::importLayer(const api::types::v1::PackageInfo &info,
+                        const std::function<utils::error::Result<void>(OstreeMutableTree *)>
+                          &writeTree) noexcept
+{
+    LINGLONG_TRACE("import layer");
+
+    utils::Transaction transaction;
+
+    auto reference = package::Reference::fromPackageInfo(info);
+    if (!reference) {
+        return LINGLONG_ERR(reference);
+    }
+
+    const auto isDevel = info.packageInfoModule == "develop";
+
+    if (this->getLayerDir(*reference, isDevel)) {
+        return LINGLONG_ERR(reference->toString() + " exists.");
+    }
+
+    const auto refspec = ostreeSpecFromReference(*reference, isDevel).toUtf8();
+
+    auto result = commitToRepo(this->ostreeRepo.get(), refspec, writeTree);
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+    transaction.addRollBack([this, refspec]() noexcept {
+        auto result = removeOstreeRef(this->ostreeRepo.get(), refspec);
+        if (!result) {
+            qCritical() << result.error();
+            Q_ASSERT(false);
+        }
+    });
+
+    if (isDevel) {
+        return LINGLONG_OK;
+    }
+
+    result =
+      handleRepositoryUpdate(this->ostreeRepo.get(), this->getLayerQDir(*reference), refspec);
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
+
+    transaction.commit();
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> OSTreeRepo::exportDelta(const package::Reference &from,
+                                                   const package::Reference &to,
+                                                   const QString &path) noexcept
+{
+    LINGLONG_TRACE(QString("export delta from %1 to %2").arg(from.toString(), to.toString()));
+
+    auto toDir = this->getLayerDir(to);
+    if (!toDir) {
+        return LINGLONG_ERR(toDir);
+    }
+    auto info = toDir->info();
+    if (!info) {
+        return LINGLONG_ERR(info);
+    }
+
+    // The canonical commits are only needed to generate the delta.
+    QStringList written;
+    auto deleteWritten = utils::finally::finally([this, &written]() {
+        deleteCommits(this->ostreeRepo.get(), written);
+    });
+    auto fromCommit = writeCanonicalCommit(this->ostreeRepo.get(),
+                                           ostreeSpecFromReference(from).toUtf8(),
+                                           written);
+    if (!fromCommit) {
+        return LINGLONG_ERR(fromCommit);
+    }
+    auto toCommit =
+      writeCanonicalCommit(this->ostreeRepo.get(), ostreeSpecFromReference(to).toUtf8(), written);
+    if (!toCommit) {
+        return LINGLONG_ERR(toCommit);
+    }
+
+    QTemporaryFile delta(this->ostreeRepoDir().absoluteFilePath("tmp/linglong-delta-XXXXXX"));
+    if (!delta.open()) {
+        return LINGLONG_ERR(delta);
+    }
+
+    g_autoptr(GError) gErr = nullptr;
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    g_variant_builder_add(&builder,
+                          "{sv}",
+                          "filename",
+                          g_variant_new_bytestring(delta.fileName().toLocal8Bit().constData()));
+    g_variant_builder_add(&builder, "{sv}", "inline-parts", g_variant_new_boolean(TRUE));
+    g_autoptr(GVariant) params = g_variant_ref_sink(g_variant_builder_end(&builder));
+    if (ostree_repo_static_delta_generate(this->ostreeRepo.get(),
+                                          OSTREE_STATIC_DELTA_GENERATE_OPT_MAJOR,
+                                          fromCommit->toUtf8().constData(),
+                                          toCommit->toUtf8().constData(),
+                                          nullptr,
+                                          params,
+                                          nullptr,
+                                          &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_static_delta_generate", gErr);
+    }
+
+    // The delta was written by ostree behind the descriptor of the temporary file.
+    QFile generated(delta.fileName());
+    if (!generated.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(generated);
+    }
+    QCryptographicHash checksum(QCryptographicHash::Sha256);
+    if (!checksum.addData(&generated) || !generated.seek(0)) {
+        return LINGLONG_ERR(generated);
+    }
+
+    const nlohmann::json deltaInfo{
+        { "version", "1" },
+        { "from", fromCommit->toStdString() },
+        { "to", toCommit->toStdString() },
+        { "checksum", checksum.result().toHex().toStdString() },
+        { "info", *info },
+    };
+    const auto data = QByteArray::fromStdString(deltaInfo.dump());
+
+    QFile output(path);
+    if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return LINGLONG_ERR(output);
+    }
+    QDataStream stream(&output);
+    stream.setVersion(QDataStream::Qt_5_10);
+    stream.writeRawData(deltaMagicNumber.constData(), deltaMagicNumber.size());
+    stream << quint32(data.size());
+    stream.writeRawData(data.constData(), data.size());
+    if (stream.status() != QDataStream::Ok) {
+        return LINGLONG_ERR(output);
+    }
+
+    while (!generated.atEnd()) {
+        const auto chunk = generated.read(1024 * 1024);
+        if (chunk.isEmpty() || output.write(chunk) != chunk.size()) {
+            return LINGLONG_ERR(output);
+        }
+    }
+    if (!output.flush()) {
+        return LINGLONG_ERR(output);
+    }
+    if (::fsync(output.handle()) == -1) {
+        return LINGLONG_ERR("fsync " + path, errno);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> OSTreeRepo::importDelta(const QString &path) noexcept
+{
+    LINGLONG_TRACE("import delta " + path);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(file);
+    }
+    if (file.read(deltaMagicNumber.size()) != deltaMagicNumber) {
+        return LINGLONG_ERR("invalid magic number, this is not a delta");
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+    quint32 length = 0;
+    stream >> length;
+    if (stream.status() != QDataStream::Ok) {
+        return LINGLONG_ERR("delta is truncated");
+    }
+
+    auto deltaInfo = utils::serialize::LoadJSON<nlohmann::json>(file.read(length));
+    if (!deltaInfo) {
+        return LINGLONG_ERR(deltaInfo);
+    }
+
+    std::string fromCommit;
+    std::string toCommit;
+    std::string checksum;
+    api::types::v1::PackageInfo info;
+    try {
+        fromCommit = deltaInfo->at("from").get<std::string>();
+        toCommit = deltaInfo->at("to").get<std::string>();
+        checksum = deltaInfo->at("checksum").get<std::string>();
+        info = deltaInfo->at("info").get<api::types::v1::PackageInfo>();
+    } catch (const std::exception &e) {
+        return LINGLONG_ERR("invalid delta info", e);
+    }
+
+    if (info.packageInfoModule == "develop") {
+        return LINGLONG_ERR("deltas of develop modules are not supported");
+    }
+
+    auto reference = package::Reference::fromPackageInfo(info);
+    if (!reference) {
+        return LINGLONG_ERR(reference);
+    }
+    if (this->getLayerDir(*reference)) {
+        return LINGLONG_ERR(reference->toString() + " exists.");
+    }
+
+    auto pkgInfos = this->listLocal();
+    if (!pkgInfos) {
+        return LINGLONG_ERR(pkgInfos);
+    }
+
+    // The commit the delta starts from is made again from the files of an installed version.
+    std::optional<package::Reference> base;
+    for (const auto &pkgInfo : *pkgInfos) {
+        if (pkgInfo.appid != info.appid || pkgInfo.arch != info.arch
+            || pkgInfo.packageInfoModule != info.packageInfoModule) {
+            continue;
+        }
+
+        auto installed = package::Reference::fromPackageInfo(pkgInfo);
+        if (!installed) {
+            continue;
+        }
+
+        auto commit = canonicalCommit(this->ostreeRepo.get(),
+                                      ostreeSpecFromReference(*installed).toUtf8());
+        if (commit && commit->toStdString() == fromCommit) {
+            base = *installed;
+            break;
+        }
+    }
+    if (!base) {
+        return LINGLONG_ERR("no installed version of " + QString::fromStdString(info.appid)
+                            + " is the base of the delta");
+    }
+
+    // The delta is checked against the checksum in its info before ostree parses it.
+    QTemporaryFile delta(this->ostreeRepoDir().absoluteFilePath("tmp/linglong-delta-XXXXXX"));
+    if (!delta.open()) {
+        return LINGLONG_ERR(delta);
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    while (!file.atEnd()) {
+        const auto chunk = file.read(1024 * 1024);
+        if (chunk.isEmpty() || delta.write(chunk) != chunk.size()) {
+            return LINGLONG_ERR(delta);
+        }
+        hash.addData(chunk);
+    }
+    if (!delta.flush()) {
+        return LINGLONG_ERR(delta);
+    }
+    if (hash.result().toHex().toStdString() != checksum) {
+        return LINGLONG_ERR("checksum of the delta mismatches, it is corrupted");
+    }
+
+    utils::Transaction transaction;
+    const auto refspec = ostreeSpecFromReference(*reference).toUtf8();
+    auto *repo = this->ostreeRepo.get();
+
+    // NOTE: Deltas are installed on machines without network access, the commit is
+    // compared with the remote repository only if it can be reached. The installed
+    // version the delta starts from is the local anchor.
+    auto remote = this->checkRemoteCommit(refspec, QString::fromStdString(toCommit));
+    if (!remote) {
+        return LINGLONG_ERR(remote);
+    }
+    if (!*remote) {
+        qWarning() << "remote repository is not reachable, skip checking"
+                   << QString::fromUtf8(refspec) << "of delta" << path;
+    }
+
+    // The delta is applied on top of the canonical commit of the installed version.
+    QStringList written;
+    auto deleteWritten = utils::finally::finally([repo, &written]() {
+        deleteCommits(repo, written);
+    });
+    auto baseCommit =
+      writeCanonicalCommit(repo, ostreeSpecFromReference(*base).toUtf8(), written);
+    if (!baseCommit) {
+        return LINGLONG_ERR(baseCommit);
+    }
 
-        g_clear_error(&gErr);
-        g_clear_object(&ostreeRepo);
+    g_autoptr(GError) gErr = nullptr;
+    if (ostree_repo_prepare_transaction(repo, NULL, NULL, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_prepare_transaction", gErr);
     }
+    auto abort = utils::finally::finally([repo]() {
+        ostree_repo_abort_transaction(repo, nullptr, nullptr);
+    });
 
-    LINGLONG_TRACE("init ostree-based linglong repository");
+    // Objects are validated by their checksums, the result is the commit of the full layer.
+    g_autoptr(GFile) deltaFile = g_file_new_for_path(delta.fileName().toLocal8Bit());
+    if (ostree_repo_static_delta_execute_offline(repo, deltaFile, FALSE, nullptr, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_static_delta_execute_offline", gErr);
+    }
+    if (ostree_repo_commit_transaction(repo, NULL, NULL, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_commit_transaction", gErr);
+    }
 
-    auto result = createOstreeRepo(this->ostreeRepoDir().absolutePath(),
-                                   QString::fromStdString(this->cfg.defaultRepo),
-                                   QString::fromStdString(this->cfg.repos[this->cfg.defaultRepo]
-                                                          + "/repos/" + this->cfg.defaultRepo));
+    // The layer made by the delta must be the package in the delta info.
+    auto made = layerInfoOfCommit(repo, toCommit.c_str());
+    if (!made) {
+        return LINGLONG_ERR(made);
+    }
+    auto madeRef = package::Reference::fromPackageInfo(*made);
+    if (!madeRef || madeRef->toString() != reference->toString()
+        || made->packageInfoModule != info.packageInfoModule) {
+        return LINGLONG_ERR("the delta makes a layer other than " + reference->toString());
+    }
+
+    if (ostree_repo_set_ref_immediate(repo, nullptr, refspec, toCommit.c_str(), nullptr, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_set_ref_immediate", gErr);
+    }
+    transaction.addRollBack([this, refspec]() noexcept {
+        auto result = removeOstreeRef(this->ostreeRepo.get(), refspec);
+        if (!result) {
+            qCritical() << result.error();
+            Q_ASSERT(false);
+        }
+    });
+
+    auto result = handleRepositoryUpdate(repo, this->getLayerQDir(*reference), refspec);
     if (!result) {
-        qCritical() << LINGLONG_ERRV(result);
-        qFatal("abort");
+        return LINGLONG_ERR(result);
     }
 
-    this->ostreeRepo.reset(*result);
+    transaction.commit();
+    return LINGLONG_OK;
 }
 
-api::types::v1::RepoConfig OSTreeRepo::getConfig() const noexcept
+utils::error::Result<bool> OSTreeRepo::checkRemoteCommit(const QByteArray &refspec,
+                                                          const QString &commit) noexcept
 {
-    return cfg;
+    LINGLONG_TRACE("check " + QString::fromUtf8(refspec) + " in the remote repository");
+
+    // Only the commit object is pulled to compare the files of the layers.
+    QTemporaryDir remoteRepoDir;
+    if (!remoteRepoDir.isValid()) {
+        return LINGLONG_ERR("create temporary directory: " + remoteRepoDir.errorString());
+    }
+    auto remoteRepo = createOstreeRepo(remoteRepoDir.path(),
+                                       QString::fromStdString(this->cfg.defaultRepo),
+                                       QString::fromStdString(
+                                         this->cfg.repos[this->cfg.defaultRepo]),
+                                       this->ostreeRepoDir().absolutePath());
+    if (!remoteRepo) {
+        return LINGLONG_ERR(remoteRepo);
+    }
+    g_autoptr(OstreeRepo) tmpRepo = *remoteRepo;
+    g_autoptr(GError) gErr = nullptr;
+    char *refs[] = { const_cast<char *>(refspec.constData()), nullptr };
+    if (ostree_repo_pull(tmpRepo,
+                         this->cfg.defaultRepo.c_str(),
+                         refs,
+                         static_cast<OstreeRepoPullFlags>(OSTREE_REPO_PULL_FLAGS_MIRROR
+                                                          | OSTREE_REPO_PULL_FLAGS_COMMIT_ONLY),
+                         nullptr,
+                         nullptr,
+                         &gErr)
+        == FALSE) {
+        qDebug() << LINGLONG_ERRV("pull commit of " + QString::fromUtf8(refspec), gErr);
+        return false;
+    }
+
+    auto trusted = canonicalCommit(tmpRepo, refspec.constData());
+    if (!trusted) {
+        return LINGLONG_ERR(trusted);
+    }
+    if (*trusted != commit) {
+        return LINGLONG_ERR("files of the delta differ from " + QString::fromUtf8(refspec)
+                            + " in the remote repository");
+    }
+
+    return true;
 }
 
-utils::error::Result<void> OSTreeRepo::setConfig(const api::types::v1::RepoConfig &cfg) noexcept
+utils::error::Result<void> OSTreeRepo::exportBundle(const std::vector<package::Reference> &refs,
+                                                    const QString &path) const noexcept
 {
-    LINGLONG_TRACE("set config");
+    LINGLONG_TRACE("export bundle to " + path);
 
-    if (cfg == this->cfg) {
-        return LINGLONG_OK;
+    // The bundle may be large, it is made next to the output instead of in /tmp.
+    QTemporaryDir workDir(QFileInfo(path).absolutePath() + "/.linglong-bundle-XXXXXX");
+    if (!workDir.isValid()) {
+        return LINGLONG_ERR("create temporary directory: " + workDir.errorString());
     }
+    const QDir dir(workDir.path());
 
-    utils::Transaction transaction;
-
-    auto result = saveConfig(cfg, this->repoDir.absoluteFilePath("config.yaml"));
-    if (!result) {
-        return LINGLONG_ERR(result);
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(GFile) repoPath = g_file_new_for_path(dir.absoluteFilePath("repo").toLocal8Bit());
+    g_autoptr(OstreeRepo) bundleRepo = ostree_repo_new(repoPath);
+    if (ostree_repo_create(bundleRepo, OSTREE_REPO_MODE_ARCHIVE, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_create", gErr);
     }
-    transaction.addRollBack([this]() noexcept {
-        auto result = saveConfig(this->cfg, this->repoDir.absoluteFilePath("config.yaml"));
-        if (!result) {
-            qCritical() << result.error();
-            Q_ASSERT(false);
+
+    std::vector<QByteArray> refspecs;
+    nlohmann::json layers = nlohmann::json::array();
+    for (const auto &ref : refs) {
+        auto layerDir = this->getLayerDir(ref);
+        if (!layerDir) {
+            return LINGLONG_ERR(layerDir);
+        }
+        auto info = layerDir->info();
+        if (!info) {
+            return LINGLONG_ERR(info);
         }
-    });
 
-    result = updateOstreeRepoConfig(this->ostreeRepo.get(),
-                                    QString::fromStdString(cfg.defaultRepo),
-                                    QString::fromStdString(cfg.repos.at(cfg.defaultRepo)));
+        refspecs.push_back(ostreeSpecFromReference(ref).toUtf8());
+        layers.push_back({ { "ref", refspecs.back().toStdString() }, { "info", *info } });
+    }
+
+    // Objects shared by the layers are stored once.
+    auto result = pullLocal(bundleRepo,
+                            this->ostreeRepoDir().absolutePath(),
+                            refspecs,
+                            OSTREE_REPO_PULL_FLAGS_NONE);
     if (!result) {
         return LINGLONG_ERR(result);
     }
-    transaction.addRollBack([this]() noexcept {
-        auto result =
-          updateOstreeRepoConfig(this->ostreeRepo.get(),
-                                 QString::fromStdString(this->cfg.defaultRepo),
-                                 QString::fromStdString(this->cfg.repos.at(this->cfg.defaultRepo)));
-        if (!result) {
-            qCritical() << result.error();
-            Q_ASSERT(false);
-        }
-    });
 
-    this->apiClient.setNewServerForAllOperations(
-      QString::fromStdString(cfg.repos.at(cfg.defaultRepo)));
+    for (const auto &refspec : refspecs) {
+        g_autofree char *commit = nullptr;
+        if (ostree_repo_resolve_rev(this->ostreeRepo.get(), refspec, FALSE, &commit, &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_resolve_rev", gErr);
+        }
+        if (ostree_repo_set_ref_immediate(bundleRepo, nullptr, refspec, commit, nullptr, &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_set_ref_immediate", gErr);
+        }
+    }
 
-    this->cfg = cfg;
+    QFile bundleInfo(dir.absoluteFilePath("bundle.json"));
+    if (!bundleInfo.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(bundleInfo);
+    }
+    const nlohmann::json content{ { "version", "1" }, { "layers", layers } };
+    if (bundleInfo.write(QByteArray::fromStdString(content.dump())) == -1) {
+        return LINGLONG_ERR(bundleInfo);
+    }
+    bundleInfo.close();
 
-    transaction.commit();
+    // Objects of archive repositories are compressed already.
+    auto ret =
+      utils::command::Exec("tar", { "-cf", path, "-C", dir.absolutePath(), "bundle.json", "repo" });
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
 
     return LINGLONG_OK;
 }
 
-utils::error::Result<void> OSTreeRepo::importLayerDir(const package::LayerDir &dir) noexcept
+utils::error::Result<std::vector<package::Reference>>
+OSTreeRepo::importBundle(const QString &path) noexcept
 {
-    LINGLONG_TRACE("import layer dir");
+    LINGLONG_TRACE("import bundle " + path);
 
-    if (!dir.exists()) {
-        return LINGLONG_ERR(QString("layer directory %1 not exists").arg(dir.absolutePath()));
+    QTemporaryDir workDir(this->ostreeRepoDir().absoluteFilePath("tmp/linglong-bundle-XXXXXX"));
+    if (!workDir.isValid()) {
+        return LINGLONG_ERR("create temporary directory: " + workDir.errorString());
     }
+    const QDir dir(workDir.path());
 
-    utils::Transaction transaction;
-
-    g_autoptr(GFile) gFile = g_file_new_for_path(dir.absolutePath().toUtf8());
-    if (gFile == nullptr) {
-        qFatal("g_file_new_for_path");
+    auto ret = extractBundle(path, dir);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
     }
 
-    auto info = dir.info();
-    if (!info) {
-        return LINGLONG_ERR(info);
+    QFile bundleInfo(dir.absoluteFilePath("bundle.json"));
+    if (!bundleInfo.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(bundleInfo);
     }
-
-    auto reference = package::Reference::fromPackageInfo(*info);
-    if (!reference) {
-        return LINGLONG_ERR(reference);
+    auto content = utils::serialize::LoadJSON<nlohmann::json>(bundleInfo.readAll());
+    if (!content) {
+        return LINGLONG_ERR(content);
     }
 
-    const auto isDevel = info->packageInfoModule == "develop";
+    std::vector<package::Reference> imported;
+    std::vector<QByteArray> refspecs;
+    try {
+        for (const auto &layer : content->at("layers")) {
+            auto info = layer.at("info").get<api::types::v1::PackageInfo>();
+            auto ref = package::Reference::fromPackageInfo(info);
+            if (!ref) {
+                return LINGLONG_ERR(ref);
+            }
+            const auto refspec = ostreeSpecFromReference(*ref).toUtf8();
+            if (refspec.toStdString() != layer.at("ref").get<std::string>()) {
+                return LINGLONG_ERR("reference of " + ref->toString() + " mismatched");
+            }
 
-    if (this->getLayerDir(*reference, isDevel)) {
-        return LINGLONG_ERR(reference->toString() + " exists.");
+            // Layers installed already are kept.
+            if (this->getLayerDir(*ref)) {
+                continue;
+            }
+            imported.push_back(*ref);
+            refspecs.push_back(refspec);
+        }
+    } catch (const std::exception &e) {
+        return LINGLONG_ERR("invalid bundle info", e);
     }
 
-    const auto refspec = ostreeSpecFromReference(*reference, isDevel).toUtf8();
+    if (imported.empty()) {
+        return imported;
+    }
 
-    auto result = commitDirToRepo(gFile, this->ostreeRepo.get(), refspec);
+    // Objects from removable media are verified by their checksums.
+    auto result = pullLocal(this->ostreeRepo.get(),
+                            dir.absoluteFilePath("repo"),
+                            refspecs,
+                            OSTREE_REPO_PULL_FLAGS_UNTRUSTED);
     if (!result) {
         return LINGLONG_ERR(result);
     }
-    transaction.addRollBack([this, &refspec]() noexcept {
-        auto result = removeOstreeRef(this->ostreeRepo.get(), refspec);
-        if (!result) {
-            qCritical() << result.error();
-            Q_ASSERT(false);
-        }
-    });
 
-    if (isDevel) {
-        return LINGLONG_OK;
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(GFile) repoPath = g_file_new_for_path(dir.absoluteFilePath("repo").toLocal8Bit());
+    g_autoptr(OstreeRepo) bundleRepo = ostree_repo_new(repoPath);
+    if (ostree_repo_open(bundleRepo, nullptr, &gErr) == FALSE) {
+        return LINGLONG_ERR("ostree_repo_open", gErr);
     }
 
-    result =
-      handleRepositoryUpdate(this->ostreeRepo.get(), this->getLayerQDir(*reference), refspec);
-    if (!result) {
-        return LINGLONG_ERR(result);
+    utils::Transaction transaction;
+    for (std::size_t i = 0; i < imported.size(); ++i) {
+        const auto &refspec = refspecs[i];
+
+        g_autofree char *commit = nullptr;
+        if (ostree_repo_resolve_rev(bundleRepo, refspec, FALSE, &commit, &gErr) == FALSE) {
+            return LINGLONG_ERR("ostree_repo_resolve_rev", gErr);
+        }
+        if (ostree_repo_set_ref_immediate(this->ostreeRepo.get(),
+                                          nullptr,
+                                          refspec,
+                                          commit,
+                                          nullptr,
+                                          &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_set_ref_immediate", gErr);
+        }
+        transaction.addRollBack([this, refspec]() noexcept {
+            auto result = removeOstreeRef(this->ostreeRepo.get(), refspec);
+            if (!result) {
+                qCritical() << result.error();
+                Q_ASSERT(false);
+            }
+        });
+
+        result = handleRepositoryUpdate(this->ostreeRepo.get(),
+                                        this->getLayerQDir(imported[i]),
+                                        refspec);
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
     }
 
     transaction.commit();
-    return LINGLONG_OK;
+    return imported;
 }
 
 utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
-                                            bool devel) const noexcept
+                                            bool devel,
+                                            const pushOption &opts) const noexcept
 {
     const qint32 HTTP_OK = 200;
 
     LINGLONG_TRACE("push " + ref.toString());
 
-    auto token = [this]() -> utils::error::Result<QString> {
+    const auto &deadline = opts.deadline;
+
+    auto token = [this, &deadline, &opts]() -> utils::error::Result<QString> {
         LINGLONG_TRACE("sign in");
 
         utils::error::Result<QString> result;
+        bool answered = false;
 
         auto env = QProcessEnvironment::systemEnvironment();
         api::client::Request_Auth auth;
@@ -848,6 +2249,7 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
           &api::client::ClientApi::signInSignal,
           &loop,
           [&](api::client::SignIn_200_response resp) {
+              answered = true;
               loop.exit();
               if (resp.getCode() != HTTP_OK) {
                   result = LINGLONG_ERR(resp.getMsg(), resp.getCode());
@@ -862,13 +2264,18 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
           &api::client::ClientApi::signInSignalEFull,
           &loop,
           [&](auto, auto error_type, const QString &error_str) {
+              answered = true;
               loop.exit();
               result = LINGLONG_ERR(error_str, error_type);
           },
           loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
 
         apiClient.signIn(auth);
-        loop.exec();
+        auto ret = execPushLoop(loop, answered, deadline, opts.cancellable);
+        if (!ret) {
+            this->apiClient.abortRequests();
+            return LINGLONG_ERR(ret);
+        }
 
         if (!result) {
             return LINGLONG_ERR(result);
@@ -879,10 +2286,11 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
         return LINGLONG_ERR(token);
     }
 
-    auto taskID = [&ref, this, &token]() -> utils::error::Result<QString> {
+    auto newTaskID = [&ref, this, &token, &deadline, &opts]() -> utils::error::Result<QString> {
         LINGLONG_TRACE("new upload task request");
 
         utils::error::Result<QString> result;
+        bool answered = false;
 
         api::client::Schema_NewUploadTaskReq uploadReq;
         uploadReq.setRef(ref.toString());
@@ -894,6 +2302,7 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
           &api::client::ClientApi::newUploadTaskIDSignal,
           &loop,
           [&](const api::client::NewUploadTaskID_200_response &resp) {
+              answered = true;
               loop.exit();
               if (resp.getCode() != HTTP_OK) {
                   result = LINGLONG_ERR(resp.getMsg(), resp.getCode());
@@ -907,18 +2316,24 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
           &api::client::ClientApi::newUploadTaskIDSignalEFull,
           &loop,
           [&](auto, auto error_type, const QString &error_str) {
+              answered = true;
               loop.exit();
               result = LINGLONG_ERR(error_str, error_type);
           },
           loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
 
         apiClient.newUploadTaskID(*token, uploadReq);
-        loop.exec();
+        auto ret = execPushLoop(loop, answered, deadline, opts.cancellable);
+        if (!ret) {
+            this->apiClient.abortRequests();
+            return LINGLONG_ERR(ret);
+        }
         if (!result) {
             return LINGLONG_ERR(result);
         }
         return result;
-    }();
+    };
+    auto taskID = newTaskID();
     if (!taskID) {
         return LINGLONG_ERR(taskID);
     }
@@ -928,99 +2343,282 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
         return LINGLONG_ERR(tmpDir.errorString());
     }
 
-    const QString tarFileName = QString("%1.tgz").arg(ref.id);
-    const QString tarFilePath = QDir::cleanPath(tmpDir.filePath(tarFileName));
+    auto commit = this->getLayerCommit(ref, devel);
+    if (!commit) {
+        return LINGLONG_ERR(commit);
+    }
+    auto objects = listCommitObjects(this->ostreeRepo.get(), *commit);
+    if (!objects) {
+        return LINGLONG_ERR(objects);
+    }
 
-    auto tarStdout = utils::command::Exec(
-      "tar",
-      QStringList() << "-zcf" << tarFilePath << this->getLayerQDir(ref, devel).absolutePath());
-    if (!tarStdout) {
-        return LINGLONG_ERR(tarStdout);
+    // Servers which do not know the objects endpoints answer 404 or 405,
+    // the whole layer directory is uploaded as a tarball to them.
+    bool objectsSupported = true;
+    auto getMissingObjects = [this, &commit, &objects, &token, &taskID, &objectsSupported,
+                              &deadline, &opts]() -> utils::error::Result<QStringList> {
+        LINGLONG_TRACE("get missing objects");
+
+        utils::error::Result<QStringList> result;
+        bool answered = false;
+
+        api::client::Request_UploadTaskObjectsReq req;
+        req.setCommit(*commit);
+        req.setObjects(*objects);
+
+        QEventLoop loop;
+        QEventLoop::connect(
+          &this->apiClient,
+          &api::client::ClientApi::uploadTaskMissingObjectsSignal,
+          &loop,
+          [&](const api::client::UploadTaskMissingObjects_200_response &resp) {
+              answered = true;
+              loop.exit();
+              if (resp.getCode() != HTTP_OK) {
+                  result = LINGLONG_ERR(resp.getMsg(), resp.getCode());
+                  return;
+              }
+              result = QStringList(resp.getData().getObjects());
+          },
+          loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
+        QEventLoop::connect(
+          &apiClient,
+          &api::client::ClientApi::uploadTaskMissingObjectsSignalEFull,
+          &loop,
+          [&](auto, auto error_type, const QString &error_str) {
+              answered = true;
+              loop.exit();
+              if (error_type == QNetworkReply::ContentNotFoundError
+                  || error_type == QNetworkReply::ContentOperationNotPermittedError) {
+                  objectsSupported = false;
+              }
+              result = LINGLONG_ERR(error_str, error_type);
+          },
+          loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
+
+        apiClient.uploadTaskMissingObjects(*token, *taskID, req);
+        auto ret = execPushLoop(loop, answered, deadline, opts.cancellable);
+        if (!ret) {
+            this->apiClient.abortRequests();
+            return LINGLONG_ERR(ret);
+        }
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+        return result;
+    };
+    auto missingObjects = getMissingObjects();
+    if (!missingObjects && objectsSupported) {
+        return LINGLONG_ERR(missingObjects);
+    }
+
+    QString uploadFilePath;
+    if (objectsSupported) {
+        // Only objects listed by us are accepted, the list of the server may contain duplicates.
+        QSet<QString> known;
+        for (const auto &object : *objects) {
+            known.insert(object);
+        }
+        QStringList missing;
+        for (const auto &object : *missingObjects) {
+            if (known.remove(object)) {
+                missing.push_back(object);
+            }
+        }
+        qInfo() << "upload" << missing.size() << "of" << objects->size() << "objects of"
+                << *commit;
+
+        uploadFilePath = QDir::cleanPath(tmpDir.filePath("objects.tar"));
+        auto ret = exportObjects(this->ostreeRepo.get(), missing, tmpDir.path(), uploadFilePath);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+    } else {
+        qInfo() << "server does not support uploading objects, upload the whole layer";
+
+        uploadFilePath = QDir::cleanPath(tmpDir.filePath(QString("%1.tgz").arg(ref.id)));
+
+        // The server expects a gzip compressed tarball, pigz produces the same format with all
+        // cores.
+        QString compressProgram = "gzip";
+        if (!QStandardPaths::findExecutable("pigz").isEmpty()) {
+            compressProgram = QString("pigz -p %1").arg(QThread::idealThreadCount());
+        }
+        auto tarStdout =
+          utils::command::Exec("tar",
+                               QStringList() << "--use-compress-program=" + compressProgram << "-cf"
+                                             << uploadFilePath
+                                             << this->getLayerQDir(ref, devel).absolutePath());
+        if (!tarStdout) {
+            return LINGLONG_ERR(tarStdout);
+        }
     }
 
-    auto uploadTaskResult = [this, &tarFilePath, &token, &taskID]() -> utils::error::Result<void> {
+    QString watchId;
+    bool transient = false;
+    auto uploadTask = [this, &uploadFilePath, &token, &taskID, objectsSupported, &watchId,
+                       &transient, &deadline, &opts]() -> utils::error::Result<void> {
         LINGLONG_TRACE("do upload task");
 
         utils::error::Result<void> result;
+        bool answered = false;
+        transient = false;
 
         QEventLoop loop;
         QEventLoop::connect(
           &this->apiClient,
-          &api::client::ClientApi::uploadTaskFileSignal,
+          objectsSupported ? &api::client::ClientApi::uploadTaskObjectsSignal
+                           : &api::client::ClientApi::uploadTaskFileSignal,
           &loop,
           [&](const api::client::Api_UploadTaskFileResp &resp) {
+              answered = true;
               loop.exit();
               if (resp.getCode() != HTTP_OK) {
+                  const qint32 HTTP_INTERNAL_SERVER_ERROR = 500;
+                  transient = resp.getCode() >= HTTP_INTERNAL_SERVER_ERROR;
                   result = LINGLONG_ERR(resp.getMsg(), resp.getCode());
                   return;
               }
+              watchId = resp.getData().getWatchId();
           },
           loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
         QEventLoop::connect(
           &this->apiClient,
-          &api::client::ClientApi::uploadTaskFileSignalEFull,
+          objectsSupported ? &api::client::ClientApi::uploadTaskObjectsSignalEFull
+                           : &api::client::ClientApi::uploadTaskFileSignalEFull,
           &loop,
           [&](auto, auto error_type, const QString &error_str) {
+              answered = true;
               loop.exit();
+              transient = isTransientUploadError(error_type);
               result = LINGLONG_ERR(error_str, error_type);
           },
           loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
 
         api::client::HttpFileElement file;
-        file.setFileName(tarFilePath);
-        file.setRequestFileName(tarFilePath);
-        apiClient.uploadTaskFile(*token, *taskID, file);
+        file.setFileName(uploadFilePath);
+        file.setRequestFileName(uploadFilePath);
+        if (objectsSupported) {
+            apiClient.uploadTaskObjects(*token, *taskID, file);
+        } else {
+            apiClient.uploadTaskFile(*token, *taskID, file);
+        }
 
-        loop.exec();
+        auto ret = execPushLoop(loop, answered, deadline, opts.cancellable);
+        if (!ret) {
+            this->apiClient.abortRequests();
+            return LINGLONG_ERR(ret);
+        }
         return result;
-    }();
+    };
+
+    // The file is streamed from disk, so a failed upload is retried without packing it again.
+    // The upload endpoints take the file in one request, a retry sends it from the beginning.
+    const int maxUploadAttempts = 3;
+    utils::error::Result<void> uploadTaskResult;
+    for (int attempt = 1;; ++attempt) {
+        uploadTaskResult = uploadTask();
+        if (uploadTaskResult || !transient || attempt == maxUploadAttempts) {
+            break;
+        }
+        qWarning() << "upload" << uploadFilePath << "attempt" << attempt << "failed:"
+                   << uploadTaskResult.error().message();
+
+        auto ret = waitPush(std::chrono::seconds(attempt * 2), deadline, opts.cancellable);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+
+        // The failed task may be left in any state on the server, the upload is retried with a
+        // new one. Objects are only added to the server, so the packed objects are still enough.
+        taskID = newTaskID();
+        if (!taskID) {
+            return LINGLONG_ERR(taskID);
+        }
+        if (objectsSupported) {
+            missingObjects = getMissingObjects();
+            if (!missingObjects) {
+                return LINGLONG_ERR(missingObjects);
+            }
+        }
+    }
     if (!uploadTaskResult) {
         return LINGLONG_ERR(uploadTaskResult);
     }
 
-    auto uploadResult = [&taskID, &token, this]() -> utils::error::Result<void> {
+    // Servers which push the status of the task give a watch id, others are polled with an
+    // exponential backoff, with jitter so pushes started together do not poll in step.
+    auto uploadResult = [&taskID, &token, &watchId, &deadline, &opts, this]()
+      -> utils::error::Result<void> {
         LINGLONG_TRACE("get upload status");
 
+        if (!watchId.isEmpty()) {
+            QUrl url(QString::fromStdString(this->cfg.repos.at(this->cfg.defaultRepo)));
+            url.setScheme(url.scheme() == "https" ? "wss" : "ws");
+            url.setPath(QDir::cleanPath(
+              QString("%1/api/v1/upload-tasks/%2/watch").arg(url.path(), *taskID)));
+            url.setQuery("watch_id=" + QUrl::toPercentEncoding(watchId));
+
+            auto watched = watchUploadTask(url, *token, deadline, opts.cancellable);
+            if (!watched) {
+                return LINGLONG_ERR(watched);
+            }
+            if (*watched) {
+                return LINGLONG_OK;
+            }
+            qInfo() << "lost the status channel of upload task" << *taskID << ", poll instead";
+        }
+
         utils::error::Result<bool> isFinished;
+        bool answered = false;
 
-        while (true) {
-            QEventLoop loop;
-            QEventLoop::connect(
-              &this->apiClient,
-              &api::client::ClientApi::uploadTaskInfoSignal,
-              &loop,
-              [&](const api::client::UploadTaskInfo_200_response &resp) {
-                  loop.exit();
-                  const qint32 HTTP_OK = 200;
-                  if (resp.getCode() != HTTP_OK) {
-                      isFinished = LINGLONG_ERR(resp.getMsg(), resp.getCode());
-                      return;
-                  }
-                  if (resp.getData().getStatus() == "complete") {
-                      isFinished = true;
-                      return;
-                  }
-                  if (resp.getData().getStatus() == "failed") {
-                      isFinished = LINGLONG_ERR(resp.getData().asJson());
-                      return;
-                  }
+        QEventLoop loop;
+        QEventLoop::connect(
+          &this->apiClient,
+          &api::client::ClientApi::uploadTaskInfoSignal,
+          &loop,
+          [&](const api::client::UploadTaskInfo_200_response &resp) {
+              answered = true;
+              loop.exit();
+              const qint32 HTTP_OK = 200;
+              if (resp.getCode() != HTTP_OK) {
+                  isFinished = LINGLONG_ERR(resp.getMsg(), resp.getCode());
+                  return;
+              }
+              if (resp.getData().getStatus() == "complete") {
+                  isFinished = true;
+                  return;
+              }
+              if (resp.getData().getStatus() == "failed") {
+                  isFinished = LINGLONG_ERR(resp.getData().asJson());
+                  return;
+              }
+
+              isFinished = false;
+          },
+          loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
+        QEventLoop::connect(
+          &apiClient,
+          &api::client::ClientApi::uploadTaskInfoSignalEFull,
+          &loop,
+          [&](auto, auto error_type, const QString &error_str) {
+              answered = true;
+              loop.exit();
+              isFinished = LINGLONG_ERR(error_str, error_type);
+          },
+          loop.thread() == apiClient.thread() ? Qt::AutoConnection : Qt::BlockingQueuedConnection);
 
-                  isFinished = false;
-              },
-              loop.thread() == apiClient.thread() ? Qt::AutoConnection
-                                                  : Qt::BlockingQueuedConnection);
-            QEventLoop::connect(
-              &apiClient,
-              &api::client::ClientApi::uploadTaskInfoSignalEFull,
-              &loop,
-              [&](auto, auto error_type, const QString &error_str) {
-                  loop.exit();
-                  isFinished = LINGLONG_ERR(error_str, error_type);
-              },
-              loop.thread() == apiClient.thread() ? Qt::AutoConnection
-                                                  : Qt::BlockingQueuedConnection);
+        const std::chrono::milliseconds minInterval(500);
+        const std::chrono::milliseconds maxInterval(30000);
+        auto interval = minInterval;
+        while (true) {
+            answered = false;
             apiClient.uploadTaskInfo(*token, *taskID);
-            loop.exec();
+            auto ret = execPushLoop(loop, answered, deadline, opts.cancellable);
+            if (!ret) {
+                this->apiClient.abortRequests();
+                return LINGLONG_ERR(ret);
+            }
 
             if (!isFinished) {
                 return LINGLONG_ERR(isFinished);
@@ -1030,10 +2628,15 @@ utils::error::Result<void> OSTreeRepo::push(const package::Reference &ref,
                 return LINGLONG_OK;
             }
 
-            QThread::sleep(1);
+            const auto half = interval.count() / 2;
+            const std::chrono::milliseconds wait(
+              half + QRandomGenerator::global()->bounded(static_cast<int>(half) + 1));
+            ret = waitPush(wait, deadline, opts.cancellable);
+            if (!ret) {
+                return LINGLONG_ERR(ret);
+            }
+            interval = std::min(interval * 2, maxInterval);
         }
-
-        return LINGLONG_OK;
     }();
     if (!uploadResult) {
         return LINGLONG_ERR(uploadResult);
@@ -1451,6 +3054,23 @@ auto OSTreeRepo::getLayerDir(const package::Reference &ref, bool devel) const no
     return dir.absolutePath();
 }
 
+auto OSTreeRepo::getLayerCommit(const package::Reference &ref, bool devel) const noexcept
+  -> utils::error::Result<QString>
+{
+    LINGLONG_TRACE("get commit of " + ref.toString());
+
+    const auto refspec = ostreeSpecFromReference(ref, devel).toUtf8();
+
+    g_autoptr(GError) gErr = nullptr;
+    g_autofree char *commit = nullptr;
+    if (ostree_repo_resolve_rev(this->ostreeRepo.get(), refspec, FALSE, &commit, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_resolve_rev", gErr);
+    }
+
+    return QString::fromUtf8(commit);
+}
+
 OSTreeRepo::~OSTreeRepo() = default;
 
 } // namespace linglong::repo
@@ -11,12 +11,14 @@
 #include "linglong/api/types/v1/RepoConfig.hpp"
 #include "linglong/package/fuzzy_reference.h"
 #include "linglong/package/layer_dir.h"
+#include "linglong/package/layer_file.h"
 #include "linglong/package/reference.h"
 #include "linglong/package_manager/task.h"
 #include "linglong/utils/error/error.h"
 
 #include <ostree.h>
 
+#include <QDeadlineTimer>
 #include <QHttpPart>
 #include <QList>
 #include <QPointer>
@@ -24,6 +26,9 @@
 #include <QScopedPointer>
 #include <QThread>
 
+#include <chrono>
+#include <functional>
+
 namespace linglong::repo {
 
 struct clearReferenceOption
@@ -32,6 +37,14 @@ struct clearReferenceOption
     bool fallbackToRemote = true;
 };
 
+struct pushOption
+{
+    // Give up when the deadline expires, pushes sharing the option share the deadline too.
+    QDeadlineTimer deadline{ QDeadlineTimer::Forever };
+    // Cancel it to abort the push.
+    GCancellable *cancellable = nullptr;
+};
+
 class OSTreeRepo : public QObject
 {
     Q_OBJECT
@@ -50,12 +63,45 @@ public:
     utils::error::Result<void> setConfig(const api::types::v1::RepoConfig &cfg) noexcept;
 
     utils::error::Result<void> importLayerDir(const package::LayerDir &dir) noexcept;
+    // Import the EROFS image in a layer file without mounting it.
+    utils::error::Result<void> importLayerFile(package::LayerFile &file) noexcept;
+
+    // Delta file format:
+    //
+    // Name              Length (bytes)    Starts at (bytes)
+    // magic number      40                0
+    // delta info length 4                 40
+    // delta info        delta info length 44
+    // ostree delta                        44 + delta info length
+    //
+    // The delta info is a JSON object with the commits the delta goes "from" and "to",
+    // the SHA-256 "checksum" of the ostree delta and the package "info" of the new version.
+    // The commits are made again from the files of the layers without time and parent,
+    // so they are the same on all machines.
+    utils::error::Result<void> exportDelta(const package::Reference &from,
+                                           const package::Reference &to,
+                                           const QString &path) noexcept;
+    // Install the new version in a delta on top of an installed old version. The new version
+    // is compared with the remote repository if it can be reached, the delta is installed
+    // offline otherwise.
+    utils::error::Result<void> importDelta(const QString &path) noexcept;
+
+    // A bundle is an uncompressed tar of "bundle.json", with the references and package infos
+    // of the layers, and "repo", an ostree archive repository with the commits of the layers.
+    utils::error::Result<void> exportBundle(const std::vector<package::Reference> &refs,
+                                            const QString &path) const noexcept;
+    // Import the layers in a bundle which are not installed, and return their references.
+    utils::error::Result<std::vector<package::Reference>>
+    importBundle(const QString &path) noexcept;
 
     utils::error::Result<package::LayerDir> getLayerDir(const package::Reference &ref,
                                                         bool devel = false) const noexcept;
+    utils::error::Result<QString> getLayerCommit(const package::Reference &ref,
+                                                 bool devel = false) const noexcept;
 
     utils::error::Result<void> push(const package::Reference &reference,
-                                    bool devel = false) const noexcept;
+                                    bool devel = false,
+                                    const pushOption &opts = {}) const noexcept;
 
     void pull(std::shared_ptr<service::InstallTask> taskContext,
               const package::Reference &reference,
@@ -90,6 +136,14 @@ private:
     QDir repoDir;
     QDir ostreeRepoDir() const noexcept;
     QDir getLayerQDir(const package::Reference &ref, bool devel = false) const noexcept;
+    utils::error::Result<void>
+    importLayer(const api::types::v1::PackageInfo &info,
+                const std::function<utils::error::Result<void>(OstreeMutableTree *)>
+                  &writeTree) noexcept;
+    // Whether the commit of refspec in the remote repository has the files of commit,
+    // false if the remote repository can not be reached.
+    utils::error::Result<bool> checkRemoteCommit(const QByteArray &refspec,
+                                                 const QString &commit) noexcept;
 
     api::client::ClientApi &apiClient;
 };
@@ -0,0 +1,222 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/cgroup.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <linux/magic.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+namespace linglong::runtime::cgroup {
+
+namespace {
+
+constexpr auto cgroupRoot = "sys/fs/cgroup";
+
+// The unified hierarchy of cgroup v2 is mounted at the cgroup root,
+// the root of a cgroup v1 or hybrid hierarchy has no cgroup.controllers.
+auto isCgroup2(const QDir &root) noexcept -> bool
+{
+    const auto path = root.absoluteFilePath(cgroupRoot);
+    struct statfs info{};
+    if (::statfs(path.toLocal8Bit().constData(), &info) == 0
+        && info.f_type == CGROUP2_SUPER_MAGIC) {
+        return true;
+    }
+    return QFileInfo::exists(path + "/cgroup.controllers");
+}
+
+// Path of the cgroup of the process relative to the cgroup root.
+auto cgroupOf(const QDir &root, const QString &pid) noexcept -> utils::error::Result<QString>
+{
+    LINGLONG_TRACE("get cgroup of process " + pid);
+
+    QFile file(root.absoluteFilePath("proc/" + pid + "/cgroup"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(file);
+    }
+
+    // The only entry of cgroup v2 is "0::PATH".
+    for (const auto &line : QString(file.readAll()).split('\n')) {
+        if (line.startsWith("0::")) {
+            return line.mid(3);
+        }
+    }
+
+    return LINGLONG_ERR("not in a cgroup v2 hierarchy");
+}
+
+// Characters other than ASCII letters, digits, "_" and "." are replaced,
+// as "-" and ":" are separators in the scope name and the cgroups path.
+auto unitName(const QString &appID, const QString &containerID) noexcept -> std::string
+{
+    QString name = appID;
+    for (auto &c : name) {
+        if (c.unicode() > 0x7f || (!c.isLetterOrNumber() && c != '_' && c != '.')) {
+            c = '_';
+        }
+    }
+
+    constexpr auto hashLength = 16;
+    auto hash =
+      QCryptographicHash::hash(containerID.toUtf8(), QCryptographicHash::Sha256).toHex();
+    return (name + "_" + hash.left(hashLength)).toStdString();
+}
+
+auto readFile(const QDir &dir, const QString &name) noexcept -> std::optional<QString>
+{
+    QFile file(dir.absoluteFilePath(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+    return QString(file.readAll()).trimmed();
+}
+
+// Read the value of key in a flat keyed file like cpu.stat.
+auto readKey(const QDir &dir, const QString &name, const QString &key) noexcept
+  -> std::optional<int64_t>
+{
+    auto content = readFile(dir, name);
+    if (!content) {
+        return std::nullopt;
+    }
+
+    for (const auto &line : content->split('\n')) {
+        auto fields = line.split(' ');
+        if (fields.size() == 2 && fields[0] == key) {
+            return fields[1].toLongLong();
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+auto placement(const QString &appID, const QString &containerID, const QDir &root) noexcept
+  -> std::optional<Placement>
+{
+    if (!isCgroup2(root)) {
+        return std::nullopt;
+    }
+
+    const auto name = unitName(appID, containerID);
+
+    // The OCI runtime creates the scope by the systemd instance of the user,
+    // which is reached through the session bus.
+    const auto runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (root.exists("run/systemd/system")
+        && (::getuid() == 0 || QFileInfo::exists(root.filePath("." + runtimeDir + "/bus")))) {
+        return Placement{ .path = "app.slice:linglong:" + name, .systemd = true };
+    }
+
+    auto self = cgroupOf(root, "self");
+    if (!self) {
+        qDebug() << self.error();
+        return std::nullopt;
+    }
+
+    // Processes can not be in a cgroup with children, so the cgroup of the
+    // container is created next to the cgroup of this process.
+    auto parent = QFileInfo(*self).path();
+    const auto parentDir = root.absoluteFilePath(cgroupRoot + parent);
+    if (::access(parentDir.toLocal8Bit().constData(), W_OK) != 0) {
+        qDebug() << "cgroup" << parent << "is not delegated to the user";
+        return std::nullopt;
+    }
+
+    auto path = QDir(parent).absoluteFilePath(QString::fromStdString("linglong-" + name));
+    return Placement{ .path = path.toStdString(), .systemd = false };
+}
+
+auto controllers(const QDir &root) noexcept -> QStringList
+{
+    auto self = cgroupOf(root, "self");
+    if (!self) {
+        return {};
+    }
+
+    auto content = readFile(QDir(root.absoluteFilePath(cgroupRoot + *self)), "cgroup.controllers");
+    if (!content) {
+        return {};
+    }
+    return content->split(' ', Qt::SkipEmptyParts);
+}
+
+auto unifiedResources(
+  const api::types::v1::ApplicationConfigurationPermissionsResources &resources) noexcept
+  -> std::map<std::string, std::string>
+{
+    std::map<std::string, std::string> unified;
+    if (resources.cpuWeight) {
+        unified["cpu.weight"] = std::to_string(*resources.cpuWeight);
+    }
+    if (resources.memoryHigh) {
+        unified["memory.high"] = std::to_string(*resources.memoryHigh);
+    }
+    if (resources.memoryMax) {
+        unified["memory.max"] = std::to_string(*resources.memoryMax);
+    }
+    if (resources.ioWeight) {
+        unified["io.weight"] = "default " + std::to_string(*resources.ioWeight);
+    }
+    return unified;
+}
+
+auto stats(pid_t pid, const QDir &root) noexcept
+  -> utils::error::Result<api::types::v1::CliContainerStats>
+{
+    LINGLONG_TRACE(QString("read resource usage of process %1").arg(pid));
+
+    auto path = cgroupOf(root, QString::number(pid));
+    if (!path) {
+        return LINGLONG_ERR(path);
+    }
+
+    const QDir dir(root.absoluteFilePath(cgroupRoot + *path));
+    api::types::v1::CliContainerStats stats;
+    stats.cpuUsageUsec = readKey(dir, "cpu.stat", "usage_usec");
+
+    // NOTE: memory.current counts the page cache too, which is mostly shared with
+    // other applications, it is only used if memory.stat can not be read.
+    auto anon = readKey(dir, "memory.stat", "anon");
+    auto mapped = readKey(dir, "memory.stat", "file_mapped");
+    if (anon) {
+        stats.rss = *anon + mapped.value_or(0);
+    } else if (auto current = readFile(dir, "memory.current"); current) {
+        stats.rss = current->toLongLong();
+    }
+
+    if (auto pids = readFile(dir, "pids.current"); pids) {
+        stats.pids = pids->toLongLong();
+    }
+
+    // io.stat has a line of "MAJOR:MINOR rbytes=N wbytes=N ..." for each device.
+    if (auto io = readFile(dir, "io.stat"); io) {
+        int64_t readBytes = 0;
+        int64_t writeBytes = 0;
+        for (const auto &line : io->split('\n', Qt::SkipEmptyParts)) {
+            for (const auto &field : line.split(' ')) {
+                if (field.startsWith("rbytes=")) {
+                    readBytes += field.mid(7).toLongLong();
+                } else if (field.startsWith("wbytes=")) {
+                    writeBytes += field.mid(7).toLongLong();
+                }
+            }
+        }
+        stats.ioReadBytes = readBytes;
+        stats.ioWriteBytes = writeBytes;
+    }
+
+    return stats;
+}
+
+} // namespace linglong::runtime::cgroup
@@ -0,0 +1,60 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_CGROUP_H_
+#define LINGLONG_RUNTIME_CGROUP_H_
+
+#include "linglong/api/types/v1/ApplicationConfigurationPermissionsResources.hpp"
+#include "linglong/api/types/v1/CliContainerStats.hpp"
+#include "linglong/utils/error/error.h"
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <optional>
+#include <string>
+
+#include <sys/types.h>
+
+// Each application container is placed in its own cgroup v2 subtree,
+// so the resources it uses can be limited and read.
+namespace linglong::runtime::cgroup {
+
+struct Placement
+{
+    // linux.cgroupsPath of the OCI configuration.
+    std::string path;
+    // The path is in the "slice:prefix:name" format of a systemd transient scope,
+    // which the OCI runtime creates by systemd.
+    bool systemd;
+};
+
+// Place the container in a systemd transient scope if systemd is running,
+// otherwise in a cgroup next to the cgroup of this process if it is delegated to the user.
+//
+// Files of /proc, /run and /sys are read in root, which is only changed by tests.
+[[nodiscard]] auto placement(const QString &appID,
+                             const QString &containerID,
+                             const QDir &root = QDir::root()) noexcept -> std::optional<Placement>;
+
+// Controllers available in the cgroup of this process,
+// interface files of other controllers can not be written.
+[[nodiscard]] auto controllers(const QDir &root = QDir::root()) noexcept -> QStringList;
+
+// Interface files of cgroup v2 set by linux.resources.unified of the OCI configuration.
+[[nodiscard]] auto unifiedResources(
+  const api::types::v1::ApplicationConfigurationPermissionsResources &resources) noexcept
+  -> std::map<std::string, std::string>;
+
+// Read the resource usage of the cgroup of the process.
+[[nodiscard]] auto stats(pid_t pid, const QDir &root = QDir::root()) noexcept
+  -> utils::error::Result<api::types::v1::CliContainerStats>;
+
+} // namespace linglong::runtime::cgroup
+
+#endif
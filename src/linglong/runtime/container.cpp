@@ -8,26 +8,71 @@
 
 #include "linglong/package/architecture.h"
 #include "linglong/package/layer_packager.h"
+#include "linglong/runtime/cgroup.h"
+#include "linglong/runtime/zygote.h"
 #include "linglong/utils/finally/finally.h"
+#include "linglong/utils/trace/trace.h"
+#include "ocppi/runtime/RunOption.hpp"
 #include "ocppi/runtime/config/types/Generators.hpp"
+#include "ocppi/runtime/state/types/Generators.hpp"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QStandardPaths>
 
+#include <cerrno>
 #include <fstream>
 
 #include <sys/stat.h>
 
 namespace linglong::runtime {
 
+namespace {
+
+// Hooks of the container run in other processes,
+// the time they finished is known by the files they wrote.
+void traceFileWritten(const char *name,
+                      const QString &path,
+                      utils::trace::WallClock::time_point since) noexcept
+{
+    struct stat info{};
+    if (::stat(path.toLocal8Bit().constData(), &info) != 0) {
+        return;
+    }
+
+    auto mtime =
+      std::chrono::seconds(info.st_mtim.tv_sec) + std::chrono::nanoseconds(info.st_mtim.tv_nsec);
+    auto time = utils::trace::WallClock::time_point(
+      std::chrono::duration_cast<utils::trace::WallClock::duration>(mtime));
+    // The file is left by a previous launch.
+    if (time < since) {
+        return;
+    }
+
+    utils::trace::instant(name, time);
+}
+
+} // namespace
+
 Container::Container(const ocppi::runtime::config::types::Config &cfg,
                      const QString &appID,
                      const QString &conatinerID,
-                     ocppi::cli::CLI &cli)
+                     ocppi::cli::CLI &cli,
+                     ContainerRegistry &registry,
+                     const QString &ref,
+                     std::optional<QDir> ldCacheDir,
+                     std::optional<QString> zygoteID,
+                     std::unique_ptr<Readahead> readahead)
     : cfg(cfg)
     , id(conatinerID)
     , appID(appID)
     , cli(cli)
+    , registry(registry)
+    , ref(ref)
+    , ldCacheDir(std::move(ldCacheDir))
+    , zygoteID(std::move(zygoteID))
+    , readahead(std::move(readahead))
 {
     Q_ASSERT(!cfg.process.has_value());
 }
@@ -36,6 +81,9 @@ utils::error::Result<void>
 Container::run(const ocppi::runtime::config::types::Process &process) noexcept
 {
     LINGLONG_TRACE(QString("run container %1").arg(this->id));
+    LINGLONG_SPAN("run container");
+
+    utils::trace::Span prepareSpan("prepare bundle");
 
     QDir runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
     QDir bundle = runtimeDir.absoluteFilePath(QString("linglong/%1").arg(this->id));
@@ -96,36 +144,223 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
       .type = "bind",
     });
 
-    {
-        std::ofstream ofs(bundle.absoluteFilePath("ld.so.cache").toStdString());
-        Q_ASSERT(ofs.is_open());
-        if (!ofs.is_open()) {
-            return LINGLONG_ERR("create ld config in bundle directory");
+    std::optional<QString> cachedLdCache;
+    std::optional<QString> generatedLdCache;
+    if (this->ldCacheDir) {
+        cachedLdCache = this->ldCacheDir->absoluteFilePath("ld.so.cache");
+    }
+    const bool ldCacheReady = cachedLdCache && QFileInfo(*cachedLdCache).isFile();
+    if (ldCacheReady) {
+        // NOTE: The ld.so.cache is generated for the exact layers of this container,
+        // running ldconfig again is unnecessary.
+        this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
+          .destination = "/etc/ld.so.cache",
+          .options = { { "ro", "rbind" } },
+          .source = cachedLdCache->toStdString(),
+          .type = "bind",
+        });
+    } else {
+        {
+            std::ofstream ofs(bundle.absoluteFilePath("ld.so.cache").toStdString());
+            Q_ASSERT(ofs.is_open());
+            if (!ofs.is_open()) {
+                return LINGLONG_ERR("create ld config in bundle directory");
+            }
         }
+        this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
+          .destination = "/etc/ld.so.cache",
+          .options = { { "rbind" } },
+          .source = bundle.absoluteFilePath("ld.so.cache").toStdString(),
+          .type = "bind",
+        });
+
+        // ldconfig writes the cache to a temporary file and renames it,
+        // which is not possible on a bind mounted file.
+        // So it generates the cache in a writable directory, then the cache is
+        // copied to /etc/ld.so.cache and published to the cache directory
+        // for the later launches.
+        QDir ldCacheWorkDir = this->ldCacheDir.value_or(QDir(bundle.absoluteFilePath("ld-cache")));
+        if (!ldCacheWorkDir.mkpath(".")) {
+            return LINGLONG_ERR("make ld cache directory " + ldCacheWorkDir.absolutePath());
+        }
+        generatedLdCache = ldCacheWorkDir.absoluteFilePath("ld.so.cache");
+        this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
+          .destination = "/run/linglong/ld-cache",
+          .options = { { "rbind" } },
+          .source = ldCacheWorkDir.absolutePath().toStdString(),
+          .type = "bind",
+        });
+
+        const auto generating = "/run/linglong/ld-cache/ld.so.cache." + this->id.toStdString();
+        if (!this->cfg.hooks) {
+            this->cfg.hooks = ocppi::runtime::config::types::Hooks{};
+        }
+        if (!this->cfg.hooks->startContainer) {
+            this->cfg.hooks->startContainer = std::vector<ocppi::runtime::config::types::Hook>{};
+        }
+        this->cfg.hooks->startContainer->push_back(ocppi::runtime::config::types::Hook{
+          .args = std::vector<std::string>{
+            "/bin/bash",
+            "-c",
+            "( /sbin/ldconfig -C " + generating + " && cat " + generating
+              + " > /etc/ld.so.cache && mv -f " + generating
+              + " /run/linglong/ld-cache/ld.so.cache ) || true",
+          },
+          .path = "/bin/bash",
+        });
     }
-    {
-        std::ofstream ofs(bundle.absoluteFilePath("ld.so.cache~").toStdString());
-        Q_ASSERT(ofs.is_open());
-        if (!ofs.is_open()) {
-            return LINGLONG_ERR("create ld config in bundle directory");
+
+    if (!this->cfg.hooks) {
+        this->cfg.hooks = ocppi::runtime::config::types::Hooks{};
+    }
+    if (!this->cfg.hooks->createRuntime) {
+        this->cfg.hooks->createRuntime = std::vector<ocppi::runtime::config::types::Hook>{};
+    }
+    auto stateHookArgs = ContainerRegistry::stateHookArgs(bundle.absolutePath());
+    this->cfg.hooks->createRuntime->push_back(ocppi::runtime::config::types::Hook{
+      .args = stateHookArgs,
+      .path = stateHookArgs[0],
+    });
+
+    ocppi::runtime::RunOption runOption{};
+    auto placement = cgroup::placement(this->appID, this->id);
+    if (placement) {
+        if (!this->cfg.linux) {
+            this->cfg.linux = ocppi::runtime::config::types::Linux{};
         }
+        this->cfg.linux->cgroupsPath = placement->path;
+        runOption.systemdCgroup = placement->systemd;
     }
-    this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
-      .destination = "/etc/ld.so.cache",
-      .options = { { "rbind" } },
-      .source = bundle.absoluteFilePath("ld.so.cache").toStdString(),
-      .type = "bind",
+
+    // The OCI runtime fails to write the interface files of controllers
+    // not enabled for the user, or if there is no cgroup for the container.
+    if (this->cfg.linux && this->cfg.linux->resources && this->cfg.linux->resources->unified) {
+        auto &unified = *this->cfg.linux->resources->unified;
+        const auto available = placement ? cgroup::controllers() : QStringList{};
+        for (auto it = unified.begin(); it != unified.end();) {
+            auto controller = QString::fromStdString(it->first).section('.', 0, 0);
+            if (available.contains(controller)) {
+                ++it;
+                continue;
+            }
+
+            qWarning() << "ignore" << it->first.c_str() << "of the container,"
+                       << "controller" << controller << "is not available";
+            it = unified.erase(it);
+        }
+    }
+
+    const bool isZygote = this->appID == Zygote::appID;
+    if (isZygote) {
+        if (!bundle.mkpath("zygote")) {
+            return LINGLONG_ERR("make zygote directory in bundle directory");
+        }
+        auto mounts = Zygote::serverMounts(bundle);
+        this->cfg.mounts->insert(this->cfg.mounts->end(), mounts.begin(), mounts.end());
+    }
+
+    const api::types::v1::ContainerRegistryEntry entry{
+        .appId = this->appID.toStdString(),
+        .bundle = bundle.absolutePath().toStdString(),
+        .containerId = this->id.toStdString(),
+        .ref = this->ref.toStdString(),
+    };
+    if (auto ret = this->registry.add(entry); !ret) {
+        qWarning() << ret.error();
+    }
+    auto removeEntry = utils::finally::finally([this, &entry]() {
+        this->registry.remove(entry);
     });
-    this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
-      .destination = "/etc/ld.so.cache~",
-      .options = { { "rbind" } },
-      .source = bundle.absoluteFilePath("ld.so.cache~").toStdString(),
-      .type = "bind",
+    prepareSpan.end();
+
+    // Pages read by the application are recorded after it has run for a while or exited.
+    if (this->readahead) {
+        this->readahead->applicationStarting();
+    }
+    auto applicationExited = utils::finally::finally([this]() {
+        if (this->readahead) {
+            this->readahead->applicationExited();
+        }
     });
 
-    nlohmann::json json = this->cfg;
+    // Processes launched in a zygote stay in the cgroup of the zygote,
+    // applications with resource limits are launched in their own containers.
+    const bool hasResources = this->cfg.linux && this->cfg.linux->resources
+      && this->cfg.linux->resources->unified && !this->cfg.linux->resources->unified->empty();
+    if (this->zygoteID && hasResources) {
+        qDebug() << "launch in a new container to limit the resources";
+    }
+
+    // The ld.so.cache of the application is generated by the hooks of its container,
+    // so an application is launched in a zygote only after it has been launched once.
+    if (this->zygoteID && ldCacheReady && !hasResources) {
+        if (auto zygote = this->registry.get(*this->zygoteID); zygote) {
+            QElapsedTimer timer;
+            timer.start();
+            utils::trace::Span zygoteSpan("launch in zygote");
+
+            bool started = false;
+            auto exitCode = Zygote(*zygote).spawn(bundle, this->cfg, [&](pid_t pid) {
+                started = true;
+                utils::trace::instant("process started", utils::trace::Clock::now());
+                qDebug() << "process started in zygote" << *this->zygoteID << "in"
+                         << timer.elapsed() << "ms";
+
+                // Record the state like the createRuntime hook does.
+                const ocppi::runtime::state::types::State state{
+                    .bundle = entry.bundle,
+                    .id = entry.containerId,
+                    .ociVersion = "1.0.1",
+                    .pid = pid,
+                    .status = ocppi::runtime::state::types::Status::Running,
+                };
+                {
+                    std::ofstream ofs(bundle.absoluteFilePath("state.json").toStdString());
+                    ofs << nlohmann::json(state).dump();
+                }
+
+                // Commands can not be executed in this container by the OCI runtime.
+                auto launched = entry;
+                launched.zygoteId = this->zygoteID->toStdString();
+                if (auto ret = this->registry.add(launched); !ret) {
+                    qWarning() << ret.error();
+                }
+            });
+
+            if (exitCode && *exitCode != 0) {
+                return LINGLONG_ERR("process exited with code", *exitCode);
+            }
+            if (exitCode) {
+                return LINGLONG_OK;
+            }
+            if (started) {
+                return LINGLONG_ERR(exitCode);
+            }
+
+            if (exitCode.error().code() == ENOTSUP) {
+                qDebug() << "launch in a new container:" << exitCode.error();
+            } else {
+                qWarning() << "launch in a new container:" << exitCode.error();
+            }
+        }
+    }
+
+    // Bundles of other containers, including the sockets of zygotes, are not visible
+    // to applications. Zygotes read the requests of applications from them.
+    if (!isZygote) {
+        this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
+          .destination =
+            "/run/host/rootfs" + runtimeDir.absoluteFilePath("linglong").toStdString(),
+          .options = { { "nodev", "nosuid", "noexec", "ro", "mode=755" } },
+          .source = "tmpfs",
+          .type = "tmpfs",
+        });
+    }
 
     {
+        LINGLONG_SPAN("write config.json");
+        nlohmann::json json = this->cfg;
+
         std::ofstream ofs(bundle.absoluteFilePath("config.json").toStdString());
         Q_ASSERT(ofs.is_open());
         if (!ofs.is_open()) {
@@ -134,8 +369,21 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
 
         ofs << json.dump();
     }
-    auto result = this->cli.run(ocppi::runtime::ContainerID(this->id.toStdString()),
-                                std::filesystem::path(bundle.absolutePath().toStdString()));
+
+    auto containerID = ocppi::runtime::ContainerID(this->id.toStdString());
+    auto bundlePath = std::filesystem::path(bundle.absolutePath().toStdString());
+    // Modification times of files are wall times.
+    const auto runStarted = utils::trace::WallClock::now();
+    utils::trace::Span runSpan("oci runtime run");
+    auto result = this->cli.run(containerID, bundlePath, runOption);
+    runSpan.end();
+
+    if (utils::trace::enabled()) {
+        traceFileWritten("container created", bundle.absoluteFilePath("state.json"), runStarted);
+        if (generatedLdCache) {
+            traceFileWritten("ldconfig finished", *generatedLdCache, runStarted);
+        }
+    }
 
     if (!result) {
         return LINGLONG_ERR(result);
@@ -7,11 +7,18 @@
 #ifndef LINGLONG_RUNTIME_CONTAINER_H_
 #define LINGLONG_RUNTIME_CONTAINER_H_
 
+#include "linglong/runtime/container_registry.h"
+#include "linglong/runtime/readahead.h"
 #include "linglong/utils/error/error.h"
 #include "ocppi/cli/CLI.hpp"
 #include "ocppi/runtime/config/types/Config.hpp"
 #include "ocppi/runtime/config/types/Process.hpp"
 
+#include <QDir>
+
+#include <memory>
+#include <optional>
+
 namespace linglong::runtime {
 
 class Container
@@ -20,7 +27,12 @@ public:
     Container(const ocppi::runtime::config::types::Config &cfg,
               const QString &appID,
               const QString &conatinerID,
-              ocppi::cli::CLI &cli);
+              ocppi::cli::CLI &cli,
+              ContainerRegistry &registry,
+              const QString &ref,
+              std::optional<QDir> ldCacheDir = std::nullopt,
+              std::optional<QString> zygoteID = std::nullopt,
+              std::unique_ptr<Readahead> readahead = nullptr);
 
     utils::error::Result<void> run(const ocppi::runtime::config::types::Process &process) noexcept;
 
@@ -29,6 +41,13 @@ private:
     QString id;
     QString appID;
     ocppi::cli::CLI &cli;
+    ContainerRegistry &registry;
+    QString ref;
+    // Directory to keep the ld.so.cache generated for the layers of this container.
+    std::optional<QDir> ldCacheDir;
+    // Launch the process in this zygote if it is running.
+    std::optional<QString> zygoteID;
+    std::unique_ptr<Readahead> readahead;
 };
 
 }; // namespace linglong::runtime
@@ -6,35 +6,30 @@
 
 #include "linglong/runtime/container_builder.h"
 
-#include "linglong/api/types/v1/ApplicationConfiguration.hpp"
+#include "linglong/runtime/cgroup.h"
+#include "linglong/runtime/font_cache.h"
+#include "linglong/runtime/oci_config_pipeline.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/error/error.h"
 #include "linglong/utils/serialize/json.h"
 #include "linglong/utils/serialize/yaml.h"
+#include "linglong/utils/trace/trace.h"
 #include "ocppi/runtime/config/types/Generators.hpp"
 #include "ocppi/runtime/config/types/Mount.hpp"
 
+#include <QCryptographicHash>
 #include <qstandardpaths.h>
 
+#include <algorithm>
+
 namespace linglong::runtime {
 
 namespace {
-auto getPatchesForApplication(const QString &appID) noexcept
+auto getPatchesForApplication(
+  const std::optional<api::types::v1::ApplicationConfiguration> &config) noexcept
   -> std::vector<api::types::v1::OciConfigurationPatch>
 {
-    auto filePath =
-      QStandardPaths::locate(QStandardPaths::ConfigLocation, "linglong/" + appID + "/config.yaml");
-    if (filePath.isEmpty()) {
-        return {};
-    }
-
-    LINGLONG_TRACE(QString("get OCI patches for application %1").arg(appID));
-
-    auto config =
-      utils::serialize::LoadYAMLFile<api::types::v1::ApplicationConfiguration>(filePath);
     if (!config) {
-        qWarning() << LINGLONG_ERRV(config);
-        Q_ASSERT(false);
         return {};
     }
 
@@ -50,7 +45,7 @@ auto getPatchesForApplication(const QString &appID) noexcept
 
     for (const auto &bind : *config->permissions->binds) {
         patches.push_back({ .ociVersion = "1.0.1",
-                            .patch = nlohmann::json::array({
+                            .patch = { nlohmann::json::object({
                               { "op", "add" },
                               { "path", "/mounts/-" },
                               { "value",
@@ -62,186 +57,205 @@ auto getPatchesForApplication(const QString &appID) noexcept
                                       "nosuid",
                                       "nodev",
                                     }) } } },
-                            }) });
+                            }) } });
     }
 
     return patches;
 }
 
-void applyJSONPatch(ocppi::runtime::config::types::Config &cfg,
-                    const api::types::v1::OciConfigurationPatch &patch) noexcept
+// Key of the caches depending on the application and its layers.
+auto layersKey(const ContainerOptions &opts) noexcept -> QString
 {
-    LINGLONG_TRACE(QString("apply oci runtime config patch %1")
-                     .arg(QString::fromStdString(nlohmann::json(patch).dump(-1, ' ', true))));
-
-    if (patch.ociVersion != cfg.ociVersion) {
-        qWarning() << LINGLONG_ERRV("ociVersion mismatched");
-        Q_ASSERT(false);
-        return;
-    }
-
-    auto raw = nlohmann::json(cfg);
-    try {
-        raw = raw.patch(patch.patch);
-        cfg = raw.get<ocppi::runtime::config::types::Config>();
-    } catch (...) {
-        qCritical() << LINGLONG_ERRV("apply patch", std::current_exception());
-        Q_ASSERT(false);
-        return;
-    }
+    return QCryptographicHash::hash((opts.appID + "\n" + opts.layerCommits.join("\n")).toUtf8(),
+                                    QCryptographicHash::Sha256)
+      .toHex();
 }
 
-void applyJSONFilePatch(ocppi::runtime::config::types::Config &cfg, const QFileInfo &info) noexcept
+// The ld.so.cache depends on the libraries in the layers and the ld.so.conf
+// generated for the application, so it is shared by containers running
+// the same application on the same layer commits.
+auto getLdCacheDir(const ContainerOptions &opts) noexcept -> utils::error::Result<QDir>
 {
-    if (!info.isFile()) {
-        return;
-    }
+    LINGLONG_TRACE("get ld.so.cache directory");
 
-    LINGLONG_TRACE(QString("apply oci runtime config patch file %1").arg(info.absoluteFilePath()));
-
-    if (!info.absoluteFilePath().endsWith(".json")) {
-        qWarning() << LINGLONG_ERRV("file not ends with .json");
-        Q_ASSERT(false);
-        return;
+    if (opts.layerCommits.isEmpty()) {
+        return LINGLONG_ERR("layer commits are unknown");
     }
 
-    auto patch = utils::serialize::LoadJSONFile<api::types::v1::OciConfigurationPatch>(
-      info.absoluteFilePath());
-    if (!patch) {
-        qWarning() << LINGLONG_ERRV(patch);
-        Q_ASSERT(false);
-        return;
-    }
-
-    applyJSONPatch(cfg, *patch);
-}
-
-void applyExecutablePatch(ocppi::runtime::config::types::Config &cfg,
-                          const QFileInfo &info) noexcept
-{
-    LINGLONG_TRACE(QString("process oci configuration generator %1").arg(info.absoluteFilePath()));
-
-    QProcess generatorProcess;
-    generatorProcess.setProgram(info.absoluteFilePath());
-    generatorProcess.start();
-    generatorProcess.write(QByteArray::fromStdString(nlohmann::json(cfg).dump()));
-    generatorProcess.closeWriteChannel();
-
-    constexpr auto timeout = 200;
-    if (!generatorProcess.waitForFinished(timeout)) {
-        qCritical() << LINGLONG_ERRV(generatorProcess.errorString(), generatorProcess.error());
-        Q_ASSERT(false);
-        return;
-    }
-
-    if (generatorProcess.exitCode() != 0) {
-        qCritical() << LINGLONG_ERRV("exit with error", generatorProcess.exitCode());
-        qCritical() << "with input:" << nlohmann::json(cfg).dump().c_str();
-        Q_ASSERT(false);
-        return;
-    }
-
-    auto error = generatorProcess.readAllStandardError();
-    if (!error.isEmpty()) {
-        qWarning() << "generator" << info.absoluteFilePath() << "stderr:" << QString(error);
+    QDir cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+      + "/linglong/ld-cache";
+    if (!cacheDir.mkpath(".")) {
+        return LINGLONG_ERR("make directory " + cacheDir.absolutePath());
     }
 
-    auto result = generatorProcess.readAllStandardOutput();
-    auto modified = utils::serialize::LoadJSON<ocppi::runtime::config::types::Config>(result);
-    if (!modified) {
-        qCritical() << LINGLONG_ERRV("parse stdout", modified);
-        Q_ASSERT(false);
-        return;
+    constexpr auto maxEntries = 64;
+    auto entries = cacheDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time);
+    while (entries.size() > maxEntries) {
+        QDir(entries.takeLast().absoluteFilePath()).removeRecursively();
     }
 
-    cfg = *modified;
+    return QDir(cacheDir.absoluteFilePath(layersKey(opts)));
 }
 
-void applyPatches(ocppi::runtime::config::types::Config &cfg, const QFileInfoList &patches) noexcept
+// Start reading the files of the application ahead before setting up the container.
+auto startReadahead(const ContainerOptions &opts, ContainerRegistry &registry) noexcept
+  -> std::unique_ptr<Readahead>
 {
-
-    for (const auto &info : patches) {
-        if (!info.isFile()) {
-            continue;
-        }
-
-        if (info.isExecutable()) {
-            applyExecutablePatch(cfg, info);
-            continue;
-        }
-
-        applyJSONFilePatch(cfg, info);
+    if (!Readahead::enabled() || opts.layerCommits.isEmpty() || !opts.appDir) {
+        return nullptr;
     }
-}
 
-void applyPatches(ocppi::runtime::config::types::Config &cfg,
-                  const std::vector<api::types::v1::OciConfigurationPatch> &patches) noexcept
-{
-    for (const auto &patch : patches) {
-        applyJSONPatch(cfg, patch);
+    // NOTE: Files of the base are mostly shared with other applications,
+    // the runtime is shared too, but fewer applications use it.
+    std::vector<QDir> sharedLayers;
+    if (opts.runtimeDir) {
+        sharedLayers.emplace_back(opts.runtimeDir->absoluteFilePath("files"));
     }
+
+    auto readahead = std::make_unique<Readahead>(
+      Readahead::defaultDir().absoluteFilePath(layersKey(opts) + ".json"),
+      std::vector<QDir>{ opts.appDir->absoluteFilePath("files") },
+      std::move(sharedLayers));
+
+    // NOTE: Recording drops the pages of the application from the page cache,
+    // which are used by other running containers of the same application.
+    const auto containers = registry.list(opts.appID);
+    const auto running =
+      std::any_of(containers.begin(), containers.end(), [&opts](const auto &entry) {
+          return QString::fromStdString(entry.ref) == opts.ref;
+      });
+    readahead->start(!running);
+    return readahead;
 }
 
-auto getOCIConfig(const ContainerOptions &opts) noexcept
+auto getOCIConfig(const ContainerOptions &opts, OCIConfigCache &cache) noexcept
   -> utils::error::Result<ocppi::runtime::config::types::Config>
 {
     LINGLONG_TRACE("get origin OCI configuration file");
+    LINGLONG_SPAN("get oci configuration");
 
     QString containerConfigFilePath = qgetenv("LINGLONG_CONTAINER_CONFIG");
     if (containerConfigFilePath.isEmpty()) {
         containerConfigFilePath = LINGLONG_INSTALL_PREFIX "/lib/linglong/container/config.json";
     }
 
-    auto config = utils::serialize::LoadJSONFile<ocppi::runtime::config::types::Config>(
-      containerConfigFilePath);
-    if (!config) {
-        Q_ASSERT(false);
-        return LINGLONG_ERR(config);
+    utils::trace::Span cacheSpan("load cached oci configuration");
+    auto cacheKey = cache.key(opts, containerConfigFilePath);
+    if (!cacheKey) {
+        qDebug() << "OCI configuration will not be cached:" << cacheKey.error();
+    } else if (auto cached = cache.load(*cacheKey); cached) {
+        return cached;
+    } else {
+        qDebug() << cached.error();
     }
+    cacheSpan.end();
 
-    config->root = ocppi::runtime::config::types::Root{
-        .path = opts.baseDir.absoluteFilePath("files").toStdString(),
-        .readonly = true,
-    };
+    auto raw = utils::serialize::LoadJSONFile<nlohmann::json>(containerConfigFilePath);
+    if (!raw) {
+        Q_ASSERT(false);
+        return LINGLONG_ERR(raw);
+    }
 
-    auto annotations = config->annotations.value_or(std::map<std::string, std::string>{});
-    annotations["org.deepin.linglong.appID"] = opts.appID.toStdString();
-    annotations["org.deepin.linglong.baseDir"] = opts.baseDir.absolutePath().toStdString();
+    try {
+        (*raw)["root"] = {
+            { "path", opts.baseDir.absoluteFilePath("files").toStdString() },
+            { "readonly", true },
+        };
+
+        auto &annotations = (*raw)["annotations"];
+        annotations["org.deepin.linglong.appID"] = opts.appID.toStdString();
+        annotations["org.deepin.linglong.baseDir"] = opts.baseDir.absolutePath().toStdString();
+        if (auto fontCache = FontCache::find(opts.baseDir); fontCache) {
+            annotations["org.deepin.linglong.fontCacheDir"] =
+              fontCache->absolutePath().toStdString();
+        }
 
-    if (opts.runtimeDir) {
-        annotations["org.deepin.linglong.runtimeDir"] =
-          opts.runtimeDir->absolutePath().toStdString();
-    }
-    if (opts.appDir) {
-        annotations["org.deepin.linglong.appDir"] = opts.appDir->absolutePath().toStdString();
+        if (opts.runtimeDir) {
+            annotations["org.deepin.linglong.runtimeDir"] =
+              opts.runtimeDir->absolutePath().toStdString();
+        }
+        if (opts.appDir) {
+            annotations["org.deepin.linglong.appDir"] = opts.appDir->absolutePath().toStdString();
+        }
+    } catch (...) {
+        return LINGLONG_ERR("set annotations", std::current_exception());
     }
-    config->annotations = std::move(annotations);
+
+    OCIConfigPipeline pipeline(std::move(*raw));
 
     QDir configDotDDir = QFileInfo(containerConfigFilePath).dir().filePath("config.d");
     Q_ASSERT(configDotDDir.exists());
 
-    applyPatches(*config, configDotDDir.entryInfoList(QDir::Files));
+    pipeline.addFiles(configDotDDir.entryInfoList(QDir::Files));
 
-    auto appPatches = getPatchesForApplication(opts.appID);
+    auto appConfig = getApplicationConfiguration(opts.appID);
+    pipeline.addPatches(getPatchesForApplication(appConfig));
 
-    applyPatches(*config, appPatches);
+    pipeline.addPatches(opts.patches);
 
-    applyPatches(*config, opts.patches);
+    try {
+        auto &document = pipeline.document();
+        auto &mounts = document["mounts"];
+        for (const auto &mount : opts.mounts) {
+            mounts.push_back(nlohmann::json(mount));
+        }
 
-    Q_ASSERT(config->mounts.has_value());
-    auto &mounts = *config->mounts;
+        document["linux"]["maskedPaths"] = opts.masks;
 
-    mounts.insert(mounts.end(), opts.mounts.begin(), opts.mounts.end());
+        if (appConfig && appConfig->permissions && appConfig->permissions->resources) {
+            auto &unified = document["linux"]["resources"]["unified"];
+            for (const auto &[key, value] :
+                 cgroup::unifiedResources(*appConfig->permissions->resources)) {
+                unified[key] = value;
+            }
+        }
+    } catch (...) {
+        return LINGLONG_ERR("append mounts and resources", std::current_exception());
+    }
 
-    config->linux_->maskedPaths = opts.masks;
+    auto config = pipeline.finish();
+    if (!config) {
+        return LINGLONG_ERR(config);
+    }
+
+    if (cacheKey) {
+        auto result = cache.save(*cacheKey, *config);
+        if (!result) {
+            qWarning() << result.error();
+        }
+    }
 
     return config;
 }
 
 } // namespace
 
+auto getApplicationConfiguration(const QString &appID) noexcept
+  -> std::optional<api::types::v1::ApplicationConfiguration>
+{
+    auto filePath =
+      QStandardPaths::locate(QStandardPaths::ConfigLocation, "linglong/" + appID + "/config.yaml");
+    if (filePath.isEmpty()) {
+        return std::nullopt;
+    }
+
+    LINGLONG_TRACE(QString("get configuration of application %1").arg(appID));
+
+    auto config =
+      utils::serialize::LoadYAMLFile<api::types::v1::ApplicationConfiguration>(filePath);
+    if (!config) {
+        qWarning() << LINGLONG_ERRV(config);
+        Q_ASSERT(false);
+        return std::nullopt;
+    }
+
+    return *config;
+}
+
 ContainerBuilder::ContainerBuilder(ocppi::cli::CLI &cli)
     : cli(cli)
+    , configCache(OCIConfigCache::defaultDir())
+    , registry(ContainerRegistry::defaultDir())
 {
 }
 
@@ -249,14 +263,32 @@ auto ContainerBuilder::create(const ContainerOptions &opts) noexcept
   -> utils::error::Result<QSharedPointer<Container>>
 {
     LINGLONG_TRACE("create container");
+    LINGLONG_SPAN("create container");
+
+    auto readahead = startReadahead(opts, this->registry);
 
-    auto config = getOCIConfig(opts);
+    auto config = getOCIConfig(opts, this->configCache);
     if (!config) {
         Q_ASSERT(false);
         return LINGLONG_ERR(config);
     }
 
-    return QSharedPointer<Container>::create(*config, opts.appID, opts.containerID, this->cli);
+    std::optional<QDir> ldCacheDir;
+    if (auto dir = getLdCacheDir(opts); dir) {
+        ldCacheDir = *dir;
+    } else {
+        qDebug() << "ld.so.cache will not be cached:" << dir.error();
+    }
+
+    return QSharedPointer<Container>::create(*config,
+                                             opts.appID,
+                                             opts.containerID,
+                                             this->cli,
+                                             this->registry,
+                                             opts.ref,
+                                             std::move(ldCacheDir),
+                                             opts.zygoteID,
+                                             std::move(readahead));
 }
 
 } // namespace linglong::runtime
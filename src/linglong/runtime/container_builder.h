@@ -7,8 +7,12 @@
 #ifndef LINGLONG_RUNTIME_CONTAINER_BUILDER_H_
 #define LINGLONG_RUNTIME_CONTAINER_BUILDER_H_
 
+#include "linglong/api/types/v1/ApplicationConfiguration.hpp"
 #include "linglong/api/types/v1/OciConfigurationPatch.hpp"
 #include "linglong/runtime/container.h"
+#include "linglong/runtime/container_registry.h"
+#include "linglong/runtime/oci_config_cache.h"
+#include "linglong/runtime/readahead.h"
 #include "linglong/utils/error/error.h"
 #include "ocppi/cli/CLI.hpp"
 #include "ocppi/runtime/config/types/Mount.hpp"
@@ -22,6 +26,7 @@ struct ContainerOptions
 {
     QString appID;
     QString containerID;
+    QString ref; // recorded in the container registry
 
     std::optional<QDir> runtimeDir; // mount to /runtime
     QDir baseDir;                   // mount to /
@@ -30,8 +35,19 @@ struct ContainerOptions
     std::vector<api::types::v1::OciConfigurationPatch> patches;
     std::vector<ocppi::runtime::config::types::Mount> mounts; // extra mounts
     std::vector<std::string> masks;
+
+    // Commits of the layers above, the generated OCI configuration
+    // is cached only if they are known.
+    QStringList layerCommits;
+
+    // Launch the process in the zygote with this container ID if it is running.
+    std::optional<QString> zygoteID;
 };
 
+// Load $XDG_CONFIG_HOME/linglong/<appID>/config.yaml.
+auto getApplicationConfiguration(const QString &appID) noexcept
+  -> std::optional<api::types::v1::ApplicationConfiguration>;
+
 class ContainerBuilder : public QObject
 {
     Q_OBJECT
@@ -43,6 +59,8 @@ public:
 
 private:
     ocppi::cli::CLI &cli;
+    OCIConfigCache configCache;
+    ContainerRegistry registry;
 };
 
 }; // namespace linglong::runtime
@@ -0,0 +1,361 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/container_registry.h"
+
+#include "linglong/utils/finally/finally.h"
+#include "linglong/utils/serialize/json.h"
+#include "ocppi/runtime/state/types/Generators.hpp"
+
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+#include <csignal>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+constexpr auto stateFileName = "state.json";
+
+// Read the start time of a process in clock ticks after boot,
+// which is the 22nd field of /proc/<pid>/stat.
+auto processStartTime(int64_t pid) noexcept -> utils::error::Result<int64_t>
+{
+    LINGLONG_TRACE(QString("get start time of process %1").arg(pid));
+
+    QFile stat(QString("/proc/%1/stat").arg(pid));
+    if (!stat.open(QIODevice::ReadOnly)) {
+        return LINGLONG_ERR(stat);
+    }
+
+    // The command name in the second field might contain spaces,
+    // so fields are counted after its closing parenthesis.
+    auto content = stat.readAll();
+    auto fields = content.mid(content.lastIndexOf(')') + 2).split(' ');
+    constexpr auto startTimeIndex = 22 - 3;
+    if (fields.size() <= startTimeIndex) {
+        return LINGLONG_ERR("invalid stat " + QString(content));
+    }
+
+    bool ok = false;
+    auto startTime = fields[startTimeIndex].toLongLong(&ok);
+    if (!ok) {
+        return LINGLONG_ERR("invalid start time " + QString(fields[startTimeIndex]));
+    }
+
+    return startTime;
+}
+
+// The PID of an exited container might be reused by another process.
+auto isRunning(const api::types::v1::ContainerRegistryEntry &entry) noexcept -> bool
+{
+    if (!entry.pid || !entry.startTime) {
+        return false;
+    }
+
+    auto startTime = processStartTime(*entry.pid);
+    return startTime && *startTime == *entry.startTime;
+}
+
+// Application IDs are used as directory names, so they must not contain '/' or be '.' or '..'.
+auto isAppID(const QString &appID) noexcept -> bool
+{
+    static const QRegularExpression regex(R"(^[A-Za-z0-9_-]+(\.[A-Za-z0-9_-]+)*$)");
+    return regex.match(appID).hasMatch();
+}
+
+auto isContainerID(const QString &containerID) noexcept -> bool
+{
+    static const QRegularExpression regex(R"(^[A-Za-z0-9+/]+={0,2}$)");
+    return regex.match(containerID).hasMatch();
+}
+
+// Prefixes of decoded container IDs, which are "<reference>-<uuid>".
+auto isDecodedIDPrefix(const QString &prefix) noexcept -> bool
+{
+    static const QRegularExpression regex(R"(^[A-Za-z0-9._:/{}+-]+$)");
+    return regex.match(prefix).hasMatch() && !prefix.contains("..");
+}
+
+} // namespace
+
+ContainerRegistry::ContainerRegistry(const QDir &dir) noexcept
+    : dir(dir)
+{
+}
+
+auto ContainerRegistry::stateHookArgs(const QString &bundle) noexcept -> std::vector<std::string>
+{
+    return {
+        "/bin/sh",
+        "-c",
+        R"(cat > "$0")",
+        QDir(bundle).absoluteFilePath(stateFileName).toStdString(),
+    };
+}
+
+auto ContainerRegistry::entryPath(const QString &appID, const QString &containerID) const noexcept
+  -> QString
+{
+    // NOTE: Container ID is encoded by base64, which might contain '/'.
+    return this->dir.absoluteFilePath(appID + "/" + QUrl::toPercentEncoding(containerID)
+                                      + ".json");
+}
+
+auto ContainerRegistry::add(const api::types::v1::ContainerRegistryEntry &entry) noexcept
+  -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("add container " + QString::fromStdString(entry.containerId) + " to registry");
+
+    if (!isAppID(QString::fromStdString(entry.appId))) {
+        return LINGLONG_ERR("invalid application ID " + QString::fromStdString(entry.appId));
+    }
+
+    const auto path = this->entryPath(QString::fromStdString(entry.appId),
+                                      QString::fromStdString(entry.containerId));
+    if (!QFileInfo(path).dir().mkpath(".")) {
+        return LINGLONG_ERR("failed to create " + QFileInfo(path).absolutePath());
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(file);
+    }
+
+    auto content = QByteArray::fromStdString(nlohmann::json(entry).dump());
+    if (file.write(content) != content.size()) {
+        return LINGLONG_ERR(file);
+    }
+
+    if (!file.commit()) {
+        return LINGLONG_ERR(file);
+    }
+
+    return LINGLONG_OK;
+}
+
+void ContainerRegistry::remove(const api::types::v1::ContainerRegistryEntry &entry) noexcept
+{
+    if (!isAppID(QString::fromStdString(entry.appId))) {
+        qWarning() << "invalid application ID" << QString::fromStdString(entry.appId);
+        return;
+    }
+
+    const auto path = this->entryPath(QString::fromStdString(entry.appId),
+                                      QString::fromStdString(entry.containerId));
+    if (!QFile::remove(path) && QFile::exists(path)) {
+        qWarning() << "failed to remove" << path;
+        return;
+    }
+
+    // Remove the directory of the application if it is empty.
+    this->dir.rmdir(QString::fromStdString(entry.appId));
+}
+
+auto ContainerRegistry::load(const QString &path) noexcept
+  -> utils::error::Result<api::types::v1::ContainerRegistryEntry>
+{
+    LINGLONG_TRACE("load container registry entry " + path);
+
+    auto entry = utils::serialize::LoadJSONFile<api::types::v1::ContainerRegistryEntry>(path);
+    if (!entry) {
+        QFile::remove(path);
+        return LINGLONG_ERR(entry);
+    }
+
+    if (!entry->pid) {
+        const auto bundle = QDir(QString::fromStdString(entry->bundle));
+        if (!bundle.exists()) {
+            this->remove(*entry);
+            return LINGLONG_ERR("container is not running");
+        }
+
+        // The container is still starting if its state is not recorded yet.
+        if (!bundle.exists(stateFileName)) {
+            return entry;
+        }
+
+        auto state = utils::serialize::LoadJSONFile<ocppi::runtime::state::types::State>(
+          bundle.absoluteFilePath(stateFileName));
+        if (!state) {
+            return LINGLONG_ERR(state);
+        }
+
+        if (!state->pid) {
+            return entry;
+        }
+
+        auto startTime = processStartTime(*state->pid);
+        if (!startTime) {
+            this->remove(*entry);
+            return LINGLONG_ERR("container is not running", startTime);
+        }
+
+        entry->pid = state->pid;
+        entry->startTime = *startTime;
+        if (auto ret = this->add(*entry); !ret) {
+            qWarning() << ret.error();
+        }
+
+        return entry;
+    }
+
+    if (!isRunning(*entry)) {
+        this->remove(*entry);
+        return LINGLONG_ERR("container is not running");
+    }
+
+    return entry;
+}
+
+auto ContainerRegistry::get(const QString &containerID) noexcept
+  -> utils::error::Result<api::types::v1::ContainerRegistryEntry>
+{
+    LINGLONG_TRACE("get container " + containerID);
+
+    for (const auto &appID : this->dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const auto path = this->entryPath(appID, containerID);
+        if (!QFile::exists(path)) {
+            continue;
+        }
+
+        auto entry = this->load(path);
+        if (!entry) {
+            return LINGLONG_ERR(entry);
+        }
+
+        return entry;
+    }
+
+    return LINGLONG_ERR("not found");
+}
+
+auto ContainerRegistry::list(const QString &appID) noexcept
+  -> std::vector<api::types::v1::ContainerRegistryEntry>
+{
+    std::vector<api::types::v1::ContainerRegistryEntry> entries;
+    if (!isAppID(appID)) {
+        qWarning() << "invalid application ID" << appID;
+        return entries;
+    }
+
+    QDir appDir = this->dir.absoluteFilePath(appID);
+    for (const auto &info : appDir.entryInfoList({ "*.json" }, QDir::Files)) {
+        auto entry = this->load(info.absoluteFilePath());
+        if (!entry) {
+            qDebug() << entry.error();
+            continue;
+        }
+
+        entries.push_back(std::move(*entry));
+    }
+
+    return entries;
+}
+
+auto ContainerRegistry::list() noexcept -> std::vector<api::types::v1::ContainerRegistryEntry>
+{
+    std::vector<api::types::v1::ContainerRegistryEntry> entries;
+
+    for (const auto &appID : this->dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        auto appEntries = this->list(appID);
+        std::move(appEntries.begin(), appEntries.end(), std::back_inserter(entries));
+    }
+
+    return entries;
+}
+
+auto ContainerRegistry::find(const QString &pagoda) noexcept
+  -> utils::error::Result<api::types::v1::ContainerRegistryEntry>
+{
+    LINGLONG_TRACE("find container " + pagoda);
+
+    if (!isContainerID(pagoda) && !isAppID(pagoda) && !isDecodedIDPrefix(pagoda)) {
+        return LINGLONG_ERR("invalid container or application ID");
+    }
+
+    if (isContainerID(pagoda)) {
+        if (auto entry = this->get(pagoda); entry) {
+            return entry;
+        }
+    }
+
+    if (isAppID(pagoda)) {
+        if (auto entries = this->list(pagoda); !entries.empty()) {
+            return entries.front();
+        }
+    }
+
+    for (auto &entry : this->list()) {
+        auto decodedID = QString(QByteArray::fromBase64(entry.containerId.c_str()));
+        if (decodedID.startsWith(pagoda)) {
+            return entry;
+        }
+    }
+
+    return LINGLONG_ERR("not found");
+}
+
+auto ContainerRegistry::kill(const api::types::v1::ContainerRegistryEntry &entry,
+                             int signal) noexcept -> utils::error::Result<void>
+{
+    LINGLONG_TRACE(QString("send signal %1 to container %2")
+                     .arg(signal)
+                     .arg(QString::fromStdString(entry.containerId)));
+
+    if (!entry.pid || !entry.startTime) {
+        return LINGLONG_ERR("PID of container is unknown");
+    }
+
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_send_signal)
+    // Hold a pidfd while checking the start time,
+    // so the signal can not be sent to another process reusing the PID.
+    int pidfd = static_cast<int>(syscall(SYS_pidfd_open, *entry.pid, 0));
+    if (pidfd >= 0) {
+        auto closePidfd = utils::finally::finally([pidfd] {
+            ::close(pidfd);
+        });
+
+        if (!isRunning(entry)) {
+            return LINGLONG_ERR("container is not running");
+        }
+
+        if (syscall(SYS_pidfd_send_signal, pidfd, signal, nullptr, 0) != 0) {
+            return LINGLONG_ERR("pidfd_send_signal", errno);
+        }
+
+        return LINGLONG_OK;
+    }
+
+    if (errno != ENOSYS) {
+        return LINGLONG_ERR("pidfd_open", errno);
+    }
+#endif
+
+    if (!isRunning(entry)) {
+        return LINGLONG_ERR("container is not running");
+    }
+
+    if (::kill(static_cast<pid_t>(*entry.pid), signal) != 0) {
+        return LINGLONG_ERR("kill", errno);
+    }
+
+    return LINGLONG_OK;
+}
+
+auto ContainerRegistry::defaultDir() noexcept -> QDir
+{
+    return QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)
+      + "/linglong/containers";
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_CONTAINER_REGISTRY_H_
+#define LINGLONG_RUNTIME_CONTAINER_REGISTRY_H_
+
+#include "linglong/api/types/v1/ContainerRegistryEntry.hpp"
+#include "linglong/utils/error/error.h"
+
+#include <QDir>
+
+#include <vector>
+
+namespace linglong::runtime {
+
+// ContainerRegistry records the running containers started by linglong,
+// so that looking up a container does not need to ask the OCI runtime.
+//
+// Entries are stored as $XDG_RUNTIME_DIR/linglong/containers/<appID>/<containerID>.json,
+// they are added before a container starts and removed after it exits.
+// The PID of the container is written to the bundle by a createRuntime hook,
+// entries of containers which are not running anymore are removed on lookup.
+class ContainerRegistry
+{
+public:
+    explicit ContainerRegistry(const QDir &dir) noexcept;
+
+    // Return the hook which records the state of the container in its bundle,
+    // it should be added to the createRuntime hooks of the container.
+    [[nodiscard]] static auto stateHookArgs(const QString &bundle) noexcept
+      -> std::vector<std::string>;
+
+    auto add(const api::types::v1::ContainerRegistryEntry &entry) noexcept
+      -> utils::error::Result<void>;
+    void remove(const api::types::v1::ContainerRegistryEntry &entry) noexcept;
+
+    auto get(const QString &containerID) noexcept
+      -> utils::error::Result<api::types::v1::ContainerRegistryEntry>;
+    auto list(const QString &appID) noexcept -> std::vector<api::types::v1::ContainerRegistryEntry>;
+    auto list() noexcept -> std::vector<api::types::v1::ContainerRegistryEntry>;
+
+    // Find a container by its ID, its application ID or the prefix of its decoded ID.
+    auto find(const QString &pagoda) noexcept
+      -> utils::error::Result<api::types::v1::ContainerRegistryEntry>;
+
+    // Send signal to the init process of the container.
+    static auto kill(const api::types::v1::ContainerRegistryEntry &entry, int signal) noexcept
+      -> utils::error::Result<void>;
+
+    static auto defaultDir() noexcept -> QDir;
+
+private:
+    auto entryPath(const QString &appID, const QString &containerID) const noexcept -> QString;
+    auto load(const QString &path) noexcept
+      -> utils::error::Result<api::types::v1::ContainerRegistryEntry>;
+
+    QDir dir;
+};
+
+} // namespace linglong::runtime
+
+#endif
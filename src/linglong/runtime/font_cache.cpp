@@ -0,0 +1,347 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/font_cache.h"
+
+#include "linglong/runtime/oci_runtime.h"
+#include "linglong/utils/configure.h"
+#include "ocppi/runtime/RunOption.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QUuid>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+constexpr auto stampName = "linglong.stamp";
+// Directory of the caches in the container which runs fc-cache.
+constexpr auto containerCacheDir = "/run/fontconfig/cache";
+// Scanning a lot of fonts takes a while on slow disks.
+constexpr auto generateTimeout = 5 * 60 * 1000;
+
+// Resolve the path in the rootfs like chroot(2) does, absolute symbolic links point
+// into the rootfs instead of the host, e.g. /lib64/ld-linux-x86-64.so.2 of Debian.
+auto resolve(const QDir &rootfs, const QString &path) noexcept -> utils::error::Result<QString>
+{
+    LINGLONG_TRACE("resolve " + path + " in " + rootfs.absolutePath());
+
+    constexpr auto maxLinks = 40;
+    auto pending = path.split('/', Qt::SkipEmptyParts);
+    QStringList resolved;
+    int links = 0;
+    while (!pending.isEmpty()) {
+        auto component = pending.takeFirst();
+        if (component == ".") {
+            continue;
+        }
+        if (component == "..") {
+            if (!resolved.isEmpty()) {
+                resolved.removeLast();
+            }
+            continue;
+        }
+
+        resolved << component;
+        const auto current = rootfs.absolutePath() + "/" + resolved.join('/');
+        std::error_code ec;
+        if (!std::filesystem::is_symlink(current.toStdString(), ec)) {
+            continue;
+        }
+
+        if (++links > maxLinks) {
+            return LINGLONG_ERR("too many levels of symbolic links", ELOOP);
+        }
+        auto link = std::filesystem::read_symlink(current.toStdString(), ec);
+        if (ec) {
+            return LINGLONG_ERR("read symbolic link " + current, ec.value());
+        }
+        const auto target = QString::fromStdString(link.string());
+
+        resolved.removeLast();
+        if (target.startsWith('/')) {
+            resolved.clear();
+        }
+        pending = target.split('/', Qt::SkipEmptyParts) + pending;
+    }
+
+    return rootfs.absolutePath() + "/" + resolved.join('/');
+}
+
+// Caches are invalidated by the modification time of the directories of fonts,
+// the stamp changes whenever fontconfig would rescan a directory, or the base is updated.
+auto stamp(const QDir &baseDir) noexcept -> QByteArray
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray(LINGLONG_VERSION));
+
+    QFile info(baseDir.absoluteFilePath("info.json"));
+    if (info.open(QIODevice::ReadOnly)) {
+        hash.addData(info.readAll());
+    }
+    hash.addData(QByteArray::number(
+      QFileInfo(baseDir.absoluteFilePath("files")).lastModified().toMSecsSinceEpoch()));
+
+    for (const auto &fontDir : FontCache::fontDirs()) {
+        const QFileInfo top(fontDir);
+        if (!top.isDir()) {
+            continue;
+        }
+        hash.addData(fontDir.toUtf8());
+        hash.addData(QByteArray::number(top.lastModified().toMSecsSinceEpoch()));
+
+        QDirIterator it(fontDir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            hash.addData(it.next().toUtf8());
+            hash.addData(QByteArray::number(it.fileInfo().lastModified().toMSecsSinceEpoch()));
+        }
+    }
+
+    return hash.result().toHex();
+}
+
+} // namespace
+
+auto FontCache::fontDirs() noexcept -> QStringList
+{
+    // NOTE: Keep it in sync with the fonts mounted by the 90-legacy generator.
+    return { "/usr/share/fonts" };
+}
+
+auto FontCache::cacheDir(const QDir &baseDir) noexcept -> std::optional<QDir>
+{
+    const QDir layers(LINGLONG_ROOT "/layers");
+    const auto relative = layers.relativeFilePath(baseDir.absolutePath());
+    if (relative.isEmpty() || relative == "." || relative.startsWith("..")) {
+        return std::nullopt;
+    }
+
+    return QDir(LINGLONG_ROOT "/cache/fontconfig/" + relative);
+}
+
+auto FontCache::find(const QDir &baseDir) noexcept -> std::optional<QDir>
+{
+    auto dir = cacheDir(baseDir);
+    if (!dir || !dir->exists(stampName)) {
+        return std::nullopt;
+    }
+
+    return dir;
+}
+
+auto FontCache::generate(const QDir &baseDir) noexcept -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("generate font cache for " + baseDir.absolutePath());
+
+    auto dir = cacheDir(baseDir);
+    if (!dir) {
+        return LINGLONG_ERR("base is not installed in " LINGLONG_ROOT);
+    }
+
+    const auto currentStamp = stamp(baseDir);
+    QFile stampFile(dir->absoluteFilePath(stampName));
+    if (stampFile.open(QIODevice::ReadOnly) && stampFile.readAll() == currentStamp) {
+        return LINGLONG_OK;
+    }
+    stampFile.close();
+
+    const QDir rootfs = baseDir.absoluteFilePath("files");
+    QString fcCache;
+    for (const auto *path : { "/usr/bin/fc-cache", "/bin/fc-cache" }) {
+        auto resolved = resolve(rootfs, path);
+        if (resolved && QFileInfo(*resolved).isFile()) {
+            fcCache = path;
+            break;
+        }
+    }
+    if (fcCache.isEmpty()) {
+        return LINGLONG_ERR("fc-cache not found in base");
+    }
+
+    const auto parent = QFileInfo(dir->absolutePath()).absolutePath();
+    if (!QDir().mkpath(parent)) {
+        return LINGLONG_ERR("make directory " + parent);
+    }
+
+    QTemporaryDir generating(dir->absolutePath() + ".XXXXXX");
+    if (!generating.isValid()) {
+        return LINGLONG_ERR("create temporary directory: " + generating.errorString());
+    }
+
+    QTemporaryDir bundle(parent + "/bundle.XXXXXX");
+    if (!bundle.isValid()) {
+        return LINGLONG_ERR("create temporary directory: " + bundle.errorString());
+    }
+
+    QFile fontsConf(QDir(bundle.path()).absoluteFilePath("fonts.conf"));
+    if (!fontsConf.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(fontsConf);
+    }
+    fontsConf.write("<?xml version=\"1.0\"?>\n"
+                    "<!DOCTYPE fontconfig SYSTEM \"urn:fontconfig:fonts.dtd\">\n"
+                    "<fontconfig>\n");
+    for (const auto &fontDir : fontDirs()) {
+        fontsConf.write(("  <dir>" + fontDir.toHtmlEscaped() + "</dir>\n").toUtf8());
+    }
+    fontsConf.write(QByteArray("  <cachedir>") + containerCacheDir + "</cachedir>\n"
+                    + "</fontconfig>\n");
+    if (!fontsConf.flush()) {
+        return LINGLONG_ERR(fontsConf);
+    }
+    fontsConf.close();
+
+    // NOTE: The base is not trusted, anyone can install one. Its fc-cache is run in a
+    // container with the rootfs of the base and the fonts read only, no network and no
+    // privileges, only the directory of the new caches is writable.
+    nlohmann::json mounts = nlohmann::json::array({
+      { { "destination", "/proc" }, { "type", "proc" }, { "source", "proc" } },
+      { { "destination", "/dev" },
+        { "type", "tmpfs" },
+        { "source", "tmpfs" },
+        { "options", { "nosuid", "noexec", "mode=0755" } } },
+      { { "destination", "/tmp" },
+        { "type", "tmpfs" },
+        { "source", "tmpfs" },
+        { "options", { "nosuid", "nodev" } } },
+      { { "destination", "/run" },
+        { "type", "tmpfs" },
+        { "source", "tmpfs" },
+        { "options", { "nosuid", "nodev", "mode=0755" } } },
+      { { "destination", "/run/fontconfig/fonts.conf" },
+        { "type", "bind" },
+        { "source", fontsConf.fileName().toStdString() },
+        { "options", { "rbind", "ro", "nosuid", "nodev" } } },
+      { { "destination", containerCacheDir },
+        { "type", "bind" },
+        { "source", generating.path().toStdString() },
+        { "options", { "rbind", "rw", "nosuid", "nodev", "noexec" } } },
+    });
+    for (const auto &fontDir : fontDirs()) {
+        if (!QFileInfo(fontDir).isDir()) {
+            continue;
+        }
+        mounts.push_back({ { "destination", fontDir.toStdString() },
+                           { "type", "bind" },
+                           { "source", fontDir.toStdString() },
+                           { "options", { "rbind", "ro", "nosuid", "nodev", "noexec" } } });
+    }
+
+    auto namespaces = nlohmann::json::array();
+    for (const auto *type : { "pid", "mount", "ipc", "uts", "network", "user" }) {
+        namespaces.push_back({ { "type", type } });
+    }
+
+    const nlohmann::json config{
+        { "ociVersion", "1.0.1" },
+        { "hostname", "linglong" },
+        { "root", { { "path", rootfs.absolutePath().toStdString() }, { "readonly", true } } },
+        { "process",
+          {
+            { "args", { fcCache.toStdString(), "--system-only" } },
+            { "env", { "FONTCONFIG_FILE=/run/fontconfig/fonts.conf", "PATH=/usr/bin:/bin" } },
+            { "cwd", "/" },
+            { "user", { { "uid", ::getuid() }, { "gid", ::getgid() } } },
+            { "noNewPrivileges", true },
+          } },
+        { "mounts", std::move(mounts) },
+        { "linux",
+          {
+            { "namespaces", std::move(namespaces) },
+            { "uidMappings",
+              nlohmann::json::array({ nlohmann::json::object({
+                { "containerID", ::getuid() },
+                { "hostID", ::getuid() },
+                { "size", 1 },
+              }) }) },
+            { "gidMappings",
+              nlohmann::json::array({ nlohmann::json::object({
+                { "containerID", ::getgid() },
+                { "hostID", ::getgid() },
+                { "size", 1 },
+              }) }) },
+          } },
+    };
+
+    QFile configFile(QDir(bundle.path()).absoluteFilePath("config.json"));
+    if (!configFile.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(configFile);
+    }
+    configFile.write(QByteArray::fromStdString(config.dump()));
+    if (!configFile.flush()) {
+        return LINGLONG_ERR(configFile);
+    }
+    configFile.close();
+
+    auto runtime = newOCIRuntime();
+    if (!runtime) {
+        return LINGLONG_ERR(runtime);
+    }
+
+    // The state of the container is kept with the bundle, the package manager
+    // might have no runtime directory.
+    ocppi::runtime::RunOption option{};
+    option.root = QDir(bundle.path()).absoluteFilePath("state").toStdString();
+    option.timeout = std::chrono::milliseconds(generateTimeout);
+    const auto containerID =
+      "linglong-fc-cache-" + QUuid::createUuid().toString(QUuid::Id128).toStdString();
+    auto result = (*runtime)->run(containerID, bundle.path().toStdString(), option);
+    if (!result) {
+        return LINGLONG_ERR("run fc-cache", result);
+    }
+
+    // The stamp is written last, the caches are used only if it exists.
+    QFile newStamp(QDir(generating.path()).absoluteFilePath(stampName));
+    if (!newStamp.open(QIODevice::WriteOnly) || newStamp.write(currentStamp) == -1) {
+        return LINGLONG_ERR(newStamp);
+    }
+    newStamp.close();
+
+    // Containers of all users read the caches.
+    if (!QFile::setPermissions(generating.path(),
+                               QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner
+                                 | QFile::ReadGroup | QFile::ExeGroup | QFile::ReadOther
+                                 | QFile::ExeOther)) {
+        return LINGLONG_ERR("set permissions of " + generating.path());
+    }
+
+    // Replace the old caches atomically, they are removed with the temporary directory.
+    const auto from = generating.path().toLocal8Bit();
+    const auto to = dir->absolutePath().toLocal8Bit();
+    const unsigned int flags = dir->exists() ? RENAME_EXCHANGE : RENAME_NOREPLACE;
+    if (::renameat2(AT_FDCWD, from.constData(), AT_FDCWD, to.constData(), flags) == -1) {
+        return LINGLONG_ERR("rename " + generating.path(), errno);
+    }
+
+    return LINGLONG_OK;
+}
+
+void FontCache::remove(const QDir &baseDir) noexcept
+{
+    auto dir = cacheDir(baseDir);
+    if (!dir || !dir->exists()) {
+        return;
+    }
+
+    if (!dir->removeRecursively()) {
+        qWarning() << "failed to remove font cache" << dir->absolutePath();
+    }
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_FONT_CACHE_H_
+#define LINGLONG_RUNTIME_FONT_CACHE_H_
+
+#include "linglong/utils/error/error.h"
+
+#include <QDir>
+#include <QStringList>
+
+#include <optional>
+
+namespace linglong::runtime {
+
+// FontCache keeps the fontconfig caches of the host fonts for each base installed
+// in LINGLONG_ROOT. The format of the caches depends on the version of fontconfig,
+// so they are generated by the fc-cache of the base, the package manager does it
+// when a base is installed and when the fonts of the host change. Bases are not
+// trusted, fc-cache is run in a container by the OCI runtime.
+// The 90-legacy generator mounts the cache read only, so applications do not scan
+// the fonts at startup.
+class FontCache
+{
+public:
+    // Directories of the host fonts mounted into containers.
+    [[nodiscard]] static auto fontDirs() noexcept -> QStringList;
+
+    // Directory of the caches for the base in baseDir,
+    // nullopt if the base is not a layer in LINGLONG_ROOT.
+    [[nodiscard]] static auto cacheDir(const QDir &baseDir) noexcept -> std::optional<QDir>;
+
+    // Directory of the caches for the base in baseDir if they have been generated.
+    [[nodiscard]] static auto find(const QDir &baseDir) noexcept -> std::optional<QDir>;
+
+    // Generate the caches for the base in baseDir, nothing is done if they are up to date.
+    static auto generate(const QDir &baseDir) noexcept -> utils::error::Result<void>;
+
+    static void remove(const QDir &baseDir) noexcept;
+};
+
+} // namespace linglong::runtime
+
+#endif
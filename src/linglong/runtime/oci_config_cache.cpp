@@ -0,0 +1,311 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/oci_config_cache.h"
+
+#include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/font_cache.h"
+#include "linglong/utils/configure.h"
+#include "linglong/utils/serialize/json.h"
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <array>
+
+#include <unistd.h>
+#include <utime.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+// Environment variables read by the OCI configuration generators.
+constexpr std::array envNames{
+    "HOME",
+    "XDG_DATA_HOME",
+    "XDG_CONFIG_HOME",
+    "XDG_CACHE_HOME",
+    "XDG_STATE_HOME",
+    "XDG_RUNTIME_DIR",
+    "WAYLAND_DISPLAY",
+    "DISPLAY",
+    "XAUTHORITY",
+    "DBUS_SESSION_BUS_ADDRESS",
+    "DBUS_SYSTEM_BUS_ADDRESS",
+};
+
+// Host paths whose existence changes the mounts generated by the
+// OCI configuration generators.
+constexpr std::array hostPaths{
+    "/run/dbus/system_bus_socket",
+    "/etc/resolv.conf",
+    "/etc/resolvconf",
+    "/etc/localtime",
+    "/etc/machine-id",
+    "/etc/ssl/certs",
+    "/var/cache/fontconfig",
+    "/usr/share/fonts",
+    "/usr/lib/locale",
+    "/usr/share/themes",
+    "/usr/share/icons",
+    "/usr/share/zoneinfo",
+};
+
+constexpr auto maxEntries = 64;
+
+nlohmann::json fileStamp(const QFileInfo &info) noexcept
+{
+    if (!info.exists()) {
+        return nullptr;
+    }
+
+    return {
+        { "path", info.absoluteFilePath().toStdString() },
+        { "size", info.size() },
+        { "mtime", info.lastModified().toMSecsSinceEpoch() },
+        { "executable", info.isExecutable() },
+    };
+}
+
+QString envValue(const char *name) noexcept
+{
+    return QString::fromLocal8Bit(qgetenv(name));
+}
+
+// Paths derived from the environment and the application ID,
+// which are probed by the generators as well.
+QStringList userPaths(const QString &appID) noexcept
+{
+    QStringList paths;
+
+    const auto home = envValue("HOME");
+    if (!home.isEmpty()) {
+        paths << home + "/.linglong/" + appID;
+        paths << home + "/.Xauthority";
+    }
+
+    const auto runtimeDir = envValue("XDG_RUNTIME_DIR");
+    if (!runtimeDir.isEmpty()) {
+        paths << runtimeDir + "/dconf";
+        if (auto wayland = envValue("WAYLAND_DISPLAY"); !wayland.isEmpty()) {
+            paths << runtimeDir + "/" + wayland;
+        }
+    }
+
+    if (auto xauth = envValue("XAUTHORITY"); !xauth.isEmpty()) {
+        paths << xauth;
+    }
+
+    const QString sessionBusPrefix = "unix:path=";
+    if (auto sessionBus = envValue("DBUS_SESSION_BUS_ADDRESS");
+        sessionBus.startsWith(sessionBusPrefix)) {
+        paths << sessionBus.mid(sessionBusPrefix.length());
+    }
+
+    return paths;
+}
+
+// Files whose content is copied into the generated configuration.
+QStringList userContentFiles() noexcept
+{
+    const auto home = envValue("HOME");
+    if (home.isEmpty()) {
+        return {};
+    }
+
+    return { home + "/.config/user-dirs.dirs", home + "/.config/user-dirs.locale" };
+}
+
+nlohmann::json fileDigest(const QString &path) noexcept
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return nullptr;
+    }
+
+    return hash.result().toHex().toStdString();
+}
+
+// Device nodes are passed through by name, so the key depends on the listing.
+QStringList videoDevices() noexcept
+{
+    return QDir("/dev").entryList({ "video*", "nvidia*" },
+                                  QDir::System | QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                                  QDir::Name);
+}
+
+} // namespace
+
+OCIConfigCache::OCIConfigCache(const QDir &dir) noexcept
+    : dir(dir)
+{
+}
+
+auto OCIConfigCache::defaultDir() noexcept -> QDir
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+      + "/linglong/oci-config";
+}
+
+auto OCIConfigCache::key(const ContainerOptions &opts,
+                         const QString &containerConfigFilePath) const noexcept
+  -> utils::error::Result<QString>
+{
+    LINGLONG_TRACE("compute OCI configuration cache key");
+
+    if (opts.layerCommits.isEmpty()) {
+        return LINGLONG_ERR("layer commits unknown");
+    }
+
+    nlohmann::json inputs;
+    try {
+        inputs["version"] = LINGLONG_VERSION;
+        inputs["uid"] = ::getuid();
+        inputs["gid"] = ::getgid();
+        inputs["layers"] = nlohmann::json::array();
+        for (const auto &commit : opts.layerCommits) {
+            inputs["layers"].push_back(commit.toStdString());
+        }
+
+        const QFileInfo containerConfigFile(containerConfigFilePath);
+        inputs["config"] = fileStamp(containerConfigFile);
+
+        inputs["configD"] = nlohmann::json::array();
+        QDir configDotDDir = containerConfigFile.dir().filePath("config.d");
+        for (const auto &info : configDotDDir.entryInfoList(QDir::Files)) {
+            inputs["configD"].push_back(fileStamp(info));
+        }
+
+        inputs["application"] = fileStamp(
+          QStandardPaths::locate(QStandardPaths::ConfigLocation,
+                                 "linglong/" + opts.appID + "/config.yaml"));
+
+        inputs["options"] = {
+            { "appID", opts.appID.toStdString() },
+            { "baseDir", opts.baseDir.absolutePath().toStdString() },
+            { "runtimeDir",
+              opts.runtimeDir ? opts.runtimeDir->absolutePath().toStdString() : "" },
+            { "appDir", opts.appDir ? opts.appDir->absolutePath().toStdString() : "" },
+            { "patches", opts.patches },
+            { "mounts", opts.mounts },
+            { "masks", opts.masks },
+        };
+
+        for (const auto *name : envNames) {
+            inputs["env"][name] = envValue(name).toStdString();
+        }
+
+        for (const auto *path : hostPaths) {
+            inputs["host"][path] = QFileInfo::exists(path);
+        }
+        for (const auto &path : userPaths(opts.appID)) {
+            inputs["host"][path.toStdString()] = QFileInfo::exists(path);
+        }
+        for (const auto &path : userContentFiles()) {
+            inputs["content"][path.toStdString()] = fileDigest(path);
+        }
+        inputs["fontCache"] = FontCache::find(opts.baseDir).has_value();
+
+        inputs["devices"] = nlohmann::json::array();
+        for (const auto &device : videoDevices()) {
+            inputs["devices"].push_back(device.toStdString());
+        }
+    } catch (...) {
+        return LINGLONG_ERR("collect inputs", std::current_exception());
+    }
+
+    return QCryptographicHash::hash(QByteArray::fromStdString(inputs.dump()),
+                                    QCryptographicHash::Sha256)
+      .toHex();
+}
+
+auto OCIConfigCache::load(const QString &key) const noexcept
+  -> utils::error::Result<ocppi::runtime::config::types::Config>
+{
+    LINGLONG_TRACE("load cached OCI configuration " + key);
+
+    const auto path = this->dir.absoluteFilePath(key + ".json");
+    if (!QFileInfo::exists(path)) {
+        return LINGLONG_ERR("cache miss");
+    }
+
+    auto config = utils::serialize::LoadJSONFile<ocppi::runtime::config::types::Config>(path);
+    if (!config) {
+        return LINGLONG_ERR(config);
+    }
+
+    // Entries are pruned by modification time, touch it on every hit to keep the
+    // recently used ones.
+    ::utime(QFile::encodeName(path).constData(), nullptr);
+
+    // Directories created by generators might be removed after the entry is
+    // written, drop the entry instead of failing to start the container.
+    if (!config->mounts) {
+        return config;
+    }
+
+    for (const auto &mount : *config->mounts) {
+        if (mount.type.value_or("bind") != "bind" || !mount.source) {
+            continue;
+        }
+
+        if (!QFileInfo::exists(QString::fromStdString(*mount.source))) {
+            QFile::remove(path);
+            return LINGLONG_ERR("mount source " + QString::fromStdString(*mount.source)
+                                + " not exists");
+        }
+    }
+
+    return config;
+}
+
+auto OCIConfigCache::save(const QString &key,
+                          const ocppi::runtime::config::types::Config &config) noexcept
+  -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("save OCI configuration to cache " + key);
+
+    if (!this->dir.mkpath(".")) {
+        return LINGLONG_ERR("failed to create " + this->dir.absolutePath());
+    }
+
+    QSaveFile file(this->dir.absoluteFilePath(key + ".json"));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(file);
+    }
+
+    auto content = QByteArray::fromStdString(nlohmann::json(config).dump());
+    if (file.write(content) != content.size()) {
+        return LINGLONG_ERR(file);
+    }
+
+    if (!file.commit()) {
+        return LINGLONG_ERR(file);
+    }
+
+    this->prune();
+
+    return LINGLONG_OK;
+}
+
+void OCIConfigCache::prune() noexcept
+{
+    auto entries = this->dir.entryInfoList({ "*.json" }, QDir::Files, QDir::Time);
+    while (entries.size() > maxEntries) {
+        QFile::remove(entries.takeLast().absoluteFilePath());
+    }
+}
+
+} // namespace linglong::runtime
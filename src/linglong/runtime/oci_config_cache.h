@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_OCI_CONFIG_CACHE_H_
+#define LINGLONG_RUNTIME_OCI_CONFIG_CACHE_H_
+
+#include "linglong/utils/error/error.h"
+#include "ocppi/runtime/config/types/Config.hpp"
+
+#include <QDir>
+
+namespace linglong::runtime {
+
+struct ContainerOptions;
+
+// OCIConfigCache stores the OCI runtime configuration generated for a
+// container, so that a warm launch can skip the config.d patches and
+// generators entirely.
+//
+// Entries are content addressed: the key is a digest of everything the
+// generation depends on, which includes the layer commits, the config.d file
+// set, the application configuration, the relevant environment variables,
+// the host paths probed by the generators and the user. The least recently
+// used entries are dropped when there are too many of them.
+class OCIConfigCache
+{
+public:
+    explicit OCIConfigCache(const QDir &dir) noexcept;
+
+    // Return an error if the configuration generated from opts can not be cached.
+    [[nodiscard]] auto key(const ContainerOptions &opts,
+                           const QString &containerConfigFilePath) const noexcept
+      -> utils::error::Result<QString>;
+
+    [[nodiscard]] auto load(const QString &key) const noexcept
+      -> utils::error::Result<ocppi::runtime::config::types::Config>;
+
+    auto save(const QString &key, const ocppi::runtime::config::types::Config &config) noexcept
+      -> utils::error::Result<void>;
+
+    static auto defaultDir() noexcept -> QDir;
+
+private:
+    void prune() noexcept;
+
+    QDir dir;
+};
+
+} // namespace linglong::runtime
+
+#endif
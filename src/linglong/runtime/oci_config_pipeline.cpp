@@ -0,0 +1,297 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/oci_config_pipeline.h"
+
+#include "linglong/oci_cfg_generators/builtins.h"
+#include "linglong/oci_cfg_generators/plugin.h"
+#include "linglong/utils/configure.h"
+#include "linglong/utils/serialize/json.h"
+#include "linglong/utils/trace/trace.h"
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+#include <QLibrary>
+#include <QProcess>
+
+namespace linglong::runtime {
+
+namespace {
+
+// The files shipped in config.d only execute the wrapper of the builtin generator with the same
+// name, so the builtin can run in process instead. Files replaced by others run as they are.
+bool isBuiltinWrapper(const QFileInfo &info) noexcept
+{
+    QFile file(info.absoluteFilePath());
+    if (info.size() > 4096 || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const auto expected = QString("#!/bin/bash\n\nexec %1/%2 \"$@\"")
+                            .arg(LINGLONG_LIBEXEC_DIR, info.fileName());
+    return QString::fromUtf8(file.readAll()).trimmed() == expected;
+}
+
+} // namespace
+
+OCIConfigPipeline::OCIConfigPipeline(nlohmann::json config) noexcept
+    : config(std::move(config))
+{
+}
+
+void OCIConfigPipeline::addPatch(const api::types::v1::OciConfigurationPatch &patch) noexcept
+{
+    LINGLONG_TRACE(QString("apply oci runtime config patch %1")
+                     .arg(QString::fromStdString(nlohmann::json(patch).dump(-1, ' ', true))));
+
+    if (patch.ociVersion != this->config.value("ociVersion", "")) {
+        qWarning() << LINGLONG_ERRV("ociVersion mismatched");
+        Q_ASSERT(false);
+        return;
+    }
+
+    this->pending.push_back(patch);
+}
+
+void OCIConfigPipeline::addPatches(
+  const std::vector<api::types::v1::OciConfigurationPatch> &patches) noexcept
+{
+    for (const auto &patch : patches) {
+        this->addPatch(patch);
+    }
+}
+
+void OCIConfigPipeline::addFiles(const QFileInfoList &files) noexcept
+{
+    const auto &builtins = generator::builtinGenerators();
+
+    for (const auto &info : files) {
+        if (!info.isFile()) {
+            continue;
+        }
+
+        if (auto gen = builtins.find(info.fileName().toStdString()); gen != builtins.end()) {
+            if (isBuiltinWrapper(info)) {
+                this->runGenerator(*gen->second);
+                continue;
+            }
+            qInfo() << info.absoluteFilePath() << "overrides the builtin generator";
+        }
+
+        if (info.suffix() == "so") {
+            this->runPluginGenerator(info);
+            continue;
+        }
+
+        if (info.isExecutable()) {
+            this->runExecutableGenerator(info);
+            continue;
+        }
+
+        this->addPatchFile(info);
+    }
+}
+
+void OCIConfigPipeline::addPatchFile(const QFileInfo &info) noexcept
+{
+    LINGLONG_TRACE(QString("apply oci runtime config patch file %1").arg(info.absoluteFilePath()));
+
+    if (!info.absoluteFilePath().endsWith(".json")) {
+        qWarning() << LINGLONG_ERRV("file not ends with .json");
+        Q_ASSERT(false);
+        return;
+    }
+
+    auto patch = utils::serialize::LoadJSONFile<api::types::v1::OciConfigurationPatch>(
+      info.absoluteFilePath());
+    if (!patch) {
+        qWarning() << LINGLONG_ERRV(patch);
+        Q_ASSERT(false);
+        return;
+    }
+
+    this->addPatch(*patch);
+}
+
+void OCIConfigPipeline::flush() noexcept
+{
+    LINGLONG_TRACE("apply oci runtime config patches");
+
+    if (this->pending.empty()) {
+        return;
+    }
+
+    LINGLONG_SPAN("apply patches");
+
+    auto patches = std::move(this->pending);
+    this->pending.clear();
+
+    auto merged = nlohmann::json::array();
+    for (const auto &patch : patches) {
+        merged.insert(merged.end(), patch.patch.begin(), patch.patch.end());
+    }
+
+    try {
+        this->config = this->config.patch(merged);
+        return;
+    } catch (...) {
+        if (patches.size() == 1) {
+            qWarning() << LINGLONG_ERRV("skip patch", std::current_exception());
+            return;
+        }
+        qDebug() << LINGLONG_ERRV("apply merged patch", std::current_exception());
+    }
+
+    // Patches which can not be applied are skipped, the others still apply.
+    for (const auto &patch : patches) {
+        try {
+            this->config = this->config.patch(patch.patch);
+        } catch (...) {
+            qWarning() << LINGLONG_ERRV(
+              "skip patch " + QString::fromStdString(nlohmann::json(patch).dump()),
+              std::current_exception());
+        }
+    }
+}
+
+void OCIConfigPipeline::runGenerator(const generator::Generator &gen) noexcept
+{
+    LINGLONG_TRACE(QString("run builtin oci configuration generator %1")
+                     .arg(QString::fromUtf8(gen.name().data(), gen.name().size())));
+
+    this->flush();
+
+    utils::trace::Span span("run generator");
+    span.arg("name", QString::fromUtf8(gen.name().data(), gen.name().size()));
+    if (!gen.generate(this->config)) {
+        qCritical() << LINGLONG_ERRV("generator failed");
+        Q_ASSERT(false);
+        return;
+    }
+}
+
+void OCIConfigPipeline::runPluginGenerator(const QFileInfo &info) noexcept
+{
+    LINGLONG_TRACE(
+      QString("process oci configuration generator plugin %1").arg(info.absoluteFilePath()));
+
+    // NOTE: QLibrary keeps the shared object loaded after destruction,
+    // so the resolved symbol remains valid.
+    QLibrary library(info.absoluteFilePath());
+    library.setLoadHints(QLibrary::ResolveAllSymbolsHint);
+    const auto *plugin = reinterpret_cast<const LinglongOCICfgGeneratorV1 *>( // NOLINT
+      library.resolve(LINGLONG_OCI_CFG_GENERATOR_SYMBOL));
+    if (plugin == nullptr) {
+        qCritical() << LINGLONG_ERRV(library.errorString());
+        return;
+    }
+
+    if (plugin->abiVersion != LINGLONG_OCI_CFG_GENERATOR_ABI_VERSION) {
+        qCritical() << LINGLONG_ERRV("unsupported plugin ABI version", plugin->abiVersion);
+        return;
+    }
+
+    if (plugin->jsonVersion != LINGLONG_OCI_CFG_GENERATOR_JSON_VERSION) {
+        qCritical() << LINGLONG_ERRV("plugin is built with another nlohmann_json version",
+                                     plugin->jsonVersion);
+        return;
+    }
+
+    this->flush();
+
+    utils::trace::Span span("run generator");
+    span.arg("name", info.absoluteFilePath());
+    if (!plugin->generate(&this->config)) {
+        qCritical() << LINGLONG_ERRV("generator failed");
+        return;
+    }
+}
+
+void OCIConfigPipeline::runExecutableGenerator(const QFileInfo &info) noexcept
+{
+    LINGLONG_TRACE(QString("process oci configuration generator %1").arg(info.absoluteFilePath()));
+
+    this->flush();
+
+    utils::trace::Span span("run generator");
+    span.arg("name", info.absoluteFilePath());
+    QProcess generatorProcess;
+    generatorProcess.setProgram(info.absoluteFilePath());
+    generatorProcess.start();
+    generatorProcess.write(QByteArray::fromStdString(this->config.dump()));
+    generatorProcess.closeWriteChannel();
+
+    // Executable generators might be slow on a busy system,
+    // the timeout is configurable by LINGLONG_GENERATOR_TIMEOUT in milliseconds.
+    constexpr auto defaultTimeout = 5000;
+    bool ok = false;
+    auto timeout = qEnvironmentVariableIntValue("LINGLONG_GENERATOR_TIMEOUT", &ok);
+    if (!ok) {
+        timeout = defaultTimeout;
+    }
+
+    if (!generatorProcess.waitForFinished(timeout)) {
+        qCritical() << LINGLONG_ERRV(QString("not finished in %1ms: %2")
+                                       .arg(timeout)
+                                       .arg(generatorProcess.errorString()),
+                                     generatorProcess.error());
+        generatorProcess.kill();
+        generatorProcess.waitForFinished();
+        Q_ASSERT(false);
+        return;
+    }
+
+    if (generatorProcess.exitCode() != 0) {
+        qCritical() << LINGLONG_ERRV("exit with error", generatorProcess.exitCode());
+        qCritical() << "with input:" << this->config.dump().c_str();
+        Q_ASSERT(false);
+        return;
+    }
+
+    auto error = generatorProcess.readAllStandardError();
+    if (!error.isEmpty()) {
+        qWarning() << "generator" << info.absoluteFilePath() << "stderr:" << QString(error);
+    }
+
+    auto result = generatorProcess.readAllStandardOutput();
+    auto modified = utils::serialize::LoadJSON<nlohmann::json>(result);
+    if (!modified) {
+        qCritical() << LINGLONG_ERRV("parse stdout", modified);
+        Q_ASSERT(false);
+        return;
+    }
+
+    if (!modified->is_object()
+        || modified->value("ociVersion", "") != this->config.value("ociVersion", "")) {
+        qCritical() << LINGLONG_ERRV("invalid oci configuration in stdout");
+        Q_ASSERT(false);
+        return;
+    }
+
+    this->config = std::move(*modified);
+}
+
+auto OCIConfigPipeline::document() noexcept -> nlohmann::json &
+{
+    this->flush();
+    return this->config;
+}
+
+auto OCIConfigPipeline::finish() noexcept
+  -> utils::error::Result<ocppi::runtime::config::types::Config>
+{
+    LINGLONG_TRACE("convert oci configuration");
+    LINGLONG_SPAN("convert oci configuration");
+
+    auto config = utils::serialize::LoadJSON<ocppi::runtime::config::types::Config>(
+      this->document());
+    if (!config) {
+        return LINGLONG_ERR(config);
+    }
+
+    return config;
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,58 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_OCI_CONFIG_PIPELINE_H_
+#define LINGLONG_RUNTIME_OCI_CONFIG_PIPELINE_H_
+
+#include "linglong/api/types/v1/OciConfigurationPatch.hpp"
+#include "linglong/oci_cfg_generators/generator.h"
+#include "linglong/utils/error/error.h"
+#include "nlohmann/json.hpp"
+#include "ocppi/runtime/config/types/Config.hpp"
+
+#include <QFileInfo>
+
+namespace linglong::runtime {
+
+// OCIConfigPipeline applies OCI configuration patches and generators to a
+// single json document, which is converted to the typed configuration only
+// once by finish().
+//
+// Consecutive JSON patches are merged into one JSON patch and applied in one
+// pass right before the next generator runs or the document is read.
+// If the merged patch fails, the patches are applied one by one,
+// so that only the broken ones are ignored.
+class OCIConfigPipeline
+{
+public:
+    explicit OCIConfigPipeline(nlohmann::json config) noexcept;
+
+    void addPatch(const api::types::v1::OciConfigurationPatch &patch) noexcept;
+    void addPatches(const std::vector<api::types::v1::OciConfigurationPatch> &patches) noexcept;
+
+    // Apply files in config.d, which are JSON patch files or generators.
+    void addFiles(const QFileInfoList &files) noexcept;
+
+    void runGenerator(const generator::Generator &gen) noexcept;
+
+    // Get the json document with all added patches applied.
+    auto document() noexcept -> nlohmann::json &;
+
+    auto finish() noexcept -> utils::error::Result<ocppi::runtime::config::types::Config>;
+
+private:
+    void flush() noexcept;
+    void addPatchFile(const QFileInfo &info) noexcept;
+    void runPluginGenerator(const QFileInfo &info) noexcept;
+    void runExecutableGenerator(const QFileInfo &info) noexcept;
+
+    nlohmann::json config;
+    std::vector<api::types::v1::OciConfigurationPatch> pending;
+};
+
+} // namespace linglong::runtime
+
+#endif
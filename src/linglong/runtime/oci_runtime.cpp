@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/oci_runtime.h"
+
+#include "ocppi/cli/crun/Crun.hpp"
+
+#include <QStandardPaths>
+
+namespace linglong::runtime {
+
+auto newOCIRuntime() noexcept -> utils::error::Result<std::unique_ptr<ocppi::cli::CLI>>
+{
+    LINGLONG_TRACE("create OCI runtime");
+
+    auto path = QStandardPaths::findExecutable("crun");
+    if (path.isEmpty()) {
+        return LINGLONG_ERR("crun not found");
+    }
+
+    auto crun = ocppi::cli::crun::Crun::New(path.toStdString());
+    if (!crun) {
+        return LINGLONG_ERR("crun", crun.error());
+    }
+    return std::move(*crun);
+}
+
+} // namespace linglong::runtime
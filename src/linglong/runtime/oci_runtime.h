@@ -0,0 +1,22 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_OCI_RUNTIME_H_
+#define LINGLONG_RUNTIME_OCI_RUNTIME_H_
+
+#include "linglong/utils/error/error.h"
+#include "ocppi/cli/CLI.hpp"
+
+#include <memory>
+
+namespace linglong::runtime {
+
+// Create the OCI runtime, which executes crun found in PATH for every operation.
+auto newOCIRuntime() noexcept -> utils::error::Result<std::unique_ptr<ocppi::cli::CLI>>;
+
+} // namespace linglong::runtime
+
+#endif
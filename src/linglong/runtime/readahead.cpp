@@ -0,0 +1,350 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/readahead.h"
+
+#include "linglong/utils/finally/finally.h"
+#include "linglong/utils/serialize/json.h"
+#include "linglong/utils/trace/trace.h"
+
+#include <QDirIterator>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <functional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+constexpr auto profileVersion = 1;
+constexpr auto defaultRecordDuration = std::chrono::seconds(10);
+
+// Call func with the opened regular files in the layers until it returns false,
+// symbolic links are not followed.
+void forEachFile(const std::vector<QDir> &layers,
+                 const std::function<bool(const std::string &, int, off_t)> &func) noexcept
+{
+    for (const auto &layer : layers) {
+        QDirIterator it(layer.absolutePath(),
+                        QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const auto path = it.next().toStdString();
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+            if (fd == -1) {
+                continue;
+            }
+            auto closeFile = utils::finally::finally([fd] {
+                ::close(fd);
+            });
+
+            struct stat info{};
+            if (::fstat(fd, &info) == -1 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+                continue;
+            }
+
+            if (!func(path, fd, info.st_size)) {
+                return;
+            }
+        }
+    }
+}
+
+// Pages of the file in the page cache, empty if they are unknown.
+auto filePages(int fd, off_t size) noexcept -> std::vector<bool>
+{
+    static const auto pageSize = ::sysconf(_SC_PAGESIZE);
+
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        return {};
+    }
+    auto unmap = utils::finally::finally([addr, size] {
+        ::munmap(addr, size);
+    });
+
+    std::vector<unsigned char> vec((size + pageSize - 1) / pageSize);
+    if (::mincore(addr, size, vec.data()) == -1) {
+        return {};
+    }
+
+    std::vector<bool> pages(vec.size());
+    for (std::size_t i = 0; i < vec.size(); ++i) {
+        pages[i] = (vec[i] & 1) != 0;
+    }
+    return pages;
+}
+
+} // namespace
+
+auto Readahead::enabled() noexcept -> bool
+{
+    return qgetenv("LINGLONG_READAHEAD") != "0";
+}
+
+auto Readahead::defaultDir() noexcept -> QDir
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+      + "/linglong/readahead";
+}
+
+Readahead::Readahead(QString profile,
+                     std::vector<QDir> layers,
+                     std::vector<QDir> sharedLayers) noexcept
+    : profile(std::move(profile))
+    , layers(std::move(layers))
+    , sharedLayers(std::move(sharedLayers))
+    , recordDuration(defaultRecordDuration)
+{
+    bool ok = false;
+    auto duration = qEnvironmentVariableIntValue("LINGLONG_READAHEAD_DURATION", &ok);
+    if (ok && duration > 0) {
+        this->recordDuration = std::chrono::seconds(duration);
+    }
+}
+
+Readahead::~Readahead()
+{
+    this->applicationExited();
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+}
+
+void Readahead::start(bool record) noexcept
+{
+    Q_ASSERT(!this->worker.joinable());
+
+    if (QFileInfo::exists(this->profile)) {
+        auto profile = utils::serialize::LoadJSONFile<nlohmann::json>(this->profile);
+        if (profile && profile->value("version", 0) == profileVersion) {
+            this->worker = std::thread([this, profile = std::move(*profile)] {
+                this->replay(profile);
+            });
+            return;
+        }
+
+        qWarning() << "drop invalid readahead profile" << this->profile;
+        QFile::remove(this->profile);
+    }
+
+    if (!record) {
+        qDebug() << "readahead profile" << this->profile << "is recorded on a later launch";
+        return;
+    }
+
+    this->recording = true;
+    this->worker = std::thread([this] {
+        this->record();
+    });
+}
+
+auto Readahead::waitPrepared(std::chrono::milliseconds timeout) noexcept -> bool
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    return this->recording && this->cv.wait_for(lock, timeout, [this] {
+        return this->prepared;
+    });
+}
+
+void Readahead::applicationStarting() noexcept
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->starting = true;
+    this->cv.notify_all();
+}
+
+void Readahead::applicationExited() noexcept
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->exited = true;
+    this->cv.notify_all();
+}
+
+auto Readahead::residentPages(const std::vector<QDir> &layers, const Pages &baseline) noexcept
+  -> nlohmann::json
+{
+    const auto pageSize = ::sysconf(_SC_PAGESIZE);
+    auto files = nlohmann::json::object();
+
+    forEachFile(layers, [&](const std::string &path, int fd, off_t size) {
+        auto pages = filePages(fd, size);
+        if (auto old = baseline.find(path); old != baseline.end()) {
+            for (std::size_t i = 0; i < pages.size() && i < old->second.size(); ++i) {
+                pages[i] = pages[i] && !old->second[i];
+            }
+        }
+
+        // Adjacent resident pages are merged into a range.
+        auto ranges = nlohmann::json::array();
+        std::size_t begin = 0;
+        while (begin < pages.size()) {
+            if (!pages[begin]) {
+                ++begin;
+                continue;
+            }
+
+            auto end = begin + 1;
+            while (end < pages.size() && pages[end]) {
+                ++end;
+            }
+            ranges.push_back({ begin * pageSize, (end - begin) * pageSize });
+            begin = end;
+        }
+
+        if (!ranges.empty()) {
+            files[path] = std::move(ranges);
+        }
+        return true;
+    });
+
+    return files;
+}
+
+void Readahead::replay(const nlohmann::json &profile) noexcept
+{
+    LINGLONG_TRACE("read ahead by profile " + this->profile);
+    LINGLONG_SPAN("readahead");
+
+    try {
+        const auto &files = profile.at("files");
+        for (auto file = files.begin(); file != files.end(); ++file) {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (this->exited) {
+                    return;
+                }
+            }
+
+            int fd = ::open(file.key().c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1) {
+                continue;
+            }
+            auto closeFile = utils::finally::finally([fd] {
+                ::close(fd);
+            });
+
+            // NOTE: POSIX_FADV_WILLNEED starts reading without waiting for the pages.
+            for (const auto &range : file.value()) {
+                ::posix_fadvise(fd,
+                                range.at(0).get<off_t>(),
+                                range.at(1).get<off_t>(),
+                                POSIX_FADV_WILLNEED);
+            }
+        }
+    } catch (...) {
+        qWarning() << LINGLONG_ERRV("invalid profile", std::current_exception());
+    }
+}
+
+void Readahead::record() noexcept
+{
+    auto launched = [this] {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->starting || this->exited;
+    };
+
+    // NOTE: Preparing stops as soon as the application starts, pages it has
+    // read may be dropped or taken as the baseline otherwise.
+    bool interrupted = false;
+    Pages baseline;
+    {
+        LINGLONG_SPAN("prepare to record readahead profile");
+        forEachFile(this->layers, [&](const std::string & /*path*/, int fd, off_t /*size*/) {
+            interrupted = launched();
+            if (!interrupted) {
+                ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            }
+            return !interrupted;
+        });
+
+        if (!interrupted) {
+            forEachFile(this->sharedLayers, [&](const std::string &path, int fd, off_t size) {
+                interrupted = launched();
+                if (!interrupted) {
+                    baseline[path] = filePages(fd, size);
+                }
+                return !interrupted;
+            });
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (interrupted) {
+            this->recording = false;
+            this->cv.notify_all();
+            qDebug() << "application started before readahead profile" << this->profile
+                     << "is prepared, record it on a later launch";
+            return;
+        }
+
+        this->prepared = true;
+        this->cv.notify_all();
+        this->cv.wait(lock, [this] {
+            return this->starting || this->exited;
+        });
+        if (!this->starting) {
+            return;
+        }
+
+        this->cv.wait_for(lock, this->recordDuration, [this] {
+            return this->exited;
+        });
+    }
+
+    LINGLONG_SPAN("record readahead profile");
+    auto files = residentPages(this->layers);
+    files.update(residentPages(this->sharedLayers, baseline));
+    auto result = this->save({
+      { "version", profileVersion },
+      { "files", std::move(files) },
+    });
+    if (!result) {
+        qWarning() << result.error();
+    }
+}
+
+auto Readahead::save(const nlohmann::json &profile) noexcept -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("save readahead profile " + this->profile);
+
+    QDir dir = QFileInfo(this->profile).dir();
+    if (!dir.mkpath(".")) {
+        return LINGLONG_ERR("failed to create " + dir.absolutePath());
+    }
+
+    QSaveFile file(this->profile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR(file);
+    }
+
+    auto content = QByteArray::fromStdString(profile.dump());
+    if (file.write(content) != content.size()) {
+        return LINGLONG_ERR(file);
+    }
+
+    if (!file.commit()) {
+        return LINGLONG_ERR(file);
+    }
+
+    // Profiles of upgraded layers are never used again.
+    constexpr auto maxEntries = 64;
+    auto entries = dir.entryInfoList({ "*.json" }, QDir::Files, QDir::Time);
+    while (entries.size() > maxEntries) {
+        QFile::remove(entries.takeLast().absoluteFilePath());
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_READAHEAD_H_
+#define LINGLONG_RUNTIME_READAHEAD_H_
+
+#include "linglong/utils/error/error.h"
+
+#include <nlohmann/json.hpp>
+
+#include <QDir>
+#include <QString>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace linglong::runtime {
+
+// Readahead records the pages of the layer files an application has read
+// in the first seconds after it started, and reads them ahead on its
+// later launches, in parallel with setting up the container.
+//
+// A profile is recorded by checking which pages are in the page cache by
+// mincore(2) after the application has run for a while. Pages of the layers
+// private to the application are dropped from the page cache beforehand, so
+// all pages it reads are recorded. Pages of the shared layers are kept for
+// other applications, only the ones read after the recording is prepared are
+// recorded. Profiles are keyed by the layer commits, so upgrading any layer
+// records a new one.
+//
+// The launch never waits for the recording. If the application starts before
+// the recording is prepared, no profile is recorded and a later launch retries.
+// Pages of an application which is running already are used by the running
+// instance, they are not dropped and no profile is recorded then either.
+class Readahead
+{
+public:
+    // Pages in the page cache of the files, indexed by path.
+    using Pages = std::map<std::string, std::vector<bool>>;
+
+    // Readahead is disabled by LINGLONG_READAHEAD=0.
+    [[nodiscard]] static auto enabled() noexcept -> bool;
+
+    static auto defaultDir() noexcept -> QDir;
+
+    // profile is the file to load the profile from or save it to,
+    // layers and sharedLayers are the directories of the files in the profile,
+    // the files of sharedLayers are also used by other applications.
+    Readahead(QString profile,
+              std::vector<QDir> layers,
+              std::vector<QDir> sharedLayers = {}) noexcept;
+    Readahead(const Readahead &) = delete;
+    Readahead(Readahead &&) = delete;
+    auto operator=(const Readahead &) -> Readahead & = delete;
+    auto operator=(Readahead &&) -> Readahead & = delete;
+    ~Readahead();
+
+    // Read the pages in the profile ahead in background,
+    // or prepare to record a profile if there is none and record is true.
+    void start(bool record = true) noexcept;
+
+    // Wait until the recording is prepared, false if there is nothing to record
+    // or it is not prepared in time.
+    [[nodiscard]] auto waitPrepared(std::chrono::milliseconds timeout) noexcept -> bool;
+
+    // The profile is recorded after the application has run for a while.
+    void applicationStarting() noexcept;
+
+    // Record the profile now if the application exited early.
+    void applicationExited() noexcept;
+
+    // Pages of the files in the page cache except the ones in baseline,
+    // in ranges of [offset, length].
+    [[nodiscard]] static auto residentPages(const std::vector<QDir> &layers,
+                                            const Pages &baseline = {}) noexcept
+      -> nlohmann::json;
+
+private:
+    void replay(const nlohmann::json &profile) noexcept;
+    void record() noexcept;
+    auto save(const nlohmann::json &profile) noexcept -> utils::error::Result<void>;
+
+    QString profile;
+    std::vector<QDir> layers;
+    std::vector<QDir> sharedLayers;
+    std::chrono::seconds recordDuration;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool recording{ false };
+    bool prepared{ false };
+    bool starting{ false };
+    bool exited{ false };
+    std::thread worker;
+};
+
+} // namespace linglong::runtime
+
+#endif
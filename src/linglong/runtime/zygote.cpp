@@ -0,0 +1,376 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/runtime/zygote.h"
+
+#include "linglong/utils/configure.h"
+#include "linglong/utils/finally/finally.h"
+#include "linglong/utils/serialize/json.h"
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <set>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+constexpr auto hostRootfs = "/run/host/rootfs";
+constexpr auto socketDir = "/run/linglong/zygote";
+constexpr auto socketName = "zygote.sock";
+constexpr auto requestFile = "zygote-request.json";
+constexpr std::size_t maxMessageSize = 64 * 1024;
+constexpr int stdioCount = 3;
+// The zygote replies in milliseconds, do not keep the user waiting if it is stuck.
+constexpr int startTimeout = 5000;
+
+auto isBind(const ocppi::runtime::config::types::Mount &mount) noexcept -> bool
+{
+    if (mount.type == "bind") {
+        return true;
+    }
+
+    if (!mount.options) {
+        return false;
+    }
+
+    return std::any_of(mount.options->begin(), mount.options->end(), [](const auto &option) {
+        return option == "bind" || option == "rbind";
+    });
+}
+
+auto hasCapabilities(const ocppi::runtime::config::types::Capabilities &capabilities) noexcept
+  -> bool
+{
+    for (const auto &set : { capabilities.ambient,
+                             capabilities.bounding,
+                             capabilities.effective,
+                             capabilities.inheritable,
+                             capabilities.permitted }) {
+        if (set && !set->empty()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Bundles of containers on the host, see Container::run.
+auto bundlesDir() noexcept -> QDir
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation))
+      .absoluteFilePath("linglong");
+}
+
+auto newToken() noexcept -> QString
+{
+    quint32 token[4];
+    QRandomGenerator::system()->fillRange(token);
+    return QString::fromLatin1(
+      QByteArray(reinterpret_cast<const char *>(token), sizeof(token)).toHex()); // NOLINT
+}
+
+} // namespace
+
+auto Zygote::enabled() noexcept -> bool
+{
+    return qgetenv("LINGLONG_ZYGOTE") == "1";
+}
+
+auto Zygote::containerID(const QStringList &layerCommits) noexcept -> QString
+{
+    // NOTE: The path of the socket in the bundle is limited to 108 bytes.
+    constexpr auto keyLength = 16;
+    auto key = QCryptographicHash::hash(layerCommits.join("\n").toUtf8(),
+                                        QCryptographicHash::Sha256)
+                 .toHex()
+                 .left(keyLength);
+    return "zygote-" + QString(key);
+}
+
+auto Zygote::serverProcess() noexcept -> ocppi::runtime::config::types::Process
+{
+    std::vector<std::string> args{
+        std::string(hostRootfs) + LINGLONG_LIBEXEC_DIR "/ll-zygote",
+        std::string(socketDir) + "/" + socketName,
+        hostRootfs + bundlesDir().absolutePath().toStdString(),
+    };
+    if (auto idleTimeout = qgetenv("LINGLONG_ZYGOTE_IDLE_TIMEOUT"); !idleTimeout.isEmpty()) {
+        args.push_back(idleTimeout.toStdString());
+    }
+
+    // ll-zygote needs CAP_SYS_ADMIN in the user namespace of the container
+    // to create mount namespaces for the applications,
+    // and CAP_SETPCAP to drop the bounding set before executing them.
+    const std::vector<std::string> capabilities{ "CAP_SETPCAP", "CAP_SYS_ADMIN" };
+
+    return {
+        .args = args,
+        .capabilities =
+          ocppi::runtime::config::types::Capabilities{
+            .ambient = capabilities,
+            .bounding = capabilities,
+            .effective = capabilities,
+            .inheritable = capabilities,
+            .permitted = capabilities,
+          },
+        .cwd = "/",
+    };
+}
+
+auto Zygote::serverMounts(const QDir &bundle) noexcept
+  -> std::vector<ocppi::runtime::config::types::Mount>
+{
+    return {
+        {
+          .destination = socketDir,
+          .options = { { "rbind" } },
+          .source = bundle.absoluteFilePath("zygote").toStdString(),
+          .type = "bind",
+        },
+        // Applications mount their own tmpfs on /opt/apps,
+        // the mount point can not be created on the read only base.
+        {
+          .destination = "/opt/apps",
+          .options = { { "nodev", "nosuid", "mode=755" } },
+          .source = "tmpfs",
+          .type = "tmpfs",
+        },
+    };
+}
+
+auto Zygote::request(const ocppi::runtime::config::types::Config &zygoteConfig,
+                     const ocppi::runtime::config::types::Config &config) noexcept
+  -> utils::error::Result<nlohmann::json>
+{
+    LINGLONG_TRACE("build zygote request");
+
+    if (!config.process || !config.process->args || config.process->args->empty()) {
+        return LINGLONG_ERR("no command to run");
+    }
+
+    // The zygote can not load security profiles, and processes launched in it have no
+    // capabilities, such applications are launched in new containers by the OCI runtime.
+    const auto &process = *config.process;
+    if (config.linux && config.linux->seccomp) {
+        return LINGLONG_ERR("seccomp is not supported in zygotes", ENOTSUP);
+    }
+    if (process.apparmorProfile && !process.apparmorProfile->empty()) {
+        return LINGLONG_ERR("apparmor profile is not supported in zygotes", ENOTSUP);
+    }
+    if (process.selinuxLabel && !process.selinuxLabel->empty()) {
+        return LINGLONG_ERR("selinux label is not supported in zygotes", ENOTSUP);
+    }
+    if (process.capabilities && hasCapabilities(*process.capabilities)) {
+        return LINGLONG_ERR("capabilities are not supported in zygotes", ENOTSUP);
+    }
+
+    std::set<std::string> zygoteMounts;
+    if (zygoteConfig.mounts) {
+        for (const auto &mount : *zygoteConfig.mounts) {
+            zygoteMounts.insert(nlohmann::json(mount).dump());
+        }
+    }
+
+    // NOTE: Mounts are done in the order of the configuration,
+    // the ones already done in the zygote are skipped.
+    auto mounts = nlohmann::json::array();
+    for (auto mount : config.mounts.value_or(std::vector<ocppi::runtime::config::types::Mount>{})) {
+        if (zygoteMounts.count(nlohmann::json(mount).dump()) != 0) {
+            continue;
+        }
+
+        // Paths on the host are accessed through the rootfs of the host in the zygote.
+        if (isBind(mount) && mount.source) {
+            mount.source = hostRootfs + *mount.source;
+        }
+        mounts.push_back(mount);
+    }
+
+    // The process is set up like a cold launch does, see process of the OCI runtime spec.
+    return nlohmann::json{
+        { "args", *config.process->args },
+        { "env", config.process->env.value_or(std::vector<std::string>{}) },
+        { "cwd", config.process->cwd.empty() ? "/" : config.process->cwd },
+        { "mounts", std::move(mounts) },
+        { "rlimits",
+          config.process->rlimits.value_or(std::vector<ocppi::runtime::config::types::Rlimit>{}) },
+        { "noNewPrivileges", config.process->noNewPrivileges.value_or(false) },
+        { "maskedPaths",
+          config.linux ? config.linux->maskedPaths.value_or(std::vector<std::string>{})
+                       : std::vector<std::string>{} },
+        { "readonlyPaths",
+          config.linux ? config.linux->readonlyPaths.value_or(std::vector<std::string>{})
+                       : std::vector<std::string>{} },
+    };
+}
+
+Zygote::Zygote(const api::types::v1::ContainerRegistryEntry &entry) noexcept
+    : bundle(QString::fromStdString(entry.bundle))
+{
+}
+
+auto Zygote::spawn(const QDir &bundle,
+                   const ocppi::runtime::config::types::Config &config,
+                   const std::function<void(pid_t)> &started) noexcept -> utils::error::Result<int>
+{
+    LINGLONG_TRACE("launch process in zygote " + this->bundle.dirName());
+
+    auto zygoteConfig = utils::serialize::LoadJSONFile<ocppi::runtime::config::types::Config>(
+      this->bundle.absoluteFilePath("config.json"));
+    if (!zygoteConfig) {
+        return LINGLONG_ERR(zygoteConfig);
+    }
+
+    auto req = request(*zygoteConfig, config);
+    if (!req) {
+        return LINGLONG_ERR(req);
+    }
+
+    // The zygote only accepts the request from the bundle of the application,
+    // which is written by us and invisible to containers.
+    const auto token = newToken();
+    (*req)["token"] = token.toStdString();
+    QFile requestJSON(bundle.absoluteFilePath(requestFile));
+    if (!requestJSON.open(QIODevice::WriteOnly)
+        || !requestJSON.setPermissions(QFile::ReadOwner | QFile::WriteOwner)
+        || requestJSON.write(QByteArray::fromStdString(req->dump())) == -1) {
+        return LINGLONG_ERR(requestJSON);
+    }
+    requestJSON.close();
+    auto removeRequest = utils::finally::finally([&requestJSON] {
+        requestJSON.remove();
+    });
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    const auto socketPath =
+      this->bundle.absoluteFilePath(QString("zygote/") + socketName).toStdString();
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        return LINGLONG_ERR("socket path is too long: " + QString::fromStdString(socketPath));
+    }
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return LINGLONG_ERR("socket", errno);
+    }
+    auto closeSocket = utils::finally::finally([fd] {
+        ::close(fd);
+    });
+
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) { // NOLINT
+        return LINGLONG_ERR("connect", errno);
+    }
+
+    // Receive the PID of the process, which is translated to our PID namespace.
+    int enable = 1;
+    if (::setsockopt(fd, SOL_SOCKET, SO_PASSCRED, &enable, sizeof(enable)) == -1) {
+        return LINGLONG_ERR("setsockopt", errno);
+    }
+
+    auto content = nlohmann::json{
+        { "bundle", bundlesDir().relativeFilePath(bundle.absolutePath()).toStdString() },
+        { "token", token.toStdString() },
+    }.dump();
+    iovec iov{ content.data(), content.size() };
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * stdioCount)]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    auto *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * stdioCount);
+    const int stdio[stdioCount]{ STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    std::memcpy(CMSG_DATA(cmsg), stdio, sizeof(stdio));
+
+    if (::sendmsg(fd, &msg, MSG_NOSIGNAL) == -1) {
+        return LINGLONG_ERR("sendmsg", errno);
+    }
+
+    bool isStarted = false;
+    std::string buffer(maxMessageSize, '\0');
+    while (true) {
+        if (!isStarted) {
+            pollfd pfd{ fd, POLLIN, 0 };
+            auto ret = ::poll(&pfd, 1, startTimeout);
+            if (ret == -1 && errno == EINTR) {
+                continue;
+            }
+            if (ret == -1) {
+                return LINGLONG_ERR("poll", errno);
+            }
+            if (ret == 0) {
+                return LINGLONG_ERR("zygote does not reply", ETIMEDOUT);
+            }
+        }
+
+        iovec replyIov{ buffer.data(), buffer.size() };
+        alignas(cmsghdr) char replyControl[CMSG_SPACE(sizeof(ucred))]{};
+        msghdr reply{};
+        reply.msg_iov = &replyIov;
+        reply.msg_iovlen = 1;
+        reply.msg_control = replyControl;
+        reply.msg_controllen = sizeof(replyControl);
+
+        auto size = ::recvmsg(fd, &reply, 0);
+        if (size == -1 && errno == EINTR) {
+            continue;
+        }
+        if (size == -1) {
+            return LINGLONG_ERR("recvmsg", errno);
+        }
+        if (size == 0) {
+            return LINGLONG_ERR("zygote exited");
+        }
+
+        auto message =
+          utils::serialize::LoadJSON<nlohmann::json>(QByteArray(buffer.data(), size));
+        if (!message) {
+            return LINGLONG_ERR(message);
+        }
+
+        if (message->contains("error")) {
+            return LINGLONG_ERR(QString::fromStdString(message->at("error").get<std::string>()));
+        }
+
+        if (message->contains("exit")) {
+            return message->at("exit").get<int>();
+        }
+
+        if (!message->contains("started")) {
+            continue;
+        }
+
+        auto *credentials = CMSG_FIRSTHDR(&reply);
+        if (credentials == nullptr || credentials->cmsg_type != SCM_CREDENTIALS) {
+            return LINGLONG_ERR("PID of the process is unknown");
+        }
+
+        ucred cred{};
+        std::memcpy(&cred, CMSG_DATA(credentials), sizeof(cred));
+        isStarted = true;
+        started(cred.pid);
+    }
+}
+
+} // namespace linglong::runtime
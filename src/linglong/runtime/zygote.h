@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_RUNTIME_ZYGOTE_H_
+#define LINGLONG_RUNTIME_ZYGOTE_H_
+
+#include "linglong/api/types/v1/ContainerRegistryEntry.hpp"
+#include "linglong/utils/error/error.h"
+#include "ocppi/runtime/config/types/Config.hpp"
+#include "ocppi/runtime/config/types/Mount.hpp"
+#include "ocppi/runtime/config/types/Process.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <QDir>
+#include <QStringList>
+
+#include <functional>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace linglong::runtime {
+
+// Zygote is a container of a base and a runtime started in advance,
+// its init process ll-zygote launches applications on request.
+// The mounts of the application missing in the zygote are done by a child of ll-zygote
+// in a new mount namespace, so launching an application in a zygote skips creating
+// the namespaces, mounting the layers and running the hooks of a container.
+//
+// Zygotes are opt-in by LINGLONG_ZYGOTE=1, they are recorded in the container registry
+// and exit after being idle for a while or under memory pressure.
+//
+// Only ll-cli can launch applications in a zygote, the applications can not reach it.
+class Zygote
+{
+public:
+    // Application ID of zygote containers in the container registry.
+    static constexpr auto appID = "org.deepin.linglong.zygote";
+
+    [[nodiscard]] static auto enabled() noexcept -> bool;
+
+    // Container ID of the zygote for the commits of the runtime and the base.
+    [[nodiscard]] static auto containerID(const QStringList &layerCommits) noexcept -> QString;
+
+    // Process and extra mounts of the zygote container.
+    [[nodiscard]] static auto serverProcess() noexcept -> ocppi::runtime::config::types::Process;
+    [[nodiscard]] static auto serverMounts(const QDir &bundle) noexcept
+      -> std::vector<ocppi::runtime::config::types::Mount>;
+
+    // Build the request to launch the process of config in the zygote running with zygoteConfig.
+    [[nodiscard]] static auto request(const ocppi::runtime::config::types::Config &zygoteConfig,
+                                      const ocppi::runtime::config::types::Config &config) noexcept
+      -> utils::error::Result<nlohmann::json>;
+
+    explicit Zygote(const api::types::v1::ContainerRegistryEntry &entry) noexcept;
+
+    // Launch the process of config in the zygote and wait for it,
+    // the request is passed through bundle, the bundle directory of the application.
+    // started is called with the PID of the process before it is executed,
+    // the exit code of the process is returned.
+    auto spawn(const QDir &bundle,
+               const ocppi::runtime::config::types::Config &config,
+               const std::function<void(pid_t)> &started) noexcept -> utils::error::Result<int>;
+
+private:
+    QDir bundle;
+};
+
+} // namespace linglong::runtime
+
+#endif
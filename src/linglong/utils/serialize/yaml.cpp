@@ -5,3 +5,149 @@
  */
 
 #include "linglong/utils/serialize/yaml.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <sys/stat.h>
+
+namespace linglong::utils::serialize {
+
+namespace {
+
+constexpr auto cacheVersion = 1;
+constexpr auto maxEntries = 256;
+// A file modified again in the granularity of the timestamps of the
+// filesystem might keep the same size and modification time,
+// so files modified recently are not cached.
+constexpr auto racyInterval = std::chrono::seconds(2);
+
+auto cacheDir() noexcept -> QDir
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+      + "/linglong/yaml";
+}
+
+// Identity of the content of the file, which changes if the file is modified or replaced.
+auto fileIdentity(const QString &filename) noexcept -> std::optional<nlohmann::json>
+{
+    struct stat info{};
+    if (::stat(filename.toLocal8Bit().constData(), &info) != 0) {
+        return std::nullopt;
+    }
+
+    auto mtime = std::chrono::seconds(info.st_mtim.tv_sec)
+      + std::chrono::nanoseconds(info.st_mtim.tv_nsec);
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    if (now - mtime < racyInterval) {
+        return std::nullopt;
+    }
+
+    return nlohmann::json{
+        { "version", cacheVersion },
+        { "path", filename.toStdString() },
+        { "inode", info.st_ino },
+        { "size", info.st_size },
+        { "mtime", std::chrono::duration_cast<std::chrono::nanoseconds>(mtime).count() },
+    };
+}
+
+auto parseYAMLFile(const QString &filename) noexcept -> error::Result<nlohmann::json>
+{
+    LINGLONG_TRACE("parse yaml file " + filename);
+
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) {
+        return LINGLONG_ERR("open", file);
+    }
+
+    auto content = file.readAll();
+    if (file.error() != QFile::NoError) {
+        return LINGLONG_ERR("read all", file);
+    }
+
+    try {
+        return ytj::to_json(YAML::Load(content.toStdString()));
+    } catch (...) {
+        return LINGLONG_ERR(std::current_exception());
+    }
+}
+
+} // namespace
+
+auto LoadYAMLFileAsJSON(const QString &filename) noexcept -> error::Result<nlohmann::json>
+{
+    LINGLONG_TRACE("load yaml from file " + filename);
+
+    const auto path = QFileInfo(filename).absoluteFilePath();
+    auto identity = fileIdentity(path);
+    if (!identity) {
+        return parseYAMLFile(path);
+    }
+
+    const QDir dir = cacheDir();
+    const auto key =
+      QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha256).toHex();
+    const auto cachePath = dir.absoluteFilePath(key + ".cbor");
+
+    if (QFile cached(cachePath); cached.open(QIODevice::ReadOnly)) {
+        auto content = cached.readAll();
+        try {
+            auto entry = nlohmann::json::from_cbor(content.cbegin(), content.cend());
+            if (entry.at("identity") == *identity) {
+                return std::move(entry.at("json"));
+            }
+        } catch (...) {
+            qDebug() << LINGLONG_ERRV("invalid cache " + cachePath, std::current_exception());
+        }
+    }
+
+    auto json = parseYAMLFile(path);
+    if (!json) {
+        return json;
+    }
+
+    // Failing to write the cache only makes the next load slower.
+    auto save = [&]() -> error::Result<void> {
+        if (!dir.mkpath(".")) {
+            return LINGLONG_ERR("make directory " + dir.absolutePath());
+        }
+
+        QSaveFile file(cachePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return LINGLONG_ERR(file);
+        }
+
+        auto cbor = nlohmann::json::to_cbor({
+          { "identity", std::move(*identity) },
+          { "json", *json },
+        });
+        auto size = static_cast<qint64>(cbor.size());
+        if (file.write(reinterpret_cast<const char *>(cbor.data()), size) != size) { // NOLINT
+            return LINGLONG_ERR(file);
+        }
+
+        if (!file.commit()) {
+            return LINGLONG_ERR(file);
+        }
+
+        auto entries = dir.entryInfoList({ "*.cbor" }, QDir::Files, QDir::Time);
+        while (entries.size() > maxEntries) {
+            QFile::remove(entries.takeLast().absoluteFilePath());
+        }
+
+        return LINGLONG_OK;
+    };
+    if (auto ret = save(); !ret) {
+        qDebug() << ret.error();
+    }
+
+    return json;
+}
+
+} // namespace linglong::utils::serialize
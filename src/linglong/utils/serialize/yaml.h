@@ -30,26 +30,26 @@ error::Result<T> LoadYAML(Source &content)
     }
 }
 
+// Parse a YAML file to JSON. The result is cached in $XDG_CACHE_HOME/linglong/yaml
+// as CBOR, keyed by the path, inode, size and modification time of the file,
+// so parsing an unchanged file again skips the YAML parser.
+auto LoadYAMLFileAsJSON(const QString &filename) noexcept -> error::Result<nlohmann::json>;
+
 template<typename T>
 error::Result<T> LoadYAMLFile(const QString &filename) noexcept
 {
-    LINGLONG_TRACE("load yaml from file");
-
-    QFile file = filename;
+    LINGLONG_TRACE("load yaml from file " + filename);
 
-    file.open(QFile::ReadOnly);
-    if (!file.isOpen()) {
-        return LINGLONG_ERR("open", file);
+    auto json = LoadYAMLFileAsJSON(filename);
+    if (!json) {
+        return LINGLONG_ERR(json);
     }
 
-    Q_ASSERT(file.error() == QFile::NoError);
-
-    auto content = file.readAll();
-    if (file.error() != QFile::NoError) {
-        return LINGLONG_ERR("read all", file);
+    try {
+        return json->template get<T>();
+    } catch (...) {
+        return LINGLONG_ERR(std::current_exception());
     }
-
-    return LoadYAML<T>(content);
 }
 
 } // namespace linglong::utils::serialize
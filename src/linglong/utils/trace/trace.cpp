@@ -0,0 +1,173 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/utils/trace/trace.h"
+
+#include "linglong/utils/configure.h"
+
+#include <nlohmann/json.hpp>
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <mutex>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace linglong::utils::trace {
+
+namespace detail {
+std::atomic_bool enabled{ false };
+} // namespace detail
+
+namespace {
+
+struct Tracer
+{
+    std::mutex mutex;
+    QString file;
+    nlohmann::json events = nlohmann::json::array();
+};
+
+auto tracer() noexcept -> Tracer &
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+auto microseconds(WallClock::time_point time) noexcept -> std::int64_t
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+// Convert a time of the monotonic clock to wall time,
+// by the offset between the clocks when this process started tracing.
+auto microseconds(Clock::time_point time) noexcept -> std::int64_t
+{
+    static const auto steadyAnchor = Clock::now();
+    static const auto wallAnchor = WallClock::now();
+    return microseconds(wallAnchor)
+      + std::chrono::duration_cast<std::chrono::microseconds>(time - steadyAnchor).count();
+}
+
+auto threadID() noexcept -> pid_t
+{
+    thread_local const auto tid = static_cast<pid_t>(::syscall(SYS_gettid));
+    return tid;
+}
+
+void record(nlohmann::json event) noexcept
+{
+    event["pid"] = ::getpid();
+    event["tid"] = threadID();
+    event["cat"] = "linglong";
+
+    auto &t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (!enabled()) {
+        return;
+    }
+    t.events.push_back(std::move(event));
+}
+
+} // namespace
+
+void enable(const QString &file) noexcept
+{
+    auto &t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.file = file;
+    t.events = nlohmann::json::array();
+    // Take the offset between the clocks before any span is recorded.
+    microseconds(Clock::now());
+    detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+void complete(const char *name,
+              Clock::time_point start,
+              Clock::time_point end,
+              std::vector<std::pair<const char *, std::string>> args) noexcept
+{
+    // NOTE: Timestamps are in microseconds since the epoch,
+    // so traces from different processes and machines can be aggregated.
+    nlohmann::json event{
+        { "name", name },
+        { "ph", "X" },
+        { "ts", microseconds(start) },
+        { "dur", std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() },
+    };
+    for (auto &[key, value] : args) {
+        event["args"][key] = std::move(value);
+    }
+
+    record(std::move(event));
+}
+
+void instant(const char *name, Clock::time_point time) noexcept
+{
+    record({
+      { "name", name },
+      { "ph", "i" },
+      { "s", "p" },
+      { "ts", microseconds(time) },
+    });
+}
+
+void instant(const char *name, WallClock::time_point time) noexcept
+{
+    record({
+      { "name", name },
+      { "ph", "i" },
+      { "s", "p" },
+      { "ts", microseconds(time) },
+    });
+}
+
+auto flush() noexcept -> error::Result<void>
+{
+    LINGLONG_TRACE("write trace");
+
+    auto &t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (!enabled()) {
+        return LINGLONG_ERR("tracing is not enabled");
+    }
+    detail::enabled.store(false, std::memory_order_relaxed);
+
+    auto events = std::move(t.events);
+    t.events = nlohmann::json::array();
+    events.push_back({
+      { "name", "process_name" },
+      { "ph", "M" },
+      { "pid", ::getpid() },
+      { "args", { { "name", QCoreApplication::applicationName().toStdString() } } },
+    });
+
+    nlohmann::json document{
+        { "traceEvents", std::move(events) },
+        { "displayTimeUnit", "ms" },
+        { "otherData",
+          {
+            { "version", LINGLONG_VERSION },
+            { "arguments", QCoreApplication::arguments().join(" ").toStdString() },
+          } },
+    };
+
+    QFile file(t.file);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return LINGLONG_ERR(file);
+    }
+
+    auto content = QByteArray::fromStdString(document.dump());
+    if (file.write(content) != content.size()) {
+        return LINGLONG_ERR(file);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace linglong::utils::trace
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_UTILS_TRACE_TRACE_H_
+#define LINGLONG_UTILS_TRACE_TRACE_H_
+
+#include "linglong/utils/error/error.h"
+
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Spans of the time spent in a process written in the Chrome trace event format,
+// which can be opened in Perfetto or chrome://tracing.
+//
+// Tracing is disabled by default, a span only loads an atomic flag then.
+namespace linglong::utils::trace {
+
+// Spans are measured by a monotonic clock, which does not jump when the wall clock is set.
+using Clock = std::chrono::steady_clock;
+// Times known only as wall time, e.g. the modification time of a file.
+using WallClock = std::chrono::system_clock;
+
+namespace detail {
+extern std::atomic_bool enabled;
+} // namespace detail
+
+// Start recording spans, which are written to file by flush().
+void enable(const QString &file) noexcept;
+
+[[nodiscard]] inline auto enabled() noexcept -> bool
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Record a span finished in this thread.
+void complete(const char *name,
+              Clock::time_point start,
+              Clock::time_point end,
+              std::vector<std::pair<const char *, std::string>> args = {}) noexcept;
+
+// Record something happened at time.
+void instant(const char *name, Clock::time_point time) noexcept;
+// Record something happened at a wall time, e.g. a file written by another process.
+void instant(const char *name, WallClock::time_point time) noexcept;
+
+// Write the recorded spans to the file passed to enable() and stop recording.
+auto flush() noexcept -> error::Result<void>;
+
+// Span records the time from its construction to its destruction.
+class Span
+{
+public:
+    explicit Span(const char *name) noexcept
+        : name(enabled() ? name : nullptr)
+    {
+        if (this->name != nullptr) {
+            this->start = Clock::now();
+        }
+    }
+
+    Span(const Span &) = delete;
+    Span(Span &&) = delete;
+    auto operator=(const Span &) -> Span & = delete;
+    auto operator=(Span &&) -> Span & = delete;
+
+    ~Span() { this->end(); }
+
+    // Attach an argument shown with the span, it is ignored if tracing is disabled.
+    void arg(const char *key, const QString &value) noexcept
+    {
+        if (this->name != nullptr) {
+            this->args.emplace_back(key, value.toStdString());
+        }
+    }
+
+    // End the span before leaving the scope.
+    void end() noexcept
+    {
+        if (this->name == nullptr) {
+            return;
+        }
+        complete(std::exchange(this->name, nullptr),
+                 this->start,
+                 Clock::now(),
+                 std::move(this->args));
+    }
+
+private:
+    const char *name;
+    Clock::time_point start;
+    std::vector<std::pair<const char *, std::string>> args;
+};
+
+} // namespace linglong::utils::trace
+
+#define LINGLONG_SPAN_CAT_(a, b) a##b
+#define LINGLONG_SPAN_CAT(a, b) LINGLONG_SPAN_CAT_(a, b)
+
+// Record a span from here to the end of the scope.
+#define LINGLONG_SPAN(name) \
+    const ::linglong::utils::trace::Span LINGLONG_SPAN_CAT(linglongSpan, __LINE__)(name)
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#ifndef LINGLONG_TEST_MODULE_API_CLIENT_FAKE_SERVER_H_
+#define LINGLONG_TEST_MODULE_API_CLIENT_FAKE_SERVER_H_
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace linglong::api::client::test {
+
+// A local stand-in for the repository server. Requests are answered by the handler of their
+// method and path once the whole request body has been received, others get 404.
+// Responses with status 0 are never sent.
+class FakeServer : public QTcpServer
+{
+public:
+    struct Response
+    {
+        int status;
+        QByteArray body;
+    };
+
+    using Handler = std::function<Response(const QByteArray &body)>;
+
+    // Handlers keyed by "<method> <path>".
+    std::map<QByteArray, Handler> handlers;
+    // Bodies of the requests keyed by "<method> <path>".
+    std::map<QByteArray, QByteArray> requests;
+
+    FakeServer() { listen(QHostAddress::LocalHost); }
+
+    // Answer with a JSON result holding data.
+    static auto ok(const QJsonObject &data) -> Response
+    {
+        return { 200, QJsonDocument(QJsonObject{ { "code", 200 }, { "data", data } }).toJson() };
+    }
+
+protected:
+    void incomingConnection(qintptr handle) override
+    {
+        auto *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(handle);
+        auto buffer = std::make_shared<QByteArray>();
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket, buffer]() {
+            buffer->append(socket->readAll());
+            const auto headerEnd = buffer->indexOf("\r\n\r\n");
+            if (headerEnd < 0) {
+                return;
+            }
+
+            const auto lines = buffer->left(headerEnd).split('\n');
+            qint64 length = 0;
+            for (const auto &line : lines) {
+                if (line.toLower().startsWith("content-length:")) {
+                    length = line.mid(line.indexOf(':') + 1).trimmed().toLongLong();
+                }
+            }
+            if (buffer->size() - headerEnd - 4 < length) {
+                return;
+            }
+
+            const auto requestLine = lines.front().trimmed().split(' ');
+            const auto key = requestLine.at(0) + ' ' + requestLine.at(1).split('?').front();
+            const auto body = buffer->mid(headerEnd + 4, length);
+            this->requests[key] = body;
+
+            Response response{ 404, R"({"code": 404, "msg": "not found"})" };
+            if (auto handler = this->handlers.find(key); handler != this->handlers.end()) {
+                response = handler->second(body);
+            }
+            if (response.status == 0) {
+                return;
+            }
+            socket->write(QString("HTTP/1.1 %1 Status\r\nContent-Type: application/json\r\n"
+                                  "Content-Length: %2\r\nConnection: close\r\n\r\n")
+                            .arg(response.status)
+                            .arg(response.body.size())
+                            .toUtf8()
+                          + response.body);
+            socket->disconnectFromHost();
+        });
+    }
+};
+
+} // namespace linglong::api::client::test
+
+#endif // LINGLONG_TEST_MODULE_API_CLIENT_FAKE_SERVER_H_
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "HttpRequest.h"
+#include "linglong/api/client/fake_server.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTemporaryFile>
+#include <QTimer>
+
+namespace {
+
+using linglong::api::client::HttpRequestInput;
+using linglong::api::client::HttpRequestWorker;
+using linglong::api::client::test::FakeServer;
+
+} // namespace
+
+TEST(HttpRequestWorker, StreamMultipartFile)
+{
+    int argc = 0;
+    const QCoreApplication app(argc, nullptr);
+
+    QByteArray content;
+    for (int i = 0; i < 1024 * 64; ++i) {
+        content.append(QByteArray::number(i % 10));
+    }
+
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    ASSERT_EQ(file.write(content), content.size());
+    ASSERT_TRUE(file.flush());
+
+    FakeServer server;
+    ASSERT_TRUE(server.isListening());
+    server.handlers["PUT /tar"] = [](const QByteArray &) {
+        return FakeServer::Response{ 200, "{}" };
+    };
+
+    HttpRequestInput input(QString("http://127.0.0.1:%1/tar").arg(server.serverPort()), "PUT");
+    input.add_var("name", "value");
+    input.add_file("file", file.fileName(), "layer.tgz", "");
+
+    HttpRequestWorker worker;
+    worker.setTimeOut(10000);
+
+    QEventLoop loop;
+    QObject::connect(&worker, &HttpRequestWorker::on_execution_finished, &loop, &QEventLoop::quit);
+    worker.execute(&input);
+    loop.exec();
+
+    EXPECT_EQ(worker.error_type, QNetworkReply::NoError) << worker.error_str.toStdString();
+    EXPECT_EQ(worker.getHttpResponseCode(), 200);
+    EXPECT_EQ(worker.response, "{}");
+
+    ASSERT_EQ(server.requests.count("PUT /tar"), 1);
+    const auto &request = server.requests["PUT /tar"];
+    EXPECT_TRUE(request.contains("filename=\"layer.tgz\""));
+    EXPECT_TRUE(request.contains("\r\n\r\nvalue\r\n"));
+    EXPECT_TRUE(request.contains("\r\n\r\n" + content + "\r\n"));
+}
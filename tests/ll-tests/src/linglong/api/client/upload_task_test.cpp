@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/api/client/fake_server.h"
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/package/layer_dir.h"
+#include "linglong/package/reference.h"
+#include "linglong/repo/ostree_repo.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <memory>
+
+namespace {
+
+using linglong::api::client::test::FakeServer;
+using linglong::api::types::v1::PackageInfo;
+using linglong::api::types::v1::RepoConfig;
+using linglong::package::LayerDir;
+using linglong::package::Reference;
+using linglong::repo::OSTreeRepo;
+
+auto packageInfo() -> PackageInfo
+{
+    return {
+        .appid = "org.deepin.demo",
+        .arch = { "x86_64" },
+        .base = "main:org.deepin.foundation/23.0.0/x86_64",
+        .channel = "main",
+        .kind = "app",
+        .packageInfoModule = "runtime",
+        .name = "demo",
+        .size = 0,
+        .version = "1.0.0.0",
+    };
+}
+
+class UploadTaskTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(this->dir.isValid());
+        ASSERT_TRUE(this->server.isListening());
+
+        const auto url = QString("http://127.0.0.1:%1").arg(this->server.serverPort());
+        const RepoConfig cfg{
+            .defaultRepo = "repo",
+            .repos = { { "repo", url.toStdString() } },
+            .version = 1,
+        };
+        const QDir root(this->dir.filePath("repo"));
+        ASSERT_TRUE(root.mkpath("."));
+        this->repo = std::make_unique<OSTreeRepo>(root, cfg, this->api);
+
+        const LayerDir layerDir(this->dir.filePath("layer"));
+        ASSERT_TRUE(layerDir.mkpath("files"));
+        QFile info(layerDir.absoluteFilePath("info.json"));
+        ASSERT_TRUE(info.open(QIODevice::WriteOnly));
+        info.write(QByteArray::fromStdString(nlohmann::json(packageInfo()).dump()));
+        info.close();
+        QFile file(layerDir.absoluteFilePath("files/demo"));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("demo");
+        file.close();
+        auto result = this->repo->importLayerDir(layerDir);
+        ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+        this->server.handlers["POST /api/v1/sign-in"] = [](const QByteArray &) {
+            return FakeServer::ok({ { "token", "token" } });
+        };
+        this->server.handlers["POST /api/v1/upload-tasks"] = [](const QByteArray &) {
+            return FakeServer::ok({ { "id", "task" } });
+        };
+        this->server.handlers["GET /api/v1/upload-tasks/task/status"] = [](const QByteArray &) {
+            return FakeServer::ok({ { "status", "complete" } });
+        };
+    }
+
+    auto reference() -> Reference
+    {
+        auto ref = Reference::fromPackageInfo(packageInfo());
+        EXPECT_TRUE(ref.has_value());
+        return *ref;
+    }
+
+    int argc = 0;
+    QCoreApplication app{ argc, nullptr };
+    QTemporaryDir dir;
+    FakeServer server;
+    linglong::api::client::ClientApi api;
+    std::unique_ptr<OSTreeRepo> repo;
+};
+
+} // namespace
+
+TEST_F(UploadTaskTest, UploadMissingObjects)
+{
+    QStringList objects;
+    QString missing;
+    this->server.handlers["POST /api/v1/upload-tasks/task/objects/missing"] =
+      [&objects, &missing](const QByteArray &body) {
+          const auto req = QJsonDocument::fromJson(body).object();
+          for (const auto &object : req["objects"].toArray()) {
+              objects.push_back(object.toString());
+          }
+          missing = req["commit"].toString() + ".commit";
+          // Objects not in the request are never uploaded.
+          return FakeServer::ok(
+            { { "objects", QJsonArray{ missing, QString(64, '0') + ".file" } } });
+      };
+    this->server.handlers["PUT /api/v1/upload-tasks/task/objects"] = [](const QByteArray &) {
+        return FakeServer::ok({});
+    };
+
+    auto result = this->repo->push(this->reference());
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    EXPECT_TRUE(objects.contains(missing));
+    EXPECT_GT(objects.size(), 1);
+
+    // Only the objects listed by the server are uploaded.
+    const auto &upload = this->server.requests["PUT /api/v1/upload-tasks/task/objects"];
+    for (const auto &object : objects) {
+        const auto checksum = object.section('.', 0, 0);
+        const auto path = "objects/" + checksum.left(2) + "/" + checksum.mid(2);
+        EXPECT_EQ(upload.contains(path.toUtf8()), object == missing) << object.toStdString();
+    }
+    EXPECT_FALSE(upload.contains(QString(62, '0').toUtf8()));
+    EXPECT_EQ(this->server.requests.count("PUT /api/v1/upload-tasks/task/tar"), 0);
+}
+
+TEST_F(UploadTaskTest, FallbackToLayerTarball)
+{
+    for (const int status : { 404, 405 }) {
+        this->server.requests.clear();
+        this->server.handlers["POST /api/v1/upload-tasks/task/objects/missing"] =
+          [status](const QByteArray &) {
+              return FakeServer::Response{ status, R"({"code": 0, "msg": "unsupported"})" };
+          };
+        this->server.handlers["PUT /api/v1/upload-tasks/task/tar"] = [](const QByteArray &) {
+            return FakeServer::ok({});
+        };
+
+        auto result = this->repo->push(this->reference());
+        ASSERT_TRUE(result.has_value()) << status << result.error().message().toStdString();
+
+        EXPECT_EQ(this->server.requests.count("PUT /api/v1/upload-tasks/task/objects"), 0)
+          << status;
+        const auto &upload = this->server.requests["PUT /api/v1/upload-tasks/task/tar"];
+        // The layer is uploaded as a gzip compressed tarball.
+        EXPECT_TRUE(upload.contains("filename=\"")) << status;
+        EXPECT_TRUE(upload.contains("\x1f\x8b")) << status;
+    }
+}
+
+TEST_F(UploadTaskTest, RejectedUploadIsNotRetried)
+{
+    int uploads = 0;
+    this->server.handlers["POST /api/v1/upload-tasks/task/objects/missing"] =
+      [](const QByteArray &) {
+          return FakeServer::ok({ { "objects", QJsonArray{} } });
+      };
+    this->server.handlers["PUT /api/v1/upload-tasks/task/objects"] =
+      [&uploads](const QByteArray &) {
+          ++uploads;
+          return FakeServer::Response{ 403, R"({"code": 403, "msg": "forbidden"})" };
+      };
+
+    EXPECT_FALSE(this->repo->push(this->reference()).has_value());
+    EXPECT_EQ(uploads, 1);
+}
+
+TEST_F(UploadTaskTest, NoAnswerBeforeDeadline)
+{
+    this->server.handlers["POST /api/v1/sign-in"] = [](const QByteArray &) {
+        return FakeServer::Response{ 0, {} };
+    };
+
+    linglong::repo::pushOption opts;
+    opts.deadline = QDeadlineTimer(std::chrono::seconds(1));
+
+    QElapsedTimer timer;
+    timer.start();
+    EXPECT_FALSE(this->repo->push(this->reference(), false, opts).has_value());
+    EXPECT_LT(timer.elapsed(), 10000);
+}
@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/builder/build_cache.h"
+#include "linglong/package/layer_dir.h"
+#include "linglong/package/reference.h"
+#include "linglong/repo/ostree_repo.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <memory>
+
+namespace {
+
+using linglong::api::types::v1::BuilderConfig;
+using linglong::api::types::v1::BuilderProject;
+using linglong::api::types::v1::BuilderProjectSource;
+using linglong::api::types::v1::PackageInfo;
+using linglong::api::types::v1::RepoConfig;
+using linglong::builder::buildCacheMissReason;
+using linglong::builder::buildCachePath;
+using linglong::builder::buildInputs;
+using linglong::builder::saveBuildCache;
+using linglong::package::LayerDir;
+using linglong::package::Reference;
+using linglong::repo::OSTreeRepo;
+
+auto packageInfo(const std::string &appid, const std::string &kind, const std::string &module)
+  -> PackageInfo
+{
+    return {
+        .appid = appid,
+        .arch = { "x86_64" },
+        .base = "main:org.deepin.foundation/23.0.0/x86_64",
+        .channel = "main",
+        .kind = kind,
+        .packageInfoModule = module,
+        .name = appid,
+        .size = 0,
+        .version = "1.0.0.0",
+    };
+}
+
+auto source(const std::string &url, const std::string &digest) -> BuilderProjectSource
+{
+    BuilderProjectSource source;
+    source.kind = "archive";
+    source.url = url;
+    source.digest = digest;
+    return source;
+}
+
+class BuildCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(this->dir.isValid());
+        const QDir root(this->dir.filePath("repo"));
+        ASSERT_TRUE(root.mkpath("."));
+        const RepoConfig repoCfg{
+            .defaultRepo = "repo",
+            .repos = { { "repo", "https://repo.example.com" } },
+            .version = 1,
+        };
+        this->repo = std::make_unique<OSTreeRepo>(root, repoCfg, this->api);
+        this->cfg.repo = root.absolutePath().toStdString();
+        this->cfg.version = 1;
+
+        this->project = QDir(this->dir.filePath("project"));
+        ASSERT_TRUE(this->project.mkpath("."));
+        QFile yaml(this->project.absoluteFilePath("linglong.yaml"));
+        ASSERT_TRUE(yaml.open(QIODevice::WriteOnly));
+        yaml.write("version: 1\n");
+        yaml.close();
+
+        this->importLayer(this->baseInfo, "base");
+        this->importLayer(this->appInfo, "app");
+        this->importLayer(this->developInfo, "app");
+    }
+
+    void importLayer(const PackageInfo &info, const QByteArray &content)
+    {
+        QTemporaryDir layer;
+        ASSERT_TRUE(layer.isValid());
+        const LayerDir layerDir(layer.path());
+        ASSERT_TRUE(layerDir.mkpath("files"));
+
+        QFile infoFile(layerDir.absoluteFilePath("info.json"));
+        ASSERT_TRUE(infoFile.open(QIODevice::WriteOnly));
+        infoFile.write(QByteArray::fromStdString(nlohmann::json(info).dump()));
+        infoFile.close();
+
+        QFile file(layerDir.absoluteFilePath("files/content"));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(content);
+        file.close();
+
+        auto result = this->repo->importLayerDir(layerDir);
+        ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    }
+
+    auto inputs(const BuilderProject &project) -> nlohmann::json
+    {
+        auto base = Reference::fromPackageInfo(this->baseInfo);
+        EXPECT_TRUE(base.has_value());
+        auto inputs = buildInputs(project,
+                                  this->project,
+                                  this->cfg,
+                                  { "build" },
+                                  *this->repo,
+                                  *base,
+                                  std::nullopt);
+        EXPECT_TRUE(inputs.has_value()) << inputs.error().message().toStdString();
+        return *inputs;
+    }
+
+    auto reference() -> Reference
+    {
+        auto ref = Reference::fromPackageInfo(this->appInfo);
+        EXPECT_TRUE(ref.has_value());
+        return *ref;
+    }
+
+    const PackageInfo baseInfo = packageInfo("org.deepin.foundation", "base", "runtime");
+    const PackageInfo appInfo = packageInfo("org.deepin.demo", "app", "runtime");
+    const PackageInfo developInfo = packageInfo("org.deepin.demo", "app", "develop");
+
+    QTemporaryDir dir;
+    QDir project;
+    BuilderConfig cfg;
+    linglong::api::client::ClientApi api;
+    std::unique_ptr<OSTreeRepo> repo;
+};
+
+} // namespace
+
+TEST_F(BuildCacheTest, Hit)
+{
+    BuilderProject project;
+    project.sources = { source("https://example.com/demo.tar.gz", "digest") };
+
+    const auto path = buildCachePath(this->cfg, this->reference());
+    EXPECT_EQ(buildCacheMissReason(path, this->inputs(project), *this->repo, this->reference()),
+              "no previous build is recorded");
+
+    auto result = saveBuildCache(path, this->inputs(project), *this->repo, this->reference());
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    EXPECT_EQ(buildCacheMissReason(path, this->inputs(project), *this->repo, this->reference()),
+              "");
+}
+
+TEST_F(BuildCacheTest, MissReasonOfSameSources)
+{
+    // A project may fetch the same url twice, both are part of the inputs.
+    BuilderProject project;
+    project.sources = { source("https://example.com/demo.tar.gz", "first"),
+                        source("https://example.com/demo.tar.gz", "second") };
+    auto inputs = this->inputs(project);
+    EXPECT_EQ(inputs.value("source 0 https://example.com/demo.tar.gz", ""), "first");
+    EXPECT_EQ(inputs.value("source 1 https://example.com/demo.tar.gz", ""), "second");
+
+    const auto path = buildCachePath(this->cfg, this->reference());
+    auto result = saveBuildCache(path, inputs, *this->repo, this->reference());
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    project.sources->at(1).digest = "changed";
+    EXPECT_EQ(buildCacheMissReason(path, this->inputs(project), *this->repo, this->reference()),
+              "source 1 https://example.com/demo.tar.gz is changed");
+}
+
+TEST_F(BuildCacheTest, ReplacedLayer)
+{
+    BuilderProject project;
+    const auto path = buildCachePath(this->cfg, this->reference());
+    auto result = saveBuildCache(path, this->inputs(project), *this->repo, this->reference());
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    this->importLayer(this->appInfo, "other");
+    EXPECT_EQ(buildCacheMissReason(path, this->inputs(project), *this->repo, this->reference()),
+              "the runtime layer of the previous build is replaced or removed");
+}
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/builder/source_fetcher.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QUrl>
+
+#include <ctime>
+
+#include <utime.h>
+
+namespace {
+
+using linglong::builder::SourceFetcher;
+
+// Writes a cached file of the size, which was used the seconds ago.
+void writeCache(const QDir &dir, const QString &name, int size, int age)
+{
+    QFile file(dir.absoluteFilePath(name));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(file.write(QByteArray(size, 'x')), size);
+    file.close();
+
+    const auto time = ::time(nullptr) - age;
+    const struct utimbuf times{ time, time };
+    ASSERT_EQ(::utime(file.fileName().toLocal8Bit().constData(), &times), 0);
+}
+
+} // namespace
+
+TEST(SourceFetcher, PruneLeastRecentlyUsed)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QDir cache = dir.filePath("sha256");
+    ASSERT_TRUE(cache.mkpath("."));
+
+    const auto newest = QString(64, 'a');
+    const auto older = QString(64, 'b');
+    const auto oldest = QString(64, 'c');
+    writeCache(cache, newest, 100, 0);
+    writeCache(cache, older, 100, 60);
+    writeCache(cache, oldest, 100, 120);
+    // A file being downloaded, and one left by a download which stopped long ago.
+    writeCache(cache, oldest + ".abcdef", 100, 180);
+    writeCache(cache, oldest + ".ghijkl", 100, 2 * 24 * 60 * 60);
+
+    linglong::api::types::v1::BuilderConfig cfg{
+        .arch = {},
+        .cache = dir.path().toStdString(),
+        .cacheSize = 250,
+        .fetchJobs = {},
+        .offline = {},
+        .repo = {},
+        .skipBuildCache = {},
+        .skipCommit = {},
+        .skipFetch = {},
+        .version = 1,
+    };
+    SourceFetcher::pruneCache(cfg);
+
+    EXPECT_TRUE(cache.exists(newest));
+    EXPECT_TRUE(cache.exists(older));
+    EXPECT_FALSE(cache.exists(oldest));
+    EXPECT_TRUE(cache.exists(oldest + ".abcdef"));
+    EXPECT_FALSE(cache.exists(oldest + ".ghijkl"));
+}
+
+TEST(SourceFetcher, FetchFileFromCache)
+{
+    int argc = 0;
+    const QCoreApplication app(argc, nullptr);
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const QByteArray content = "demo";
+    QFile origin(dir.filePath("demo.txt"));
+    ASSERT_TRUE(origin.open(QIODevice::WriteOnly));
+    ASSERT_EQ(origin.write(content), content.size());
+    origin.close();
+
+    linglong::api::types::v1::BuilderProjectSource source;
+    source.kind = "file";
+    source.url = QUrl::fromLocalFile(origin.fileName()).toString().toStdString();
+    source.digest =
+      QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex().toStdString();
+
+    linglong::api::types::v1::BuilderConfig cfg;
+    cfg.cache = dir.filePath("cache").toStdString();
+    cfg.repo = dir.filePath("repo").toStdString();
+    cfg.version = 1;
+
+    SourceFetcher fetcher(source, cfg);
+    auto result = fetcher.prefetch();
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    const QDir cache(dir.filePath("cache/sha256"));
+    EXPECT_TRUE(cache.exists(QString::fromStdString(*source.digest)));
+
+    // The origin is gone, the file can only come from the cache.
+    ASSERT_TRUE(origin.remove());
+    QDir destination(dir.filePath("sources"));
+    ASSERT_TRUE(destination.mkpath("."));
+    result = fetcher.fetch(destination);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    QFile fetched(destination.absoluteFilePath("demo.txt"));
+    ASSERT_TRUE(fetched.open(QIODevice::ReadOnly));
+    EXPECT_EQ(fetched.readAll(), content);
+}
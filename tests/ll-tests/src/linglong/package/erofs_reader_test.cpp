@@ -0,0 +1,282 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/package/erofs_reader.h"
+#include "linglong/package/layer_file.h"
+
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/stat.h>
+
+namespace {
+
+using linglong::package::ErofsReader;
+
+constexpr int blockSize = 4096;
+// Some bytes before the image, like the header of a layer file.
+constexpr int imageOffset = 100;
+
+template<typename T>
+void put(QByteArray &image, int position, T value)
+{
+    qToLittleEndian<T>(value, image.data() + imageOffset + position);
+}
+
+void putInode(QByteArray &image, int position, quint16 mode, quint32 size)
+{
+    // Compact inode with the flat inline layout.
+    put<quint16>(image, position, 2 << 1);
+    put<quint16>(image, position + 4, mode);
+    put<quint32>(image, position + 8, size);
+}
+
+// An image with a single file "hello" in the root directory.
+QByteArray makeImage()
+{
+    QByteArray image(imageOffset + 2 * blockSize, '\0');
+
+    const int superBlock = 1024;
+    put<quint32>(image, superBlock, 0xE0F5E1E2);
+    image[imageOffset + superBlock + 12] = 12;
+    put<quint16>(image, superBlock + 14, 0);
+    put<quint32>(image, superBlock + 40, 1);
+
+    const int root = blockSize;
+    putInode(image, root, S_IFDIR | 0755, 44);
+    const char *names[] = { ".", "..", "hello" };
+    const quint64 nids[] = { 0, 0, 3 };
+    const quint16 nameOffsets[] = { 36, 37, 39 };
+    for (int i = 0; i < 3; ++i) {
+        const auto dirent = root + 32 + i * 12;
+        put<quint64>(image, dirent, nids[i]);
+        put<quint16>(image, dirent + 8, nameOffsets[i]);
+        image.replace(imageOffset + root + 32 + nameOffsets[i],
+                      static_cast<int>(qstrlen(names[i])),
+                      names[i]);
+    }
+
+    const int file = blockSize + 3 * 32;
+    putInode(image, file, S_IFREG | 0644, 5);
+    image.replace(imageOffset + file + 32, 5, "hello");
+
+    return image;
+}
+
+// Write the image to a temporary file.
+auto writeImage(QTemporaryFile &file, const QByteArray &image) -> bool
+{
+    return file.open() && file.write(image) == image.size() && file.flush();
+}
+
+// Read the file at path in the image built by mkfs.erofs with args from the directory.
+auto readByMkfs(const QStringList &args, const QString &path, const QByteArray &content)
+  -> QByteArray
+{
+    QTemporaryDir dir;
+    EXPECT_TRUE(dir.isValid());
+    QDir source(dir.filePath("source"));
+    EXPECT_TRUE(source.mkpath("sub"));
+    {
+        QFile file(source.absoluteFilePath(path));
+        EXPECT_TRUE(file.open(QIODevice::WriteOnly));
+        EXPECT_EQ(file.write(content), content.size());
+    }
+
+    const auto image = dir.filePath("image.erofs");
+    QProcess mkfs;
+    mkfs.start("mkfs.erofs", args + QStringList{ image, source.absolutePath() });
+    EXPECT_TRUE(mkfs.waitForFinished(60 * 1000));
+    EXPECT_EQ(mkfs.exitCode(), 0) << mkfs.readAllStandardError().toStdString();
+
+    QFile file(image);
+    EXPECT_TRUE(file.open(QIODevice::ReadOnly));
+    auto reader = ErofsReader::open(file.handle(), 0);
+    EXPECT_TRUE(reader.has_value()) << reader.error().message().toStdString();
+    if (!reader) {
+        return {};
+    }
+
+    auto inode = reader->root();
+    for (const auto &name : path.split('/')) {
+        if (!inode) {
+            ADD_FAILURE() << inode.error().message().toStdString();
+            return {};
+        }
+        auto entries = reader->readDir(*inode);
+        if (!entries) {
+            ADD_FAILURE() << entries.error().message().toStdString();
+            return {};
+        }
+        auto entry = std::find_if(entries->begin(), entries->end(), [&name](const auto &entry) {
+            return entry.name == name.toUtf8();
+        });
+        EXPECT_NE(entry, entries->end());
+        if (entry == entries->end()) {
+            return {};
+        }
+        inode = reader->inode(entry->nid);
+    }
+
+    if (!inode) {
+        ADD_FAILURE() << inode.error().message().toStdString();
+        return {};
+    }
+    auto data = reader->readAll(*inode);
+    if (!data) {
+        ADD_FAILURE() << data.error().message().toStdString();
+        return {};
+    }
+    return *data;
+}
+
+// Content compressed to several clusters, with an incompressible part stored as plain.
+auto compressibleContent() -> QByteArray
+{
+    QByteArray content;
+    for (int i = 0; content.size() < 256 * 1024; ++i) {
+        content += QByteArray::number(i % 1000) + " linglong\n";
+    }
+    quint32 seed = 1;
+    for (int i = 0; i < 16 * 1024; ++i) {
+        seed = seed * 1103515245 + 12345;
+        content += static_cast<char>(seed >> 24);
+    }
+    return content;
+}
+
+} // namespace
+
+TEST(ErofsReader, ReadInlineFile)
+{
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    ASSERT_EQ(file.write(makeImage()), imageOffset + 2 * blockSize);
+    ASSERT_TRUE(file.flush());
+
+    auto reader = ErofsReader::open(file.handle(), imageOffset);
+    ASSERT_TRUE(reader.has_value()) << reader.error().message().toStdString();
+
+    auto root = reader->root();
+    ASSERT_TRUE(root.has_value()) << root.error().message().toStdString();
+    EXPECT_TRUE(S_ISDIR(root->mode));
+
+    auto entries = reader->readDir(*root);
+    ASSERT_TRUE(entries.has_value()) << entries.error().message().toStdString();
+    ASSERT_EQ(entries->size(), 1);
+    EXPECT_EQ(entries->at(0).name, "hello");
+    EXPECT_EQ(entries->at(0).nid, 3);
+
+    auto hello = reader->inode(entries->at(0).nid);
+    ASSERT_TRUE(hello.has_value()) << hello.error().message().toStdString();
+    EXPECT_FALSE(reader->readDir(*hello).has_value());
+
+    auto content = reader->readAll(*hello);
+    ASSERT_TRUE(content.has_value()) << content.error().message().toStdString();
+    EXPECT_EQ(*content, "hello");
+}
+
+TEST(ErofsReader, InvalidMagic)
+{
+    auto image = makeImage();
+    put<quint32>(image, 1024, 0);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    ASSERT_EQ(file.write(image), image.size());
+    ASSERT_TRUE(file.flush());
+
+    EXPECT_FALSE(ErofsReader::open(file.handle(), imageOffset).has_value());
+}
+
+TEST(ErofsReader, UnsupportedFeatures)
+{
+    auto image = makeImage();
+    put<quint32>(image, 1024 + 80, 1U << 31);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(writeImage(file, image));
+
+    // Callers fall back to mounting images with unsupported features only.
+    auto reader = ErofsReader::open(file.handle(), imageOffset);
+    ASSERT_FALSE(reader.has_value());
+    EXPECT_EQ(reader.error().code(), ENOTSUP);
+
+    put<quint32>(image, 1024 + 80, 0);
+    put<quint32>(image, 1024, 0);
+    QTemporaryFile invalid;
+    ASSERT_TRUE(writeImage(invalid, image));
+    reader = ErofsReader::open(invalid.handle(), imageOffset);
+    ASSERT_FALSE(reader.has_value());
+    EXPECT_NE(reader.error().code(), ENOTSUP);
+}
+
+TEST(ErofsReader, ReadCompressedFiles)
+{
+    if (QStandardPaths::findExecutable("mkfs.erofs").isEmpty()) {
+        GTEST_SKIP() << "mkfs.erofs is not installed";
+    }
+
+    const auto content = compressibleContent();
+    // Compact indexes by default, full indexes of the legacy format.
+    EXPECT_EQ(readByMkfs({ "-zlz4" }, "sub/data", content), content);
+    EXPECT_EQ(readByMkfs({ "-zlz4hc", "-Elegacy-compress" }, "sub/data", content), content);
+}
+
+TEST(ErofsReader, RejectOversizedInode)
+{
+    auto image = makeImage();
+    put<quint32>(image, blockSize + 3 * 32 + 8, 0x7fffffff);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(writeImage(file, image));
+    auto reader = ErofsReader::open(file.handle(), imageOffset);
+    ASSERT_TRUE(reader.has_value()) << reader.error().message().toStdString();
+
+    auto hello = reader->inode(3);
+    ASSERT_TRUE(hello.has_value()) << hello.error().message().toStdString();
+    EXPECT_FALSE(reader->readAll(*hello).has_value());
+}
+
+TEST(ErofsReader, RejectInvalidClusterOffset)
+{
+    auto image = makeImage();
+    const int hello = blockSize + 3 * 32;
+    // Compact inode with the full compressed layout, followed by the map header
+    // and the index of a head cluster starting beyond its cluster.
+    put<quint16>(image, hello, 1 << 1);
+    put<quint32>(image, hello + 8, 100);
+    const int index = hello + 32 + 8 + 8;
+    put<quint16>(image, index, 1);
+    put<quint16>(image, index + 2, blockSize);
+    put<quint32>(image, index + 4, 1);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(writeImage(file, image));
+    auto reader = ErofsReader::open(file.handle(), imageOffset);
+    ASSERT_TRUE(reader.has_value()) << reader.error().message().toStdString();
+
+    auto inode = reader->inode(3);
+    ASSERT_TRUE(inode.has_value()) << inode.error().message().toStdString();
+    EXPECT_FALSE(reader->readAll(*inode).has_value());
+}
+
+TEST(ErofsReader, RejectDirectoryCycle)
+{
+    // "hello" is the root directory itself.
+    auto image = makeImage();
+    put<quint64>(image, blockSize + 32 + 2 * 12, 0);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(writeImage(file, image));
+    EXPECT_FALSE(linglong::package::LayerFile::listFiles(file.handle(), imageOffset).has_value());
+}
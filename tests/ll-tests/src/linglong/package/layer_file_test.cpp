@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/package/layer_file.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QTemporaryFile>
+
+namespace {
+
+using linglong::package::LayerFile;
+
+void writeLayer(QTemporaryFile &file, const nlohmann::json &metaInfo, const QByteArray &data)
+{
+    ASSERT_TRUE(file.open());
+
+    const auto content = QByteArray::fromStdString(metaInfo.dump());
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_10);
+    stream.writeRawData(linglong::package::magicNumber.constData(),
+                        linglong::package::magicNumber.size());
+    stream << quint32(content.size());
+    stream.writeRawData(content.constData(), content.size());
+    stream.writeRawData(data.constData(), data.size());
+    ASSERT_TRUE(file.flush());
+}
+
+std::string sha256(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex().toStdString();
+}
+
+} // namespace
+
+TEST(LayerFile, VersionOne)
+{
+    QTemporaryFile file;
+    writeLayer(file, { { "appid", "org.deepin.demo" } }, "data");
+
+    auto layerFile = LayerFile::New(file.fileName());
+    ASSERT_TRUE(layerFile.has_value()) << layerFile.error().message().toStdString();
+
+    auto info = (*layerFile)->metaInfo();
+    ASSERT_TRUE(info.has_value()) << info.error().message().toStdString();
+    EXPECT_EQ(info->version, "1");
+    EXPECT_EQ(info->info.at("appid"), "org.deepin.demo");
+
+    EXPECT_TRUE((*layerFile)->verify().has_value());
+}
+
+TEST(LayerFile, VerifyChunks)
+{
+    constexpr auto chunkSize = LayerFile::minChunkSize;
+    const QByteArray data = QByteArray(chunkSize, '0') + QByteArray(chunkSize, '4') + "89";
+    const linglong::api::types::v1::LayerInfo layerInfo{
+        .chunkSize = chunkSize,
+        .chunks = { { sha256(data.mid(0, chunkSize)),
+                      sha256(data.mid(chunkSize, chunkSize)),
+                      sha256("89") } },
+        .info = { { "appid", "org.deepin.demo" } },
+        .version = "2",
+    };
+
+    QTemporaryFile file;
+    writeLayer(file, layerInfo, data);
+
+    auto layerFile = LayerFile::New(file.fileName());
+    ASSERT_TRUE(layerFile.has_value()) << layerFile.error().message().toStdString();
+
+    auto info = (*layerFile)->metaInfo();
+    ASSERT_TRUE(info.has_value()) << info.error().message().toStdString();
+    EXPECT_EQ(info->version, "2");
+
+    auto result = (*layerFile)->verify();
+    EXPECT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    ASSERT_TRUE(file.seek(file.size() - 1));
+    ASSERT_EQ(file.write("x"), 1);
+    ASSERT_TRUE(file.flush());
+    EXPECT_FALSE((*layerFile)->verify().has_value());
+}
+
+TEST(LayerFile, HostileChunkSize)
+{
+    const QByteArray data(3 * LayerFile::minChunkSize, '0');
+    // A chunk size which is truncated to a small int must not be used to read chunks.
+    for (const qint64 chunkSize : { qint64(0),
+                                    qint64(-1),
+                                    qint64(4),
+                                    (qint64(1) << 32) + 16,
+                                    LayerFile::maxChunkSize + 1 }) {
+        const linglong::api::types::v1::LayerInfo layerInfo{
+            .chunkSize = chunkSize,
+            .chunks = { { sha256(data) } },
+            .info = { { "appid", "org.deepin.demo" } },
+            .version = "2",
+        };
+
+        QTemporaryFile file;
+        writeLayer(file, layerInfo, data);
+        auto layerFile = LayerFile::New(file.fileName());
+        ASSERT_TRUE(layerFile.has_value()) << layerFile.error().message().toStdString();
+        EXPECT_FALSE((*layerFile)->verify().has_value()) << chunkSize;
+    }
+
+    // The number of chunks must match the size of the binary data.
+    const linglong::api::types::v1::LayerInfo layerInfo{
+        .chunkSize = LayerFile::minChunkSize,
+        .chunks = { { sha256(data.left(LayerFile::minChunkSize)) } },
+        .info = { { "appid", "org.deepin.demo" } },
+        .version = "2",
+    };
+    QTemporaryFile file;
+    writeLayer(file, layerInfo, data);
+    auto layerFile = LayerFile::New(file.fileName());
+    ASSERT_TRUE(layerFile.has_value()) << layerFile.error().message().toStdString();
+    EXPECT_FALSE((*layerFile)->verify().has_value());
+
+    EXPECT_FALSE(LayerFile::digestChunks(file.handle(), 0, (qint64(1) << 32) + 16).has_value());
+}
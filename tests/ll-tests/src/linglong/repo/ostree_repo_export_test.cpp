@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/package/layer_dir.h"
+#include "linglong/package/reference.h"
+#include "linglong/repo/ostree_repo.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <map>
+#include <memory>
+
+namespace {
+
+using linglong::api::types::v1::PackageInfo;
+using linglong::api::types::v1::RepoConfig;
+using linglong::package::LayerDir;
+using linglong::package::Reference;
+using linglong::repo::OSTreeRepo;
+
+constexpr auto remoteName = "repo";
+
+auto packageInfo(const std::string &version) -> PackageInfo
+{
+    return {
+        .appid = "org.deepin.demo",
+        .arch = { "x86_64" },
+        .base = "main:org.deepin.foundation/23.0.0/x86_64",
+        .channel = "main",
+        .kind = "app",
+        .packageInfoModule = "runtime",
+        .name = "demo",
+        .size = 0,
+        .version = version,
+    };
+}
+
+auto reference(const std::string &version) -> Reference
+{
+    auto ref = Reference::fromPackageInfo(packageInfo(version));
+    EXPECT_TRUE(ref.has_value());
+    return *ref;
+}
+
+// Number of commit objects in the ostree repository of the linglong repository at root.
+auto commitCount(const QString &root) -> int
+{
+    int count = 0;
+    QDirIterator it(root + "/repo/objects",
+                    { "*.commit" },
+                    QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        ++count;
+    }
+    return count;
+}
+
+class OSTreeRepoExportTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(this->dir.isValid());
+        // The remote repository is served from <url>/repos/<name>.
+        this->server = this->open("server/repos");
+        this->builder = this->open("builder");
+        this->client = this->open("client");
+    }
+
+    auto open(const QString &path, const QString &server = "server")
+      -> std::unique_ptr<OSTreeRepo>
+    {
+        const QDir root(this->dir.filePath(path));
+        EXPECT_TRUE(root.mkpath("."));
+        const RepoConfig cfg{
+            .defaultRepo = remoteName,
+            .repos = { { remoteName, "file://" + this->dir.filePath(server).toStdString() } },
+            .version = 1,
+        };
+        return std::make_unique<OSTreeRepo>(root, cfg, this->api);
+    }
+
+    // Import a layer with the files into repo.
+    void importLayer(OSTreeRepo &repo,
+                     const std::string &version,
+                     const std::map<QString, QByteArray> &files)
+    {
+        QTemporaryDir layer;
+        ASSERT_TRUE(layer.isValid());
+        const LayerDir layerDir(layer.path());
+        ASSERT_TRUE(layerDir.mkpath("files"));
+
+        QFile info(layerDir.absoluteFilePath("info.json"));
+        ASSERT_TRUE(info.open(QIODevice::WriteOnly));
+        info.write(QByteArray::fromStdString(nlohmann::json(packageInfo(version)).dump()));
+        info.close();
+
+        for (const auto &[name, content] : files) {
+            QFile file(layerDir.absoluteFilePath("files/" + name));
+            ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+            ASSERT_EQ(file.write(content), content.size());
+        }
+
+        auto result = repo.importLayerDir(layerDir);
+        ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    }
+
+    QTemporaryDir dir;
+    linglong::api::client::ClientApi api;
+    std::unique_ptr<OSTreeRepo> server;
+    std::unique_ptr<OSTreeRepo> builder;
+    std::unique_ptr<OSTreeRepo> client;
+};
+
+const std::map<QString, QByteArray> oldFiles{
+    { "shared", QByteArray(64 * 1024, 's') },
+    { "changed", "old" },
+};
+const std::map<QString, QByteArray> newFiles{
+    { "shared", QByteArray(64 * 1024, 's') },
+    { "changed", "new" },
+};
+
+} // namespace
+
+TEST_F(OSTreeRepoExportTest, DeltaRoundTrip)
+{
+    this->importLayer(*this->builder, "1.0.0.0", oldFiles);
+    this->importLayer(*this->builder, "2.0.0.0", newFiles);
+    this->importLayer(*this->server, "2.0.0.0", newFiles);
+    this->importLayer(*this->client, "1.0.0.0", oldFiles);
+
+    const auto builderCommits = commitCount(this->dir.filePath("builder"));
+    const auto clientCommits = commitCount(this->dir.filePath("client"));
+
+    const auto delta = this->dir.filePath("demo.delta");
+    auto result = this->builder->exportDelta(reference("1.0.0.0"), reference("2.0.0.0"), delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    // Canonical commits are not left behind.
+    EXPECT_EQ(commitCount(this->dir.filePath("builder")), builderCommits);
+
+    result = this->client->importDelta(delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    // Only the commit of the new version is added.
+    EXPECT_EQ(commitCount(this->dir.filePath("client")), clientCommits + 1);
+
+    auto layerDir = this->client->getLayerDir(reference("2.0.0.0"));
+    ASSERT_TRUE(layerDir.has_value()) << layerDir.error().message().toStdString();
+    QFile changed(layerDir->absoluteFilePath("files/changed"));
+    ASSERT_TRUE(changed.open(QIODevice::ReadOnly));
+    EXPECT_EQ(changed.readAll(), "new");
+}
+
+TEST_F(OSTreeRepoExportTest, DeltaDifferentFromRemote)
+{
+    this->importLayer(*this->builder, "1.0.0.0", oldFiles);
+    this->importLayer(*this->builder, "2.0.0.0", newFiles);
+    this->importLayer(*this->server, "2.0.0.0", { { "changed", "published" } });
+    this->importLayer(*this->client, "1.0.0.0", oldFiles);
+
+    const auto delta = this->dir.filePath("demo.delta");
+    auto result = this->builder->exportDelta(reference("1.0.0.0"), reference("2.0.0.0"), delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    EXPECT_FALSE(this->client->importDelta(delta).has_value());
+    EXPECT_FALSE(this->client->getLayerDir(reference("2.0.0.0")).has_value());
+}
+
+TEST_F(OSTreeRepoExportTest, DeltaWithoutBase)
+{
+    this->importLayer(*this->builder, "1.0.0.0", oldFiles);
+    this->importLayer(*this->builder, "2.0.0.0", newFiles);
+    this->importLayer(*this->server, "2.0.0.0", newFiles);
+    this->importLayer(*this->client, "1.0.0.0", { { "changed", "other" } });
+
+    const auto delta = this->dir.filePath("demo.delta");
+    auto result = this->builder->exportDelta(reference("1.0.0.0"), reference("2.0.0.0"), delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    EXPECT_FALSE(this->client->importDelta(delta).has_value());
+}
+
+TEST_F(OSTreeRepoExportTest, DeltaOffline)
+{
+    // The remote repository can not be reached.
+    this->client = this->open("offline", "unreachable");
+    this->importLayer(*this->builder, "1.0.0.0", oldFiles);
+    this->importLayer(*this->builder, "2.0.0.0", newFiles);
+    this->importLayer(*this->client, "1.0.0.0", oldFiles);
+
+    const auto delta = this->dir.filePath("demo.delta");
+    auto result = this->builder->exportDelta(reference("1.0.0.0"), reference("2.0.0.0"), delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    result = this->client->importDelta(delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    EXPECT_TRUE(this->client->getLayerDir(reference("2.0.0.0")).has_value());
+}
+
+TEST_F(OSTreeRepoExportTest, CorruptedDelta)
+{
+    this->client = this->open("offline", "unreachable");
+    this->importLayer(*this->builder, "1.0.0.0", oldFiles);
+    this->importLayer(*this->builder, "2.0.0.0", newFiles);
+    this->importLayer(*this->client, "1.0.0.0", oldFiles);
+
+    const auto delta = this->dir.filePath("demo.delta");
+    auto result = this->builder->exportDelta(reference("1.0.0.0"), reference("2.0.0.0"), delta);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    QFile file(delta);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(file.seek(file.size() - 1));
+    const auto last = file.read(1);
+    ASSERT_TRUE(file.seek(file.size() - 1));
+    ASSERT_EQ(file.write(QByteArray(1, static_cast<char>(~last.at(0)))), 1);
+    file.close();
+
+    EXPECT_FALSE(this->client->importDelta(delta).has_value());
+    EXPECT_FALSE(this->client->getLayerDir(reference("2.0.0.0")).has_value());
+}
+
+TEST_F(OSTreeRepoExportTest, BundleRoundTrip)
+{
+    this->importLayer(*this->builder, "1.0.0.0", oldFiles);
+
+    const auto bundle = this->dir.filePath("demo.bundle");
+    auto result = this->builder->exportBundle({ reference("1.0.0.0") }, bundle);
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+
+    auto refs = this->client->importBundle(bundle);
+    ASSERT_TRUE(refs.has_value()) << refs.error().message().toStdString();
+    ASSERT_EQ(refs->size(), 1);
+    EXPECT_EQ(refs->at(0).toString(), reference("1.0.0.0").toString());
+
+    auto layerDir = this->client->getLayerDir(reference("1.0.0.0"));
+    ASSERT_TRUE(layerDir.has_value()) << layerDir.error().message().toStdString();
+    QFile changed(layerDir->absoluteFilePath("files/changed"));
+    ASSERT_TRUE(changed.open(QIODevice::ReadOnly));
+    EXPECT_EQ(changed.readAll(), "old");
+
+    // Layers installed already are skipped.
+    refs = this->client->importBundle(bundle);
+    ASSERT_TRUE(refs.has_value()) << refs.error().message().toStdString();
+    EXPECT_TRUE(refs->empty());
+}
+
+TEST_F(OSTreeRepoExportTest, BundleWithUnexpectedMembers)
+{
+    QDir content(this->dir.filePath("content"));
+    ASSERT_TRUE(content.mkpath("repo"));
+    QFile bundleInfo(content.absoluteFilePath("bundle.json"));
+    ASSERT_TRUE(bundleInfo.open(QIODevice::WriteOnly));
+    bundleInfo.write(R"({"version": "1", "layers": []})");
+    bundleInfo.close();
+    QFile other(content.absoluteFilePath("other"));
+    ASSERT_TRUE(other.open(QIODevice::WriteOnly));
+    other.close();
+    ASSERT_TRUE(QFile::link("/etc/passwd", content.absoluteFilePath("repo/link")));
+
+    for (const auto &member : { "other", "repo/link" }) {
+        const auto bundle = this->dir.filePath("evil.bundle");
+        QFile::remove(bundle);
+        ASSERT_EQ(QProcess::execute("tar",
+                                    { "-cf", bundle, "-C", content.absolutePath(), "bundle.json",
+                                      member }),
+                  0);
+
+        EXPECT_FALSE(this->client->importBundle(bundle).has_value()) << member;
+    }
+}
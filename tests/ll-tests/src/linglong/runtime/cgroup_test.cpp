@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/cgroup.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+TEST(Cgroup, UnifiedResources)
+{
+    linglong::api::types::v1::ApplicationConfigurationPermissionsResources resources;
+    EXPECT_TRUE(linglong::runtime::cgroup::unifiedResources(resources).empty());
+
+    resources.cpuWeight = 50;
+    resources.ioWeight = 200;
+    resources.memoryHigh = 1024;
+    resources.memoryMax = 2048;
+
+    auto unified = linglong::runtime::cgroup::unifiedResources(resources);
+    EXPECT_EQ(unified.size(), 4);
+    EXPECT_EQ(unified["cpu.weight"], "50");
+    EXPECT_EQ(unified["io.weight"], "default 200");
+    EXPECT_EQ(unified["memory.high"], "1024");
+    EXPECT_EQ(unified["memory.max"], "2048");
+}
+
+namespace {
+
+// Write content to path in root, creating the directories.
+void writeFile(const QDir &root, const QString &path, const QByteArray &content)
+{
+    ASSERT_TRUE(QFileInfo(root.absoluteFilePath(path)).dir().mkpath("."));
+    QFile file(root.absoluteFilePath(path));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(file.write(content), content.size());
+}
+
+} // namespace
+
+TEST(Cgroup, Stats)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QDir root(dir.path());
+    const QString cgroup = "sys/fs/cgroup/app.slice/app.scope/";
+
+    writeFile(root, "proc/1234/cgroup", "0::/app.slice/app.scope\n");
+    writeFile(root,
+              cgroup + "cpu.stat",
+              "usage_usec 1500\nuser_usec 1000\nsystem_usec 500\n");
+    writeFile(root, cgroup + "memory.stat", "anon 4096\nfile 65536\nfile_mapped 8192\n");
+    writeFile(root, cgroup + "memory.current", "131072\n");
+    writeFile(root, cgroup + "pids.current", "3\n");
+    writeFile(root,
+              cgroup + "io.stat",
+              "8:0 rbytes=100 wbytes=200 rios=1 wios=2\n"
+              "8:16 rbytes=10 wbytes=20 rios=1 wios=2\n");
+
+    auto stats = linglong::runtime::cgroup::stats(1234, root);
+    ASSERT_TRUE(stats.has_value()) << stats.error().message().toStdString();
+    EXPECT_EQ(stats->cpuUsageUsec, 1500);
+    // The page cache is not counted.
+    EXPECT_EQ(stats->rss, 4096 + 8192);
+    EXPECT_EQ(stats->pids, 3);
+    EXPECT_EQ(stats->ioReadBytes, 110);
+    EXPECT_EQ(stats->ioWriteBytes, 220);
+
+    // Controllers which are not enabled have no interface files.
+    ASSERT_TRUE(QFile::remove(root.absoluteFilePath(cgroup + "memory.stat")));
+    ASSERT_TRUE(QFile::remove(root.absoluteFilePath(cgroup + "io.stat")));
+    ASSERT_TRUE(QFile::remove(root.absoluteFilePath(cgroup + "cpu.stat")));
+    stats = linglong::runtime::cgroup::stats(1234, root);
+    ASSERT_TRUE(stats.has_value()) << stats.error().message().toStdString();
+    EXPECT_FALSE(stats->cpuUsageUsec.has_value());
+    EXPECT_EQ(stats->rss, 131072);
+    EXPECT_FALSE(stats->ioReadBytes.has_value());
+
+    // Processes in cgroup v1 hierarchies only.
+    writeFile(root, "proc/1234/cgroup", "1:name=systemd:/app.slice\n");
+    EXPECT_FALSE(linglong::runtime::cgroup::stats(1234, root).has_value());
+    EXPECT_FALSE(linglong::runtime::cgroup::stats(4321, root).has_value());
+}
+
+TEST(Cgroup, Placement)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QDir root(dir.path());
+    const QString appID = "org.deepin.demo";
+    const QString containerID = "container";
+
+    // Not a cgroup v2 hierarchy.
+    EXPECT_FALSE(linglong::runtime::cgroup::placement(appID, containerID, root).has_value());
+
+    // Next to the cgroup of this process.
+    writeFile(root, "sys/fs/cgroup/cgroup.controllers", "cpu memory pids\n");
+    writeFile(root, "sys/fs/cgroup/user.slice/ll-cli.scope/cgroup.controllers", "cpu memory\n");
+    writeFile(root, "proc/self/cgroup", "0::/user.slice/ll-cli.scope\n");
+    auto placement = linglong::runtime::cgroup::placement(appID, containerID, root);
+    ASSERT_TRUE(placement.has_value());
+    EXPECT_FALSE(placement->systemd);
+    EXPECT_EQ(QString::fromStdString(placement->path).section('_', 0, 0),
+              "/user.slice/linglong-org.deepin.demo");
+    EXPECT_EQ(linglong::runtime::cgroup::controllers(root), QStringList({ "cpu", "memory" }));
+
+    // Names of scopes are unique for each container.
+    auto other = linglong::runtime::cgroup::placement(appID, "other", root);
+    ASSERT_TRUE(other.has_value());
+    EXPECT_NE(other->path, placement->path);
+
+    // In a systemd transient scope, characters which are separators are replaced.
+    ASSERT_TRUE(root.mkpath("run/systemd/system"));
+    const auto runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    writeFile(root, "." + runtimeDir + "/bus", {});
+    placement = linglong::runtime::cgroup::placement("org.deepin:demo-app", containerID, root);
+    ASSERT_TRUE(placement.has_value());
+    EXPECT_TRUE(placement->systemd);
+    EXPECT_EQ(QString::fromStdString(placement->path).section('_', 0, -2),
+              "app.slice:linglong:org.deepin_demo_app");
+}
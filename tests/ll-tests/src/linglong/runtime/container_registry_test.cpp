@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/container_registry.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <unistd.h>
+
+namespace {
+
+using linglong::api::types::v1::ContainerRegistryEntry;
+using linglong::runtime::ContainerRegistry;
+
+// Read the start time of this process, which is the 22nd field of /proc/self/stat.
+auto startTime() -> int64_t
+{
+    QFile stat("/proc/self/stat");
+    EXPECT_TRUE(stat.open(QIODevice::ReadOnly));
+    auto content = stat.readAll();
+    return content.mid(content.lastIndexOf(')') + 2).split(' ').at(22 - 3).toLongLong();
+}
+
+class ContainerRegistryTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(this->dir.isValid());
+        ASSERT_TRUE(QDir(this->dir.path()).mkpath("bundle"));
+    }
+
+    // An entry of a running container which is this process.
+    auto entry(const QString &appID, const QString &suffix) -> ContainerRegistryEntry
+    {
+        const auto ref = "main:" + appID + "/1.0.0.0/x86_64";
+        ContainerRegistryEntry entry;
+        entry.appId = appID.toStdString();
+        entry.bundle = QDir(this->dir.path()).absoluteFilePath("bundle").toStdString();
+        entry.containerId = (ref + "-" + suffix).toUtf8().toBase64().toStdString();
+        entry.pid = getpid();
+        entry.ref = ref.toStdString();
+        entry.startTime = startTime();
+        return entry;
+    }
+
+    auto registryDir() const -> QDir { return QDir(this->dir.filePath("containers")); }
+
+    QTemporaryDir dir;
+};
+
+} // namespace
+
+TEST_F(ContainerRegistryTest, AddListFind)
+{
+    ContainerRegistry registry(this->registryDir());
+    const auto demo = this->entry("org.deepin.demo", "first");
+    const auto other = this->entry("org.deepin.other", "second");
+    ASSERT_TRUE(registry.add(demo).has_value());
+    ASSERT_TRUE(registry.add(other).has_value());
+
+    EXPECT_EQ(registry.list().size(), 2);
+    auto entries = registry.list("org.deepin.demo");
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries.front().containerId, demo.containerId);
+
+    auto entry = registry.get(QString::fromStdString(other.containerId));
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->appId, other.appId);
+
+    entry = registry.find(QString::fromStdString(demo.containerId));
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->containerId, demo.containerId);
+
+    entry = registry.find("org.deepin.other");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->containerId, other.containerId);
+
+    registry.remove(demo);
+    EXPECT_TRUE(registry.list("org.deepin.demo").empty());
+    EXPECT_FALSE(this->registryDir().exists("org.deepin.demo"));
+}
+
+TEST_F(ContainerRegistryTest, StartingContainer)
+{
+    ContainerRegistry registry(this->registryDir());
+    auto entry = this->entry("org.deepin.demo", "starting");
+    entry.pid.reset();
+    entry.startTime.reset();
+    ASSERT_TRUE(registry.add(entry).has_value());
+
+    // The state of the container is not recorded in its bundle yet.
+    auto entries = registry.list("org.deepin.demo");
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_FALSE(entries.front().pid.has_value());
+
+    // Its bundle is removed after it exits.
+    ASSERT_TRUE(QDir(QString::fromStdString(entry.bundle)).removeRecursively());
+    EXPECT_TRUE(registry.list("org.deepin.demo").empty());
+}
+
+TEST_F(ContainerRegistryTest, StalePID)
+{
+    ContainerRegistry registry(this->registryDir());
+    auto entry = this->entry("org.deepin.demo", "stale");
+    // The PID is reused by another process.
+    entry.startTime = *entry.startTime + 1;
+    ASSERT_TRUE(registry.add(entry).has_value());
+
+    EXPECT_TRUE(registry.list("org.deepin.demo").empty());
+    EXPECT_FALSE(registry.get(QString::fromStdString(entry.containerId)).has_value());
+    EXPECT_TRUE(this->registryDir().isEmpty());
+}
+
+TEST_F(ContainerRegistryTest, PrefixMatch)
+{
+    ContainerRegistry registry(this->registryDir());
+    const auto entry = this->entry("org.deepin.demo", "prefix");
+    ASSERT_TRUE(registry.add(entry).has_value());
+
+    auto found = registry.find("main:org.deepin.demo/1.0.0.0");
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->containerId, entry.containerId);
+
+    EXPECT_FALSE(registry.find("main:org.deepin.other").has_value());
+}
+
+TEST_F(ContainerRegistryTest, RejectPaths)
+{
+    ContainerRegistry registry(this->registryDir());
+    const auto entry = this->entry("org.deepin.demo", "path");
+    ASSERT_TRUE(registry.add(entry).has_value());
+
+    EXPECT_TRUE(registry.list("..").empty());
+    EXPECT_TRUE(registry.list("org.deepin.demo/..").empty());
+    EXPECT_FALSE(registry.find("..").has_value());
+    EXPECT_FALSE(registry.find("../containers/org.deepin.demo").has_value());
+    EXPECT_FALSE(registry.find("").has_value());
+
+    auto evil = this->entry("../evil", "evil");
+    EXPECT_FALSE(registry.add(evil).has_value());
+    EXPECT_FALSE(QDir(this->dir.path()).exists("evil"));
+}
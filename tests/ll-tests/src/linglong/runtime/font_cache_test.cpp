@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/font_cache.h"
+#include "linglong/utils/configure.h"
+
+#include <QTemporaryDir>
+
+using linglong::runtime::FontCache;
+
+TEST(FontCache, CacheDirOfInstalledBase)
+{
+    const QString layer = "main/org.deepin.foundation/23.0.0/x86_64/binary";
+    auto dir = FontCache::cacheDir(QDir(LINGLONG_ROOT "/layers/" + layer));
+    ASSERT_TRUE(dir.has_value());
+    EXPECT_EQ(dir->absolutePath(),
+              QDir(LINGLONG_ROOT "/cache/fontconfig/" + layer).absolutePath());
+}
+
+TEST(FontCache, CacheDirOfOtherBase)
+{
+    EXPECT_FALSE(FontCache::cacheDir(QDir(LINGLONG_ROOT "/layers")).has_value());
+    EXPECT_FALSE(FontCache::cacheDir(QDir("/tmp/layers/org.deepin.foundation")).has_value());
+}
+
+TEST(FontCache, GenerateWithoutFcCache)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    EXPECT_FALSE(FontCache::find(QDir(dir.path())).has_value());
+    EXPECT_FALSE(FontCache::generate(QDir(dir.path())).has_value());
+}
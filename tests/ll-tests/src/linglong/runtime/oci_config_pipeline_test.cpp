@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/oci_config_pipeline.h"
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+using linglong::api::types::v1::OciConfigurationPatch;
+using linglong::runtime::OCIConfigPipeline;
+
+constexpr std::size_t mountCount = 500;
+
+nlohmann::json baseConfig()
+{
+    return {
+        { "ociVersion", "1.0.1" },
+        { "root", { { "path", "/" } } },
+        { "mounts", nlohmann::json::array() },
+    };
+}
+
+std::vector<OciConfigurationPatch> mountPatches()
+{
+    std::vector<OciConfigurationPatch> patches;
+    for (std::size_t i = 0; i < mountCount; ++i) {
+        auto path = "/tmp/linglong-test/" + std::to_string(i);
+        patches.push_back({ .ociVersion = "1.0.1",
+                            .patch = { nlohmann::json::object({
+                              { "op", "add" },
+                              { "path", "/mounts/-" },
+                              { "value",
+                                { { "source", path },
+                                  { "destination", path },
+                                  { "type", "bind" },
+                                  { "options", nlohmann::json::array({ "rbind" }) } } },
+                            }) } });
+    }
+    return patches;
+}
+
+} // namespace
+
+TEST(OCIConfigPipeline, MergedPatches)
+{
+    OCIConfigPipeline pipeline(baseConfig());
+    pipeline.addPatches(mountPatches());
+
+    auto config = pipeline.finish();
+    ASSERT_TRUE(config.has_value());
+    ASSERT_TRUE(config->mounts.has_value());
+    ASSERT_EQ(config->mounts->size(), mountCount);
+    EXPECT_EQ(config->mounts->back().destination,
+              "/tmp/linglong-test/" + std::to_string(mountCount - 1));
+}
+
+TEST(OCIConfigPipeline, BrokenPatchIgnored)
+{
+    OCIConfigPipeline pipeline(baseConfig());
+    auto patches = mountPatches();
+    patches.insert(patches.begin() + 1,
+                   { .ociVersion = "1.0.1",
+                     .patch = { nlohmann::json::object({
+                       { "op", "remove" },
+                       { "path", "/not-exists" },
+                     }) } });
+    for (const auto &patch : patches) {
+        pipeline.addPatch(patch);
+    }
+
+    auto config = pipeline.finish();
+    ASSERT_TRUE(config.has_value());
+    EXPECT_EQ(config->mounts->size(), mountCount);
+}
+
+// Run with --gtest_also_run_disabled_tests to compare patching round trips with a single document.
+TEST(OCIConfigPipeline, DISABLED_Benchmark)
+{
+    const auto patches = mountPatches();
+
+    auto start = std::chrono::steady_clock::now();
+    auto typed = baseConfig().get<ocppi::runtime::config::types::Config>();
+    for (const auto &patch : patches) {
+        auto raw = nlohmann::json(typed);
+        raw = raw.patch(patch.patch);
+        typed = raw.get<ocppi::runtime::config::types::Config>();
+    }
+    auto roundTrip = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    OCIConfigPipeline pipeline(baseConfig());
+    pipeline.addPatches(patches);
+    auto config = pipeline.finish();
+    auto merged = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(config.has_value());
+    EXPECT_EQ(config->mounts->size(), typed.mounts->size());
+
+    using std::chrono::microseconds;
+    std::cout << "apply " << patches.size() << " patches, round trip per patch: "
+              << std::chrono::duration_cast<microseconds>(roundTrip).count()
+              << "us, single document: "
+              << std::chrono::duration_cast<microseconds>(merged).count() << "us" << std::endl;
+}
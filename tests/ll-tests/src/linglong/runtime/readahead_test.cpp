@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/readahead.h"
+#include "linglong/utils/serialize/json.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+using linglong::runtime::Readahead;
+
+TEST(Readahead, RecordProfile)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QDir layer(dir.filePath("files"));
+    ASSERT_TRUE(layer.mkpath("lib"));
+
+    const auto library = layer.absoluteFilePath("lib/libapp.so");
+    {
+        QFile file(library);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(file.write(QByteArray(64 * 1024, 'x')), 64 * 1024);
+    }
+
+    const auto profile = dir.filePath("profile.json");
+    {
+        Readahead readahead(profile, { layer });
+        readahead.start();
+        ASSERT_TRUE(readahead.waitPrepared(std::chrono::seconds(10)));
+        readahead.applicationStarting();
+
+        QFile file(library);
+        ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+        ASSERT_EQ(file.readAll().size(), 64 * 1024);
+
+        readahead.applicationExited();
+    }
+
+    auto recorded = linglong::utils::serialize::LoadJSONFile<nlohmann::json>(profile);
+    ASSERT_TRUE(recorded.has_value());
+    const auto &ranges = recorded->at("files").at(library.toStdString());
+    ASSERT_FALSE(ranges.empty());
+    EXPECT_EQ(ranges[0].at(0), 0);
+
+    // Later launches read the recorded pages ahead.
+    Readahead readahead(profile, { layer });
+    readahead.start();
+    EXPECT_FALSE(readahead.waitPrepared(std::chrono::milliseconds(0)));
+    readahead.applicationStarting();
+}
+
+TEST(Readahead, KeepPagesOfRunningApplication)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QDir layer(dir.filePath("files"));
+    ASSERT_TRUE(layer.mkpath("."));
+
+    const auto library = layer.absoluteFilePath("libapp.so");
+    {
+        QFile file(library);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(file.write(QByteArray(64 * 1024, 'x')), 64 * 1024);
+    }
+    auto before = Readahead::residentPages({ layer });
+
+    // Another instance of the application is running.
+    const auto profile = dir.filePath("profile.json");
+    {
+        Readahead readahead(profile, { layer });
+        readahead.start(false);
+        EXPECT_FALSE(readahead.waitPrepared(std::chrono::milliseconds(0)));
+        readahead.applicationStarting();
+        readahead.applicationExited();
+    }
+
+    EXPECT_FALSE(QFile::exists(profile));
+    if (before.contains(library.toStdString())) {
+        EXPECT_TRUE(Readahead::residentPages({ layer }).contains(library.toStdString()));
+    }
+}
+
+TEST(Readahead, KeepPagesOfSharedLayers)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QDir layer(dir.filePath("app"));
+    QDir shared(dir.filePath("runtime"));
+    ASSERT_TRUE(layer.mkpath("."));
+    ASSERT_TRUE(shared.mkpath("."));
+
+    // The library is in the page cache as another application is using it.
+    const auto library = shared.absoluteFilePath("libshared.so");
+    {
+        QFile file(library);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(file.write(QByteArray(64 * 1024, 'x')), 64 * 1024);
+    }
+    auto before = Readahead::residentPages({ shared });
+    if (!before.contains(library.toStdString())) {
+        GTEST_SKIP() << "pages of new files are not in the page cache";
+    }
+
+    const auto profile = dir.filePath("profile.json");
+    {
+        Readahead readahead(profile, { layer }, { shared });
+        readahead.start();
+        ASSERT_TRUE(readahead.waitPrepared(std::chrono::seconds(10)));
+        readahead.applicationStarting();
+        readahead.applicationExited();
+    }
+
+    EXPECT_EQ(Readahead::residentPages({ shared }), before);
+
+    // Pages in the page cache before the application started are not recorded.
+    auto recorded = linglong::utils::serialize::LoadJSONFile<nlohmann::json>(profile);
+    ASSERT_TRUE(recorded.has_value());
+    EXPECT_FALSE(recorded->at("files").contains(library.toStdString()));
+}
@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/zygote.h"
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+#include <cerrno>
+
+namespace {
+
+using linglong::runtime::Zygote;
+using ocppi::runtime::config::types::Config;
+using ocppi::runtime::config::types::Mount;
+
+Mount bind(const std::string &source, const std::string &destination)
+{
+    return {
+        .destination = destination,
+        .options = { { "rbind" } },
+        .source = source,
+        .type = "bind",
+    };
+}
+
+} // namespace
+
+TEST(Zygote, RequestMissingMounts)
+{
+    Config zygoteConfig;
+    zygoteConfig.mounts = {
+        bind("/usr/share/fonts", "/usr/share/fonts"),
+        bind("/home/user/.linglong/zygote/config", "/home/user/.config"),
+    };
+
+    Config config;
+    config.mounts = {
+        bind("/usr/share/fonts", "/usr/share/fonts"),
+        bind("/home/user/.linglong/app/config", "/home/user/.config"),
+        Mount{
+          .destination = "/opt/apps",
+          .options = { { "nodev", "nosuid", "mode=700" } },
+          .source = "tmpfs",
+          .type = "tmpfs",
+        },
+    };
+    config.process = ocppi::runtime::config::types::Process{
+        .args = { { "app", "--flag" } },
+        .cwd = "/run/host/rootfs/home/user",
+        .env = { { "HOME=/home/user" } },
+        .noNewPrivileges = true,
+        .rlimits = { { { .hard = 1024, .soft = 512, .type = "RLIMIT_NOFILE" } } },
+    };
+
+    auto request = Zygote::request(zygoteConfig, config);
+    ASSERT_TRUE(request.has_value()) << request.error().message().toStdString();
+
+    const auto &mounts = request->at("mounts");
+    ASSERT_EQ(mounts.size(), 2);
+    EXPECT_EQ(mounts[0].at("source"), "/run/host/rootfs/home/user/.linglong/app/config");
+    EXPECT_EQ(mounts[0].at("destination"), "/home/user/.config");
+    EXPECT_EQ(mounts[1].at("source"), "tmpfs");
+
+    EXPECT_EQ(request->at("args"), nlohmann::json({ "app", "--flag" }));
+    EXPECT_EQ(request->at("cwd"), "/run/host/rootfs/home/user");
+    EXPECT_EQ(request->at("env"), nlohmann::json({ "HOME=/home/user" }));
+    EXPECT_EQ(request->at("noNewPrivileges"), true);
+    ASSERT_EQ(request->at("rlimits").size(), 1);
+    EXPECT_EQ(request->at("rlimits")[0].at("type"), "RLIMIT_NOFILE");
+    EXPECT_EQ(request->at("rlimits")[0].at("soft"), 512);
+}
+
+TEST(Zygote, RequestIsolation)
+{
+    Config config;
+    config.process = ocppi::runtime::config::types::Process{ .args = { { "app" } } };
+    config.linux = ocppi::runtime::config::types::Linux{
+        .maskedPaths = { { "/proc/kcore" } },
+        .readonlyPaths = { { "/proc/sys" } },
+    };
+
+    auto request = Zygote::request(Config{}, config);
+    ASSERT_TRUE(request.has_value()) << request.error().message().toStdString();
+    EXPECT_EQ(request->at("maskedPaths"), nlohmann::json({ "/proc/kcore" }));
+    EXPECT_EQ(request->at("readonlyPaths"), nlohmann::json({ "/proc/sys" }));
+
+    // Empty capability sets are the same as no capabilities.
+    config.process->capabilities = ocppi::runtime::config::types::Capabilities{
+        .bounding = std::vector<std::string>{},
+    };
+    EXPECT_TRUE(Zygote::request(Config{}, config).has_value());
+}
+
+TEST(Zygote, RequestUnsupportedIsolation)
+{
+    Config config;
+    config.process = ocppi::runtime::config::types::Process{ .args = { { "app" } } };
+
+    auto withCapabilities = config;
+    withCapabilities.process->capabilities = ocppi::runtime::config::types::Capabilities{
+        .bounding = { { "CAP_NET_RAW" } },
+    };
+    auto withApparmor = config;
+    withApparmor.process->apparmorProfile = "app";
+    auto withSeccomp = config;
+    withSeccomp.linux = ocppi::runtime::config::types::Linux{
+        .seccomp = ocppi::runtime::config::types::Seccomp{},
+    };
+
+    for (const auto &unsupported : { withCapabilities, withApparmor, withSeccomp }) {
+        auto request = Zygote::request(Config{}, unsupported);
+        ASSERT_FALSE(request.has_value());
+        EXPECT_EQ(request.error().code(), ENOTSUP);
+    }
+}
+
+TEST(Zygote, RequestWithoutCommand)
+{
+    Config config;
+    config.process = ocppi::runtime::config::types::Process{};
+
+    EXPECT_FALSE(Zygote::request(Config{}, config).has_value());
+}
+
+TEST(Zygote, ServerProcess)
+{
+    auto process = Zygote::serverProcess();
+    ASSERT_TRUE(process.args.has_value());
+    ASSERT_GE(process.args->size(), 3);
+
+    // Requests are read from the bundles on the host.
+    const auto &bundlesDir = process.args->at(2);
+    EXPECT_EQ(bundlesDir.rfind("/run/host/rootfs/", 0), 0) << bundlesDir;
+    EXPECT_EQ(bundlesDir.substr(bundlesDir.size() - std::string("/linglong").size()), "/linglong")
+      << bundlesDir;
+}
+
+TEST(Zygote, ContainerID)
+{
+    EXPECT_EQ(Zygote::containerID({ "runtime", "base" }),
+              Zygote::containerID({ "runtime", "base" }));
+    EXPECT_NE(Zygote::containerID({ "runtime", "base" }), Zygote::containerID({ "base" }));
+}
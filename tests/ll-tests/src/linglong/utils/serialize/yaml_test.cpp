@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/utils/serialize/yaml.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace {
+
+// Write the file with a modification time in the past,
+// files modified just now are not cached.
+void writeFile(const QString &path, const QByteArray &content, time_t mtime)
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    ASSERT_EQ(file.write(content), content.size());
+    file.close();
+
+    const timespec times[2]{ { mtime, 0 }, { mtime, 0 } };
+    ASSERT_EQ(::utimensat(AT_FDCWD, path.toLocal8Bit().constData(), times, 0), 0);
+}
+
+class YAMLCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        oldCacheHome = qgetenv("XDG_CACHE_HOME");
+        qputenv("XDG_CACHE_HOME", dir.filePath("cache").toUtf8());
+    }
+
+    void TearDown() override { qputenv("XDG_CACHE_HOME", oldCacheHome); }
+
+    QTemporaryDir dir;
+    QByteArray oldCacheHome;
+};
+
+} // namespace
+
+TEST_F(YAMLCacheTest, InvalidatedByModification)
+{
+    const auto path = dir.filePath("config.yaml");
+    writeFile(path, "version: 1\nname: first\n", 1000);
+
+    auto json = linglong::utils::serialize::LoadYAMLFileAsJSON(path);
+    ASSERT_TRUE(json.has_value()) << json.error().message().toStdString();
+    EXPECT_EQ(json->at("name"), "first");
+    EXPECT_EQ(QDir(dir.filePath("cache/linglong/yaml")).entryList(QDir::Files).size(), 1);
+
+    json = linglong::utils::serialize::LoadYAMLFileAsJSON(path);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_EQ(json->at("name"), "first");
+
+    writeFile(path, "version: 1\nname: other\n", 2000);
+    json = linglong::utils::serialize::LoadYAMLFileAsJSON(path);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_EQ(json->at("name"), "other");
+}
+
+TEST_F(YAMLCacheTest, InvalidYAML)
+{
+    const auto path = dir.filePath("config.yaml");
+    writeFile(path, "version: [1\n", 1000);
+
+    EXPECT_FALSE(linglong::utils::serialize::LoadYAMLFileAsJSON(path).has_value());
+}
+
+// Run with --gtest_also_run_disabled_tests to compare parsing by ytj with the cache.
+TEST_F(YAMLCacheTest, DISABLED_Benchmark)
+{
+    QByteArray content = "version: 1\ndefaultRepo: stable\nrepos:\n";
+    constexpr auto repoCount = 64;
+    for (int i = 0; i < repoCount; ++i) {
+        content += QString("  repo%1: https://mirror%1.example.com/repos/stable\n").arg(i).toUtf8();
+    }
+    const auto path = dir.filePath("config.yaml");
+    writeFile(path, content, 1000);
+
+    constexpr auto rounds = 1000;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < rounds; ++i) {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+        auto json = ytj::to_json(YAML::Load(file.readAll().toStdString()));
+        ASSERT_EQ(json.at("version"), 1);
+    }
+    const auto ytjTime = timer.nsecsElapsed();
+
+    ASSERT_TRUE(linglong::utils::serialize::LoadYAMLFileAsJSON(path).has_value());
+    timer.restart();
+    for (int i = 0; i < rounds; ++i) {
+        auto json = linglong::utils::serialize::LoadYAMLFileAsJSON(path);
+        ASSERT_TRUE(json.has_value());
+    }
+    const auto cacheTime = timer.nsecsElapsed();
+
+    std::cout << "ytj: " << ytjTime / rounds / 1000 << "us per load, cache: "
+              << cacheTime / rounds / 1000 << "us per load" << std::endl;
+}
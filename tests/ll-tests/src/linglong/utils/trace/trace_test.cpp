@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/utils/serialize/json.h"
+#include "linglong/utils/trace/trace.h"
+
+#include <QTemporaryDir>
+
+namespace trace = linglong::utils::trace;
+
+TEST(Trace, Disabled)
+{
+    ASSERT_FALSE(trace::enabled());
+    {
+        LINGLONG_SPAN("ignored");
+    }
+    EXPECT_FALSE(trace::flush().has_value());
+}
+
+TEST(Trace, WriteSpans)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    auto file = dir.filePath("trace.json");
+
+    trace::enable(file);
+    {
+        trace::Span span("outer");
+        span.arg("key", "value");
+        LINGLONG_SPAN("inner");
+    }
+    trace::instant("mark", trace::Clock::now());
+    ASSERT_TRUE(trace::flush().has_value());
+    EXPECT_FALSE(trace::enabled());
+
+    auto document = linglong::utils::serialize::LoadJSONFile<nlohmann::json>(file);
+    ASSERT_TRUE(document.has_value());
+
+    const auto &events = document->at("traceEvents");
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events[0].at("name"), "inner");
+    EXPECT_EQ(events[1].at("name"), "outer");
+    EXPECT_EQ(events[1].at("ph"), "X");
+    EXPECT_EQ(events[1].at("args").at("key"), "value");
+    EXPECT_LE(events[1].at("ts").get<std::int64_t>(), events[0].at("ts").get<std::int64_t>());
+    EXPECT_EQ(events[2].at("ph"), "i");
+    EXPECT_EQ(events[3].at("ph"), "M");
+}
+
+TEST(Trace, WallTime)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    auto file = dir.filePath("trace.json");
+
+    trace::enable(file);
+    const auto before = trace::WallClock::now();
+    const auto start = trace::Clock::now();
+    trace::complete("span", start, start + std::chrono::seconds(1));
+    trace::instant("mark", trace::WallClock::now());
+    const auto after = trace::WallClock::now();
+    ASSERT_TRUE(trace::flush().has_value());
+
+    auto document = linglong::utils::serialize::LoadJSONFile<nlohmann::json>(file);
+    ASSERT_TRUE(document.has_value());
+
+    // Timestamps are wall times, durations are measured by the monotonic clock.
+    const auto microseconds = [](trace::WallClock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch())
+          .count();
+    };
+    const auto &events = document->at("traceEvents");
+    ASSERT_EQ(events.size(), 3);
+    EXPECT_EQ(events[0].at("dur").get<std::int64_t>(), 1000 * 1000);
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_GE(events[i].at("ts").get<std::int64_t>(), microseconds(before) - 1000 * 1000);
+        EXPECT_LE(events[i].at("ts").get<std::int64_t>(), microseconds(after) + 1000 * 1000);
+    }
+}
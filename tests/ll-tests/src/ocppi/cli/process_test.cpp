@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "ocppi/cli/Process.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <future>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST(Process, ExitStatus)
+{
+    EXPECT_EQ(runProcess("/bin/true", {}), 0);
+    EXPECT_EQ(runProcess("/bin/false", {}), 1);
+    EXPECT_EQ(runProcess("/bin/sh", { "-c", "exit 42" }), 42);
+}
+
+TEST(Process, Output)
+{
+    std::string output;
+    EXPECT_EQ(runProcess("/bin/sh", { "-c", "echo hello; exit 3" }, output), 3);
+    EXPECT_EQ(output, "hello\n");
+
+    // Larger than the buffer used to read the pipe.
+    output.clear();
+    EXPECT_EQ(runProcess("/bin/sh", { "-c", "head -c 200000 /dev/zero" }, output), 0);
+    EXPECT_EQ(output.size(), 200000);
+}
+
+TEST(Process, KilledBySignal)
+{
+    EXPECT_EQ(runProcess("/bin/sh", { "-c", "kill -TERM $$" }), 128 + SIGTERM);
+
+    std::string output;
+    EXPECT_EQ(runProcess("/bin/sh", { "-c", "echo started; kill -KILL $$" }, output),
+              128 + SIGKILL);
+    EXPECT_EQ(output, "started\n");
+}
+
+TEST(Process, ExecutableNotFound)
+{
+    try {
+        runProcess("/not/exists", {});
+        FAIL() << "no exception thrown";
+    } catch (const std::system_error &e) {
+        EXPECT_EQ(e.code().value(), ENOENT);
+    }
+}
+
+TEST(Process, Timeout)
+{
+    using namespace std::chrono_literals;
+
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        runProcess("/bin/sleep", { "10" }, 100ms);
+        FAIL() << "no exception thrown";
+    } catch (const std::system_error &e) {
+        EXPECT_EQ(e.code().value(), ETIMEDOUT);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    std::string output;
+    EXPECT_EQ(runProcess("/bin/sh", { "-c", "echo fast" }, output, 10s), 0);
+    EXPECT_EQ(output, "fast\n");
+}
+
+// Only the spawned process is waited, other children of the caller are left to their owners.
+TEST(Process, OtherChildrenNotReaped)
+{
+    const auto other = ::fork();
+    ASSERT_NE(other, -1);
+    if (other == 0) {
+        ::_exit(7);
+    }
+
+    // Let the other child exit before the spawned one.
+    siginfo_t info{};
+    ASSERT_EQ(::waitid(P_PID, other, &info, WEXITED | WNOWAIT), 0);
+
+    EXPECT_EQ(runProcess("/bin/false", {}), 1);
+
+    int status = 0;
+    ASSERT_EQ(::waitpid(other, &status, 0), other);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 7);
+}
+
+TEST(Process, ConcurrentWaits)
+{
+    std::vector<std::future<std::pair<int, std::string>>> futures;
+    for (int i = 0; i < 8; ++i) {
+        futures.push_back(runProcessAsync(
+          "/bin/sh",
+          { "-c", "sleep 0.$(( 8 - " + std::to_string(i) + " )); echo " + std::to_string(i)
+                    + "; exit " + std::to_string(i) }));
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        auto [code, output] = futures[i].get();
+        EXPECT_EQ(code, i);
+        EXPECT_EQ(output, std::to_string(i) + "\n");
+    }
+}
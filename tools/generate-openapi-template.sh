@@ -29,3 +29,4 @@ cp ./openapi-generator/modules/openapi-generator/src/main/resources/cpp-qt-clien
 
 patch -s -p0 <./no-qt-keywords.patch
 patch -s -p0 <./no-cmake.patch
+patch -s -p0 <./stream-multipart.patch